@@ -0,0 +1,102 @@
+#include <cstdlib>
+#include "bench.hpp"
+#include "../matrix/banded.hpp"
+#include "../matrix/util.hpp"
+
+/*
+ * Band solvers: Thomas and the banded LU against dense gauss() on the
+ * same tridiagonal system, and many small systems solved one by one with
+ * Thomas against one cyclic reduction over the whole batch.
+ */
+namespace {
+	typedef Math::DynamicMatrix<double> MatrixXd;
+
+	double random() {
+		return static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+	}
+
+	Math::TridiagonalMatrix<double> randomTridiagonal(int n) {
+		Math::TridiagonalMatrix<double> A(n);
+		for(int i = 0; i < n; ++i) {
+			A.lower()[i] = i > 0 ? random() : 0;
+			A.diagonal()[i] = random() + 4;
+			A.upper()[i] = i < n - 1 ? random() : 0;
+		}
+		return A;
+	}
+
+	MatrixXd randomVector(int n) {
+		MatrixXd b(n, 1);
+		for(int i = 0; i < n; ++i) {
+			b(i, 0) = random();
+		}
+		return b;
+	}
+
+	Bench::Result result(const char *name, const char *variant, int n, double seconds, double flops) {
+		Bench::Result r = {name, variant, "double", n, seconds, flops, 0};
+		return r;
+	}
+
+	void banded() {
+		Bench::printHeader();
+		std::srand(1);
+		for(int n : {500, 1000}) {
+			const Math::TridiagonalMatrix<double> A = randomTridiagonal(n);
+			const MatrixXd b = randomVector(n), dense = A.toDense();
+			MatrixXd ext(n, n + 1), x;
+			double t = Bench::perCall([&]() {
+				for(int i = 0; i < n; ++i) {
+					std::copy(dense.data() + i * n, dense.data() + (i + 1) * n, ext.data() + i * (n + 1));
+					ext(i, n) = b(i, 0);
+				}
+				Math::gauss(ext, x, Math::Pivoting::Rows);
+			});
+			Bench::record(result("tridiagonal", "gauss", n, t, 2.0 / 3 * n * n * n));
+			t = Bench::perCall([&]() { Math::thomas(A, b, x); });
+			Bench::record(result("tridiagonal", "thomas", n, t, 8.0 * n));
+		}
+		for(int n : {100000, 1000000}) {
+			const Math::TridiagonalMatrix<double> A = randomTridiagonal(n);
+			const Math::BandedMatrix<double> B(A);
+			const MatrixXd b = randomVector(n);
+			MatrixXd x;
+			double t = Bench::perCall([&]() { Math::thomas(A, b, x); });
+			Bench::record(result("tridiagonal", "thomas", n, t, 8.0 * n));
+			t = Bench::perCall([&]() { x = Math::BandedLU<double>(B).solve(b); });
+			Bench::record(result("tridiagonal", "band LU", n, t, 13.0 * n));
+			t = Bench::perCall([&]() { B.multiply(b.data(), x.data()); });
+			Bench::record(result("multiply", "banded", n, t, 6.0 * n));
+		}
+
+		/* count systems of size n: one Thomas call each, or a single cyclic reduction */
+		const int count = 1024;
+		Math::ThreadPool pool;
+		for(int n : {64, 512}) {
+			std::vector<Math::TridiagonalMatrix<double> > systems;
+			Math::TridiagonalBatch<double> batch(n, count);
+			MatrixXd B(n, count), X, x;
+			std::vector<MatrixXd> rhs;
+			for(int s = 0; s < count; ++s) {
+				systems.push_back(randomTridiagonal(n));
+				batch.set(s, systems.back());
+				rhs.push_back(randomVector(n));
+				for(int i = 0; i < n; ++i) {
+					B(i, s) = rhs.back()(i, 0);
+				}
+			}
+			double t = Bench::perCall([&]() {
+				for(int s = 0; s < count; ++s) {
+					Math::thomas(systems[s], rhs[s], x);
+				}
+			});
+			Bench::record(result("batch 1024", "thomas", n, t, 8.0 * n * count));
+			t = Bench::perCall([&]() { Math::cyclicReduction(batch, B, X); });
+			Bench::record(result("batch 1024", "cyclic", n, t, 17.0 * n * count));
+			t = Bench::perCall([&]() { Math::cyclicReduction(batch, B, X, pool); });
+			Bench::record(result("batch 1024", "cyclic p", n, t, 17.0 * n * count));
+		}
+	}
+
+	Bench::Register reg("banded", banded);
+}
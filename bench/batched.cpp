@@ -0,0 +1,49 @@
+#include <cstdlib>
+#include <iostream>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/batched.hpp"
+#include "../matrix/lu.hpp"
+
+namespace {
+	/* Batched solve against one LUFactorization per system */
+	template<int n>
+	void batchedSolve(int count) {
+		Math::SmallBatch<double, n, n> A(count);
+		Math::SmallBatch<double, n, 1> B(count), X(count);
+		std::srand(1);
+		for(int k = 0; k < count; ++k) {
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n; ++j) {
+					A(k, i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000 + (i == j) * n;
+				}
+				B(k, i, 0) = 1;
+			}
+		}
+		std::vector<unsigned char> singular(count);
+		double tb = Bench::seconds([&]() { Math::solve(A, B, X, singular.data()); });
+
+		std::vector<Math::Matrix<double, n, n> > mats(count);
+		std::vector<Math::Matrix<double, n, 1> > rhs(count), sol(count);
+		for(int k = 0; k < count; ++k) {
+			mats[k] = A.get(k);
+			rhs[k] = B.get(k);
+		}
+		double tl = Bench::seconds([&]() {
+			for(int k = 0; k < count; ++k) {
+				Math::LUFactorization<Math::Matrix<double, n, n> > lu(mats[k]);
+				sol[k] = lu.solve(rhs[k]);
+			}
+		});
+		std::cout << boost::format("%dx%d %9d systems  batched %7.2f ns/system  LU %7.2f ns/system  x%.1f\n")
+			% n % n % count % (tb / count * 1e9) % (tl / count * 1e9) % (tl / tb);
+	}
+
+	void batched() {
+		batchedSolve<2>(1 << 20);
+		batchedSolve<3>(1 << 20);
+		batchedSolve<4>(1 << 20);
+	}
+
+	Bench::Register reg("batched", batched);
+}
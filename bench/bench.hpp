@@ -0,0 +1,123 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal benchmark registry: every translation unit registers its cases
+ * with a static Bench::Register, main() runs the ones selected on the
+ * command line. Cases that report through record() also end up in the
+ * JSON written by `bench --json file`.
+ */
+namespace Bench
+{
+	struct Case {
+		std::string name;
+		std::function<void()> run;
+	};
+
+	inline std::vector<Case>& registry() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	struct Register {
+		Register(const char *name, std::function<void()> run) {
+			Case c = {name, run};
+			registry().push_back(c);
+		}
+	};
+
+	/** One measurement; flops and iterations are 0 when they do not apply. */
+	struct Result {
+		std::string name;
+		std::string variant;
+		std::string type;
+		int n;
+		double seconds;
+		double flops;
+		int iterations;
+
+		double gflops() const { return flops > 0 ? flops / seconds * 1e-9 : 0; }
+		/** Time per element of the n x n input */
+		double nsPerElement() const { return seconds * 1e9 / (static_cast<double>(n) * n); }
+	};
+
+	inline std::vector<Result>& results() {
+		static std::vector<Result> all;
+		return all;
+	}
+
+	/** Prints one table row and keeps the result for the JSON report. */
+	inline void record(const Result &r) {
+		char line[160];
+		std::snprintf(line, sizeof(line), "%-16s %-8s %-6s %6d %12.6f %9.3f %10.3f %6d\n",
+					  r.name.c_str(), r.variant.c_str(), r.type.c_str(), r.n, r.seconds,
+					  r.gflops(), r.nsPerElement(), r.iterations);
+		std::fputs(line, stdout);
+		results().push_back(r);
+	}
+
+	inline void printHeader() {
+		std::printf("%-16s %-8s %-6s %6s %12s %9s %10s %6s\n",
+					"case", "variant", "type", "n", "seconds", "GFLOP/s", "ns/elem", "iter");
+	}
+
+	inline void writeJson(std::ostream &out) {
+		out << "{\n  \"results\": [";
+		const std::vector<Result> &all = results();
+		for(size_t i = 0; i < all.size(); ++i) {
+			const Result &r = all[i];
+			char obj[512];
+			std::snprintf(obj, sizeof(obj),
+						  "%s\n    {\"name\": \"%s\", \"variant\": \"%s\", \"type\": \"%s\", \"n\": %d, "
+						  "\"seconds\": %.9g, \"gflops\": %.6g, \"ns_per_element\": %.6g, \"iterations\": %d}",
+						  i ? "," : "", r.name.c_str(), r.variant.c_str(), r.type.c_str(), r.n,
+						  r.seconds, r.gflops(), r.nsPerElement(), r.iterations);
+			out << obj;
+		}
+		out << "\n  ]\n}\n";
+	}
+
+	/** Best wall time of `reps` runs of f, in seconds. */
+	template<typename F>
+	double seconds(F f, int reps = 3) {
+		double best = 1e300;
+		for(int r = 0; r < reps; ++r) {
+			auto start = std::chrono::steady_clock::now();
+			f();
+			std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+			best = std::min(best, d.count());
+		}
+		return best;
+	}
+
+	/**
+	 * Wall time of one call of f, averaged over enough calls to run for
+	 * at least minSeconds; best of three such batches.
+	 */
+	template<typename F>
+	double perCall(F f, double minSeconds = 0.05) {
+		long calls = 1;
+		for(;;) {
+			double t = seconds([&]() {
+				for(long c = 0; c < calls; ++c) {
+					f();
+				}
+			}, 1);
+			if(t >= minSeconds || calls >= (1L << 30)) {
+				break;
+			}
+			calls *= 2;
+		}
+		return seconds([&]() {
+			for(long c = 0; c < calls; ++c) {
+				f();
+			}
+		}) / calls;
+	}
+};
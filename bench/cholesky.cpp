@@ -0,0 +1,45 @@
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/cholesky.hpp"
+#include "../matrix/lu.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* B^T B + n I: symmetric positive definite */
+	MatrixXd randomSpd(int n) {
+		MatrixXd B(n, n, Math::uninitialized), A(n, n, Math::uninitialized);
+		std::srand(1);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				B(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+			}
+		}
+		Math::gemm(n, n, n, 1.0, B.data(), 1, n, B.data(), n, 1, 0.0, A.data(), n, 1);
+		for(int i = 0; i < n; ++i) {
+			A(i, i) += n;
+		}
+		return A;
+	}
+
+	/* Tiled LLT and LDLT over the tile size and the pool, against LUFactorization */
+	void cholesky() {
+		const int n = 1024;
+		const MatrixXd A = randomSpd(n);
+		Math::ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+		double tl = Bench::seconds([&]() { Math::LUFactorization<MatrixXd> lu(A); });
+		std::cout << boost::format("LU, n = %d: %.4f s\n") % n % tl;
+		std::cout << boost::format("%-6s %12s %12s %12s\n") % "tile" % "LLT, s" % "LLT pool" % "LDLT, s";
+		for(int b : {32, 64, 128, 256}) {
+			double t1 = Bench::seconds([&]() { Math::LLTFactorization<MatrixXd> llt(A, b); });
+			double tp = Bench::seconds([&]() { Math::LLTFactorization<MatrixXd> llt(A, pool, b); });
+			double td = Bench::seconds([&]() { Math::LDLTFactorization<MatrixXd> ldlt(A, b); });
+			std::cout << boost::format("%-6d %12.4f %12.4f %12.4f\n") % b % t1 % tp % td;
+		}
+	}
+
+	Bench::Register reg("cholesky", cholesky);
+}
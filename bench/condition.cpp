@@ -0,0 +1,36 @@
+#include <cstdlib>
+#include <iostream>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/lu.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* Condition number from one LU: the O(n^2) estimate against the exact one through inverse() */
+	void condition() {
+		const int sizes[] = {128, 256, 512, 1024};
+		std::cout << boost::format("%-6s %12s %12s %12s %10s\n")
+			% "n" % "LU, s" % "rcond, s" % "inverse, s" % "est/exact";
+		for(int n : sizes) {
+			MatrixXd A(n, n, Math::uninitialized);
+			std::srand(1);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n; ++j) {
+					A(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+				}
+			}
+			Math::LUFactorization<MatrixXd> lu(A);
+			double estimate = 0, exact = 0;
+			double tl = Bench::seconds([&]() { lu.factorize(A); }, 3);
+			double tr = Bench::seconds([&]() { estimate = lu.cond(); }, 3);
+			double ti = Bench::seconds([&]() {
+				exact = Math::detail::norm1(A) * Math::detail::norm1(lu.inverse());
+			}, n > 512 ? 1 : 3);
+			std::cout << boost::format("%-6d %12.5f %12.5f %12.5f %10.3f\n")
+				% n % tl % tr % ti % (estimate / exact);
+		}
+	}
+
+	Bench::Register reg("condition", condition);
+}
@@ -0,0 +1,39 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/jacobi.hpp"
+#include "../problems/p13/eigen.hpp"
+#include "../tests/common.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/*
+	 * Largest-element jakobi of problem 13 against cyclic and parallel
+	 * jacobiEigen, all at its default eps: jakobi stalls on tighter ones.
+	 */
+	void jacobi() {
+		const int sizes[] = {50, 100, 200, 400};
+		Math::ThreadPool pool;
+		std::cout << boost::format("%-6s %12s %12s %8s %12s %8s\n")
+			% "n" % "jakobi, s" % "cyclic, s" % "sweeps" % "parallel, s" % "sweeps";
+		for(int n : sizes) {
+			const MatrixXd A = Test::randomSymmetric(n, 1);
+			MatrixXd D, X;
+			std::string tj = "-";
+			if(n <= 100) {
+				double t = Bench::seconds([&]() { D = A; Math::jakobi(D, X, 1e-5); }, 1);
+				tj = (boost::format("%.4f") % t).str();
+			}
+			int sc = 0, sp = 0;
+			double tc = Bench::seconds([&]() { D = A; sc = Math::jacobiEigen(D, X, 1e-5); });
+			double tp = Bench::seconds([&]() { D = A; sp = Math::jacobiEigen(D, X, pool, 1e-5); });
+			std::cout << boost::format("%-6d %12s %12.4f %8d %12.4f %8d\n") % n % tj % tc % sc % tp % sp;
+		}
+		std::cout << "(jakobi skipped above n = 100; parallel on " << pool.size() << " threads)\n";
+	}
+
+	Bench::Register reg("jacobi", jacobi);
+}
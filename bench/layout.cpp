@@ -0,0 +1,71 @@
+#include <cstdlib>
+#include "bench.hpp"
+#include "../matrix/util.hpp"
+
+/*
+ * Storage orders: gauss() with every kind of pivoting, and fixed-size
+ * gauss() and dot() in each layout, including the layout-mismatched
+ * products that take the transposed-access kernel.
+ */
+namespace {
+	template<typename M>
+	void fill(M &A, int diagonal) {
+		for(int i = 0; i < A.rows(); ++i) {
+			for(int j = 0; j < A.cols(); ++j) {
+				A(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000 + (i == j) * diagonal;
+			}
+		}
+	}
+
+	Bench::Result result(const char *name, const char *variant, int n, double seconds, double flops) {
+		Bench::Result r = {name, variant, "double", n, seconds, flops, 0};
+		return r;
+	}
+
+	const char* pivotingName(Math::Pivoting p) {
+		switch(p) {
+		case Math::Pivoting::None: return "none";
+		case Math::Pivoting::Rows: return "rows";
+		case Math::Pivoting::Columns: return "columns";
+		default: return "full";
+		}
+	}
+
+	template<typename L>
+	void fixedSize(const char *name) {
+		const int n = 64;
+		static Math::Matrix<double, n, n + 1, L> ext0, ext;
+		static Math::Matrix<double, n, 1> x;
+		fill(ext0, 0);
+		double t = Bench::perCall([&]() { ext = ext0; Math::gauss(ext, x, Math::Pivoting::Rows); });
+		Bench::record(result("gauss rows", name, n, t, 2.0 / 3 * n * n * n));
+
+		const int m = 32;
+		static Math::Matrix<double, m, m> A;
+		static Math::Matrix<double, m, m, L> B, C;
+		fill(A, 0);
+		fill(B, 0);
+		t = Bench::perCall([&]() { C = Math::dot(A, B); });
+		Bench::record(result("dot row x", name, m, t, 2.0 * m * m * m));
+	}
+
+	void layout() {
+		Bench::printHeader();
+		std::srand(1);
+		const Math::Pivoting modes[] = {Math::Pivoting::None, Math::Pivoting::Rows,
+										Math::Pivoting::Columns, Math::Pivoting::Full};
+		for(int n : {256, 512}) {
+			Math::DynamicMatrix<double> ext0(n, n + 1), ext, x;
+			fill(ext0, n);
+			for(Math::Pivoting p : modes) {
+				double t = Bench::perCall([&]() { ext = ext0; Math::gauss(ext, x, p); });
+				Bench::record(result("gauss", pivotingName(p), n, t, 2.0 / 3 * n * n * n));
+			}
+		}
+		fixedSize<Math::RowMajor>("row-major");
+		fixedSize<Math::ColMajor>("col-major");
+		fixedSize<Math::Tiled<16> >("tiled 16");
+	}
+
+	Bench::Register reg("layout", layout);
+}
@@ -0,0 +1,40 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "bench.hpp"
+
+/*
+ * Usage: bench [--json file] [name...]; runs the cases whose names contain
+ * any of the names, and writes the recorded results to file as JSON.
+ */
+int main(int argc, char **argv) {
+	const char *json = nullptr;
+	std::vector<const char*> names;
+	for(int i = 1; i < argc; ++i) {
+		if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			json = argv[++i];
+		} else {
+			names.push_back(argv[i]);
+		}
+	}
+	for(const Bench::Case &c : Bench::registry()) {
+		bool selected = names.empty();
+		for(const char *name : names) {
+			selected = selected || c.name.find(name) != std::string::npos;
+		}
+		if(selected) {
+			std::cout << "== " << c.name << std::endl;
+			c.run();
+		}
+	}
+	if(json) {
+		std::ofstream out(json);
+		Bench::writeJson(out);
+		if(!out) {
+			std::cerr << "Cannot write " << json << "\n";
+			return 1;
+		}
+	}
+	return 0;
+}
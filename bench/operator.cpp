@@ -0,0 +1,54 @@
+#include <iostream>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/krylov.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* CG on the 5-point stencil of a k x k grid: applied as a lambda against stored as CSR */
+	void linearOperator() {
+		const int grids[] = {100, 300, 1000};
+		std::cout << boost::format("%-6s %10s %12s %12s %8s %12s\n")
+			% "k" % "n" % "operator, s" % "sparse, s" % "iter" % "CSR, MB";
+		for(int k : grids) {
+			const int n = k * k;
+			Math::LinearOperator<double> op(n, [k](const double *x, double *y) {
+				for(int i = 0; i < k; ++i) {
+					for(int j = 0; j < k; ++j) {
+						const int r = i * k + j;
+						double v = 4 * x[r];
+						if(i > 0) v -= x[r - k];
+						if(i < k - 1) v -= x[r + k];
+						if(j > 0) v -= x[r - 1];
+						if(j < k - 1) v -= x[r + 1];
+						y[r] = v;
+					}
+				}
+			});
+			std::vector<Math::Triplet<double> > t;
+			for(int i = 0; i < k; ++i) {
+				for(int j = 0; j < k; ++j) {
+					const int r = i * k + j;
+					t.push_back({r, r, 4});
+					if(i > 0) t.push_back({r, r - k, -1});
+					if(i < k - 1) t.push_back({r, r + k, -1});
+					if(j > 0) t.push_back({r, r - 1, -1});
+					if(j < k - 1) t.push_back({r, r + 1, -1});
+				}
+			}
+			const Math::SparseMatrix<double> A(n, n, t);
+			MatrixXd b(n, 1), x;
+			for(int i = 0; i < n; ++i) {
+				b(i, 0) = 1;
+			}
+			int iter = 0;
+			double to = Bench::seconds([&]() { iter = Math::conjugateGradient(op, b, x, 1e-6, 200); }, 1);
+			double ts = Bench::seconds([&]() { Math::conjugateGradient(A, b, x, 1e-6, 200); }, 1);
+			const double mb = (A.nonZeros() * (sizeof(double) + sizeof(int)) + (n + 1) * sizeof(int)) / 1e6;
+			std::cout << boost::format("%-6d %10d %12.4f %12.4f %8d %12.1f\n") % k % n % to % ts % iter % mb;
+		}
+	}
+
+	Bench::Register reg("operator", linearOperator);
+}
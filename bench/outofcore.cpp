@@ -0,0 +1,53 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/outofcore.hpp"
+#include "../matrix/lu.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* Out-of-core gauss under shrinking memory budgets against the in-memory LU */
+	void outOfCore() {
+		const int n = 2048, b = 256;
+		const char *path = "bench_outofcore.bin";
+		MatrixXd ext(n, n + 1, Math::uninitialized);
+		std::srand(1);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j <= n; ++j) {
+				ext(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+			}
+		}
+		MatrixXd A(n, n, Math::uninitialized), rhs(n, 1, Math::uninitialized), x;
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				A(i, j) = ext(i, j);
+			}
+			rhs(i, 0) = ext(i, n);
+		}
+		double tl = Bench::seconds([&]() { x = Math::LUFactorization<MatrixXd>(A).solve(rhs); }, 1);
+		std::cout << boost::format("in-memory LU, n = %d: %.3f s\n") % n % tl;
+
+		Math::TiledMatrix<double> file(path, n, n + 1, b);
+		const size_t tile = file.tileBytes();
+		const int tiles = file.tileRows() * file.tileCols();
+		std::cout << boost::format("%-8s %8s %10s %10s %10s %10s\n")
+			% "budget" % "s" % "read, MB" % "written" % "stall, s" % "hit rate";
+		for(int budget : {tiles, 3 * file.tileRows(), 2 * file.tileRows()}) {
+			Math::OutOfCoreStats io;
+			double t = Bench::seconds([&]() {
+				file.setBlock(0, 0, ext);
+				Math::gauss(file, x, budget * tile, &io);
+			}, 1);
+			std::cout << boost::format("%-8s %8.3f %10.1f %10.1f %10.3f %10.2f\n")
+				% (boost::format("%d/%d") % budget % tiles).str() % t
+				% (io.bytesRead / 1e6) % (io.bytesWritten / 1e6) % io.stallSeconds
+				% (static_cast<double>(io.hits) / (io.hits + io.misses));
+		}
+		std::remove(path);
+	}
+
+	Bench::Register reg("outofcore", outOfCore);
+}
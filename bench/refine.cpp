@@ -0,0 +1,43 @@
+#include <cstdlib>
+#include <iostream>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/refine.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	MatrixXd randomMatrix(int n, int cols) {
+		MatrixXd A(n, cols, Math::uninitialized);
+		std::srand(1);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < cols; ++j) {
+				A(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+			}
+		}
+		return A;
+	}
+
+	/* Factor and solve one system: double LU against float LU plus refinement */
+	void refine() {
+		const int sizes[] = {256, 512, 1024, 2048};
+		std::cout << boost::format("%-6s %12s %12s %8s %6s %12s\n")
+			% "n" % "LU, s" % "mixed, s" % "speedup" % "steps" % "backward err";
+		for(int n : sizes) {
+			const MatrixXd A = randomMatrix(n, n), b = randomMatrix(n, 1);
+			MatrixXd x;
+			Math::SolverStats stats;
+			double tl = Bench::seconds([&]() {
+				x = Math::LUFactorization<MatrixXd>(A).solve(b);
+			}, n > 1024 ? 1 : 3);
+			double tm = Bench::seconds([&]() {
+				Math::MixedPrecisionSolver<MatrixXd> solver(A);
+				x = solver.solve(b, &stats);
+			}, n > 1024 ? 1 : 3);
+			std::cout << boost::format("%-6d %12.4f %12.4f %8.2f %6d %12.2e\n")
+				% n % tl % tm % (tl / tm) % stats.iterations % stats.residuals.back();
+		}
+	}
+
+	Bench::Register reg("refine", refine);
+}
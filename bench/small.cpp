@@ -0,0 +1,99 @@
+#include <cstdlib>
+#include <vector>
+#include "bench.hpp"
+#include "../matrix/util.hpp"
+
+/*
+ * The unrolled fixed-size kernels of dot(), invert() and gauss() against
+ * the generic code they replace, on a ring of matrices so that no call
+ * can be hoisted out of the timing loop.
+ */
+namespace {
+	const int ring = 64;
+
+	template<int n, int m>
+	std::vector<Math::Matrix<double, n, m> > randomRing() {
+		std::vector<Math::Matrix<double, n, m> > mats(ring);
+		for(auto &A : mats) {
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < m; ++j) {
+					A(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000 + (i == j) * n;
+				}
+			}
+		}
+		return mats;
+	}
+
+	Bench::Result result(const char *name, const char *variant, int n, double seconds, double flops) {
+		Bench::Result r = {name, variant, "double", n, seconds, flops, 0};
+		return r;
+	}
+
+	template<int n>
+	void smallSize() {
+		typedef Math::Matrix<double, n, n> M;
+		typedef Math::Matrix<double, n, n + 1> Ext;
+		const std::vector<M> A = randomRing<n, n>(), B = randomRing<n, n>();
+		const std::vector<Ext> E = randomRing<n, n + 1>();
+		int k = 0;
+		volatile double sink = 0;
+		M C;
+
+		double t = Bench::perCall([&]() {
+			C = M();
+			Math::detail::multiplyAdd(1.0, A[k], B[k], C.data());
+			sink = C(0, 0);
+			k = (k + 1) % ring;
+		});
+		Bench::record(result("small dot", "unrolled", n, t, 2.0 * n * n * n));
+		t = Bench::perCall([&]() {
+			C = M();
+			Math::detail::multiplyAdd<double, M, M>(1.0, A[k], B[k], C.data());
+			sink = C(0, 0);
+			k = (k + 1) % ring;
+		});
+		Bench::record(result("small dot", "generic", n, t, 2.0 * n * n * n));
+
+		t = Bench::perCall([&]() {
+			C = Math::invert(A[k]);
+			sink = C(0, 0);
+			k = (k + 1) % ring;
+		});
+		Bench::record(result("small invert", "unrolled", n, t, 0));
+		t = Bench::perCall([&]() {
+			Math::detail::invert(A[k], C, std::integral_constant<int, 0>());
+			sink = C(0, 0);
+			k = (k + 1) % ring;
+		});
+		Bench::record(result("small invert", "generic", n, t, 0));
+
+		Math::Matrix<double, n, 1> x;
+		Ext ext;
+		t = Bench::perCall([&]() {
+			ext = E[k];
+			Math::gauss(ext, x);
+			sink = x(0, 0);
+			k = (k + 1) % ring;
+		});
+		Bench::record(result("small gauss", "unrolled", n, t, 0));
+		t = Bench::perCall([&]() {
+			ext = E[k];
+			Math::detail::gauss(ext, x, n, 1, Math::Pivoting::None, 1e-5, nullptr, nullptr);
+			sink = x(0, 0);
+			k = (k + 1) % ring;
+		});
+		Bench::record(result("small gauss", "generic", n, t, 0));
+	}
+
+	void small() {
+		Bench::printHeader();
+		std::srand(1);
+		smallSize<2>();
+		smallSize<3>();
+		smallSize<4>();
+		smallSize<6>();
+		smallSize<8>();
+	}
+
+	Bench::Register reg("small", small);
+}
@@ -0,0 +1,188 @@
+#include <cstdlib>
+#include <string>
+#include "bench.hpp"
+#include "../matrix/util.hpp"
+#include "../problems/p10/system2.hpp"
+#include "../problems/p13/eigen.hpp"
+
+/*
+ * The dense kernels and solvers over sizes and element types. Every row
+ * reports GFLOP/s from the textbook operation count (0 where the count
+ * depends on the data), ns per element of the n x n input and, for the
+ * iterative methods, the number of iterations.
+ */
+namespace {
+	const int sizes[] = {16, 64, 256, 512};
+
+	template<typename T> const char* typeName();
+	template<> const char* typeName<float>() { return "float"; }
+	template<> const char* typeName<double>() { return "double"; }
+
+	/* Diagonally dominant, so the iterative methods converge */
+	template<typename T>
+	Math::DynamicMatrix<T> randomMatrix(int n, int cols) {
+		Math::DynamicMatrix<T> A(n, cols, Math::uninitialized);
+		std::srand(1);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < cols; ++j) {
+				A(i, j) = static_cast<T>(std::rand() % 2001 - 1000) / 1000;
+			}
+			A(i, i) += n;
+		}
+		return A;
+	}
+
+	template<typename T>
+	Math::DynamicMatrix<T> leftBlock(const Math::DynamicMatrix<T> &ext, int n) {
+		Math::DynamicMatrix<T> A(n, n, Math::uninitialized);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				A(i, j) = ext(i, j);
+			}
+		}
+		return A;
+	}
+
+	template<typename T>
+	Math::DynamicMatrix<T> rightColumn(const Math::DynamicMatrix<T> &ext, int n) {
+		Math::DynamicMatrix<T> b(n, 1, Math::uninitialized);
+		for(int i = 0; i < n; ++i) {
+			b(i, 0) = ext(i, n);
+		}
+		return b;
+	}
+
+	Bench::Result result(const char *name, const char *variant, const char *type, int n,
+						 double seconds, double flops, int iterations = 0) {
+		Bench::Result r = {name, variant, type, n, seconds, flops, iterations};
+		return r;
+	}
+
+	template<typename T>
+	void dotSizes() {
+		for(int n : sizes) {
+			const Math::DynamicMatrix<T> A = randomMatrix<T>(n, n), B = randomMatrix<T>(n, n);
+			Math::DynamicMatrix<T> C;
+			double t = Bench::perCall([&]() { C = Math::dot(A, B); });
+			Bench::record(result("dot", "", typeName<T>(), n, t, 2.0 * n * n * n));
+		}
+	}
+
+	template<typename T>
+	void gaussSizes() {
+		for(int n : sizes) {
+			const Math::DynamicMatrix<T> ext = randomMatrix<T>(n, n + 1);
+			const double flops = 2.0 / 3 * n * n * n + 2.0 * n * n;
+			for(int swapVar = 0; swapVar < 2; ++swapVar) {
+				Math::DynamicMatrix<T> mat, x;
+				double t = Bench::perCall([&]() { mat = ext; Math::gauss(mat, x, swapVar != 0); });
+				Bench::record(result("gauss", swapVar ? "swapVar" : "", typeName<T>(), n, t, flops));
+			}
+		}
+	}
+
+	template<typename T>
+	void luSizes() {
+		for(int n : sizes) {
+			const Math::DynamicMatrix<T> A = randomMatrix<T>(n, n);
+			Math::DynamicMatrix<T> L, U;
+			double t = Bench::perCall([&]() { Math::luDecomposition(A, L, U); });
+			Bench::record(result("luDecomposition", "", typeName<T>(), n, t, 2.0 / 3 * n * n * n));
+		}
+	}
+
+	template<typename T>
+	void invertSizes() {
+		for(int n : sizes) {
+			const Math::DynamicMatrix<T> A = randomMatrix<T>(n, n);
+			Math::DynamicMatrix<T> inv;
+			/* gauss on [A | I]: 5/3 n^3 to eliminate, n^3 to substitute back */
+			double t = Bench::perCall([&]() { inv = Math::invert(A); });
+			Bench::record(result("invert", "", typeName<T>(), n, t, 8.0 / 3 * n * n * n));
+		}
+	}
+
+	template<typename T>
+	void iterativeSizes() {
+		for(int n : sizes) {
+			const Math::DynamicMatrix<T> ext = randomMatrix<T>(n, n + 1);
+			const Math::DynamicMatrix<T> A = leftBlock(ext, n), b = rightColumn(ext, n);
+			Math::DynamicMatrix<T> H, g, sol;
+			Math::rewriteSystem(A, b, H, g);
+			const Math::DynamicMatrix<T> guess(n, 1);
+			int iter = 0;
+			double t = Bench::perCall([&]() { iter = Math::iterativeSolve(H, g, guess, sol, 1e-5, 1000); });
+			Bench::record(result("iterativeSolve", "", typeName<T>(), n, t, 2.0 * n * n * (iter + 1), iter));
+		}
+	}
+
+	template<typename T>
+	void seidelSizes() {
+		for(int n : sizes) {
+			const Math::DynamicMatrix<T> ext = randomMatrix<T>(n, n + 1);
+			const Math::DynamicMatrix<T> A = leftBlock(ext, n), b = rightColumn(ext, n);
+			Math::DynamicMatrix<T> sol;
+			int iter = 0;
+			double t = Bench::perCall([&]() { iter = Math::seidel(A, b, sol, 1e-5, 1000); });
+			Bench::record(result("seidel", "", typeName<T>(), n, t, 2.0 * n * n * (iter + 1), iter));
+		}
+	}
+
+	/* jakobi() is double only; its rotation count depends on the matrix */
+	void jakobiSizes() {
+		const int small[] = {16, 32, 64};
+		for(int n : small) {
+			Math::DynamicMatrix<double> A = randomMatrix<double>(n, n);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < i; ++j) {
+					A(i, j) = A(j, i);
+				}
+			}
+			Math::DynamicMatrix<double> D, X;
+			double t = Bench::perCall([&]() { D = A; Math::jakobi(D, X); });
+			Bench::record(result("jakobi", "", "double", n, t, 0));
+		}
+	}
+
+	/* solve2() of problem 10 on a ring of systems, so no call can be hoisted */
+	void solve2Case() {
+		const int count = 64;
+		std::vector<Matrix2d> mats(count);
+		std::vector<Vector2d> rhs(count);
+		std::srand(1);
+		for(int k = 0; k < count; ++k) {
+			for(int i = 0; i < 2; ++i) {
+				for(int j = 0; j < 2; ++j) {
+					mats[k](i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000 + (i == j) * 2;
+				}
+				rhs[k](i, 0) = 1;
+			}
+		}
+		int k = 0;
+		volatile double sink = 0;
+		double t = Bench::perCall([&]() {
+			sink = solve2(mats[k], rhs[k])(0, 0);
+			k = (k + 1) % count;
+		});
+		/* determinant 3, adjugate scaling 5, product 6 */
+		Bench::record(result("solve2", "", "double", 2, t, 14));
+	}
+
+	void runDot() { Bench::printHeader(); dotSizes<float>(); dotSizes<double>(); }
+	void runGauss() { Bench::printHeader(); gaussSizes<float>(); gaussSizes<double>(); }
+	void runLu() { Bench::printHeader(); luSizes<float>(); luSizes<double>(); }
+	void runInvert() { Bench::printHeader(); invertSizes<float>(); invertSizes<double>(); }
+	void runIterative() { Bench::printHeader(); iterativeSizes<float>(); iterativeSizes<double>(); }
+	void runSeidel() { Bench::printHeader(); seidelSizes<float>(); seidelSizes<double>(); }
+	void runJakobi() { Bench::printHeader(); jakobiSizes(); }
+	void runSolve2() { Bench::printHeader(); solve2Case(); }
+
+	Bench::Register regDot("dot", runDot);
+	Bench::Register regGauss("gauss", runGauss);
+	Bench::Register regLu("luDecomposition", runLu);
+	Bench::Register regInvert("invert", runInvert);
+	Bench::Register regIterative("iterativeSolve", runIterative);
+	Bench::Register regSeidel("seidel", runSeidel);
+	Bench::Register regJakobi("jakobi", runJakobi);
+	Bench::Register regSolve2("solve2", runSolve2);
+}
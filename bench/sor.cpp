@@ -0,0 +1,58 @@
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/sor.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::SparseMatrix<double> SparseXd;
+
+namespace {
+	/* 5-point Laplacian on a k x k grid */
+	SparseXd stencil(int k) {
+		std::vector<Math::Triplet<double> > t;
+		for(int i = 0; i < k; ++i) {
+			for(int j = 0; j < k; ++j) {
+				int r = i * k + j;
+				t.push_back({r, r, 4});
+				if(i > 0) t.push_back({r, r - k, -1});
+				if(i < k - 1) t.push_back({r, r + k, -1});
+				if(j > 0) t.push_back({r, r - 1, -1});
+				if(j < k - 1) t.push_back({r, r + 1, -1});
+			}
+		}
+		return SparseXd(k * k, k * k, t);
+	}
+
+	/* seidel against SOR/SSOR with an estimated omega, natural and red-black order */
+	void sor() {
+		const double eps = 1e-8;
+		const int maxiter = 100000;
+		Math::ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+		std::cout << boost::format("%-6s %-16s %8s %8s %10s\n") % "grid" % "method" % "sweeps" % "omega" % "s";
+		for(int k : {64, 128}) {
+			const SparseXd A = stencil(k);
+			MatrixXd x, ones(k * k, 1);
+			for(int i = 0; i < k * k; ++i) {
+				ones(i, 0) = 1;
+			}
+			const Math::Colouring rb = Math::Colouring::redBlack(k, k);
+			auto row = [&](const char *name, std::function<void(Math::SolverStats*)> solve) {
+				Math::SolverStats stats;
+				double t = Bench::seconds([&]() { solve(&stats); }, 1);
+				std::cout << boost::format("%-6s %-16s %8d %8.4f %10.4f\n")
+					% (boost::format("%dx%d") % k % k).str() % name % stats.iterations % stats.omega % t;
+			};
+			row("seidel", [&](Math::SolverStats *s) { Math::seidel(A, ones, x, eps, maxiter, s); });
+			row("seidel r/b", [&](Math::SolverStats *s) { Math::seidel(A, ones, x, rb, pool, eps, maxiter, s); });
+			row("sor", [&](Math::SolverStats *s) { Math::sor(A, ones, x, Math::autoOmega, eps, maxiter, s); });
+			row("sor r/b", [&](Math::SolverStats *s) {
+				Math::sor(A, ones, x, rb, pool, Math::autoOmega, eps, maxiter, s);
+			});
+			row("ssor", [&](Math::SolverStats *s) { Math::ssor(A, ones, x, Math::autoOmega, eps, maxiter, s); });
+		}
+	}
+
+	Bench::Register reg("sor", sor);
+}
@@ -0,0 +1,45 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/jacobi.hpp"
+#include "../matrix/symeig.hpp"
+#include "../problems/p13/eigen.hpp"
+#include "../tests/common.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/*
+	 * Jacobi (p13 jakobi at its default eps, cyclic jacobiEigen) against
+	 * tridiagonalisation followed by QR or divide and conquer, and the
+	 * eigenvalues-only mode.
+	 */
+	void symeig() {
+		typedef Math::SymmetricEigenSolver<MatrixXd> Solver;
+		const int sizes[] = {50, 100, 200, 400, 800};
+		std::cout << boost::format("%-6s %10s %10s %10s %10s %10s\n")
+			% "n" % "jakobi, s" % "cyclic, s" % "QR, s" % "D&C, s" % "values, s";
+		for(int n : sizes) {
+			const MatrixXd A = Test::randomSymmetric(n, 2);
+			MatrixXd D, X;
+			std::string tj = "-", tc = "-";
+			if(n <= 100) {
+				double t = Bench::seconds([&]() { D = A; Math::jakobi(D, X, 1e-5); }, 1);
+				tj = (boost::format("%.4f") % t).str();
+			}
+			if(n <= 400) {
+				double t = Bench::seconds([&]() { D = A; Math::jacobiEigen(D, X, 1e-5); }, 1);
+				tc = (boost::format("%.4f") % t).str();
+			}
+			double tq = Bench::seconds([&]() { Solver s(A, true, Math::EigenMethod::QR); });
+			double td = Bench::seconds([&]() { Solver s(A, true, Math::EigenMethod::DivideAndConquer); });
+			double tv = Bench::seconds([&]() { Solver s(A, false); });
+			std::cout << boost::format("%-6d %10s %10s %10.4f %10.4f %10.4f\n") % n % tj % tc % tq % td % tv;
+		}
+		std::cout << "(jakobi skipped above n = 100, cyclic above n = 400)\n";
+	}
+
+	Bench::Register reg("symeig", symeig);
+}
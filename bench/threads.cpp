@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <boost/format.hpp>
+#include "bench.hpp"
+#include "../matrix/lu.hpp"
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	MatrixXd randomSystem(int n, int s) {
+		MatrixXd ext(n, n + s, Math::uninitialized);
+		std::srand(1);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n + s; ++j) {
+				ext(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+			}
+			ext(i, i) += n;
+		}
+		return ext;
+	}
+
+	std::vector<int> threadCounts() {
+		std::vector<int> counts;
+		int hw = std::max(1u, std::thread::hardware_concurrency());
+		for(int t = 1; t < hw; t *= 2) {
+			counts.push_back(t);
+		}
+		counts.push_back(hw);
+		return counts;
+	}
+
+	/* Strong scaling of gauss() and LUFactorization over the pool size */
+	void threadScaling() {
+		const int sizes[] = {512, 1024, 2048};
+		std::cout << boost::format("%-6s %5s %12s %8s %12s %8s\n")
+			% "n" % "thr" % "gauss, s" % "speedup" % "LU, s" % "speedup";
+		for(int n : sizes) {
+			const MatrixXd ext = randomSystem(n, 1);
+			MatrixXd A(n, n, Math::uninitialized);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n; ++j) {
+					A(i, j) = ext(i, j);
+				}
+			}
+			double gauss1 = 0, lu1 = 0;
+			for(int t : threadCounts()) {
+				Math::ThreadPool pool(t);
+				double tg = Bench::seconds([&]() {
+					MatrixXd mat(ext), x;
+					Math::gauss(mat, x, pool);
+				}, n > 1024 ? 1 : 3);
+				double tl = Bench::seconds([&]() {
+					Math::LUFactorization<MatrixXd> lu(A, pool);
+				});
+				if(t == 1) {
+					gauss1 = tg;
+					lu1 = tl;
+				}
+				std::cout << boost::format("%-6d %5d %12.4f %8.2f %12.4f %8.2f\n")
+					% n % t % tg % (gauss1 / tg) % tl % (lu1 / tl);
+			}
+		}
+	}
+
+	Bench::Register reg("threads", threadScaling);
+}
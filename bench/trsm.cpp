@@ -0,0 +1,45 @@
+#include <cstdlib>
+#include <vector>
+#include "bench.hpp"
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+
+/*
+ * Triangular solves with many right-hand sides: trsm() itself, and the
+ * solves built on it, LUFactorization::solve() and invert().
+ */
+namespace {
+	Bench::Result result(const char *name, const char *variant, int n, double seconds, double flops) {
+		Bench::Result r = {name, variant, "double", n, seconds, flops, 0};
+		return r;
+	}
+
+	void trsm() {
+		Bench::printHeader();
+		std::srand(1);
+		for(int n : {256, 512, 1024}) {
+			Math::DynamicMatrix<double> A(n, n), B(n, n);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n; ++j) {
+					A(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000 + (i == j) * n;
+					B(i, j) = i - j;
+				}
+			}
+			std::vector<double> X(n * n);
+			double t = Bench::perCall([&]() {
+				std::copy(B.data(), B.data() + n * n, X.begin());
+				Math::trsm(Math::Triangle::Upper, n, n, A.data(), n, 1, X.data(), n, 1);
+			});
+			Bench::record(result("trsm", "upper", n, t, 1.0 * n * n * n));
+
+			Math::LUFactorization<Math::DynamicMatrix<double> > lu(A);
+			Math::DynamicMatrix<double> Y;
+			t = Bench::perCall([&]() { Y = lu.solve(B); });
+			Bench::record(result("lu solve", "s = n", n, t, 2.0 * n * n * n));
+			t = Bench::perCall([&]() { Y = Math::invert(A); });
+			Bench::record(result("invert", "gauss", n, t, 8.0 / 3 * n * n * n));
+		}
+	}
+
+	Bench::Register reg("trsm", trsm);
+}
@@ -0,0 +1,659 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <assert.h>
+
+#include "matrix.hpp"
+#include "threadpool.hpp"
+
+/*
+ * Band matrices: only the diagonals are stored, so products cost
+ * O(n * bandwidth) and solves O(n * bandwidth^2) instead of O(n^2) and
+ * O(n^3). Both types are operators (see operator.hpp), so the Krylov and
+ * iterative solvers take them as they are.
+ */
+namespace Math
+{
+	/**
+	 * n x n matrix with a_ij = 0 for |i - j| > 1, as three diagonals:
+	 * lower()[i] = a_i,i-1, diagonal()[i] = a_ii, upper()[i] = a_i,i+1;
+	 * lower()[0] and upper()[n-1] are zero.
+	 */
+	template<typename T>
+	class TridiagonalMatrix
+	{
+	public:
+		typedef T Scalar;
+
+		TridiagonalMatrix() : n(0) {}
+		/** n x n zero matrix */
+		explicit TridiagonalMatrix(int n) : n(n), a(n), b(n), c(n) {}
+		/** Keeps the three diagonals of a dense matrix; the other elements are dropped. */
+		template<typename E>
+		explicit TridiagonalMatrix(const MatrixExpr<E> &dense);
+
+		int rows() const { return n; }
+		int cols() const { return n; }
+		/** a_ij, zero outside the band */
+		T coeff(int i, int j) const;
+		/** a_ij for |i - j| <= 1 */
+		T& operator()(int i, int j);
+
+		T* lower() { return a.data(); }
+		T* diagonal() { return b.data(); }
+		T* upper() { return c.data(); }
+		const T* lower() const { return a.data(); }
+		const T* diagonal() const { return b.data(); }
+		const T* upper() const { return c.data(); }
+
+		/** y = A*x, arrays of n elements */
+		void multiply(const T *x, T *y) const;
+		void apply(const T *x, T *y) const { multiply(x, y); }
+		T diagonal(int i) const { return b[i]; }
+
+		DynamicMatrix<T> toDense() const;
+
+	private:
+		int n;
+		std::vector<T> a, b, c;
+	};
+
+	/**
+	 * n x n matrix with a_ij = 0 for j < i - kl or j > i + ku.
+	 * Row i keeps its kl + ku + 1 band elements next to each other,
+	 * a_ij at band()[i * width() + j - i + kl], so a row of a product or
+	 * an elimination step walks contiguous memory.
+	 */
+	template<typename T>
+	class BandedMatrix
+	{
+	public:
+		typedef T Scalar;
+
+		BandedMatrix() : n(0), kl(0), ku(0) {}
+		/** n x n zero matrix with kl subdiagonals and ku superdiagonals */
+		BandedMatrix(int n, int kl, int ku) : n(n), kl(kl), ku(ku), band_(n * (kl + ku + 1)) {}
+		/** A dense matrix with its bandwidths found from the nonzero elements */
+		template<typename E>
+		explicit BandedMatrix(const MatrixExpr<E> &dense);
+		explicit BandedMatrix(const TridiagonalMatrix<T> &tri);
+
+		int rows() const { return n; }
+		int cols() const { return n; }
+		int lowerBandwidth() const { return kl; }
+		int upperBandwidth() const { return ku; }
+		int width() const { return kl + ku + 1; }
+		/** a_ij, zero outside the band */
+		T coeff(int i, int j) const;
+		/** a_ij for -kl <= j - i <= ku */
+		T& operator()(int i, int j);
+		T* band() { return band_.data(); }
+		const T* band() const { return band_.data(); }
+
+		/** y = A*x, arrays of n elements */
+		void multiply(const T *x, T *y) const;
+		void apply(const T *x, T *y) const { multiply(x, y); }
+		T diagonal(int i) const { return band_[i * width() + kl]; }
+
+		DynamicMatrix<T> toDense() const;
+
+	private:
+		int n, kl, ku;
+		std::vector<T> band_;
+	};
+
+	/**
+	 * LU factorization of a band matrix with partial (row) pivoting, as
+	 * LAPACK gbtrf: a row swap moves at most kl rows up, so U keeps
+	 * kl + ku superdiagonals and L at most kl subdiagonals. Factoring costs
+	 * O(n kl (kl + ku)), each right-hand side O(n (2kl + ku)).
+	 */
+	template<typename T>
+	class BandedLU
+	{
+	public:
+		typedef T Scalar;
+
+		explicit BandedLU(const BandedMatrix<T> &A);
+		explicit BandedLU(const TridiagonalMatrix<T> &A) : BandedLU(BandedMatrix<T>(A)) {}
+
+		/**
+		 * Solves A*X = B for every column of B.
+		 * @throws std::domain_error if A is singular
+		 */
+		template<typename Rhs>
+		typename PlainObject<Rhs>::type solve(const MatrixExpr<Rhs> &b) const;
+
+		T determinant() const;
+		bool invertible() const { return !singular; }
+		int size() const { return n; }
+
+	private:
+		T& at(int i, int j) { return lu[i * w + j - i + kl]; }
+		T at(int i, int j) const { return lu[i * w + j - i + kl]; }
+
+		int n, kl, ku, w;
+		std::vector<T> lu;
+		std::vector<int> pivots;
+		int swaps;
+		bool singular;
+	};
+
+	/**
+	 * Many tridiagonal systems of the same size n, stored interleaved:
+	 * element i of system s sits at i * size() + s, so the solvers run
+	 * over all systems in the innermost loop.
+	 */
+	template<typename T>
+	class TridiagonalBatch
+	{
+	public:
+		typedef T Scalar;
+
+		TridiagonalBatch(int n, int count)
+			: n(n), count(count), a(n * count), b(n * count), c(n * count) {}
+
+		/** Number of systems */
+		int size() const { return count; }
+		/** Size of each system */
+		int rows() const { return n; }
+
+		/** Row i of every system: lower(i)[s] = a_i,i-1 of system s */
+		T* lower(int i) { return a.data() + i * count; }
+		T* diagonal(int i) { return b.data() + i * count; }
+		T* upper(int i) { return c.data() + i * count; }
+		const T* lower(int i) const { return a.data() + i * count; }
+		const T* diagonal(int i) const { return b.data() + i * count; }
+		const T* upper(int i) const { return c.data() + i * count; }
+
+		void set(int s, const TridiagonalMatrix<T> &A);
+		TridiagonalMatrix<T> get(int s) const;
+
+	private:
+		int n, count;
+		std::vector<T> a, b, c;
+	};
+
+	template<typename T>
+	template<typename E>
+	TridiagonalMatrix<T>::TridiagonalMatrix(const MatrixExpr<E> &expr)
+		: n(expr.derived().rows()), a(n), b(n), c(n)
+	{
+		typename PlainObject<E>::type dense(expr);
+		assert(dense.cols() == n);
+		for(int i = 0; i < n; ++i) {
+			a[i] = (i > 0) ? dense(i, i - 1) : T(0);
+			b[i] = dense(i, i);
+			c[i] = (i < n - 1) ? dense(i, i + 1) : T(0);
+		}
+	}
+
+	template<typename T>
+	T TridiagonalMatrix<T>::coeff(int i, int j) const {
+		if(j == i) {
+			return b[i];
+		}
+		return (j == i - 1) ? a[i] : (j == i + 1) ? c[i] : T(0);
+	}
+
+	template<typename T>
+	T& TridiagonalMatrix<T>::operator()(int i, int j) {
+		assert(j >= i - 1 && j <= i + 1 && j >= 0 && j < n);
+		return (j == i) ? b[i] : (j < i) ? a[i] : c[i];
+	}
+
+	template<typename T>
+	void TridiagonalMatrix<T>::multiply(const T *x, T *y) const {
+		if(n < 2) {
+			if(n) {
+				y[0] = b[0] * x[0];
+			}
+			return;
+		}
+		y[0] = b[0] * x[0] + c[0] * x[1];
+		for(int i = 1; i < n - 1; ++i) {
+			y[i] = a[i] * x[i - 1] + b[i] * x[i] + c[i] * x[i + 1];
+		}
+		y[n - 1] = a[n - 1] * x[n - 2] + b[n - 1] * x[n - 1];
+	}
+
+	template<typename T>
+	DynamicMatrix<T> TridiagonalMatrix<T>::toDense() const {
+		DynamicMatrix<T> dense(n, n);
+		for(int i = 0; i < n; ++i) {
+			if(i > 0) {
+				dense(i, i - 1) = a[i];
+			}
+			dense(i, i) = b[i];
+			if(i < n - 1) {
+				dense(i, i + 1) = c[i];
+			}
+		}
+		return dense;
+	}
+
+	template<typename T>
+	template<typename E>
+	BandedMatrix<T>::BandedMatrix(const MatrixExpr<E> &expr) : n(expr.derived().rows()), kl(0), ku(0) {
+		typename PlainObject<E>::type dense(expr);
+		assert(dense.cols() == n);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				if(dense(i, j) != T(0)) {
+					kl = std::max(kl, i - j);
+					ku = std::max(ku, j - i);
+				}
+			}
+		}
+		band_.assign(n * width(), T(0));
+		for(int i = 0; i < n; ++i) {
+			for(int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j) {
+				(*this)(i, j) = dense(i, j);
+			}
+		}
+	}
+
+	template<typename T>
+	BandedMatrix<T>::BandedMatrix(const TridiagonalMatrix<T> &tri)
+		: n(tri.rows()), kl(n > 1), ku(n > 1), band_(n * width())
+	{
+		for(int i = 0; i < n; ++i) {
+			for(int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j) {
+				(*this)(i, j) = tri.coeff(i, j);
+			}
+		}
+	}
+
+	template<typename T>
+	T BandedMatrix<T>::coeff(int i, int j) const {
+		return (j - i >= -kl && j - i <= ku) ? band_[i * width() + j - i + kl] : T(0);
+	}
+
+	template<typename T>
+	T& BandedMatrix<T>::operator()(int i, int j) {
+		assert(j - i >= -kl && j - i <= ku && j >= 0 && j < n);
+		return band_[i * width() + j - i + kl];
+	}
+
+	template<typename T>
+	void BandedMatrix<T>::multiply(const T *x, T *y) const {
+		const int w = width();
+		for(int i = 0; i < n; ++i) {
+			const int j0 = std::max(0, i - kl), j1 = std::min(n - 1, i + ku);
+			const T *row = band_.data() + i * w - i + kl;
+			T sum = 0;
+			for(int j = j0; j <= j1; ++j) {
+				sum += row[j] * x[j];
+			}
+			y[i] = sum;
+		}
+	}
+
+	template<typename T>
+	DynamicMatrix<T> BandedMatrix<T>::toDense() const {
+		DynamicMatrix<T> dense(n, n);
+		for(int i = 0; i < n; ++i) {
+			for(int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j) {
+				dense(i, j) = band_[i * width() + j - i + kl];
+			}
+		}
+		return dense;
+	}
+
+	/** Tridiagonal times dense: every column of \p rhs in one pass over A. */
+	template<typename T, typename E>
+	DynamicMatrix<T> dot(const TridiagonalMatrix<T> &A, const MatrixExpr<E> &rhs) {
+		DynamicMatrix<T> x(rhs);
+		assert(A.cols() == x.rows());
+		const int n = A.rows(), s = x.cols();
+		DynamicMatrix<T> y(n, s);
+		if(s == 1) {
+			A.multiply(x.data(), y.data());
+			return y;
+		}
+		const T *X = x.data();
+		for(int i = 0; i < n; ++i) {
+			T *yi = y.data() + i * s;
+			const T *xi = X + i * s;
+			for(int k = 0; k < s; ++k) {
+				yi[k] = A.diagonal()[i] * xi[k];
+			}
+			if(i > 0) {
+				for(int k = 0; k < s; ++k) {
+					yi[k] += A.lower()[i] * xi[k - s];
+				}
+			}
+			if(i < n - 1) {
+				for(int k = 0; k < s; ++k) {
+					yi[k] += A.upper()[i] * xi[k + s];
+				}
+			}
+		}
+		return y;
+	}
+
+	/** Band times dense: every column of \p rhs in one pass over A. */
+	template<typename T, typename E>
+	DynamicMatrix<T> dot(const BandedMatrix<T> &A, const MatrixExpr<E> &rhs) {
+		DynamicMatrix<T> x(rhs);
+		assert(A.cols() == x.rows());
+		const int n = A.rows(), s = x.cols();
+		DynamicMatrix<T> y(n, s);
+		if(s == 1) {
+			A.multiply(x.data(), y.data());
+			return y;
+		}
+		const int kl = A.lowerBandwidth(), ku = A.upperBandwidth(), w = A.width();
+		const T *X = x.data();
+		for(int i = 0; i < n; ++i) {
+			T *yi = y.data() + i * s;
+			const T *row = A.band() + i * w - i + kl;
+			for(int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j) {
+				const T v = row[j];
+				const T *xj = X + j * s;
+				for(int k = 0; k < s; ++k) {
+					yi[k] += v * xj[k];
+				}
+			}
+		}
+		return y;
+	}
+
+	/**
+	 * Solve A*X = B with the Thomas algorithm: Gaussian elimination without
+	 * pivoting restricted to the three diagonals, O(n) per column of B.
+	 * Stable for diagonally dominant or symmetric positive definite A;
+	 * BandedLU pivots for the others.
+	 * @param[out] x n x s solution, one column per column of \p b
+	 * @throws std::domain_error on a zero leading element
+	 */
+	template<typename T>
+	void thomas(const TridiagonalMatrix<T> &A, const DynamicMatrix<T> &b, DynamicMatrix<T> &x) {
+		const int n = A.rows(), s = b.cols();
+		assert(b.rows() == n);
+		x = b;
+		if(n == 0) {
+			return;
+		}
+		const T *lo = A.lower(), *d = A.diagonal(), *up = A.upper();
+		std::vector<T> c(n);
+		T *X = x.data();
+		T m = d[0];
+		for(int i = 0; i < n; ++i) {
+			if(i > 0) {
+				m = d[i] - lo[i] * c[i - 1];
+			}
+			if(m == T(0)) {
+				throw std::domain_error("Zero leading element");
+			}
+			const T inv = T(1) / m;
+			c[i] = up[i] * inv;
+			T *xi = X + i * s;
+			if(i > 0) {
+				const T l = lo[i];
+				for(int k = 0; k < s; ++k) {
+					xi[k] = (xi[k] - l * xi[k - s]) * inv;
+				}
+			} else {
+				for(int k = 0; k < s; ++k) {
+					xi[k] *= inv;
+				}
+			}
+		}
+		for(int i = n - 2; i >= 0; --i) {
+			T *xi = X + i * s;
+			const T ci = c[i];
+			for(int k = 0; k < s; ++k) {
+				xi[k] -= ci * xi[k + s];
+			}
+		}
+	}
+
+	template<typename T>
+	BandedLU<T>::BandedLU(const BandedMatrix<T> &A)
+		: n(A.rows()), kl(A.lowerBandwidth()), ku(A.upperBandwidth()), w(2 * kl + ku + 1),
+		  lu(n * w), pivots(n), swaps(0), singular(false)
+	{
+		/* row i holds columns i-kl .. i+kl+ku: the band plus room for the fill of swaps */
+		for(int i = 0; i < n; ++i) {
+			for(int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j) {
+				at(i, j) = A.coeff(i, j);
+			}
+		}
+		for(int k = 0; k < n; ++k) {
+			const int last = std::min(n - 1, k + kl);
+			const int right = std::min(n - 1, k + kl + ku);
+			int p = k;
+			for(int i = k + 1; i <= last; ++i) {
+				if(std::abs(at(i, k)) > std::abs(at(p, k))) {
+					p = i;
+				}
+			}
+			pivots[k] = p;
+			if(at(p, k) == T(0)) {
+				singular = true;
+				continue;
+			}
+			if(p != k) {
+				for(int j = k; j <= right; ++j) {
+					std::swap(at(k, j), at(p, j));
+				}
+				++swaps;
+			}
+			const T inv = T(1) / at(k, k);
+			const T *pivotRow = &at(k, k);
+			for(int i = k + 1; i <= last; ++i) {
+				T *row = &at(i, k);
+				const T l = row[0] * inv;
+				row[0] = l;
+				for(int j = 1; j <= right - k; ++j) {
+					row[j] -= l * pivotRow[j];
+				}
+			}
+		}
+	}
+
+	template<typename T>
+	template<typename Rhs>
+	typename PlainObject<Rhs>::type BandedLU<T>::solve(const MatrixExpr<Rhs> &rhs) const {
+		if(singular) {
+			throw std::domain_error("Not invertible matrix");
+		}
+		typename PlainObject<Rhs>::type x(rhs.derived());
+		assert(x.rows() == n);
+		const int s = x.cols();
+		T *X = x.data();
+		/* L^-1 P B: the swaps and eliminations in the order of the factorization */
+		for(int k = 0; k < n; ++k) {
+			T *xk = X + k * s;
+			if(pivots[k] != k) {
+				std::swap_ranges(xk, xk + s, X + pivots[k] * s);
+			}
+			for(int i = k + 1; i <= std::min(n - 1, k + kl); ++i) {
+				const T l = at(i, k);
+				T *xi = X + i * s;
+				for(int c = 0; c < s; ++c) {
+					xi[c] -= l * xk[c];
+				}
+			}
+		}
+		/* U^-1 */
+		for(int i = n - 1; i >= 0; --i) {
+			T *xi = X + i * s;
+			for(int j = i + 1; j <= std::min(n - 1, i + kl + ku); ++j) {
+				const T u = at(i, j);
+				const T *xj = X + j * s;
+				for(int c = 0; c < s; ++c) {
+					xi[c] -= u * xj[c];
+				}
+			}
+			const T inv = T(1) / at(i, i);
+			for(int c = 0; c < s; ++c) {
+				xi[c] *= inv;
+			}
+		}
+		return x;
+	}
+
+	template<typename T>
+	T BandedLU<T>::determinant() const {
+		T det = (swaps % 2) ? -1 : 1;
+		for(int i = 0; i < n; ++i) {
+			det *= at(i, i);
+		}
+		return det;
+	}
+
+	template<typename T>
+	void TridiagonalBatch<T>::set(int s, const TridiagonalMatrix<T> &A) {
+		assert(A.rows() == n && s >= 0 && s < count);
+		for(int i = 0; i < n; ++i) {
+			a[i * count + s] = A.lower()[i];
+			b[i * count + s] = A.diagonal()[i];
+			c[i * count + s] = A.upper()[i];
+		}
+	}
+
+	template<typename T>
+	TridiagonalMatrix<T> TridiagonalBatch<T>::get(int s) const {
+		TridiagonalMatrix<T> A(n);
+		for(int i = 0; i < n; ++i) {
+			A.lower()[i] = a[i * count + s];
+			A.diagonal()[i] = b[i * count + s];
+			A.upper()[i] = c[i * count + s];
+		}
+		return A;
+	}
+
+	namespace detail {
+		template<typename T>
+		int cyclicReduction(const TridiagonalBatch<T> &A, const DynamicMatrix<T> &B, DynamicMatrix<T> &X,
+							ThreadPool *pool, unsigned char *singular) {
+			const int n = A.rows(), count = A.size();
+			assert(B.rows() == n && B.cols() == count);
+			X = B;
+			if(n == 0 || count == 0) {
+				return 0;
+			}
+			std::vector<T> a(A.lower(0), A.lower(0) + n * count);
+			std::vector<T> b(A.diagonal(0), A.diagonal(0) + n * count);
+			std::vector<T> c(A.upper(0), A.upper(0) + n * count);
+			T *x = X.data();
+			/* one level runs over about 4096 elements per task */
+			const int grain = std::max(1, 4096 / count);
+			auto run = [&](int equations, const std::function<void(int, int)> &f) {
+				if(pool) {
+					parallelFor(*pool, 0, equations, grain, f);
+				} else if(equations > 0) {
+					f(0, equations);
+				}
+			};
+
+			/* Reduction: equation i (1-based, i = 0 mod 2h) absorbs i - h and
+			 * i + h and couples to i - 2h and i + 2h; all of a level at once. */
+			int h = 1;
+			for(; 2 * h <= n; h *= 2) {
+				run(n / (2 * h), [&, h](int e0, int e1) {
+					for(int e = e0; e < e1; ++e) {
+						const int i = 2 * h * (e + 1) - 1, lo = i - h, hi = i + h;
+						T *ai = &a[i * count], *bi = &b[i * count], *ci = &c[i * count], *xi = x + i * count;
+						const T *al = &a[lo * count], *bl = &b[lo * count], *cl = &c[lo * count], *xl = x + lo * count;
+						if(hi < n) {
+							const T *ah = &a[hi * count], *bh = &b[hi * count], *ch = &c[hi * count];
+							const T *xh = x + hi * count;
+							for(int s = 0; s < count; ++s) {
+								const T alpha = -ai[s] / bl[s], gamma = -ci[s] / bh[s];
+								ai[s] = alpha * al[s];
+								bi[s] += alpha * cl[s] + gamma * ah[s];
+								ci[s] = gamma * ch[s];
+								xi[s] += alpha * xl[s] + gamma * xh[s];
+							}
+						} else {
+							for(int s = 0; s < count; ++s) {
+								const T alpha = -ai[s] / bl[s];
+								ai[s] = alpha * al[s];
+								bi[s] += alpha * cl[s];
+								ci[s] = 0;
+								xi[s] += alpha * xl[s];
+							}
+						}
+					}
+				});
+			}
+
+			/* Back substitution: the odd multiples of h, from their solved neighbours */
+			for(; h >= 1; h /= 2) {
+				run((n / h + 1) / 2, [&, h](int e0, int e1) {
+					for(int e = e0; e < e1; ++e) {
+						const int i = h * (2 * e + 1) - 1, lo = i - h, hi = i + h;
+						const T *ai = &a[i * count], *bi = &b[i * count], *ci = &c[i * count];
+						T *xi = x + i * count;
+						const T *xl = x + std::max(lo, 0) * count, *xh = x + std::min(hi, n - 1) * count;
+						for(int s = 0; s < count; ++s) {
+							T v = xi[s];
+							if(lo >= 0) {
+								v -= ai[s] * xl[s];
+							}
+							if(hi < n) {
+								v -= ci[s] * xh[s];
+							}
+							xi[s] = v / bi[s];
+						}
+					}
+				});
+			}
+
+			/* a zero pivot anywhere leaves its system non-finite */
+			std::vector<unsigned char> failed(count);
+			for(int i = 0; i < n; ++i) {
+				const T *xi = x + i * count;
+				for(int s = 0; s < count; ++s) {
+					failed[s] |= !std::isfinite(static_cast<double>(xi[s]));
+				}
+			}
+			int nfailed = 0;
+			for(int s = 0; s < count; ++s) {
+				if(failed[s]) {
+					++nfailed;
+					for(int i = 0; i < n; ++i) {
+						x[i * count + s] = 0;
+					}
+				}
+				if(singular) {
+					singular[s] = failed[s];
+				}
+			}
+			return nfailed;
+		}
+	}
+
+	/**
+	 * Solve count tridiagonal systems at once by cyclic reduction: log2(n)
+	 * levels each eliminate every other remaining unknown, and the
+	 * equations of a level as well as the systems are independent, so
+	 * each level vectorizes across the systems and splits across threads.
+	 * Like Thomas, there is no pivoting: meant for diagonally dominant or
+	 * positive definite systems. Instead of throwing, a system that hits a
+	 * zero pivot gets a zero solution.
+	 * @param B n x count right-hand sides, column s for system s
+	 * @param[out] X n x count solutions
+	 * @param[out] singular If not null, singular[s] = 1 for a failed system s, 0 otherwise.
+	 * @returns number of failed systems
+	 */
+	template<typename T>
+	int cyclicReduction(const TridiagonalBatch<T> &A, const DynamicMatrix<T> &B, DynamicMatrix<T> &X,
+						unsigned char *singular = nullptr) {
+		return detail::cyclicReduction(A, B, X, nullptr, singular);
+	}
+
+	/** cyclicReduction() with the equations of each level split across \p pool */
+	template<typename T>
+	int cyclicReduction(const TridiagonalBatch<T> &A, const DynamicMatrix<T> &B, DynamicMatrix<T> &X,
+						ThreadPool &pool, unsigned char *singular = nullptr) {
+		return detail::cyclicReduction(A, B, X, &pool, singular);
+	}
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <vector>
+#include <assert.h>
+
+#include "matrix.hpp"
+#include "small.hpp"
+
+namespace Math
+{
+	/**
+	 * A batch of `size()` independent rows x cols matrices stored as a
+	 * structure of arrays: element (i, j) of every matrix is contiguous, so
+	 * one SIMD register holds the same element of several matrices.
+	 * The lane count is padded to a multiple of 8; padding lanes are zero.
+	 */
+	template<typename T, int rows, int cols>
+	class SmallBatch
+	{
+	public:
+		typedef T Scalar;
+		static constexpr int Rows = rows;
+		static constexpr int Cols = cols;
+
+		explicit SmallBatch(int count = 0) : count(count), soa(rows * cols, padded(count)) {}
+
+		int size() const { return count; }
+		/** Distance between element arrays, a multiple of 8 lanes */
+		int stride() const { return soa.cols(); }
+
+		/** Element (i, j) of all the matrices */
+		T* element(int i, int j) { return soa.data() + (i * cols + j) * stride(); }
+		const T* element(int i, int j) const { return soa.data() + (i * cols + j) * stride(); }
+
+		T& operator()(int lane, int i, int j) { return element(i, j)[lane]; }
+		T operator()(int lane, int i, int j) const { return element(i, j)[lane]; }
+
+		void set(int lane, const Matrix<T, rows, cols> &mat) {
+			for(int i = 0; i < rows; ++i) {
+				for(int j = 0; j < cols; ++j) {
+					element(i, j)[lane] = mat(i, j);
+				}
+			}
+		}
+
+		Matrix<T, rows, cols> get(int lane) const {
+			Matrix<T, rows, cols> mat;
+			for(int i = 0; i < rows; ++i) {
+				for(int j = 0; j < cols; ++j) {
+					mat(i, j) = element(i, j)[lane];
+				}
+			}
+			return mat;
+		}
+
+	private:
+		int count;
+		DynamicMatrix<T> soa;
+
+		static int padded(int count) { return (count + 7) / 8 * 8; }
+	};
+
+	namespace detail {
+		/* 32-byte vectors: four doubles or eight floats, so a stride of 8 lanes is whole vectors */
+		template<typename T>
+		struct BatchVector {
+			typedef T type __attribute__((vector_size(32)));
+			static const int width = 32 / sizeof(T);
+		};
+
+		/* Vectors travel by reference: by value they would change the ABI without AVX */
+		template<typename V, typename T>
+		inline void loadLanes(V &v, const T *p) {
+			std::memcpy(&v, p, sizeof(V));
+		}
+
+		template<typename V, typename T>
+		inline void storeLanes(T *p, const V &v) {
+			std::memcpy(p, &v, sizeof(V));
+		}
+
+		/* 1/det, or 0 where det == 0; marks singular lanes */
+		template<typename V, typename T>
+		inline void safeInverse(const V &det, V &inv, int lane0, int count, unsigned char *singular, int &nsingular) {
+			const int width = sizeof(V) / sizeof(T);
+			inv = T(1) / det;
+			for(int l = 0; l < width; ++l) {
+				bool zero = (det[l] == 0);
+				if(zero) {
+					inv[l] = 0;
+				}
+				if(lane0 + l < count) {
+					nsingular += zero;
+					if(singular) {
+						singular[lane0 + l] = zero;
+					}
+				}
+			}
+		}
+	}
+
+	/** Determinants of all the matrices of a batch */
+	template<typename T, int n>
+	void determinant(const SmallBatch<T, n, n> &A, T *det) {
+		typedef typename detail::BatchVector<T>::type V;
+		const int width = detail::BatchVector<T>::width;
+		for(int k = 0; k < A.size(); k += width) {
+			V a[n * n];
+			for(int e = 0; e < n * n; ++e) {
+				detail::loadLanes(a[e], A.element(e / n, e % n) + k);
+			}
+			V d;
+			detail::SmallInverse<n>::determinant(a, d);
+			for(int l = 0; l < width && k + l < A.size(); ++l) {
+				det[k + l] = d[l];
+			}
+		}
+	}
+
+	/**
+	 * Inverts all the matrices of a batch.
+	 * Instead of throwing, singular matrices get a zero inverse.
+	 * @param[out] inv Batch of the same size as A.
+	 * @param[out] singular If not null, singular[k] = 1 for a singular matrix k, 0 otherwise.
+	 * @returns number of singular matrices
+	 */
+	template<typename T, int n>
+	int invert(const SmallBatch<T, n, n> &A, SmallBatch<T, n, n> &inv, unsigned char *singular = nullptr) {
+		typedef typename detail::BatchVector<T>::type V;
+		const int width = detail::BatchVector<T>::width;
+		assert(inv.size() == A.size());
+		int nsingular = 0;
+		for(int k = 0; k < A.size(); k += width) {
+			V a[n * n], b[n * n];
+			for(int e = 0; e < n * n; ++e) {
+				detail::loadLanes(a[e], A.element(e / n, e % n) + k);
+			}
+			V det, detInv;
+			detail::SmallInverse<n>::adjugate(a, b, det);
+			detail::safeInverse<V, T>(det, detInv, k, A.size(), singular, nsingular);
+			for(int e = 0; e < n * n; ++e) {
+				b[e] *= detInv;
+				detail::storeLanes(inv.element(e / n, e % n) + k, b[e]);
+			}
+		}
+		return nsingular;
+	}
+
+	/**
+	 * Solves A_k * X_k = B_k for every matrix k of a batch.
+	 * Singular systems get a zero solution.
+	 * @param[out] X Batch of the same size as A.
+	 * @param[out] singular If not null, singular[k] = 1 for a singular matrix k, 0 otherwise.
+	 * @returns number of singular systems
+	 */
+	template<typename T, int n, int s>
+	int solve(const SmallBatch<T, n, n> &A, const SmallBatch<T, n, s> &B, SmallBatch<T, n, s> &X,
+			  unsigned char *singular = nullptr) {
+		typedef typename detail::BatchVector<T>::type V;
+		const int width = detail::BatchVector<T>::width;
+		assert(B.size() == A.size() && X.size() == A.size());
+		int nsingular = 0;
+		for(int k = 0; k < A.size(); k += width) {
+			V a[n * n], b[n * n];
+			for(int e = 0; e < n * n; ++e) {
+				detail::loadLanes(a[e], A.element(e / n, e % n) + k);
+			}
+			V det, detInv;
+			detail::SmallInverse<n>::adjugate(a, b, det);
+			detail::safeInverse<V, T>(det, detInv, k, A.size(), singular, nsingular);
+			for(int c = 0; c < s; ++c) {
+				V rhs[n];
+				for(int j = 0; j < n; ++j) {
+					detail::loadLanes(rhs[j], B.element(j, c) + k);
+				}
+				for(int i = 0; i < n; ++i) {
+					V sum = b[i * n] * rhs[0];
+					for(int j = 1; j < n; ++j) {
+						sum += b[i * n + j] * rhs[j];
+					}
+					sum *= detInv;
+					detail::storeLanes(X.element(i, c) + k, sum);
+				}
+			}
+		}
+		return nsingular;
+	}
+
+	/** Maximum absolute row sum of every matrix of a batch, as norm2() of problem 10 */
+	template<typename T, int n>
+	void norm(const SmallBatch<T, n, n> &A, T *result) {
+		typedef typename detail::BatchVector<T>::type V;
+		const int width = detail::BatchVector<T>::width;
+		for(int k = 0; k < A.size(); k += width) {
+			V best = {};
+			for(int i = 0; i < n; ++i) {
+				V sum = {};
+				for(int j = 0; j < n; ++j) {
+					V a;
+					detail::loadLanes(a, A.element(i, j) + k);
+					sum += (a < 0) ? -a : a;
+				}
+				best = (sum > best) ? sum : best;
+			}
+			for(int l = 0; l < width && k + l < A.size(); ++l) {
+				result[k + l] = best[l];
+			}
+		}
+	}
+
+	/**
+	 * Condition numbers ||A|| * ||A^-1|| in the norm of norm().
+	 * Singular matrices get infinity.
+	 * @param[out] singular If not null, singular[k] = 1 for a singular matrix k, 0 otherwise.
+	 * @returns number of singular matrices
+	 */
+	template<typename T, int n>
+	int cond(const SmallBatch<T, n, n> &A, T *result, unsigned char *singular = nullptr) {
+		SmallBatch<T, n, n> inv(A.size());
+		std::vector<unsigned char> mask(A.size());
+		int nsingular = invert(A, inv, mask.data());
+		std::vector<T> invNorm(A.size());
+		norm(A, result);
+		norm(inv, invNorm.data());
+		for(int k = 0; k < A.size(); ++k) {
+			result[k] = mask[k] ? std::numeric_limits<T>::infinity() : result[k] * invNorm[k];
+		}
+		if(singular) {
+			std::copy(mask.begin(), mask.end(), singular);
+		}
+		return nsingular;
+	}
+};
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+
+#include "linsys.hpp"
+
+namespace Math
+{
+	namespace detail {
+		template<typename T, int n>
+		void resizeSquare(Matrix<T, n, n> &, int size) {
+			assert(size == n);
+		}
+
+		template<typename T>
+		void resizeSquare(DynamicMatrix<T> &mat, int size) {
+			mat.resize(size, size);
+		}
+
+		/**
+		 * The lower triangle of a symmetric matrix as square tiles.
+		 * Tile (i, j), i >= j, is a contiguous row-major tileSize^2 block;
+		 * edge tiles are padded and the padding is never read.
+		 */
+		template<typename T>
+		class LowerTiles
+		{
+		public:
+			LowerTiles() : n(0), b(1), nt(0) {}
+
+			template<typename M>
+			LowerTiles(const M &mat, int tileSize)
+				: n(mat.rows()), b(std::max(1, tileSize)), nt((n + b - 1) / b),
+				  storage(nt * (nt + 1) / 2, b * b)
+			{
+				for(int i = 0; i < n; ++i) {
+					for(int j = 0; j <= i; ++j) {
+						tile(i / b, j / b)[(i % b) * b + j % b] = mat(i, j);
+					}
+				}
+			}
+
+			int size() const { return n; }
+			int tileSize() const { return b; }
+			int tiles() const { return nt; }
+			/* rows of tile row i */
+			int height(int i) const { return std::min(b, n - i * b); }
+			int index(int i, int j) const { return i * (i + 1) / 2 + j; }
+
+			T* tile(int i, int j) {
+				assert(i >= j);
+				return storage.data() + static_cast<size_t>(index(i, j)) * b * b;
+			}
+			const T* tile(int i, int j) const {
+				assert(i >= j);
+				return storage.data() + static_cast<size_t>(index(i, j)) * b * b;
+			}
+			/* element (i, j) of the lower triangle */
+			T operator()(int i, int j) const { return tile(i / b, j / b)[(i % b) * b + j % b]; }
+
+		private:
+			int n;
+			int b;
+			int nt;
+			DynamicMatrix<T> storage;
+		};
+
+		/** A = L*L^T of an m x m tile in place; false if A is not positive definite */
+		template<typename T>
+		bool potrfTile(T *a, int m, int ld) {
+			for(int j = 0; j < m; ++j) {
+				T *rj = a + j * ld;
+				const T d = rj[j] - rowDot(rj, rj, j);
+				if(!(d > 0)) {
+					return false;
+				}
+				const T ljj = std::sqrt(d);
+				rj[j] = ljj;
+				const T inv = T(1) / ljj;
+				for(int i = j + 1; i < m; ++i) {
+					T *ri = a + i * ld;
+					ri[j] = (ri[j] - rowDot(ri, rj, j)) * inv;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * A = L*D*L^T of an m x m tile in place, L unit lower triangular with
+		 * D on its diagonal; false if a pivot is zero.
+		 * @param w Scratch of m elements.
+		 */
+		template<typename T>
+		bool ldltTile(T *a, int m, int ld, T *w) {
+			for(int j = 0; j < m; ++j) {
+				T *rj = a + j * ld;
+				/* w_p = l_jp * d_p */
+				for(int p = 0; p < j; ++p) {
+					w[p] = rj[p] * a[p * ld + p];
+				}
+				const T d = rj[j] - rowDot(rj, w, j);
+				if(d == 0 || d != d) {
+					return false;
+				}
+				rj[j] = d;
+				const T inv = T(1) / d;
+				for(int i = j + 1; i < m; ++i) {
+					T *ri = a + i * ld;
+					ri[j] = (ri[j] - rowDot(ri, w, j)) * inv;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * B = B * L^-T for an mb x m tile B and the factored m x m diagonal tile;
+		 * with unit L, the columns are then divided by D.
+		 */
+		template<typename T>
+		void trsmTile(const T *l, int m, T *bt, int mb, int ld, bool unit) {
+			for(int r = 0; r < mb; ++r) {
+				T *x = bt + r * ld;
+				for(int c = 0; c < m; ++c) {
+					const T *lc = l + c * ld;
+					const T v = x[c] - rowDot(x, lc, c);
+					x[c] = unit ? v : v / lc[c];
+				}
+				if(unit) {
+					for(int c = 0; c < m; ++c) {
+						x[c] /= l[c * ld + c];
+					}
+				}
+			}
+		}
+
+		/**
+		 * Tiled right-looking LL^T (or LDL^T) of the tiles in place.
+		 * Step k factors tile (k,k) (POTRF), divides the tiles below it
+		 * (TRSM) and updates the trailing triangle (SYRK on the diagonal,
+		 * GEMM below it). Given a pool, every tile operation is a task of a
+		 * TaskGraph that depends on the last tasks writing the tiles it reads
+		 * or writes; no tile is written again after its last read, so these
+		 * are all the dependencies. Step k+1 thus starts while the trailing
+		 * update of step k is still running.
+		 * @returns false if the matrix is not positive definite (LL^T) or a pivot is zero (LDL^T)
+		 */
+		template<typename T>
+		bool choleskyTiles(LowerTiles<T> &A, bool ldl, ThreadPool *pool) {
+			const int nt = A.tiles();
+			const int b = A.tileSize();
+			std::atomic<bool> failed(false);
+			std::unique_ptr<TaskGraph> graph(pool && pool->size() > 1 ? new TaskGraph(*pool) : nullptr);
+			std::vector<int> lastWriter(nt * (nt + 1) / 2, -1);
+			/* runs f at once, or adds it to the graph after the writers of `reads` and of tile `writes` */
+			auto emit = [&](std::function<void()> f, std::initializer_list<int> reads, int writes) {
+				if(!graph) {
+					f();
+					return;
+				}
+				std::vector<int> after;
+				for(int r : reads) {
+					after.push_back(lastWriter[r]);
+				}
+				after.push_back(lastWriter[writes]);
+				lastWriter[writes] = graph->add(f, after);
+			};
+			LowerTiles<T> *tiles = &A;
+
+			for(int k = 0; k < nt; ++k) {
+				const int kk = A.index(k, k);
+				emit([=, &failed]() {
+					if(failed) {
+						return;
+					}
+					std::vector<T> w(ldl ? b : 0);
+					T *a = tiles->tile(k, k);
+					if(!(ldl ? ldltTile(a, tiles->height(k), b, w.data()) : potrfTile(a, tiles->height(k), b))) {
+						failed = true;
+					}
+				}, {}, kk);
+				for(int i = k + 1; i < nt; ++i) {
+					emit([=, &failed]() {
+						if(!failed) {
+							trsmTile(tiles->tile(k, k), tiles->height(k), tiles->tile(i, k), tiles->height(i), b, ldl);
+						}
+					}, {kk}, A.index(i, k));
+				}
+				for(int i = k + 1; i < nt; ++i) {
+					for(int j = k + 1; j <= i; ++j) {
+						/* A_ij -= L_ik * D_k * L_jk^T; SYRK for i == j, computed as a GEMM */
+						emit([=, &failed]() {
+							if(failed) {
+								return;
+							}
+							const int mk = tiles->height(k);
+							const T *lik = tiles->tile(i, k);
+							const T *ljk = tiles->tile(j, k);
+							std::vector<T> scaled;
+							if(ldl) {
+								const T *d = tiles->tile(k, k);
+								scaled.assign(ljk, ljk + static_cast<size_t>(tiles->height(j)) * b);
+								for(int r = 0; r < tiles->height(j); ++r) {
+									for(int p = 0; p < mk; ++p) {
+										scaled[r * b + p] *= d[p * b + p];
+									}
+								}
+								ljk = scaled.data();
+							}
+							gemm(tiles->height(i), tiles->height(j), mk, T(-1),
+								 lik, b, 1,
+								 ljk, 1, b,
+								 T(1), tiles->tile(i, j), b, 1);
+						}, {A.index(i, k), A.index(j, k)}, A.index(i, j));
+					}
+				}
+			}
+			if(graph) {
+				graph->run();
+			}
+			return !failed;
+		}
+
+		/** Shared by LLTFactorization and LDLTFactorization; \p unit selects LDL^T */
+		template<typename MatrixType, bool unit>
+		class TiledCholesky
+		{
+		public:
+			typedef typename MatrixType::Scalar Scalar;
+
+			explicit TiledCholesky(const MatrixType &mat, int tileSize = 64)
+				: tiles(mat, tileSize), ok(false) { factor(nullptr); }
+			TiledCholesky(const MatrixType &mat, ThreadPool &pool, int tileSize = 64)
+				: tiles(mat, tileSize), ok(false) { factor(&pool); }
+
+			/**
+			 * Solves A*X = B for every column of B; given a pool, blocks of
+			 * columns are solved in parallel.
+			 * @throws std::domain_error if the factorization failed
+			 */
+			template<typename Rhs>
+			typename PlainObject<Rhs>::type solve(const MatrixExpr<Rhs> &b, ThreadPool *pool = nullptr) const;
+
+			Scalar determinant() const;
+			int size() const { return tiles.size(); }
+
+			/** L, with a unit diagonal for LDL^T */
+			MatrixType matrixL() const;
+
+		protected:
+			LowerTiles<Scalar> tiles;
+			bool ok;
+
+		private:
+			void factor(ThreadPool *pool) { ok = choleskyTiles(tiles, unit, pool); }
+			void solveColumns(Scalar *X, int s, int c0, int c1) const;
+		};
+
+		template<typename MatrixType, bool unit>
+		MatrixType TiledCholesky<MatrixType, unit>::matrixL() const {
+			const int n = tiles.size();
+			MatrixType L;
+			resizeSquare(L, n);
+			setZero(L);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < i; ++j) {
+					L(i, j) = tiles(i, j);
+				}
+				L(i, i) = unit ? Scalar(1) : tiles(i, i);
+			}
+			return L;
+		}
+
+		template<typename MatrixType, bool unit>
+		typename TiledCholesky<MatrixType, unit>::Scalar TiledCholesky<MatrixType, unit>::determinant() const {
+			Scalar det = 1;
+			for(int i = 0; i < tiles.size(); ++i) {
+				det *= unit ? tiles(i, i) : tiles(i, i) * tiles(i, i);
+			}
+			return det;
+		}
+
+		/** L*Y = B, D*Z = Y, L^T*X = Z for columns c0..c1-1 of X (row-major, s columns) */
+		template<typename MatrixType, bool unit>
+		void TiledCholesky<MatrixType, unit>::solveColumns(Scalar *X, int s, int c0, int c1) const {
+			const int nt = tiles.tiles();
+			const int b = tiles.tileSize();
+			const int w = c1 - c0;
+			for(int k = 0; k < nt; ++k) {
+				const int mk = tiles.height(k);
+				const Scalar *L = tiles.tile(k, k);
+				Scalar *Xk = X + k * b * s + c0;
+				trsm(unit ? Triangle::UnitLower : Triangle::Lower, mk, w, L, b, 1, Xk, s, 1);
+				for(int i = k + 1; i < nt; ++i) {
+					gemm(tiles.height(i), w, mk, Scalar(-1),
+						 tiles.tile(i, k), b, 1,
+						 Xk, s, 1,
+						 Scalar(1), X + i * b * s + c0, s, 1);
+				}
+			}
+			if(unit) {
+				for(int r = 0; r < tiles.size(); ++r) {
+					const Scalar inv = Scalar(1) / tiles(r, r);
+					Scalar *xr = X + r * s + c0;
+					for(int c = 0; c < w; ++c) {
+						xr[c] *= inv;
+					}
+				}
+			}
+			for(int k = nt - 1; k >= 0; --k) {
+				const int mk = tiles.height(k);
+				Scalar *Xk = X + k * b * s + c0;
+				/* X_k -= L_ik^T X_i */
+				for(int i = k + 1; i < nt; ++i) {
+					gemm(mk, w, tiles.height(i), Scalar(-1),
+						 tiles.tile(i, k), 1, b,
+						 X + i * b * s + c0, s, 1,
+						 Scalar(1), Xk, s, 1);
+				}
+				/* L_kk^T: the upper triangle, by exchanging the strides */
+				trsm(unit ? Triangle::UnitUpper : Triangle::Upper, mk, w, tiles.tile(k, k), 1, b, Xk, s, 1);
+			}
+		}
+
+		template<typename MatrixType, bool unit>
+		template<typename Rhs>
+		typename PlainObject<Rhs>::type TiledCholesky<MatrixType, unit>::solve(const MatrixExpr<Rhs> &rhs,
+																			   ThreadPool *pool) const {
+			if(!ok) {
+				throw std::domain_error(unit ? "Not invertible matrix" : "Not positive definite matrix");
+			}
+			typename PlainObject<Rhs>::type x(rhs);
+			assert(x.rows() == tiles.size());
+			const int s = x.cols();
+			Scalar *X = x.data();
+			if(pool) {
+				parallelFor(*pool, 0, s, 32, [=](int c0, int c1) { solveColumns(X, s, c0, c1); });
+			} else if(s > 0) {
+				solveColumns(X, s, 0, s);
+			}
+			return x;
+		}
+	}
+
+	/**
+	 * Cholesky factorization A = L*L^T of a symmetric positive definite matrix.
+	 * Half the flops of LUFactorization and no pivoting. Only the lower
+	 * triangle of A is read, and only the lower triangle is kept, as square
+	 * tiles; given a ThreadPool the tile operations run as a dependency
+	 * graph, so tiles of consecutive steps are factored concurrently.
+	 * @tparam MatrixType Matrix<T, n, n> or DynamicMatrix<T>
+	 */
+	template<typename MatrixType>
+	class LLTFactorization : public detail::TiledCholesky<MatrixType, false>
+	{
+	public:
+		explicit LLTFactorization(const MatrixType &mat, int tileSize = 64)
+			: detail::TiledCholesky<MatrixType, false>(mat, tileSize) {}
+		LLTFactorization(const MatrixType &mat, ThreadPool &pool, int tileSize = 64)
+			: detail::TiledCholesky<MatrixType, false>(mat, pool, tileSize) {}
+
+		bool positiveDefinite() const { return this->ok; }
+	};
+
+	/**
+	 * A = L*D*L^T with L unit lower triangular and D diagonal, for symmetric
+	 * matrices that need not be positive definite; no square roots. Tiled and
+	 * scheduled like LLTFactorization. Without pivoting it is only stable when
+	 * the matrix is definite or strongly diagonally dominant.
+	 * @tparam MatrixType Matrix<T, n, n> or DynamicMatrix<T>
+	 */
+	template<typename MatrixType>
+	class LDLTFactorization : public detail::TiledCholesky<MatrixType, true>
+	{
+	public:
+		explicit LDLTFactorization(const MatrixType &mat, int tileSize = 64)
+			: detail::TiledCholesky<MatrixType, true>(mat, tileSize) {}
+		LDLTFactorization(const MatrixType &mat, ThreadPool &pool, int tileSize = 64)
+			: detail::TiledCholesky<MatrixType, true>(mat, pool, tileSize) {}
+
+		bool invertible() const { return this->ok; }
+
+		/** The diagonal of D */
+		std::vector<typename MatrixType::Scalar> vectorD() const {
+			std::vector<typename MatrixType::Scalar> d(this->size());
+			for(int i = 0; i < this->size(); ++i) {
+				d[i] = this->tiles(i, i);
+			}
+			return d;
+		}
+	};
+};
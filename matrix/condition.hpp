@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace Math
+{
+	/** The matrix norm a condition number is taken in */
+	enum class Norm {
+		One,      ///< the largest absolute column sum
+		Infinity  ///< the largest absolute row sum, as norm2() of problem 10
+	};
+
+	namespace detail {
+		/** 1-norm: the largest absolute column sum */
+		template<typename M>
+		double norm1(const M &a) {
+			std::vector<double> sums(a.cols());
+			for(int i = 0; i < a.rows(); ++i) {
+				for(int j = 0; j < a.cols(); ++j) {
+					sums[j] += std::abs(static_cast<double>(a(i, j)));
+				}
+			}
+			return sums.empty() ? 0 : *std::max_element(sums.begin(), sums.end());
+		}
+
+		/** Infinity norm: the largest absolute row sum */
+		template<typename M>
+		double normInf(const M &a) {
+			double norm = 0;
+			for(int i = 0; i < a.rows(); ++i) {
+				double sum = 0;
+				for(int j = 0; j < a.cols(); ++j) {
+					sum += std::abs(static_cast<double>(a(i, j)));
+				}
+				norm = std::max(norm, sum);
+			}
+			return norm;
+		}
+
+		/**
+		 * Lower bound of ||B||_1 from a few products with B and B^T, after
+		 * Hager and Higham (LAPACK xLACON): a gradient ascent over the unit
+		 * 1-norm ball, at most five steps, checked against Higham's
+		 * alternating-sign vector. With B = A^-1 applied by a factorization
+		 * every product is a pair of triangular solves, so the estimate costs
+		 * O(n^2) and is almost always within a factor of 3 of the true norm.
+		 * @param apply x := B * x in place
+		 * @param applyTransposed x := B^T * x in place
+		 */
+		template<typename T, typename Apply, typename ApplyT>
+		double estimateNorm1(int n, Apply apply, ApplyT applyTransposed) {
+			if(n == 0) {
+				return 0;
+			}
+			auto sum = [&](const std::vector<T> &v) {
+				double s = 0;
+				for(int i = 0; i < n; ++i) {
+					s += std::abs(static_cast<double>(v[i]));
+				}
+				return s;
+			};
+			auto argmax = [&](const std::vector<T> &v) {
+				int j = 0;
+				for(int i = 1; i < n; ++i) {
+					if(std::abs(v[i]) > std::abs(v[j])) {
+						j = i;
+					}
+				}
+				return j;
+			};
+			std::vector<T> x(n, T(1) / n), sign(n);
+			apply(x.data());
+			double estimate = sum(x);
+			if(n == 1) {
+				return estimate;
+			}
+			for(int i = 0; i < n; ++i) {
+				sign[i] = (x[i] >= 0) ? 1 : -1;
+			}
+			x = sign;
+			applyTransposed(x.data());
+			int j = argmax(x);
+			for(int step = 1; step < 5; ++step) {
+				/* the column of B the gradient points at */
+				std::fill(x.begin(), x.end(), T(0));
+				x[j] = 1;
+				apply(x.data());
+				const double last = estimate;
+				estimate = sum(x);
+				bool repeated = true;
+				for(int i = 0; i < n; ++i) {
+					const T s = (x[i] >= 0) ? 1 : -1;
+					repeated = repeated && s == sign[i];
+					sign[i] = s;
+				}
+				/* a local maximum: the signs, and so the next column, would repeat */
+				if(repeated || !(estimate > last)) {
+					estimate = std::max(estimate, last);
+					break;
+				}
+				x = sign;
+				applyTransposed(x.data());
+				const int previous = j;
+				j = argmax(x);
+				if(std::abs(x[j]) == std::abs(x[previous])) {
+					break;
+				}
+			}
+			/* Higham's safeguard against matrices built to fool the ascent */
+			for(int i = 0; i < n; ++i) {
+				x[i] = T((i % 2) ? -1 : 1) * (1 + T(i) / (n - 1));
+			}
+			apply(x.data());
+			return std::max(estimate, 2 * sum(x) / (3.0 * n));
+		}
+
+		/** 1 / (||A|| ||A^-1||), 0 for a singular or non-finite A */
+		inline double reciprocal(double normA, double normInverse) {
+			const double r = 1 / (normA * normInverse);
+			return (r == r && normA > 0 && normInverse < std::numeric_limits<double>::infinity()) ? r : 0;
+		}
+	}
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <initializer_list>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#include <assert.h>
+
+#include "expr.hpp"
+
+namespace Math
+{
+	/** Tag for constructors that leave the elements uninitialized. */
+	struct Uninitialized {};
+	const Uninitialized uninitialized = {};
+
+	/** Tag for constructors that use storage owned by someone else, e.g. a memory-mapped file. */
+	struct External {};
+	const External external = {};
+
+	namespace detail {
+		/* Storage is aligned to a cache line, which also suits any SIMD width */
+		const size_t matrixAlignment = 64;
+
+		/**
+		 * Allocates memory aligned to matrixAlignment.
+		 * The pointer returned by malloc() is kept right before the aligned block.
+		 */
+		inline void* alignedAlloc(size_t bytes) {
+			void *raw = std::malloc(bytes + matrixAlignment + sizeof(void*));
+			if(!raw) {
+				throw std::bad_alloc();
+			}
+			std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+			std::uintptr_t aligned = (start + matrixAlignment - 1) & ~(matrixAlignment - 1);
+			reinterpret_cast<void**>(aligned)[-1] = raw;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		inline void alignedFree(void *p) {
+			if(p) {
+				std::free(reinterpret_cast<void**>(p)[-1]);
+			}
+		}
+	}
+
+	/**
+	 * A matrix whose size is chosen at runtime.
+	 * Elements are stored row by row on the heap, so moving a matrix is O(1)
+	 * and large matrices do not live on the stack.
+	 * A matrix built with the External tag works on storage it does not own
+	 * until it is resized; copies of it own their elements.
+	 * @tparam T type of matrix elements, must be trivially copyable
+	 */
+	template<typename T>
+	class DynamicMatrix : public MatrixExpr<DynamicMatrix<T> >
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "DynamicMatrix needs trivially copyable elements");
+	protected:
+		T *matrix;
+		int n;
+		int m;
+		bool owner;
+
+		void allocate(int rows, int cols) {
+			assert(rows >= 0 && cols >= 0);
+			n = rows;
+			m = cols;
+			owner = true;
+			size_t count = static_cast<size_t>(rows) * cols;
+			matrix = count ? static_cast<T*>(detail::alignedAlloc(count * sizeof(T))) : nullptr;
+		}
+	public:
+		typedef T Scalar;
+		static constexpr int Rows = Dynamic;
+		static constexpr int Cols = Dynamic;
+
+		DynamicMatrix();
+		DynamicMatrix(int rows, int cols);
+		DynamicMatrix(int rows, int cols, Uninitialized);
+		DynamicMatrix(int rows, int cols, std::initializer_list<T> l);
+		/** Uses rows*cols row-major elements at \p data, which must outlive the matrix. */
+		DynamicMatrix(int rows, int cols, T *data, External);
+		DynamicMatrix(const DynamicMatrix<T> &mat);
+		DynamicMatrix(DynamicMatrix<T> &&mat);
+		template<typename E>
+		DynamicMatrix(const MatrixExpr<E> &expr);
+		~DynamicMatrix();
+
+		int rows() const { return n; }
+		int cols() const { return m; }
+		T& operator()(int row, int col);
+		T operator()(int row, int col) const;
+		/** Row-major storage of the elements */
+		T* data() { return matrix; }
+		const T* data() const { return matrix; }
+		/** False for a matrix on External storage */
+		bool ownsData() const { return owner; }
+
+		/**
+		 * Changes the size of the matrix.
+		 * Elements are kept only if the size does not change.
+		 */
+		void resize(int rows, int cols);
+
+		DynamicMatrix<T>& operator=(const DynamicMatrix<T> &mat);
+		DynamicMatrix<T>& operator=(DynamicMatrix<T> &&mat);
+		template<typename E>
+		DynamicMatrix<T>& operator=(const MatrixExpr<E> &expr);
+		friend void swap(DynamicMatrix& m1, DynamicMatrix& m2) {
+			std::swap(m1.matrix, m2.matrix);
+			std::swap(m1.n, m2.n);
+			std::swap(m1.m, m2.m);
+			std::swap(m1.owner, m2.owner);
+		}
+
+		/* arithmetics */
+		template<typename E>
+		DynamicMatrix<T>& operator+=(const MatrixExpr<E>& rhs);
+		template<typename E>
+		DynamicMatrix<T>& operator-=(const MatrixExpr<E>& rhs);
+		DynamicMatrix<T>& operator*=(T scalar);
+		bool operator==(const DynamicMatrix<T> &rhs) const;
+	};
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix() : matrix(nullptr), n(0), m(0), owner(true)
+	{
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix(int rows, int cols)
+	{
+		allocate(rows, cols);
+		std::fill(matrix, matrix + n*m, T(0));
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix(int rows, int cols, Uninitialized)
+	{
+		allocate(rows, cols);
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix(int rows, int cols, std::initializer_list<T> l)
+	{
+		assert(l.size() <= static_cast<size_t>(rows)*cols);
+		allocate(rows, cols);
+		std::fill(std::copy(l.begin(), l.end(), matrix), matrix + n*m, T(0));
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix(int rows, int cols, T *data, External)
+		: matrix(data), n(rows), m(cols), owner(false)
+	{
+		assert(rows >= 0 && cols >= 0);
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix(const DynamicMatrix<T> &mat)
+	{
+		allocate(mat.n, mat.m);
+		std::copy(mat.matrix, mat.matrix + n*m, matrix);
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::DynamicMatrix(DynamicMatrix<T> &&mat) : matrix(nullptr), n(0), m(0), owner(true)
+	{
+		swap(*this, mat);
+	}
+
+	template<typename T>
+	template<typename E>
+	DynamicMatrix<T>::DynamicMatrix(const MatrixExpr<E> &expr)
+	{
+		allocate(expr.derived().rows(), expr.derived().cols());
+		detail::evalTo(*this, expr.derived());
+	}
+
+	template<typename T>
+	DynamicMatrix<T>::~DynamicMatrix()
+	{
+		if(owner) {
+			detail::alignedFree(matrix);
+		}
+	}
+
+	template<typename T>
+	T& DynamicMatrix<T>::operator()(int row, int col)
+	{
+		assert(row >= 0 && row < n);
+		assert(col >= 0 && col < m);
+		return matrix[row*m+col];
+	}
+
+	template<typename T>
+	T DynamicMatrix<T>::operator()(int row, int col) const {
+		assert(row >= 0 && row < n);
+		assert(col >= 0 && col < m);
+		return matrix[row*m+col];
+	}
+
+	template<typename T>
+	void DynamicMatrix<T>::resize(int rows, int cols) {
+		if(rows == n && cols == m) {
+			return;
+		}
+		DynamicMatrix<T> tmp(rows, cols, uninitialized);
+		swap(*this, tmp);
+	}
+
+	/** Copies the elements, reusing the storage if the size matches. */
+	template<typename T>
+	DynamicMatrix<T>& DynamicMatrix<T>::operator=(const DynamicMatrix<T> &mat) {
+		if(this != &mat) {
+			resize(mat.n, mat.m);
+			std::copy(mat.matrix, mat.matrix + n*m, matrix);
+		}
+		return *this;
+	}
+
+	template<typename T>
+	DynamicMatrix<T>& DynamicMatrix<T>::operator=(DynamicMatrix<T> &&mat) {
+		swap(*this, mat);
+		return *this;
+	}
+
+	/**
+	 * Assigns an expression in a single pass, resizing the matrix if needed.
+	 * A temporary is made only if the expression reads this matrix through a product.
+	 */
+	template<typename T>
+	template<typename E>
+	DynamicMatrix<T>& DynamicMatrix<T>::operator=(const MatrixExpr<E> &expr) {
+		if(detail::aliases(expr.derived(), data())) {
+			DynamicMatrix<T> tmp(expr);
+			swap(*this, tmp);
+		} else {
+			resize(expr.derived().rows(), expr.derived().cols());
+			detail::evalTo(*this, expr.derived());
+		}
+		return *this;
+	}
+
+	/* arithmetics */
+	template<typename T>
+	template<typename E>
+	DynamicMatrix<T>& DynamicMatrix<T>::operator+=(const MatrixExpr<E>& rhs) {
+		assert(rhs.derived().rows() == n && rhs.derived().cols() == m);
+		if(detail::aliases(rhs.derived(), data())) {
+			detail::addTo(*this, DynamicMatrix<T>(rhs), T(1));
+		} else {
+			detail::addTo(*this, rhs.derived(), T(1));
+		}
+		return *this;
+	}
+
+	template<typename T>
+	template<typename E>
+	DynamicMatrix<T>& DynamicMatrix<T>::operator-=(const MatrixExpr<E>& rhs) {
+		assert(rhs.derived().rows() == n && rhs.derived().cols() == m);
+		if(detail::aliases(rhs.derived(), data())) {
+			detail::addTo(*this, DynamicMatrix<T>(rhs), T(-1));
+		} else {
+			detail::addTo(*this, rhs.derived(), T(-1));
+		}
+		return *this;
+	}
+
+	template<typename T>
+	DynamicMatrix<T>& DynamicMatrix<T>::operator*=(T scalar) {
+		for(T *it = matrix; it != matrix + n*m; ++it) {
+			(*it) *= scalar;
+		}
+		return *this;
+	}
+
+	template<typename T>
+	bool DynamicMatrix<T>::operator==(const DynamicMatrix<T> &rhs) const {
+		return n == rhs.n && m == rhs.m && std::equal(matrix, matrix + n*m, rhs.matrix);
+	}
+};
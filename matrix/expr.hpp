@@ -0,0 +1,547 @@
+#pragma once
+
+#include <assert.h>
+#include <type_traits>
+
+#include "gemm.hpp"
+#include "layout.hpp"
+#include "small.hpp"
+
+namespace Math
+{
+	template<typename T, int n, int m, typename Layout = RowMajor>
+	class Matrix;
+
+	template<typename T>
+	class DynamicMatrix;
+
+	/** Value of Rows/Cols of expressions whose size is known only at runtime */
+	const int Dynamic = -1;
+
+	template<typename E>
+	struct PlainObject;
+
+	template<typename L, typename R>
+	class ProductExpr;
+
+	/**
+	 * Base class of everything that can appear in a matrix expression.
+	 * Arithmetic operators build lightweight expression objects instead of
+	 * matrices; the work is done in a single pass when an expression is
+	 * assigned to a matrix.
+	 *
+	 * Every expression type provides
+	 *   - typedef Scalar and static constants Rows and Cols,
+	 *   - rows(), cols() and a read-only operator()(row, col),
+	 *   - aliases(p), true if evaluating it while writing to the storage at p
+	 *     gives a wrong result (only products may alias).
+	 */
+	template<typename Derived>
+	class MatrixExpr
+	{
+	public:
+		const Derived& derived() const { return static_cast<const Derived&>(*this); }
+
+		/** Evaluates the expression into a matrix */
+		template<typename D = Derived>
+		typename PlainObject<D>::type eval() const {
+			return typename PlainObject<D>::type(derived());
+		}
+	};
+
+	/**
+	 * Matrix type able to hold the value of an expression:
+	 * Matrix if the size is known at compile time, DynamicMatrix otherwise.
+	 */
+	template<typename E>
+	struct PlainObject {
+		typedef typename std::conditional<E::Rows == Dynamic || E::Cols == Dynamic,
+										  DynamicMatrix<typename E::Scalar>,
+										  Matrix<typename E::Scalar, E::Rows, E::Cols> >::type type;
+	};
+
+	namespace detail {
+		/** True for types that own their storage, i.e. can be referred to by pointer. */
+		template<typename E>
+		struct IsPlain : std::false_type {};
+
+		template<typename T, int n, int m, typename L>
+		struct IsPlain<Matrix<T, n, m, L> > : std::true_type {};
+
+		template<typename T>
+		struct IsPlain<DynamicMatrix<T> > : std::true_type {};
+
+		/** Storage order of a plain matrix type */
+		template<typename M>
+		struct LayoutOf {
+			typedef RowMajor type;
+		};
+
+		template<typename T, int n, int m, typename L>
+		struct LayoutOf<Matrix<T, n, m, L> > {
+			typedef L type;
+		};
+
+		/** The row-major type of the same size: what the solvers that read data() row by row keep */
+		template<typename M>
+		struct RowMajorOf {
+			typedef M type;
+		};
+
+		template<typename T, int n, int m, typename L>
+		struct RowMajorOf<Matrix<T, n, m, L> > {
+			typedef Matrix<T, n, m> type;
+		};
+
+		template<typename... M>
+		struct AllRowMajor : std::true_type {};
+
+		template<typename M, typename... Rest>
+		struct AllRowMajor<M, Rest...>
+			: std::integral_constant<bool, std::is_same<typename LayoutOf<M>::type, RowMajor>::value
+									 && AllRowMajor<Rest...>::value> {};
+
+		/** Compile-time dimensions agree unless one of them is Dynamic and the other is not. */
+		constexpr bool dimsAgree(int a, int b) {
+			return a == Dynamic || b == Dynamic || a == b;
+		}
+
+		constexpr int commonDim(int a, int b) {
+			return a == Dynamic ? b : a;
+		}
+
+		/** How an expression stores its operand: matrices by reference, expressions by value. */
+		template<typename E>
+		struct Nested {
+			typedef typename std::conditional<IsPlain<E>::value, const E&, const E>::type type;
+		};
+
+		/** Products need random access to their operands, so expressions are evaluated. */
+		template<typename E>
+		struct ProductNested {
+			typedef typename std::conditional<IsPlain<E>::value,
+											  const E&,
+											  const typename PlainObject<E>::type>::type type;
+		};
+
+		template<typename E, typename T>
+		bool aliases(const E &e, const T *p, std::true_type) {
+			return false;
+		}
+
+		template<typename E, typename T>
+		bool aliases(const E &e, const T *p, std::false_type) {
+			return e.aliases(p);
+		}
+
+		/** Elementwise expressions never alias; plain operands are checked by the product itself. */
+		template<typename E, typename T>
+		bool aliases(const E &e, const T *p) {
+			return aliases(e, p, IsPlain<E>());
+		}
+
+		/* Products with fewer multiplications than this are not worth packing */
+		const int gemmThreshold = 16 * 16 * 16;
+
+		/**
+		 * C += alpha * lhs * rhs for matrices with contiguous row-major storage.
+		 * @param c Pointer to row-major storage of C with lhs.rows() x rhs.cols() elements.
+		 */
+		template<typename T, typename L, typename R>
+		void multiplyAdd(T alpha, const L &lhs, const R &rhs, T *c) {
+			const int n = lhs.rows();
+			const int r = lhs.cols();
+			const int m = rhs.cols();
+			const T *a = lhs.data();
+			const T *b = rhs.data();
+			if(n * m * r < gemmThreshold) {
+				for(int i = 0; i < n; ++i) {
+					for(int k = 0; k < r; ++k) {
+						T aik = alpha * a[i * r + k];
+						for(int j = 0; j < m; ++j) {
+							c[i * m + j] += aik * b[k * m + j];
+						}
+					}
+				}
+			} else {
+				gemm(n, m, r, alpha, a, r, 1, b, m, 1, T(1), c, m, 1);
+			}
+		}
+
+		template<typename T, int n, int r, int m>
+		void multiplyAdd(T alpha, const Matrix<T, n, r> &lhs, const Matrix<T, r, m> &rhs, T *c, std::true_type) {
+			smallProduct<n, r, m>(alpha, lhs.data(), rhs.data(), c);
+		}
+
+		template<typename T, int n, int r, int m>
+		void multiplyAdd(T alpha, const Matrix<T, n, r> &lhs, const Matrix<T, r, m> &rhs, T *c, std::false_type) {
+			multiplyAdd<T, Matrix<T, n, r>, Matrix<T, r, m> >(alpha, lhs, rhs, c);
+		}
+
+		/** Fixed-size products up to smallSize use the unrolled kernel */
+		template<typename T, int n, int r, int m>
+		void multiplyAdd(T alpha, const Matrix<T, n, r> &lhs, const Matrix<T, r, m> &rhs, T *c) {
+			multiplyAdd(alpha, lhs, rhs, c, SmallProduct<n, r, m>());
+		}
+
+		/**
+		 * C += alpha * A * B for strided storage, looping in the order that
+		 * suits the strides: with the rows of A and the columns of B both
+		 * contiguous (a layout mismatch) every element is a contiguous dot
+		 * product, with A and C column-major columns of C are updated, and
+		 * otherwise rows of C.
+		 */
+		template<typename T>
+		void stridedProduct(int n, int m, int r, T alpha,
+							const T *a, int rsa, int csa, const T *b, int rsb, int csb,
+							T *c, int rsc, int csc) {
+			if(csa == 1 && rsb == 1) {
+				for(int i = 0; i < n; ++i) {
+					for(int j = 0; j < m; ++j) {
+						const T *ai = a + i * rsa, *bj = b + j * csb;
+						T sum = 0;
+						for(int k = 0; k < r; ++k) {
+							sum += ai[k] * bj[k];
+						}
+						c[i * rsc + j * csc] += alpha * sum;
+					}
+				}
+			} else if(rsa == 1 && rsc == 1) {
+				for(int j = 0; j < m; ++j) {
+					T *cj = c + j * csc;
+					for(int k = 0; k < r; ++k) {
+						const T bkj = alpha * b[k * rsb + j * csb];
+						const T *ak = a + k * csa;
+						for(int i = 0; i < n; ++i) {
+							cj[i] += ak[i] * bkj;
+						}
+					}
+				}
+			} else {
+				for(int i = 0; i < n; ++i) {
+					for(int k = 0; k < r; ++k) {
+						const T aik = alpha * a[i * rsa + k * csa];
+						for(int j = 0; j < m; ++j) {
+							c[i * rsc + j * csc] += aik * b[k * rsb + j * csb];
+						}
+					}
+				}
+			}
+		}
+
+		/** Operands in strided layouts: the kernel above or gemm() with the strides */
+		template<typename T, typename L, typename R, typename Dest, typename LL, typename LR, typename LD>
+		void multiplyAdd(T alpha, const L &lhs, const R &rhs, Dest &dst, LL, LR, LD,
+						 typename std::enable_if<LL::strided && LR::strided && LD::strided>::type* = 0) {
+			const int n = lhs.rows();
+			const int r = lhs.cols();
+			const int m = rhs.cols();
+			if(n * m * r < gemmThreshold) {
+				stridedProduct(n, m, r, alpha,
+							   lhs.data(), LL::rowStride(n, r), LL::colStride(n, r),
+							   rhs.data(), LR::rowStride(r, m), LR::colStride(r, m),
+							   dst.data(), LD::rowStride(n, m), LD::colStride(n, m));
+			} else {
+				gemm(n, m, r, alpha,
+					 lhs.data(), LL::rowStride(n, r), LL::colStride(n, r),
+					 rhs.data(), LR::rowStride(r, m), LR::colStride(r, m),
+					 T(1), dst.data(), LD::rowStride(n, m), LD::colStride(n, m));
+			}
+		}
+
+		/** All three tiled alike: tile by tile, the zero padding makes every tile whole */
+		template<typename T, typename L, typename R, typename Dest, int b>
+		void multiplyAdd(T alpha, const L &lhs, const R &rhs, Dest &dst, Tiled<b>, Tiled<b>, Tiled<b>) {
+			const int tn = Tiled<b>::tiles(lhs.rows());
+			const int tr = Tiled<b>::tiles(lhs.cols());
+			const int tm = Tiled<b>::tiles(rhs.cols());
+			const T *a = lhs.data();
+			const T *bt = rhs.data();
+			T *c = dst.data();
+			for(int i = 0; i < tn; ++i) {
+				for(int k = 0; k < tr; ++k) {
+					for(int j = 0; j < tm; ++j) {
+						stridedProduct(b, b, b, alpha, a + (i * tr + k) * b * b, b, 1,
+									   bt + (k * tm + j) * b * b, b, 1, c + (i * tm + j) * b * b, b, 1);
+					}
+				}
+			}
+		}
+
+		template<typename T, typename L, typename R, typename Dest>
+		void multiplyAddRowMajor(T alpha, const L &lhs, const R &rhs, Dest &dst, std::true_type) {
+			multiplyAdd(alpha, lhs, rhs, dst, RowMajor(), RowMajor(), typename LayoutOf<Dest>::type());
+		}
+
+		/* a tiled result: the product goes to a row-major one first */
+		template<typename T, typename L, typename R, typename Dest>
+		void multiplyAddRowMajor(T alpha, const L &lhs, const R &rhs, Dest &dst, std::false_type) {
+			const typename PlainObject<Dest>::type c = ProductExpr<L, R>(lhs, rhs);
+			T *d = dst.data();
+			LayoutOf<Dest>::type::forEach(c.rows(), c.cols(), [&](int i, int j, int idx) { d[idx] += alpha * c(i, j); });
+		}
+
+		/**
+		 * Any other mix: the tiled operands are copied to row-major ones, which
+		 * costs O(n^2) against the O(n^3) of the product it speeds up.
+		 */
+		template<typename T, typename L, typename R, typename Dest, typename LL, typename LR, typename LD>
+		void multiplyAdd(T alpha, const L &lhs, const R &rhs, Dest &dst, LL, LR, LD,
+						 typename std::enable_if<!(LL::strided && LR::strided && LD::strided)>::type* = 0) {
+			const typename PlainObject<L>::type a(lhs);
+			const typename PlainObject<R>::type b(rhs);
+			multiplyAddRowMajor(alpha, a, b, dst, std::integral_constant<bool, LD::strided>());
+		}
+
+		template<typename T, typename L, typename R, typename Dest>
+		void multiplyAdd(T alpha, const L &lhs, const R &rhs, Dest &dst, std::true_type) {
+			multiplyAdd(alpha, lhs, rhs, dst.data());
+		}
+
+		template<typename T, typename L, typename R, typename Dest>
+		void multiplyAdd(T alpha, const L &lhs, const R &rhs, Dest &dst, std::false_type) {
+			multiplyAdd(alpha, lhs, rhs, dst, typename LayoutOf<L>::type(), typename LayoutOf<R>::type(),
+						typename LayoutOf<Dest>::type());
+		}
+
+		struct SumOp {
+			template<typename T>
+			static T apply(T a, T b) { return a + b; }
+		};
+
+		struct DifferenceOp {
+			template<typename T>
+			static T apply(T a, T b) { return a - b; }
+		};
+	}
+
+	/** Elementwise sum or difference of two expressions of the same shape. */
+	template<typename Op, typename L, typename R>
+	class BinaryExpr : public MatrixExpr<BinaryExpr<Op, L, R> >
+	{
+		typename detail::Nested<L>::type lhs;
+		typename detail::Nested<R>::type rhs;
+	public:
+		typedef typename L::Scalar Scalar;
+		static constexpr int Rows = detail::commonDim(L::Rows, R::Rows);
+		static constexpr int Cols = detail::commonDim(L::Cols, R::Cols);
+		static_assert(detail::dimsAgree(L::Rows, R::Rows) && detail::dimsAgree(L::Cols, R::Cols),
+					  "matrix dimensions must agree");
+		static_assert(std::is_same<typename L::Scalar, typename R::Scalar>::value,
+					  "matrix element types must agree");
+
+		BinaryExpr(const L &lhs, const R &rhs) : lhs(lhs), rhs(rhs) {
+			assert(lhs.rows() == rhs.rows() && lhs.cols() == rhs.cols());
+		}
+		int rows() const { return lhs.rows(); }
+		int cols() const { return lhs.cols(); }
+		Scalar operator()(int row, int col) const { return Op::apply(lhs(row, col), rhs(row, col)); }
+		const L& left() const { return lhs; }
+		const R& right() const { return rhs; }
+		bool aliases(const Scalar *p) const {
+			return detail::aliases(lhs, p) || detail::aliases(rhs, p);
+		}
+	};
+
+	/** Elementwise negation. */
+	template<typename E>
+	class NegateExpr : public MatrixExpr<NegateExpr<E> >
+	{
+		typename detail::Nested<E>::type expr;
+	public:
+		typedef typename E::Scalar Scalar;
+		static constexpr int Rows = E::Rows;
+		static constexpr int Cols = E::Cols;
+
+		explicit NegateExpr(const E &expr) : expr(expr) {}
+		int rows() const { return expr.rows(); }
+		int cols() const { return expr.cols(); }
+		Scalar operator()(int row, int col) const { return -expr(row, col); }
+		bool aliases(const Scalar *p) const { return detail::aliases(expr, p); }
+	};
+
+	/** Multiplication by a scalar. */
+	template<typename E>
+	class ScaleExpr : public MatrixExpr<ScaleExpr<E> >
+	{
+		typename detail::Nested<E>::type expr;
+		typename E::Scalar scalar;
+	public:
+		typedef typename E::Scalar Scalar;
+		static constexpr int Rows = E::Rows;
+		static constexpr int Cols = E::Cols;
+
+		ScaleExpr(const E &expr, Scalar scalar) : expr(expr), scalar(scalar) {}
+		int rows() const { return expr.rows(); }
+		int cols() const { return expr.cols(); }
+		Scalar operator()(int row, int col) const { return scalar * expr(row, col); }
+		bool aliases(const Scalar *p) const { return detail::aliases(expr, p); }
+	};
+
+	/** Elementwise conversion to the element type U. */
+	template<typename U, typename E>
+	class CastExpr : public MatrixExpr<CastExpr<U, E> >
+	{
+		typename detail::Nested<E>::type expr;
+	public:
+		typedef U Scalar;
+		static constexpr int Rows = E::Rows;
+		static constexpr int Cols = E::Cols;
+
+		explicit CastExpr(const E &expr) : expr(expr) {}
+		int rows() const { return expr.rows(); }
+		int cols() const { return expr.cols(); }
+		Scalar operator()(int row, int col) const { return static_cast<U>(expr(row, col)); }
+		/* storage of another element type is never the destination */
+		bool aliases(const Scalar *) const { return false; }
+	};
+
+	/**
+	 * Matrix product.
+	 * Assigned on its own (or added to another expression) it is computed with
+	 * gemm(); inside other expressions each element is a dot product of a row
+	 * and a column, which is what matrix-vector expressions need anyway.
+	 */
+	template<typename L, typename R>
+	class ProductExpr : public MatrixExpr<ProductExpr<L, R> >
+	{
+		typename detail::ProductNested<L>::type lhs;
+		typename detail::ProductNested<R>::type rhs;
+	public:
+		typedef typename L::Scalar Scalar;
+		static constexpr int Rows = L::Rows;
+		static constexpr int Cols = R::Cols;
+		static_assert(detail::dimsAgree(L::Cols, R::Rows), "inner matrix dimensions must agree");
+		static_assert(std::is_same<typename L::Scalar, typename R::Scalar>::value,
+					  "matrix element types must agree");
+
+		ProductExpr(const L &lhs, const R &rhs) : lhs(lhs), rhs(rhs) {
+			assert(lhs.cols() == rhs.rows());
+		}
+		int rows() const { return lhs.rows(); }
+		int cols() const { return rhs.cols(); }
+		Scalar operator()(int row, int col) const {
+			Scalar sum = 0;
+			for(int k = 0; k < lhs.cols(); ++k) {
+				sum += lhs(row, k) * rhs(k, col);
+			}
+			return sum;
+		}
+		bool aliases(const Scalar *p) const { return lhs.data() == p || rhs.data() == p; }
+
+		/**
+		 * dst += alpha * lhs * rhs, dst must not alias the operands.
+		 * Operands in other layouts than RowMajor get a kernel that walks
+		 * each of them along its storage.
+		 */
+		template<typename Dest>
+		void addTo(Dest &dst, Scalar alpha) const {
+			typedef typename std::remove_cv<typename std::remove_reference<decltype(lhs)>::type>::type LhsPlain;
+			typedef typename std::remove_cv<typename std::remove_reference<decltype(rhs)>::type>::type RhsPlain;
+			detail::multiplyAdd(alpha, lhs, rhs, dst, detail::AllRowMajor<LhsPlain, RhsPlain, Dest>());
+		}
+	};
+
+	namespace detail {
+		/**
+		 * Writes the value of an expression into a matrix that it does not alias.
+		 * Generic expressions are evaluated element by element.
+		 */
+		template<typename Dest, typename E>
+		void evalTo(Dest &dst, const MatrixExpr<E> &expr) {
+			const E &e = expr.derived();
+			typename Dest::Scalar *d = dst.data();
+			LayoutOf<Dest>::type::forEach(e.rows(), e.cols(), [&](int i, int j, int idx) { d[idx] = e(i, j); });
+		}
+
+		template<typename Dest, typename L, typename R>
+		void evalTo(Dest &dst, const ProductExpr<L, R> &expr) {
+			const int size = LayoutOf<Dest>::type::size(dst.rows(), dst.cols());
+			std::fill(dst.data(), dst.data() + size, typename Dest::Scalar(0));
+			expr.addTo(dst, 1);
+		}
+
+		template<typename Dest, typename E, typename L, typename R>
+		void evalTo(Dest &dst, const BinaryExpr<SumOp, E, ProductExpr<L, R> > &expr) {
+			evalTo(dst, expr.left());
+			expr.right().addTo(dst, 1);
+		}
+
+		template<typename Dest, typename E, typename L, typename R>
+		void evalTo(Dest &dst, const BinaryExpr<SumOp, ProductExpr<L, R>, E> &expr) {
+			evalTo(dst, expr.right());
+			expr.left().addTo(dst, 1);
+		}
+
+		template<typename Dest, typename L1, typename R1, typename L2, typename R2>
+		void evalTo(Dest &dst, const BinaryExpr<SumOp, ProductExpr<L1, R1>, ProductExpr<L2, R2> > &expr) {
+			evalTo(dst, expr.left());
+			expr.right().addTo(dst, 1);
+		}
+
+		template<typename Dest, typename E, typename L, typename R>
+		void evalTo(Dest &dst, const BinaryExpr<DifferenceOp, E, ProductExpr<L, R> > &expr) {
+			evalTo(dst, expr.left());
+			expr.right().addTo(dst, -1);
+		}
+
+		/** dst += alpha * expr for an expression that does not alias dst. */
+		template<typename Dest, typename E>
+		void addTo(Dest &dst, const MatrixExpr<E> &expr, typename Dest::Scalar alpha) {
+			const E &e = expr.derived();
+			typename Dest::Scalar *d = dst.data();
+			LayoutOf<Dest>::type::forEach(e.rows(), e.cols(), [&](int i, int j, int idx) { d[idx] += alpha * e(i, j); });
+		}
+
+		template<typename Dest, typename L, typename R>
+		void addTo(Dest &dst, const ProductExpr<L, R> &expr, typename Dest::Scalar alpha) {
+			expr.addTo(dst, alpha);
+		}
+	}
+
+	template<typename L, typename R>
+	BinaryExpr<detail::SumOp, L, R> operator+(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+		return BinaryExpr<detail::SumOp, L, R>(lhs.derived(), rhs.derived());
+	}
+
+	template<typename L, typename R>
+	BinaryExpr<detail::DifferenceOp, L, R> operator-(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+		return BinaryExpr<detail::DifferenceOp, L, R>(lhs.derived(), rhs.derived());
+	}
+
+	template<typename E>
+	NegateExpr<E> operator-(const MatrixExpr<E> &rhs) {
+		return NegateExpr<E>(rhs.derived());
+	}
+
+	/**
+	 * A scalar multiplication.
+	 * @see dot()
+	 */
+	template<typename E>
+	ScaleExpr<E> operator*(const MatrixExpr<E> &lhs, typename E::Scalar scalar) {
+		return ScaleExpr<E>(lhs.derived(), scalar);
+	}
+
+	template<typename E>
+	ScaleExpr<E> operator*(typename E::Scalar scalar, const MatrixExpr<E> &rhs) {
+		return ScaleExpr<E>(rhs.derived(), scalar);
+	}
+
+	/**
+	 * Converts the elements to U, e.g. `DynamicMatrix<float> f = cast<float>(A);`
+	 */
+	template<typename U, typename E>
+	CastExpr<U, E> cast(const MatrixExpr<E> &expr) {
+		return CastExpr<U, E>(expr.derived());
+	}
+
+	/**
+	 * Dot product.
+	 * Small products are computed directly, larger ones go through the blocked gemm().
+	 */
+	template<typename L, typename R>
+	ProductExpr<L, R> dot(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+		return ProductExpr<L, R>(lhs.derived(), rhs.derived());
+	}
+};
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATH_GEMM_X86 1
+#endif
+
+namespace Math {
+	/**
+	 * Register micro-kernels available for gemm().
+	 * The fastest one supported by the CPU is selected at runtime.
+	 */
+	enum class GemmKernel {
+		Scalar,
+		Avx2,
+		Avx512
+	};
+
+	namespace detail {
+		/* Cache blocking parameters: a KCxNC panel of B lives in L3,
+		   an MCxKC block of A lives in L2, an MRxKC sliver of A and
+		   a KCxNR sliver of B live in L1. */
+		const int gemmMC = 96;
+		const int gemmKC = 256;
+		const int gemmNC = 4096;
+
+		/**
+		 * Computes a MRxNR block of a product of packed slivers.
+		 * @param kc Common dimension of the slivers.
+		 * @param a MRxkc sliver of A stored column by column.
+		 * @param b kcxNR sliver of B stored row by row.
+		 * @param[out] ab MRxNR row-major result.
+		 * @tparam V Vector type holding a part of a row of B (may be T itself).
+		 * @tparam NV Number of vectors per row of the block.
+		 */
+		template<typename T, typename V, int MR, int NV>
+#if defined(__GNUC__)
+		__attribute__((always_inline))
+#endif
+		inline void gemmMicroKernel(int kc, const T *a, const T *b, T *ab) {
+			const int W = sizeof(V) / sizeof(T);
+			const int NR = NV * W;
+			V zero = {};
+			V c[MR][NV];
+#pragma GCC unroll 16
+			for(int i = 0; i < MR; ++i) {
+#pragma GCC unroll 16
+				for(int v = 0; v < NV; ++v) {
+					c[i][v] = zero;
+				}
+			}
+			for(int k = 0; k < kc; ++k) {
+				V bv[NV];
+#pragma GCC unroll 16
+				for(int v = 0; v < NV; ++v) {
+					std::memcpy(&bv[v], b + k * NR + v * W, sizeof(V));
+				}
+#pragma GCC unroll 16
+				for(int i = 0; i < MR; ++i) {
+					T ai = a[k * MR + i];
+#pragma GCC unroll 16
+					for(int v = 0; v < NV; ++v) {
+						c[i][v] += ai * bv[v];
+					}
+				}
+			}
+#pragma GCC unroll 16
+			for(int i = 0; i < MR; ++i) {
+#pragma GCC unroll 16
+				for(int v = 0; v < NV; ++v) {
+					std::memcpy(ab + i * NR + v * W, &c[i][v], sizeof(V));
+				}
+			}
+		}
+
+		/** Micro-kernel together with its block shape. */
+		template<typename T>
+		struct GemmKernelInfo {
+			int mr;
+			int nr;
+			void (*kernel)(int kc, const T *a, const T *b, T *ab);
+		};
+
+		template<typename T>
+		void gemmScalarKernel(int kc, const T *a, const T *b, T *ab) {
+			gemmMicroKernel<T, T, 4, 4>(kc, a, b, ab);
+		}
+
+#ifdef MATH_GEMM_X86
+		typedef double v4d __attribute__((vector_size(32)));
+		typedef double v8d __attribute__((vector_size(64)));
+		typedef float v8f __attribute__((vector_size(32)));
+		typedef float v16f __attribute__((vector_size(64)));
+
+		__attribute__((target("avx2,fma")))
+		inline void gemmAvx2Kernel(int kc, const double *a, const double *b, double *ab) {
+			gemmMicroKernel<double, v4d, 6, 2>(kc, a, b, ab);
+		}
+
+		__attribute__((target("avx2,fma")))
+		inline void gemmAvx2Kernel(int kc, const float *a, const float *b, float *ab) {
+			gemmMicroKernel<float, v8f, 6, 2>(kc, a, b, ab);
+		}
+
+		__attribute__((target("avx512f")))
+		inline void gemmAvx512Kernel(int kc, const double *a, const double *b, double *ab) {
+			gemmMicroKernel<double, v8d, 6, 2>(kc, a, b, ab);
+		}
+
+		__attribute__((target("avx512f")))
+		inline void gemmAvx512Kernel(int kc, const float *a, const float *b, float *ab) {
+			gemmMicroKernel<float, v16f, 6, 2>(kc, a, b, ab);
+		}
+#endif
+
+		/** Picks a micro-kernel for T; only float and double have SIMD ones. */
+		template<typename T>
+		struct GemmKernelSelector {
+			static GemmKernelInfo<T> get(GemmKernel) {
+				GemmKernelInfo<T> info = {4, 4, &gemmScalarKernel<T>};
+				return info;
+			}
+		};
+
+#ifdef MATH_GEMM_X86
+		template<typename T, int W>
+		struct GemmSimdKernelSelector {
+			static GemmKernelInfo<T> get(GemmKernel kernel) {
+				GemmKernelInfo<T> info = {4, 4, &gemmScalarKernel<T>};
+				if(kernel == GemmKernel::Avx512) {
+					info.mr = 6;
+					info.nr = 2 * (64 / W);
+					info.kernel = static_cast<void (*)(int, const T*, const T*, T*)>(&gemmAvx512Kernel);
+				} else if(kernel == GemmKernel::Avx2) {
+					info.mr = 6;
+					info.nr = 2 * (32 / W);
+					info.kernel = static_cast<void (*)(int, const T*, const T*, T*)>(&gemmAvx2Kernel);
+				}
+				return info;
+			}
+		};
+
+		template<>
+		struct GemmKernelSelector<double> : GemmSimdKernelSelector<double, sizeof(double)> {};
+
+		template<>
+		struct GemmKernelSelector<float> : GemmSimdKernelSelector<float, sizeof(float)> {};
+#endif
+
+		inline GemmKernel bestGemmKernel() {
+#ifdef MATH_GEMM_X86
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx512f")) {
+				return GemmKernel::Avx512;
+			}
+			if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+				return GemmKernel::Avx2;
+			}
+#endif
+			return GemmKernel::Scalar;
+		}
+
+		inline GemmKernel &currentGemmKernel() {
+			static GemmKernel kernel = bestGemmKernel();
+			return kernel;
+		}
+
+		/**
+		 * Packs a mcxkc block of A (multiplied by alpha) into MR-row slivers.
+		 * Rows past mc are padded with zeros.
+		 */
+		template<typename T>
+		void gemmPackA(int mc, int kc, int mr, T alpha,
+					   const T *A, int rsa, int csa, T *buf) {
+			for(int i0 = 0; i0 < mc; i0 += mr) {
+				int rows = std::min(mr, mc - i0);
+				for(int k = 0; k < kc; ++k) {
+					const T *col = A + i0 * rsa + k * csa;
+					for(int i = 0; i < rows; ++i) {
+						buf[i] = alpha * col[i * rsa];
+					}
+					for(int i = rows; i < mr; ++i) {
+						buf[i] = 0;
+					}
+					buf += mr;
+				}
+			}
+		}
+
+		/**
+		 * Packs a kcxnc panel of B into NR-column slivers.
+		 * Columns past nc are padded with zeros.
+		 */
+		template<typename T>
+		void gemmPackB(int kc, int nc, int nr,
+					   const T *B, int rsb, int csb, T *buf) {
+			for(int j0 = 0; j0 < nc; j0 += nr) {
+				int cols = std::min(nr, nc - j0);
+				for(int k = 0; k < kc; ++k) {
+					const T *row = B + k * rsb + j0 * csb;
+					if(csb == 1) {
+						std::copy(row, row + cols, buf);
+					} else {
+						for(int j = 0; j < cols; ++j) {
+							buf[j] = row[j * csb];
+						}
+					}
+					for(int j = cols; j < nr; ++j) {
+						buf[j] = 0;
+					}
+					buf += nr;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @returns The micro-kernel used by gemm().
+	 */
+	inline GemmKernel gemmKernel() {
+		return detail::currentGemmKernel();
+	}
+
+	/**
+	 * @returns true if the CPU can run the given micro-kernel.
+	 */
+	inline bool gemmKernelSupported(GemmKernel kernel) {
+		return static_cast<int>(kernel) <= static_cast<int>(detail::bestGemmKernel());
+	}
+
+	/**
+	 * Forces gemm() to use the given micro-kernel.
+	 * Falls back to the best supported one if the CPU cannot run it.
+	 */
+	inline void setGemmKernel(GemmKernel kernel) {
+		detail::currentGemmKernel() = gemmKernelSupported(kernel) ? kernel : detail::bestGemmKernel();
+	}
+
+	/**
+	 * General matrix multiplication C = alpha*A*B + beta*C.
+	 * Matrices are described by a pointer to the first element and strides
+	 * between consecutive rows and columns, so both row-major and
+	 * column-major (i.e. transposed) operands can be passed.
+	 * @param M number of rows of A and C
+	 * @param N number of columns of B and C
+	 * @param K number of columns of A and rows of B
+	 * @param rsa,csa row and column strides of A (rsc, csc and rsb, csb likewise)
+	 */
+	template<typename T>
+	void gemm(int M, int N, int K, T alpha,
+			  const T *A, int rsa, int csa,
+			  const T *B, int rsb, int csb,
+			  T beta, T *C, int rsc, int csc) {
+		for(int i = 0; i < M; ++i) {
+			for(int j = 0; j < N; ++j) {
+				T &c = C[i * rsc + j * csc];
+				c = (beta == T(0)) ? T(0) : beta * c;
+			}
+		}
+		if(K == 0 || alpha == T(0)) {
+			return;
+		}
+
+		const detail::GemmKernelInfo<T> info = detail::GemmKernelSelector<T>::get(gemmKernel());
+		const int mr = info.mr;
+		const int nr = info.nr;
+		const int mcMax = (detail::gemmMC + mr - 1) / mr * mr;
+		const int ncMax = (detail::gemmNC + nr - 1) / nr * nr;
+
+		static thread_local std::vector<T> bufA, bufB, bufAB;
+		bufA.resize(static_cast<size_t>(mcMax) * detail::gemmKC);
+		bufB.resize(static_cast<size_t>(std::min(ncMax, (N + nr - 1) / nr * nr)) * detail::gemmKC);
+		bufAB.resize(mr * nr);
+
+		for(int jc = 0; jc < N; jc += ncMax) {
+			int nc = std::min(ncMax, N - jc);
+			for(int pc = 0; pc < K; pc += detail::gemmKC) {
+				int kc = std::min(detail::gemmKC, K - pc);
+				detail::gemmPackB(kc, nc, nr, B + pc * rsb + jc * csb, rsb, csb, bufB.data());
+				for(int ic = 0; ic < M; ic += mcMax) {
+					int mc = std::min(mcMax, M - ic);
+					detail::gemmPackA(mc, kc, mr, alpha, A + ic * rsa + pc * csa, rsa, csa, bufA.data());
+					for(int jr = 0; jr < nc; jr += nr) {
+						int cols = std::min(nr, nc - jr);
+						const T *b = bufB.data() + jr * kc;
+						for(int ir = 0; ir < mc; ir += mr) {
+							int rows = std::min(mr, mc - ir);
+							info.kernel(kc, bufA.data() + ir * kc, b, bufAB.data());
+							T *c = C + (ic + ir) * rsc + (jc + jr) * csc;
+							for(int i = 0; i < rows; ++i) {
+								for(int j = 0; j < cols; ++j) {
+									c[i * rsc + j * csc] += bufAB[i * nr + j];
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/** Which triangle of A trsm() solves with, and whether its diagonal is taken as ones */
+	enum class Triangle {
+		Lower,
+		UnitLower,
+		Upper,
+		UnitUpper
+	};
+
+	namespace detail {
+		/* Rows per diagonal block of trsm(), and right-hand sides per pass over a block */
+		const int trsmBlock = 64;
+		const int trsmColumns = 256;
+
+		/**
+		 * Substitution within an m x m diagonal block D for w columns of X.
+		 * Every element is b - (sum of the products in column order), as in a
+		 * scalar back traverse, so a system of at most trsmBlock rows gets
+		 * the same bits; the sums run over the w columns at once.
+		 */
+		template<typename T, bool contiguous>
+		void trsmDiagonal(Triangle tri, int m, int w, const T *D, int rsd, int csd, T *X, int rsx, int csx) {
+			const bool upper = tri == Triangle::Upper || tri == Triangle::UnitUpper;
+			const bool unit = tri == Triangle::UnitLower || tri == Triangle::UnitUpper;
+			const int cs = contiguous ? 1 : csx;
+			static thread_local std::vector<T> sum;
+			sum.resize(w);
+			for(int t = 0; t < m; ++t) {
+				const int i = upper ? m - 1 - t : t;
+				const int j0 = upper ? i + 1 : 0;
+				const int j1 = upper ? m : i;
+				std::fill(sum.begin(), sum.end(), T(0));
+				for(int j = j0; j < j1; ++j) {
+					const T d = D[i * rsd + j * csd];
+					const T *xj = X + j * rsx;
+					for(int c = 0; c < w; ++c) {
+						sum[c] += d * xj[c * cs];
+					}
+				}
+				T *xi = X + i * rsx;
+				if(unit) {
+					for(int c = 0; c < w; ++c) {
+						xi[c * cs] -= sum[c];
+					}
+				} else {
+					const T inv = T(1) / D[i * rsd + i * csd];
+					for(int c = 0; c < w; ++c) {
+						xi[c * cs] = (xi[c * cs] - sum[c]) * inv;
+					}
+				}
+			}
+		}
+
+		/**
+		 * Rows [i0, i1) of a blocked triangular solve, the rows it depends on
+		 * already solved: the off-diagonal part is one gemm() update, then the
+		 * diagonal block is substituted. \p rows points at element (i0, 0) of
+		 * A, so a caller may hand over just the panel of rows it has gathered.
+		 */
+		template<typename T>
+		void trsmRowBlock(Triangle tri, int n, int i0, int i1, int s,
+						  const T *rows, int rsa, int csa, T *B, int rsb, int csb) {
+			const bool upper = tri == Triangle::Upper || tri == Triangle::UnitUpper;
+			for(int c0 = 0; c0 < s; c0 += trsmColumns) {
+				const int w = std::min(trsmColumns, s - c0);
+				T *b = B + c0 * csb;
+				if(upper && i1 < n) {
+					gemm(i1 - i0, w, n - i1, T(-1), rows + i1 * csa, rsa, csa,
+						 b + i1 * rsb, rsb, csb, T(1), b + i0 * rsb, rsb, csb);
+				} else if(!upper && i0 > 0) {
+					gemm(i1 - i0, w, i0, T(-1), rows, rsa, csa,
+						 b, rsb, csb, T(1), b + i0 * rsb, rsb, csb);
+				}
+				if(csb == 1) {
+					trsmDiagonal<T, true>(tri, i1 - i0, w, rows + i0 * csa, rsa, csa, b + i0 * rsb, rsb, 1);
+				} else {
+					trsmDiagonal<T, false>(tri, i1 - i0, w, rows + i0 * csa, rsa, csa, b + i0 * rsb, rsb, csb);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Triangular solve with many right-hand sides: A*X = B for an n x n
+	 * triangular A, X overwriting the n x s matrix B. Blocks of trsmBlock
+	 * rows are solved in turn; all but the diagonal block of each is a
+	 * gemm() update, so with many columns most of the work runs in the
+	 * gemm() micro-kernels. Strides as in gemm(): a transposed triangle is
+	 * the other triangle with rsa and csa exchanged.
+	 */
+	template<typename T>
+	void trsm(Triangle tri, int n, int s, const T *A, int rsa, int csa, T *B, int rsb, int csb) {
+		const int nb = detail::trsmBlock;
+		if(n <= 0 || s <= 0) {
+			return;
+		}
+		if(tri == Triangle::Upper || tri == Triangle::UnitUpper) {
+			for(int i0 = (n - 1) / nb * nb; i0 >= 0; i0 -= nb) {
+				detail::trsmRowBlock(tri, n, i0, std::min(n, i0 + nb), s, A + i0 * rsa, rsa, csa, B, rsb, csb);
+			}
+		} else {
+			for(int i0 = 0; i0 < n; i0 += nb) {
+				detail::trsmRowBlock(tri, n, i0, std::min(n, i0 + nb), s, A + i0 * rsa, rsa, csa, B, rsb, csb);
+			}
+		}
+	}
+}
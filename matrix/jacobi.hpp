@@ -0,0 +1,268 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+
+#include "matrix.hpp"
+#include "threadpool.hpp"
+
+namespace Math
+{
+	namespace detail {
+		/* Plane rotation that zeroes a_pq: A' = J^T A J, columns p, q of J are (c, -s), (s, c) */
+		template<typename T>
+		struct JacobiRotation {
+			int p;
+			int q;
+			T c;
+			T s;
+			T t;
+		};
+
+		template<typename T>
+		JacobiRotation<T> makeRotation(const T *a, int n, int p, int q) {
+			JacobiRotation<T> r = {p, q, T(1), T(0), T(0)};
+			T apq = a[p * n + q];
+			if(apq == T(0)) {
+				return r;
+			}
+			T theta = (a[q * n + q] - a[p * n + p]) / (2 * apq);
+			r.t = T(1) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+			if(theta < 0) {
+				r.t = -r.t;
+			}
+			r.c = T(1) / std::sqrt(r.t * r.t + 1);
+			r.s = r.t * r.c;
+			return r;
+		}
+
+		/** Columns p and q of a row-major matrix with `cols` columns, rows r0..r1-1 */
+		template<typename T>
+		void rotateColumns(T *x, int cols, int r0, int r1, const JacobiRotation<T> &r) {
+			for(int k = r0; k < r1; ++k) {
+				T *row = x + k * cols;
+				T xp = row[r.p], xq = row[r.q];
+				row[r.p] = r.c * xp - r.s * xq;
+				row[r.q] = r.s * xp + r.c * xq;
+			}
+		}
+
+		/** Applies one rotation to symmetric A (both triangles) in O(n). */
+		template<typename T>
+		void rotateSymmetric(T *a, int n, const JacobiRotation<T> &r) {
+			const int p = r.p, q = r.q;
+			T apq = a[p * n + q];
+			a[p * n + p] -= r.t * apq;
+			a[q * n + q] += r.t * apq;
+			a[p * n + q] = a[q * n + p] = 0;
+			for(int k = 0; k < n; ++k) {
+				if(k == p || k == q) {
+					continue;
+				}
+				T akp = a[k * n + p], akq = a[k * n + q];
+				a[k * n + p] = a[p * n + k] = r.c * akp - r.s * akq;
+				a[k * n + q] = a[q * n + k] = r.s * akp + r.c * akq;
+			}
+		}
+
+		template<typename T>
+		T maxOffDiagonal(const T *a, int n, T &absSum) {
+			T max = 0;
+			absSum = 0;
+			for(int i = 0; i < n; ++i) {
+				for(int j = i + 1; j < n; ++j) {
+					T v = std::abs(a[i * n + j]);
+					max = std::max(max, v);
+					absSum += v;
+				}
+			}
+			return max;
+		}
+
+		/*
+		 * Rotations whose |a_pq| is under the threshold are skipped: below eps
+		 * they are converged, and during the first sweeps small elements are
+		 * left for later, when the large ones have been reduced.
+		 */
+		template<typename T>
+		T jacobiThreshold(T absSum, int n, int sweep, double eps) {
+			T early = (sweep < 3) ? T(0.2) * absSum / (T(n) * n) : T(0);
+			return std::max(static_cast<T>(eps), early);
+		}
+
+		template<typename Mat>
+		int jacobiCyclic(Mat &A, Mat &X, int n, double eps, int maxSweeps) {
+			typedef typename Mat::Scalar T;
+			T *a = A.data();
+			T *x = X.data();
+			for(int sweep = 0; sweep < maxSweeps; ++sweep) {
+				T absSum;
+				if(maxOffDiagonal(a, n, absSum) <= eps) {
+					return sweep;
+				}
+				const T threshold = jacobiThreshold(absSum, n, sweep, eps);
+				for(int p = 0; p < n - 1; ++p) {
+					for(int q = p + 1; q < n; ++q) {
+						if(std::abs(a[p * n + q]) <= threshold) {
+							continue;
+						}
+						JacobiRotation<T> r = makeRotation(a, n, p, q);
+						rotateSymmetric(a, n, r);
+						rotateColumns(x, n, 0, n, r);
+					}
+				}
+			}
+			return maxSweeps;
+		}
+
+		/**
+		 * Round-robin (Brent-Luk) ordering: n-1 rounds of n/2 disjoint pairs
+		 * that together cover every pair once; for odd n one index idles
+		 * every round.
+		 */
+		inline std::vector<std::vector<std::pair<int, int> > > roundRobinRounds(int n) {
+			const int m = n + (n % 2);
+			std::vector<int> players(m);
+			for(int i = 0; i < m; ++i) {
+				players[i] = i;
+			}
+			std::vector<std::vector<std::pair<int, int> > > rounds(m - 1);
+			for(int round = 0; round < m - 1; ++round) {
+				for(int i = 0; i < m / 2; ++i) {
+					int p = players[i], q = players[m - 1 - i];
+					if(p < n && q < n) {
+						rounds[round].push_back(std::make_pair(std::min(p, q), std::max(p, q)));
+					}
+				}
+				/* player 0 stays, the others move one seat */
+				std::rotate(players.begin() + 1, players.end() - 1, players.end());
+			}
+			return rounds;
+		}
+
+		/*
+		 * Each round applies its disjoint rotations together, A <- J^T A J:
+		 * first every pair rotates its two rows, then every row rotates all the
+		 * column pairs. Both phases split into independent tasks.
+		 */
+		template<typename Mat>
+		int jacobiParallel(Mat &A, Mat &X, int n, double eps, int maxSweeps, ThreadPool &pool) {
+			typedef typename Mat::Scalar T;
+			T *a = A.data();
+			T *x = X.data();
+			const std::vector<std::vector<std::pair<int, int> > > rounds = roundRobinRounds(n);
+			std::vector<JacobiRotation<T> > rotations;
+			/* rows per task of the column phase */
+			const int grain = std::max(1, 4096 / std::max(1, n));
+
+			for(int sweep = 0; sweep < maxSweeps; ++sweep) {
+				T absSum;
+				if(maxOffDiagonal(a, n, absSum) <= eps) {
+					return sweep;
+				}
+				const T threshold = jacobiThreshold(absSum, n, sweep, eps);
+				for(const std::vector<std::pair<int, int> > &round : rounds) {
+					rotations.clear();
+					for(const std::pair<int, int> &pq : round) {
+						if(std::abs(a[pq.first * n + pq.second]) > threshold) {
+							rotations.push_back(makeRotation(a, n, pq.first, pq.second));
+						}
+					}
+					if(rotations.empty()) {
+						continue;
+					}
+					const JacobiRotation<T> *rot = rotations.data();
+					const int count = static_cast<int>(rotations.size());
+					/* rows: A <- J^T A */
+					parallelFor(pool, 0, count, 1, [=](int lo, int hi) {
+						for(int k = lo; k < hi; ++k) {
+							T *rp = a + rot[k].p * n;
+							T *rq = a + rot[k].q * n;
+							const T c = rot[k].c, s = rot[k].s;
+							for(int j = 0; j < n; ++j) {
+								T vp = rp[j], vq = rq[j];
+								rp[j] = c * vp - s * vq;
+								rq[j] = s * vp + c * vq;
+							}
+						}
+					});
+					/* columns: A <- A J, X <- X J */
+					parallelFor(pool, 0, n, grain, [=](int lo, int hi) {
+						for(int k = 0; k < count; ++k) {
+							rotateColumns(a, n, lo, hi, rot[k]);
+							rotateColumns(x, n, lo, hi, rot[k]);
+						}
+					});
+					for(int k = 0; k < count; ++k) {
+						a[rot[k].p * n + rot[k].q] = a[rot[k].q * n + rot[k].p] = 0;
+					}
+				}
+			}
+			return maxSweeps;
+		}
+
+		template<typename Mat>
+		void prepareEigenvectors(Mat &A, Mat &X, int n) {
+			assert(A.rows() == n && A.cols() == n);
+			std::fill(X.data(), X.data() + n * n, typename Mat::Scalar(0));
+			for(int i = 0; i < n; ++i) {
+				X(i, i) = 1;
+			}
+		}
+	}
+
+	/**
+	 * Cyclic-by-row Jacobi eigenvalue method for a symmetric matrix.
+	 * Every rotation costs O(n): it updates two rows/columns of A and two
+	 * columns of X in place. Elements below a threshold are skipped.
+	 * @param[in,out] A Symmetric matrix; on exit its diagonal holds the eigenvalues.
+	 * @param[out] X Eigenvectors, in the columns, in the order of the eigenvalues.
+	 * @param eps Iterations stop when every off-diagonal |a_ij| <= eps.
+	 * @returns number of sweeps, or maxSweeps if it did not converge
+	 */
+	template<typename T, int n>
+	int jacobiEigen(Matrix<T, n, n> &A, Matrix<T, n, n> &X, double eps = 1e-5, int maxSweeps = 50) {
+		detail::prepareEigenvectors(A, X, n);
+		return detail::jacobiCyclic(A, X, n, eps, maxSweeps);
+	}
+
+	/** Jacobi eigenvalue method for a runtime-sized symmetric matrix.
+	 * @param[out] X Resized to the size of A.
+	 * @see jacobiEigen()
+	 */
+	template<typename T>
+	int jacobiEigen(DynamicMatrix<T> &A, DynamicMatrix<T> &X, double eps = 1e-5, int maxSweeps = 50) {
+		const int n = A.rows();
+		X.resize(n, n);
+		detail::prepareEigenvectors(A, X, n);
+		return detail::jacobiCyclic(A, X, n, eps, maxSweeps);
+	}
+
+	/**
+	 * Parallel Jacobi eigenvalue method.
+	 * Sweeps follow the round-robin (Brent-Luk) ordering, so the n/2
+	 * rotations of a round touch disjoint row/column pairs and run on the
+	 * threads of \p pool.
+	 * @see jacobiEigen()
+	 */
+	template<typename T, int n>
+	int jacobiEigen(Matrix<T, n, n> &A, Matrix<T, n, n> &X, ThreadPool &pool,
+					double eps = 1e-5, int maxSweeps = 50) {
+		detail::prepareEigenvectors(A, X, n);
+		return detail::jacobiParallel(A, X, n, eps, maxSweeps, pool);
+	}
+
+	/** Parallel Jacobi eigenvalue method for a runtime-sized symmetric matrix.
+	 * @see jacobiEigen()
+	 */
+	template<typename T>
+	int jacobiEigen(DynamicMatrix<T> &A, DynamicMatrix<T> &X, ThreadPool &pool,
+					double eps = 1e-5, int maxSweeps = 50) {
+		const int n = A.rows();
+		X.resize(n, n);
+		detail::prepareEigenvectors(A, X, n);
+		return detail::jacobiParallel(A, X, n, eps, maxSweeps, pool);
+	}
+};
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <assert.h>
+
+#include "sparse.hpp"
+
+/*
+ * Krylov subspace solvers for A*x = b.
+ *
+ * All solvers start from the zero vector, stop when the Euclid norm of the
+ * residual b - A*x drops below `precision` and return the number of
+ * iterations made, or `maxiter` if they did not converge, like seidel().
+ * A is a Matrix<T, n, n>, DynamicMatrix<T>, SparseMatrix<T> or any linear
+ * operator (see operator.hpp), e.g. a LinearOperator<T> over a stencil.
+ * b and the solution are DynamicMatrix<T> or Matrix<T, n, 1> columns in
+ * any layout; they are copied element by element.
+ *
+ * A preconditioner is any object with
+ *     void apply(const T *r, T *z) const;   // z = M^-1 * r
+ * IdentityPreconditioner, JacobiPreconditioner, SSORPreconditioner and
+ * ILU0Preconditioner are provided.
+ */
+namespace Math
+{
+	namespace detail {
+		template<typename T>
+		T dotProduct(const std::vector<T> &a, const std::vector<T> &b) {
+			T sum = 0;
+			for(size_t i = 0; i < a.size(); ++i) {
+				sum += a[i] * b[i];
+			}
+			return sum;
+		}
+
+		template<typename T>
+		double norm(const std::vector<T> &a) {
+			return std::sqrt(static_cast<double>(dotProduct(a, a)));
+		}
+
+		template<typename T, int n, typename L>
+		void resizeColumn(Matrix<T, n, 1, L> &, int rows) {
+			assert(rows == n);
+		}
+
+		template<typename T>
+		void resizeColumn(DynamicMatrix<T> &v, int rows) {
+			v.resize(rows, 1);
+		}
+
+		/* element by element: a column in Tiled storage is padded */
+		template<typename Vec>
+		std::vector<typename Vec::Scalar> loadColumn(const Vec &b) {
+			std::vector<typename Vec::Scalar> v(b.rows());
+			for(int i = 0; i < b.rows(); ++i) {
+				v[i] = b(i, 0);
+			}
+			return v;
+		}
+
+		template<typename Vec>
+		void storeSolution(const std::vector<typename Vec::Scalar> &x, Vec &sol) {
+			resizeColumn(sol, static_cast<int>(x.size()));
+			for(int i = 0; i < static_cast<int>(x.size()); ++i) {
+				sol(i, 0) = x[i];
+			}
+		}
+	}
+
+	/** M = I */
+	template<typename T>
+	class IdentityPreconditioner
+	{
+	public:
+		explicit IdentityPreconditioner(int n) : n(n) {}
+		void apply(const T *r, T *z) const { std::copy(r, r + n, z); }
+	private:
+		int n;
+	};
+
+	/** M = diag(A) */
+	template<typename T>
+	class JacobiPreconditioner
+	{
+	public:
+		explicit JacobiPreconditioner(const SparseMatrix<T> &A);
+		template<typename E>
+		explicit JacobiPreconditioner(const MatrixExpr<E> &A) : JacobiPreconditioner(SparseMatrix<T>(A)) {}
+		/** From the diagonal() of an operator; @throws std::domain_error on a zero */
+		template<typename Op>
+		explicit JacobiPreconditioner(const Op &A,
+									  typename std::enable_if<detail::IsLinearOperator<Op>::value>::type* = nullptr);
+
+		void apply(const T *r, T *z) const {
+			for(size_t i = 0; i < invDiag.size(); ++i) {
+				z[i] = invDiag[i] * r[i];
+			}
+		}
+	private:
+		std::vector<T> invDiag;
+	};
+
+	/**
+	 * Symmetric SOR: M = w/(2-w) * (D/w + L) * (D/w)^-1 * (D/w + U),
+	 * 0 < w < 2; w = 1 is symmetric Gauss-Seidel.
+	 */
+	template<typename T>
+	class SSORPreconditioner
+	{
+	public:
+		explicit SSORPreconditioner(const SparseMatrix<T> &A, double omega = 1.0);
+		template<typename E>
+		explicit SSORPreconditioner(const MatrixExpr<E> &A, double omega = 1.0)
+			: SSORPreconditioner(SparseMatrix<T>(A), omega) {}
+
+		void apply(const T *r, T *z) const;
+	private:
+		SparseMatrix<T> A;
+		std::vector<int> diag;
+		T omega;
+	};
+
+	/**
+	 * Incomplete LU factorization with the sparsity pattern of A:
+	 * M = L*U where L (unit lower) and U keep only the entries stored in A.
+	 */
+	template<typename T>
+	class ILU0Preconditioner
+	{
+	public:
+		/** @throws std::domain_error on a missing or zero pivot */
+		explicit ILU0Preconditioner(const SparseMatrix<T> &A);
+		template<typename E>
+		explicit ILU0Preconditioner(const MatrixExpr<E> &A) : ILU0Preconditioner(SparseMatrix<T>(A)) {}
+
+		void apply(const T *r, T *z) const;
+	private:
+		SparseMatrix<T> LU;
+		std::vector<int> diag;
+	};
+
+	template<typename T>
+	JacobiPreconditioner<T>::JacobiPreconditioner(const SparseMatrix<T> &A) : invDiag(A.rows()) {
+		std::vector<int> d = A.diagonalIndex();
+		for(int i = 0; i < A.rows(); ++i) {
+			if(d[i] < 0 || A.values()[d[i]] == T(0)) {
+				throw std::domain_error("Zero diagonal element");
+			}
+			invDiag[i] = T(1) / A.values()[d[i]];
+		}
+	}
+
+	template<typename T>
+	template<typename Op>
+	JacobiPreconditioner<T>::JacobiPreconditioner(const Op &A,
+												  typename std::enable_if<detail::IsLinearOperator<Op>::value>::type*)
+		: invDiag(A.rows())
+	{
+		for(int i = 0; i < A.rows(); ++i) {
+			const T d = A.diagonal(i);
+			if(d == T(0)) {
+				throw std::domain_error("Zero diagonal element");
+			}
+			invDiag[i] = T(1) / d;
+		}
+	}
+
+	template<typename T>
+	SSORPreconditioner<T>::SSORPreconditioner(const SparseMatrix<T> &A, double omega)
+		: A(A), diag(A.diagonalIndex()), omega(omega)
+	{
+		assert(omega > 0 && omega < 2);
+		for(int i = 0; i < A.rows(); ++i) {
+			if(diag[i] < 0 || A.values()[diag[i]] == T(0)) {
+				throw std::domain_error("Zero diagonal element");
+			}
+		}
+	}
+
+	template<typename T>
+	void SSORPreconditioner<T>::apply(const T *r, T *z) const {
+		const int n = A.rows();
+		const int *ptr = A.rowPtr();
+		const int *col = A.colIdx();
+		const T *val = A.values();
+		/* (D/w + L) y = r */
+		for(int i = 0; i < n; ++i) {
+			T sum = r[i];
+			for(int k = ptr[i]; k < diag[i]; ++k) {
+				sum -= val[k] * z[col[k]];
+			}
+			z[i] = sum * omega / val[diag[i]];
+		}
+		/* (D/w + U) z = D/w * y */
+		for(int i = n - 1; i >= 0; --i) {
+			T d = val[diag[i]] / omega;
+			T sum = d * z[i];
+			for(int k = diag[i] + 1; k < ptr[i + 1]; ++k) {
+				sum -= val[k] * z[col[k]];
+			}
+			z[i] = sum / d;
+		}
+		const T scale = (2 - omega) / omega;
+		for(int i = 0; i < n; ++i) {
+			z[i] *= scale;
+		}
+	}
+
+	template<typename T>
+	ILU0Preconditioner<T>::ILU0Preconditioner(const SparseMatrix<T> &A)
+		: LU(A), diag(A.diagonalIndex())
+	{
+		const int n = LU.rows();
+		const int *ptr = LU.rowPtr();
+		const int *col = LU.colIdx();
+		T *val = LU.values();
+		/* position of each column in the current row, -1 outside the pattern */
+		std::vector<int> pos(n, -1);
+		for(int i = 0; i < n; ++i) {
+			if(diag[i] < 0) {
+				throw std::domain_error("Zero pivot in ILU(0)");
+			}
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				pos[col[k]] = k;
+			}
+			for(int k = ptr[i]; k < diag[i]; ++k) {
+				const int p = col[k];
+				val[k] /= val[diag[p]];
+				const T l = val[k];
+				for(int q = diag[p] + 1; q < ptr[p + 1]; ++q) {
+					if(pos[col[q]] >= 0) {
+						val[pos[col[q]]] -= l * val[q];
+					}
+				}
+			}
+			if(val[diag[i]] == T(0)) {
+				throw std::domain_error("Zero pivot in ILU(0)");
+			}
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				pos[col[k]] = -1;
+			}
+		}
+	}
+
+	template<typename T>
+	void ILU0Preconditioner<T>::apply(const T *r, T *z) const {
+		const int n = LU.rows();
+		const int *ptr = LU.rowPtr();
+		const int *col = LU.colIdx();
+		const T *val = LU.values();
+		for(int i = 0; i < n; ++i) {
+			T sum = r[i];
+			for(int k = ptr[i]; k < diag[i]; ++k) {
+				sum -= val[k] * z[col[k]];
+			}
+			z[i] = sum;
+		}
+		for(int i = n - 1; i >= 0; --i) {
+			T sum = z[i];
+			for(int k = diag[i] + 1; k < ptr[i + 1]; ++k) {
+				sum -= val[k] * z[col[k]];
+			}
+			z[i] = sum / val[diag[i]];
+		}
+	}
+
+	/**
+	 * Preconditioned conjugate gradient method for symmetric positive
+	 * definite A; M must be symmetric positive definite too.
+	 * @param[out] sol Solution vector.
+	 */
+	template<typename Mat, typename Vec, typename Precond>
+	int conjugateGradient(const Mat &A, const Vec &b, Vec &sol, const Precond &M,
+						  double precision = 1e-5, int maxiter = 100) {
+		typedef typename Vec::Scalar T;
+		const int n = A.rows();
+		assert(A.cols() == n && b.rows() == n && b.cols() == 1);
+		std::vector<T> x(n, T(0)), r(detail::loadColumn(b)), z(n), p(n), q(n);
+
+		int iter = 0;
+		if(detail::norm(r) >= precision) {
+			M.apply(r.data(), z.data());
+			p = z;
+			T rz = detail::dotProduct(r, z);
+			for(iter = 1; iter <= maxiter; ++iter) {
+				detail::multiply(A, p.data(), q.data());
+				T alpha = rz / detail::dotProduct(p, q);
+				for(int i = 0; i < n; ++i) {
+					x[i] += alpha * p[i];
+					r[i] -= alpha * q[i];
+				}
+				if(detail::norm(r) < precision) {
+					break;
+				}
+				M.apply(r.data(), z.data());
+				T rzNew = detail::dotProduct(r, z);
+				T beta = rzNew / rz;
+				rz = rzNew;
+				for(int i = 0; i < n; ++i) {
+					p[i] = z[i] + beta * p[i];
+				}
+			}
+			iter = std::min(iter, maxiter);
+		}
+		detail::storeSolution(x, sol);
+		return iter;
+	}
+
+	/** Unpreconditioned conjugate gradient method. @see conjugateGradient() */
+	template<typename Mat, typename Vec>
+	int conjugateGradient(const Mat &A, const Vec &b, Vec &sol,
+						  double precision = 1e-5, int maxiter = 100) {
+		return conjugateGradient(A, b, sol, IdentityPreconditioner<typename Vec::Scalar>(A.rows()),
+								 precision, maxiter);
+	}
+
+	/**
+	 * Right-preconditioned BiCGSTAB for general nonsymmetric A.
+	 * Stops early, returning maxiter, on a breakdown (rho = 0 or omega = 0).
+	 * @param[out] sol Solution vector.
+	 */
+	template<typename Mat, typename Vec, typename Precond>
+	int bicgstab(const Mat &A, const Vec &b, Vec &sol, const Precond &M,
+				 double precision = 1e-5, int maxiter = 100) {
+		typedef typename Vec::Scalar T;
+		const int n = A.rows();
+		assert(A.cols() == n && b.rows() == n && b.cols() == 1);
+		std::vector<T> x(n, T(0)), r(detail::loadColumn(b)), rhat(r);
+		std::vector<T> p(n, T(0)), v(n, T(0)), phat(n), s(n), shat(n), t(n);
+		T rho = 1, alpha = 1, omega = 1;
+
+		int result = 0;
+		if(detail::norm(r) >= precision) {
+			result = maxiter;
+			for(int iter = 1; iter <= maxiter; ++iter) {
+				T rhoNew = detail::dotProduct(rhat, r);
+				if(rhoNew == T(0) || omega == T(0)) {
+					break;
+				}
+				T beta = (rhoNew / rho) * (alpha / omega);
+				rho = rhoNew;
+				for(int i = 0; i < n; ++i) {
+					p[i] = r[i] + beta * (p[i] - omega * v[i]);
+				}
+				M.apply(p.data(), phat.data());
+				detail::multiply(A, phat.data(), v.data());
+				alpha = rho / detail::dotProduct(rhat, v);
+				for(int i = 0; i < n; ++i) {
+					s[i] = r[i] - alpha * v[i];
+				}
+				if(detail::norm(s) < precision) {
+					for(int i = 0; i < n; ++i) {
+						x[i] += alpha * phat[i];
+					}
+					result = iter;
+					break;
+				}
+				M.apply(s.data(), shat.data());
+				detail::multiply(A, shat.data(), t.data());
+				omega = detail::dotProduct(t, s) / detail::dotProduct(t, t);
+				for(int i = 0; i < n; ++i) {
+					x[i] += alpha * phat[i] + omega * shat[i];
+					r[i] = s[i] - omega * t[i];
+				}
+				if(detail::norm(r) < precision) {
+					result = iter;
+					break;
+				}
+			}
+		}
+		detail::storeSolution(x, sol);
+		return result;
+	}
+
+	/** Unpreconditioned BiCGSTAB. @see bicgstab() */
+	template<typename Mat, typename Vec>
+	int bicgstab(const Mat &A, const Vec &b, Vec &sol,
+				 double precision = 1e-5, int maxiter = 100) {
+		return bicgstab(A, b, sol, IdentityPreconditioner<typename Vec::Scalar>(A.rows()),
+						precision, maxiter);
+	}
+
+	/**
+	 * Right-preconditioned GMRES restarted every `restart` iterations.
+	 * Every inner (Arnoldi) step counts as one iteration.
+	 * @param[out] sol Solution vector.
+	 */
+	template<typename Mat, typename Vec, typename Precond>
+	int gmres(const Mat &A, const Vec &b, Vec &sol, const Precond &M, int restart,
+			  double precision = 1e-5, int maxiter = 100) {
+		typedef typename Vec::Scalar T;
+		const int n = A.rows();
+		assert(A.cols() == n && b.rows() == n && b.cols() == 1);
+		restart = std::max(1, std::min(restart, n));
+		const std::vector<T> bv(detail::loadColumn(b));
+		std::vector<T> x(n, T(0)), r(bv), w(n), z(n);
+		/* Krylov basis, Hessenberg matrix (column by column) and Givens rotations */
+		std::vector<std::vector<T> > V(restart + 1, std::vector<T>(n));
+		std::vector<std::vector<T> > H(restart, std::vector<T>(restart + 1));
+		std::vector<T> cs(restart), sn(restart), e(restart + 1), y(restart);
+
+		int iter = 0;
+		double beta = detail::norm(r);
+		while(beta >= precision && iter < maxiter) {
+			for(int i = 0; i < n; ++i) {
+				V[0][i] = r[i] / beta;
+			}
+			std::fill(e.begin(), e.end(), T(0));
+			e[0] = beta;
+
+			int j = 0;
+			while(j < restart && iter < maxiter) {
+				++iter;
+				M.apply(V[j].data(), z.data());
+				detail::multiply(A, z.data(), w.data());
+				/* modified Gram-Schmidt */
+				for(int k = 0; k <= j; ++k) {
+					H[j][k] = detail::dotProduct(w, V[k]);
+					for(int i = 0; i < n; ++i) {
+						w[i] -= H[j][k] * V[k][i];
+					}
+				}
+				H[j][j + 1] = detail::norm(w);
+				if(H[j][j + 1] != T(0)) {
+					for(int i = 0; i < n; ++i) {
+						V[j + 1][i] = w[i] / H[j][j + 1];
+					}
+				}
+				for(int k = 0; k < j; ++k) {
+					T h = cs[k] * H[j][k] + sn[k] * H[j][k + 1];
+					H[j][k + 1] = -sn[k] * H[j][k] + cs[k] * H[j][k + 1];
+					H[j][k] = h;
+				}
+				T rr = std::sqrt(H[j][j] * H[j][j] + H[j][j + 1] * H[j][j + 1]);
+				cs[j] = H[j][j] / rr;
+				sn[j] = H[j][j + 1] / rr;
+				H[j][j] = rr;
+				H[j][j + 1] = 0;
+				e[j + 1] = -sn[j] * e[j];
+				e[j] = cs[j] * e[j];
+				++j;
+				if(std::abs(static_cast<double>(e[j])) < precision) {
+					break;
+				}
+			}
+
+			/* x += M^-1 * V * y with H*y = e */
+			for(int k = j - 1; k >= 0; --k) {
+				T sum = e[k];
+				for(int c = k + 1; c < j; ++c) {
+					sum -= H[c][k] * y[c];
+				}
+				y[k] = sum / H[k][k];
+			}
+			std::fill(w.begin(), w.end(), T(0));
+			for(int k = 0; k < j; ++k) {
+				for(int i = 0; i < n; ++i) {
+					w[i] += y[k] * V[k][i];
+				}
+			}
+			M.apply(w.data(), z.data());
+			for(int i = 0; i < n; ++i) {
+				x[i] += z[i];
+			}
+
+			/* the true residual guards against drift of the estimate */
+			detail::multiply(A, x.data(), w.data());
+			for(int i = 0; i < n; ++i) {
+				r[i] = bv[i] - w[i];
+			}
+			beta = detail::norm(r);
+		}
+		detail::storeSolution(x, sol);
+		return (beta < precision) ? iter : maxiter;
+	}
+
+	/** Unpreconditioned GMRES(restart). @see gmres() */
+	template<typename Mat, typename Vec>
+	int gmres(const Mat &A, const Vec &b, Vec &sol, int restart = 30,
+			  double precision = 1e-5, int maxiter = 100) {
+		return gmres(A, b, sol, IdentityPreconditioner<typename Vec::Scalar>(A.rows()), restart,
+					 precision, maxiter);
+	}
+};
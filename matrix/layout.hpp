@@ -0,0 +1,83 @@
+#pragma once
+
+namespace Math
+{
+	/*
+	 * Storage orders of Matrix<T, n, m, Layout>: where element (i, j) of an
+	 * n x m matrix lives in its array. Every layout provides
+	 *   - size(n, m), the length of the array, and index(i, j, n, m),
+	 *   - forEach(n, m, f), calling f(i, j, index) in storage order, which
+	 *     is the order loops over the whole matrix should take,
+	 *   - strided, true if element (i, j) is at i * rowStride + j * colStride,
+	 *     which is what gemm() and the product kernels take.
+	 */
+
+	/** Rows one after another: the layout of DynamicMatrix and the default of Matrix */
+	struct RowMajor {
+		static constexpr bool strided = true;
+		static constexpr int size(int n, int m) { return n * m; }
+		static constexpr int index(int i, int j, int n, int m) { return i * m + j; }
+		static constexpr int rowStride(int n, int m) { return m; }
+		static constexpr int colStride(int n, int m) { return 1; }
+
+		template<typename F>
+		static void forEach(int n, int m, F f) {
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < m; ++j) {
+					f(i, j, i * m + j);
+				}
+			}
+		}
+	};
+
+	/** Columns one after another */
+	struct ColMajor {
+		static constexpr bool strided = true;
+		static constexpr int size(int n, int m) { return n * m; }
+		static constexpr int index(int i, int j, int n, int m) { return j * n + i; }
+		static constexpr int rowStride(int n, int m) { return 1; }
+		static constexpr int colStride(int n, int m) { return n; }
+
+		template<typename F>
+		static void forEach(int n, int m, F f) {
+			for(int j = 0; j < m; ++j) {
+				for(int i = 0; i < n; ++i) {
+					f(i, j, j * n + i);
+				}
+			}
+		}
+	};
+
+	/**
+	 * b x b tiles stored row-major, each tile row-major inside, so a tile is
+	 * one contiguous block. The edges are padded to whole tiles; the padding
+	 * holds zeros, which lets products run on whole tiles.
+	 */
+	template<int b>
+	struct Tiled {
+		static_assert(b > 0, "tile size must be positive");
+		static constexpr int tile = b;
+		static constexpr bool strided = false;
+		static constexpr int tiles(int n) { return (n + b - 1) / b; }
+		static constexpr int size(int n, int m) { return tiles(n) * tiles(m) * b * b; }
+		static constexpr int index(int i, int j, int n, int m) {
+			return ((i / b) * tiles(m) + j / b) * b * b + (i % b) * b + j % b;
+		}
+
+		template<typename F>
+		static void forEach(int n, int m, F f) {
+			int t = 0;
+			for(int i0 = 0; i0 < n; i0 += b) {
+				for(int j0 = 0; j0 < m; j0 += b, t += b * b) {
+					const int i1 = (i0 + b < n) ? i0 + b : n;
+					const int j1 = (j0 + b < m) ? j0 + b : m;
+					for(int i = i0; i < i1; ++i) {
+						for(int j = j0; j < j1; ++j) {
+							f(i, j, t + (i - i0) * b + (j - j0));
+						}
+					}
+				}
+			}
+		}
+	};
+};
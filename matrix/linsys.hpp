@@ -1,129 +1,732 @@
 #pragma once
 
-#include <iostream>
 #include <vector>
 #include <cmath>
-#include <boost/format.hpp>
 
+#include "condition.hpp"
 #include "matrix.hpp"
+#include "operator.hpp"
+#include "stats.hpp"
+#include "threadpool.hpp"
 
 namespace Math {
 	/**
-	 * Gauss elimination.
-	 * Does not save the matrix but modifies it in place.
-	 * It can be used to solve `s` linear systems A*x_i = b_i (i = 0..s-1) simultaneously.
-	 * @param[in,out] mat The extended matrix of the systems. First n rows are A, last s rows are b_i.
-	 * @param[out] x Output matrix containing solutions x_i.
-	 * @param swapVar if true, algorithm will swap variables (that is, swap columns of the matrix)
-	 *                when the leading element is too small.
-	 * @param eps precision
-	 * @tparam T must be statically cast to double
+	 * How gauss() picks its pivots. Interchanges permute index vectors;
+	 * the elements stay where they are.
 	 */
-	template<typename T, int n, int s>
-	void gauss(Math::Matrix<T, n, n+s> &mat,
-			   Math::Matrix<T, n, s> &x, bool swapVar = false, double eps = 1e-5) {
-		std::array<int, n> newOrder;
-		for(int i = 0; i < n; ++i) {
-			newOrder[i] = i;
+	enum class Pivoting {
+		None,     ///< the diagonal, in order
+		Rows,     ///< partial pivoting: the largest element of the pivot column
+		Columns,  ///< the largest element of the pivot row (swapVar)
+		Full      ///< the largest element of the remaining submatrix
+	};
+
+	namespace detail {
+		/* The solvers below are written once for any matrix type with
+		   rows()/cols()/operator(); the public overloads only fix the sizes. */
+
+		template<typename M>
+		void setZero(M &mat) {
+			std::fill(mat.data(), mat.data() + mat.rows() * mat.cols(), typename M::Scalar(0));
 		}
-	
-		/* Direct traverse */
-		for(int k = 0; k < n; ++k) {
-			T temp = mat(k, k);
-			if(std::abs(static_cast<double>(temp)) < eps) {
-				std::cout << boost::format("Small leading element %1$e\n") % temp;
+
+		/** sum a[j]*x[j] with four partial sums, so consecutive products do not wait on each other */
+		template<typename T>
+		T rowDot(const T *a, const T *x, int n) {
+			T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+			int j = 0;
+			for(; j + 4 <= n; j += 4) {
+				s0 += a[j] * x[j];
+				s1 += a[j + 1] * x[j + 1];
+				s2 += a[j + 2] * x[j + 2];
+				s3 += a[j + 3] * x[j + 3];
+			}
+			for(; j < n; ++j) {
+				s0 += a[j] * x[j];
+			}
+			return (s0 + s1) + (s2 + s3);
+		}
+
+		/* Elements per tile of the trailing update; a tile fits in L2 */
+		const int gaussTileSize = 8192;
+		const int gaussTileCols = 1024;
+
+		/**
+		 * Rows r0..r1-1, columns c0..c1-1 of a row-major matrix: row_i -= l_i * row_p.
+		 * Rows without a multiplier (pivot rows) are skipped.
+		 */
+		template<typename T>
+		void eliminateTile(T *a, int ld, int p, const T *l, int r0, int r1, int c0, int c1) {
+			const T *pivotRow = a + p * ld;
+			for(int i = r0; i < r1; ++i) {
+				T li = l[i];
+				if(li == T(0)) {
+					continue;
+				}
+				T *row = a + i * ld;
+				for(int j = c0; j < c1; ++j) {
+					row[j] -= pivotRow[j] * li;
+				}
+			}
+		}
+
+		/*
+		 * The update of one elimination step, for each layout in its own order:
+		 * element (i, j) of the n x m matrix, i in r0..n-1 and j in c0..m-1,
+		 * loses l_i times element (p, j) of the pivot row. l is zero for the
+		 * rows that were pivots, which are left alone. u is workspace of m.
+		 */
+
+		/**
+		 * Row-major: row by row along the contiguous rows.
+		 * Large updates are cut into tiles that idle threads of the pool steal.
+		 */
+		template<typename T>
+		void eliminate(T *a, int n, int m, int p, const T *l, T *, int r0, int c0, ThreadPool *pool, RowMajor) {
+			const int rows = n - r0;
+			const int cols = m - c0;
+			if(!pool || pool->size() == 1 || rows * cols < 2 * gaussTileSize) {
+				eliminateTile(a, m, p, l, r0, n, c0, m);
+				return;
+			}
+			const int colTile = std::min(cols, gaussTileCols);
+			const int rowTile = std::max(1, gaussTileSize / colTile);
+			TaskGroup group(*pool);
+			for(int i0 = r0; i0 < n; i0 += rowTile) {
+				int i1 = std::min(n, i0 + rowTile);
+				for(int j0 = c0; j0 < m; j0 += colTile) {
+					int j1 = std::min(m, j0 + colTile);
+					group.run([=]() { eliminateTile(a, m, p, l, i0, i1, j0, j1); });
+				}
 			}
-			if(swapVar) {
-				T curMax = temp;
-				int maxIdx = k;
-				for(int i = k + 1; i < n; ++i) {
-					if(std::abs(mat(k, i)) > std::abs(curMax)) {
-						curMax = mat(k, i);
-						maxIdx = i;
+			group.wait();
+		}
+
+		/** Column-major: column by column, an axpy down each contiguous column */
+		template<typename T>
+		void eliminate(T *a, int n, int m, int p, const T *l, T *, int r0, int c0, ThreadPool *pool, ColMajor) {
+			auto columns = [=](int j0, int j1) {
+				for(int j = j0; j < j1; ++j) {
+					T *col = a + j * n;
+					const T u = col[p];
+					if(u == T(0)) {
+						continue;
+					}
+					for(int i = r0; i < n; ++i) {
+						col[i] -= u * l[i];
+					}
+				}
+			};
+			const int rows = n - r0;
+			if(!pool || pool->size() == 1 || rows * (m - c0) < 2 * gaussTileSize) {
+				columns(c0, m);
+			} else {
+				parallelFor(*pool, c0, m, std::max(1, gaussTileSize / std::max(1, rows)), columns);
+			}
+		}
+
+		/** Tiled: tile by tile, with the pivot row gathered into u first */
+		template<typename T, int b>
+		void eliminate(T *a, int n, int m, int p, const T *l, T *u, int r0, int c0, ThreadPool *pool, Tiled<b>) {
+			for(int j = c0; j < m; ++j) {
+				u[j] = a[Tiled<b>::index(p, j, n, m)];
+			}
+			const int tm = Tiled<b>::tiles(m);
+			auto tileRows = [=](int t0, int t1) {
+				for(int ti = t0; ti < t1; ++ti) {
+					const int i0 = std::max(r0, ti * b), i1 = std::min(n, ti * b + b);
+					for(int tj = c0 / b; tj < tm; ++tj) {
+						T *tile = a + (ti * tm + tj) * b * b;
+						const int j0 = std::max(c0, tj * b), j1 = std::min(m, tj * b + b);
+						for(int i = i0; i < i1; ++i) {
+							const T li = l[i];
+							if(li == T(0)) {
+								continue;
+							}
+							T *row = tile + (i - ti * b) * b - tj * b;
+							for(int j = j0; j < j1; ++j) {
+								row[j] -= u[j] * li;
+							}
+						}
+					}
+				}
+			};
+			const int t0 = r0 / b, t1 = Tiled<b>::tiles(n);
+			if(!pool || pool->size() == 1 || (n - r0) * (m - c0) < 2 * gaussTileSize) {
+				tileRows(t0, t1);
+			} else {
+				parallelFor(*pool, t0, t1, std::max(1, gaussTileSize / (b * std::max(1, m - c0))), tileRows);
+			}
+		}
+
+		/** U X = Y with U where gauss() left it, for a layout with strides; false for the others */
+		template<typename T, typename Layout>
+		typename std::enable_if<Layout::strided, bool>::type
+		backSolveInPlace(const T *a, int n, int ld, T *x, int s, Layout) {
+			trsm(Triangle::UnitUpper, n, s, a, Layout::rowStride(n, ld), Layout::colStride(n, ld), x, s, 1);
+			return true;
+		}
+
+		template<typename T, typename Layout>
+		typename std::enable_if<!Layout::strided, bool>::type
+		backSolveInPlace(const T*, int, int, T*, int, Layout) {
+			return false;
+		}
+
+		/**
+		 * ||A^-1||_1 estimated from what gauss() leaves behind: with P and Q
+		 * the row and column orders, P A Q = L U, where `lower` holds L by
+		 * physical row (the pivots on its diagonal) and the eliminated matrix
+		 * holds the unit upper triangular U.
+		 */
+		template<typename Mat>
+		double gaussInverseNorm1(const Mat &mat, int n, int ld, const std::vector<int> &rowOrder,
+								 const std::vector<int> &colOrder, const std::vector<typename Mat::Scalar> &lower) {
+			typedef typename Mat::Scalar T;
+			typedef typename LayoutOf<Mat>::type Layout;
+			const T *a = mat.data();
+			auto U = [=, &rowOrder, &colOrder](int k, int j) { return a[Layout::index(rowOrder[k], colOrder[j], n, ld)]; };
+			auto L = [&](int k, int j) { return lower[static_cast<size_t>(rowOrder[k]) * n + j]; };
+			std::vector<T> y(n);
+			/* x := A^-1 x = Q U^-1 L^-1 P x */
+			auto inverse = [&](T *x) {
+				for(int k = 0; k < n; ++k) {
+					T sum = x[rowOrder[k]];
+					for(int j = 0; j < k; ++j) {
+						sum -= L(k, j) * y[j];
+					}
+					y[k] = sum / L(k, k);
+				}
+				for(int k = n - 1; k >= 0; --k) {
+					for(int j = k + 1; j < n; ++j) {
+						y[k] -= U(k, j) * y[j];
+					}
+					x[colOrder[k]] = y[k];
+				}
+			};
+			/* x := A^-T x = P^T L^-T U^-T Q^T x */
+			auto transposed = [&](T *x) {
+				for(int k = 0; k < n; ++k) {
+					T sum = x[colOrder[k]];
+					for(int j = 0; j < k; ++j) {
+						sum -= U(j, k) * y[j];
 					}
+					y[k] = sum;
 				}
-				if(maxIdx != k) {
-					for(int z = 0; z < n; ++z) {
-						std::swap(mat(z,k), mat(z, maxIdx));
+				for(int k = n - 1; k >= 0; --k) {
+					for(int j = k + 1; j < n; ++j) {
+						y[k] -= L(j, k) * y[j];
+					}
+					y[k] /= L(k, k);
+					x[rowOrder[k]] = y[k];
+				}
+			};
+			return estimateNorm1<T>(n, inverse, transposed);
+		}
+
+		/**
+		 * Gauss elimination of an n x (n+s) extended matrix in any layout.
+		 * Pivoting only permutes the index vectors rowOrder and colOrder: step
+		 * k eliminates with physical row rowOrder[k] and column colOrder[k],
+		 * and nothing is moved in memory. The pivot column of every step ends
+		 * up holding exact zeros in the rows still to come, so the updates can
+		 * run over whole physical ranges and just skip finished rows.
+		 */
+		template<typename Mat, typename X>
+		void gauss(Mat &mat, X &x, int n, int s, Pivoting pivoting, double eps, ThreadPool *pool,
+				   SolverStats *stats) {
+			typedef typename Mat::Scalar T;
+			typedef typename LayoutOf<Mat>::type Layout;
+			StatsRecorder recorder(stats);
+			const int ld = n + s;
+			T *a = mat.data();
+			auto at = [=](int i, int j) -> T& { return a[Layout::index(i, j, n, ld)]; };
+			const bool pivotRows = pivoting == Pivoting::Rows || pivoting == Pivoting::Full;
+			const bool pivotCols = pivoting == Pivoting::Columns || pivoting == Pivoting::Full;
+			std::vector<int> rowOrder(n), colOrder(n);
+			for(int i = 0; i < n; ++i) {
+				rowOrder[i] = colOrder[i] = i;
+			}
+			/* multipliers by physical row; flags of the rows and columns used as pivots */
+			std::vector<T> l(n), u(ld);
+			std::vector<char> rowDone(n), colDone(n);
+			int r0 = 0, c0 = 0;
+			/* for the pivot growth: the largest element of A, and of the rows of U */
+			double maxA = 0, maxU = 0;
+			/* for the condition estimate: ||A||_1, and the columns of L by physical row */
+			std::vector<double> columnSums;
+			std::vector<T> lower;
+			if(recorder.active()) {
+				columnSums.resize(n);
+				lower.resize(static_cast<size_t>(n) * n);
+				for(int i = 0; i < n; ++i) {
+					for(int j = 0; j < n; ++j) {
+						const double v = std::abs(static_cast<double>(at(i, j)));
+						maxA = std::max(maxA, v);
+						columnSums[j] += v;
+					}
+				}
+			}
+
+			/* Direct traverse */
+			for(int k = 0; k < n; ++k) {
+				T temp = at(rowOrder[k], colOrder[k]);
+				if(recorder.active() && std::abs(static_cast<double>(temp)) < eps) {
+					++recorder->smallPivots;
+				}
+				if(pivotRows && pivotCols) {
+					/* the whole remaining submatrix: the largest |a_ij|, of equal ones the
+					   smallest physical (i, j), whichever order the layout is walked in */
+					int pr = rowOrder[k], pc = colOrder[k];
+					T best = -1;
+					if(std::is_same<Layout, ColMajor>::value) {
+						for(int j = c0; j < n; ++j) {
+							if(colDone[j]) {
+								continue;
+							}
+							for(int i = r0; i < n; ++i) {
+								const T v = std::abs(at(i, j));
+								if((v > best || (v == best && i < pr)) && !rowDone[i]) {
+									best = v;
+									pr = i;
+									pc = j;
+								}
+							}
+						}
+					} else {
+						for(int i = r0; i < n; ++i) {
+							if(rowDone[i]) {
+								continue;
+							}
+							for(int j = c0; j < n; ++j) {
+								const T v = std::abs(at(i, j));
+								if(v > best && !colDone[j]) {
+									best = v;
+									pr = i;
+									pc = j;
+								}
+							}
+						}
+					}
+					temp = at(pr, pc);
+					const int pi = std::find(rowOrder.begin() + k, rowOrder.end(), pr) - rowOrder.begin();
+					const int pj = std::find(colOrder.begin() + k, colOrder.end(), pc) - colOrder.begin();
+					std::swap(rowOrder[k], rowOrder[pi]);
+					std::swap(colOrder[k], colOrder[pj]);
+					if(recorder.active()) {
+						recorder->swaps += (pi != k) + (pj != k);
+					}
+				} else if(pivotRows || pivotCols) {
+					int pi = k, pj = k;
+					const int iEnd = pivotRows ? n : k + 1;
+					const int jEnd = pivotCols ? n : k + 1;
+					for(int i = k; i < iEnd; ++i) {
+						for(int j = k; j < jEnd; ++j) {
+							if(std::abs(at(rowOrder[i], colOrder[j])) > std::abs(temp)) {
+								temp = at(rowOrder[i], colOrder[j]);
+								pi = i;
+								pj = j;
+							}
+						}
+					}
+					if(pi != k) {
+						std::swap(rowOrder[k], rowOrder[pi]);
+					}
+					if(pj != k) {
+						std::swap(colOrder[k], colOrder[pj]);
+					}
+					if(recorder.active()) {
+						recorder->swaps += (pi != k) + (pj != k);
+					}
+				}
+				const int p = rowOrder[k];
+				const int q = colOrder[k];
+				if(recorder.active()) {
+					for(int j = k; j < n; ++j) {
+						maxU = std::max(maxU, std::abs(static_cast<double>(at(p, colOrder[j]))));
+					}
+				}
+				rowDone[p] = 1;
+				colDone[q] = 1;
+
+				/* finished columns hold zeros in the pivot row, so they may be scaled too */
+				for(int j = c0; j < ld; ++j) {
+					at(p, j) /= temp;
+				}
+				for(int i = r0; i < n; ++i) {
+					l[i] = rowDone[i] ? T(0) : at(i, q);
+				}
+				if(recorder.active()) {
+					lower[static_cast<size_t>(p) * n + k] = temp;
+					for(int i = r0; i < n; ++i) {
+						if(!rowDone[i]) {
+							lower[static_cast<size_t>(i) * n + k] = l[i];
+						}
+					}
+				}
+				eliminate(a, n, ld, p, l.data(), u.data(), r0, c0, pool, Layout());
+				while(r0 < n && rowDone[r0]) {
+					++r0;
+				}
+				while(c0 < n && colDone[c0]) {
+					++c0;
+				}
+			}
+
+			/* Back traverse: U X = Y in pivot order, by the blocked trsm(), in x itself */
+			T *xs = x.data();
+			for(int k = 0; k < n; ++k) {
+				for(int c = 0; c < s; ++c) {
+					xs[k * s + c] = at(rowOrder[k], n + c);
+				}
+			}
+			const bool rowsInPlace = std::is_sorted(rowOrder.begin(), rowOrder.end());
+			const bool colsInPlace = std::is_sorted(colOrder.begin(), colOrder.end());
+			if(!(rowsInPlace && colsInPlace && backSolveInPlace(static_cast<const T*>(a), n, ld, xs, s, Layout()))
+			   && n > 0) {
+				/* one panel of U at a time, gathered in pivot order */
+				const int nb = trsmBlock;
+				std::vector<T> panel(static_cast<size_t>(std::min(n, nb)) * n);
+				for(int i0 = (n - 1) / nb * nb; i0 >= 0; i0 -= nb) {
+					const int i1 = std::min(n, i0 + nb);
+					for(int i = i0; i < i1; ++i) {
+						for(int j = i + 1; j < n; ++j) {
+							panel[static_cast<size_t>(i - i0) * n + j] = at(rowOrder[i], colOrder[j]);
+						}
+					}
+					trsmRowBlock(Triangle::UnitUpper, n, i0, i1, s, panel.data(), n, 1, xs, s, 1);
+				}
+			}
+			/* row colOrder[k] of x holds variable colOrder[k]: follow the cycles of the permutation */
+			if(!colsInPlace) {
+				std::vector<char> placed(n);
+				std::vector<T> carry(s);
+				for(int k = 0; k < n; ++k) {
+					if(placed[k] || colOrder[k] == k) {
+						continue;
+					}
+					std::copy(xs + k * s, xs + (k + 1) * s, carry.begin());
+					int from = k;
+					do {
+						const int to = colOrder[from];
+						std::swap_ranges(carry.begin(), carry.end(), xs + to * s);
+						placed[to] = 1;
+						from = to;
+					} while(from != k);
+				}
+			}
+			if(recorder.active()) {
+				recorder->pivotGrowth = (maxA > 0) ? maxU / maxA : 0;
+				const double normA = columnSums.empty() ? 0 : *std::max_element(columnSums.begin(), columnSums.end());
+				recorder->rcond = reciprocal(normA, gaussInverseNorm1(mat, n, ld, rowOrder, colOrder, lower));
+				recorder->illConditioned = recorder->rcond < std::numeric_limits<T>::epsilon();
+			}
+			recorder.finish(n);
+		}
+
+		/* Small row-major systems without stats take the unrolled smallGauss() */
+		template<typename T, int n, int s>
+		void gaussFixed(Matrix<T, n, n+s> &mat, Matrix<T, n, s> &x, Pivoting pivoting, double eps,
+						SolverStats *stats, std::true_type) {
+			if(stats) {
+				gauss(mat, x, n, s, pivoting, eps, nullptr, stats);
+			} else {
+				smallGauss<n, s>(mat.data(), x.data(), pivoting == Pivoting::Rows || pivoting == Pivoting::Full,
+								 pivoting == Pivoting::Columns || pivoting == Pivoting::Full);
+			}
+		}
+
+		template<typename T, int n, int s, typename L>
+		void gaussFixed(Matrix<T, n, n+s, L> &mat, Matrix<T, n, s> &x, Pivoting pivoting, double eps,
+						SolverStats *stats, std::false_type) {
+			gauss(mat, x, n, s, pivoting, eps, nullptr, stats);
+		}
+
+		template<typename Mat>
+		void luDecomposition(const Mat &mat, Mat &L, Mat &U, int n) {
+			typedef typename Mat::Scalar T;
+			setZero(L);
+			setZero(U);
+			for(int i = 0; i < n; ++i) {
+				for(int j = i; j < n; ++j) {
+					T sum = 0;
+					for(int k = 0; k < j; ++k) {
+						sum += L(j, k) * U(k, i);
+					}
+					L(j, i) = mat(j, i) - sum;
+					sum = 0;
+					for(int k = 0; k < i; ++k) {
+						sum += L(i, k) * U(k, j);
 					}
-					temp = mat(k, k);
-					std::swap(newOrder[k], newOrder[maxIdx]);
-					std::cout << "Swapped columns\n";
+					U(i, j) = (mat(i, j) - sum) / L(i, i);
 				}
-			}			
-		
-			for(int j = k; j < n + s; ++j) {
-				mat(k, j) /= temp;
 			}
+		}
+
+		/**
+		 * One Jacobi step next = H*x + g in a single pass over H.
+		 * @returns |next - x|^2
+		 */
+		template<typename T>
+		T jacobiSweep(const T *H, const T *g, const T *x, T *next, int n) {
+			T diff = 0;
+			for(int i = 0; i < n; ++i) {
+				const T v = rowDot(H + i * n, x, n) + g[i];
+				const T d = v - x[i];
+				diff += d * d;
+				next[i] = v;
+			}
+			return diff;
+		}
+
+		/**
+		 * One in-place Seidel sweep for A*x = b, straight from A: every row is
+		 * split at the diagonal into two dot products, so the inner loops have
+		 * no branch and no rewritten H is needed.
+		 * @returns |x_new - x_old|^2
+		 */
+		template<typename T>
+		T seidelSweep(const T *a, const T *b, const T *invDiag, T *x, int n) {
+			T diff = 0;
+			for(int i = 0; i < n; ++i) {
+				const T *row = a + i * n;
+				const T v = (b[i] - rowDot(row, x, i) - rowDot(row + i + 1, x + i + 1, n - i - 1)) * invDiag[i];
+				const T d = v - x[i];
+				diff += d * d;
+				x[i] = v;
+			}
+			return diff;
+		}
 
-			for(int i = k + 1; i < n; ++i) {
-				T temp = mat(i, k);
-				for(int j = k; j < n + s; ++j) {
-					mat(i, j) -= mat(k, j) * temp;
+		/* The two vectors take turns holding the iterate; nothing is allocated after the setup */
+		template<typename Mat, typename Vec>
+		int iterativeSolve(const Mat &H, const Vec &g, const Vec &guess, Vec &sol,
+						   double precision, int maxiter, SolverStats *stats, const IterationCallback &callback) {
+			StatsRecorder recorder(stats, callback);
+			const int n = H.rows();
+			sol = guess;
+			Vec next(guess);
+			typename Vec::Scalar *x = sol.data(), *y = next.data();
+			const double limit = precision * precision;
+
+			int i = 0;
+			bool converged = false;
+			for(; i < maxiter; ++i) {
+				const double diff = jacobiSweep(H.data(), g.data(), x, y, n);
+				std::swap(x, y);
+				converged = i && (diff < limit);
+				if((recorder.tracking() && !recorder.iteration(i, std::sqrt(diff))) || converged) {
+					break;
 				}
 			}
+			if(x != sol.data()) {
+				std::copy(x, x + n, sol.data());
+			}
+			recorder.finish(i, converged);
+			return i;
 		}
 
-		/* Back traverse */
-		Math::Matrix<T, n, s> X;
-		for(int k = 0; k < s; ++k) {
-			for(int i = n - 1; i >= 0; --i) {
-				T sum = 0;
-				for(int j = i + 1; j < n; ++j) {
-					sum += mat(i, j) * X(j,k);
+		template<typename Mat, typename Vec>
+		void rewriteSystem(const Mat &mat, const Vec &b, Mat &H, Vec &g, int n) {
+			for(int i = 0; i < n; ++i) {
+				const typename Mat::Scalar d = mat(i, i);
+				for(int j = 0; j < n; ++j) {
+					H(i, j) = (i == j) ? 0 : -mat(i, j) / d;
 				}
-				X(i,k) = mat(i, n+k) - sum;
+				g(i, 0) = b(i, 0) / d;
 			}
 		}
-	
-		/* Restore original order */
-		for(int k = 0; k < s; ++k) {
+
+		template<typename Mat, typename Vec>
+		int seidel(const Mat &mat, const Vec &vec, Vec &sol, int n, double eps, int maxiter,
+				   SolverStats *stats, const IterationCallback &callback) {
+			typedef typename Mat::Scalar T;
+			StatsRecorder recorder(stats, callback);
+			/* b is copied in case sol is vec */
+			const Vec b(vec);
+			Vec invDiag(vec);
 			for(int i = 0; i < n; ++i) {
-				x(newOrder[i], k) = X(i, k);
+				invDiag(i, 0) = T(1) / mat(i, i);
 			}
+			sol = vec;
+			setZero(sol);
+			const double limit = eps * eps;
+
+			int iter = 0;
+			bool converged = false;
+			for(; iter < maxiter; ++iter) {
+				const double diff = seidelSweep(mat.data(), b.data(), invDiag.data(), sol.data(), n);
+				converged = iter && (diff < limit);
+				if((recorder.tracking() && !recorder.iteration(iter, std::sqrt(diff))) || converged) {
+					break;
+				}
+			}
+			recorder.finish(iter, converged);
+			return iter;
 		}
 	}
 
+	/**
+	 * Gauss elimination.
+	 * Does not save the matrix but modifies it in place.
+	 * It can be used to solve `s` linear systems A*x_i = b_i (i = 0..s-1) simultaneously.
+	 * Each layout is eliminated along its storage; pivoting permutes index
+	 * vectors, so the rows and columns of the result are not reordered.
+	 * Row pivoting suits row-major storage and column pivoting column-major:
+	 * the update skips whole finished rows (columns) there, while the other
+	 * kind leaves finished columns (rows), all zeros, inside the updated range.
+	 * @param[in,out] mat The extended matrix of the systems. First n rows are A, last s rows are b_i.
+	 * @param[out] x Output matrix containing solutions x_i.
+	 * @param pivoting which interchanges pick the leading elements
+	 * @param eps precision; smaller leading elements are counted in SolverStats::smallPivots
+	 * @param[out] stats Optional: pivot growth, swaps, small pivots, the estimated reciprocal
+	 *                   condition number (an n x n buffer more) and time.
+	 * @tparam T must be statically cast to double
+	 */
+	template<typename T, int n, int s, typename L>
+	void gauss(Math::Matrix<T, n, n+s, L> &mat,
+			   Math::Matrix<T, n, s> &x, Pivoting pivoting, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		detail::gaussFixed(mat, x, pivoting, eps, stats,
+						   std::integral_constant<bool, n <= detail::smallSize && std::is_same<L, RowMajor>::value>());
+	}
+
+	/**
+	 * @param swapVar if true, algorithm will swap variables (that is, pivot on columns)
+	 *                when the leading element is too small.
+	 * @see gauss()
+	 */
+	template<typename T, int n, int s, typename L>
+	void gauss(Math::Matrix<T, n, n+s, L> &mat,
+			   Math::Matrix<T, n, s> &x, bool swapVar = false, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		gauss(mat, x, swapVar ? Pivoting::Columns : Pivoting::None, eps, stats);
+	}
+
+	/**
+	 * Parallel Gauss elimination.
+	 * The update of the rows below each pivot is split into cache-sized tiles
+	 * that run on the threads of \p pool.
+	 * @see gauss()
+	 */
+	template<typename T, int n, int s, typename L>
+	void gauss(Math::Matrix<T, n, n+s, L> &mat,
+			   Math::Matrix<T, n, s> &x, ThreadPool &pool, Pivoting pivoting, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		detail::gauss(mat, x, n, s, pivoting, eps, &pool, stats);
+	}
+
+	template<typename T, int n, int s, typename L>
+	void gauss(Math::Matrix<T, n, n+s, L> &mat,
+			   Math::Matrix<T, n, s> &x, ThreadPool &pool, bool swapVar = false, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		detail::gauss(mat, x, n, s, swapVar ? Pivoting::Columns : Pivoting::None, eps, &pool, stats);
+	}
+
+	/**
+	 * Gauss elimination for a runtime-sized n x (n+s) extended matrix.
+	 * @param[out] x Resized to n x s.
+	 * @see gauss()
+	 */
+	template<typename T>
+	void gauss(Math::DynamicMatrix<T> &mat,
+			   Math::DynamicMatrix<T> &x, Pivoting pivoting, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		const int n = mat.rows();
+		const int s = mat.cols() - n;
+		assert(s >= 0);
+		x.resize(n, s);
+		detail::gauss(mat, x, n, s, pivoting, eps, nullptr, stats);
+	}
+
+	template<typename T>
+	void gauss(Math::DynamicMatrix<T> &mat,
+			   Math::DynamicMatrix<T> &x, bool swapVar = false, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		gauss(mat, x, swapVar ? Pivoting::Columns : Pivoting::None, eps, stats);
+	}
+
+	/**
+	 * Parallel Gauss elimination for a runtime-sized extended matrix.
+	 * @see gauss()
+	 */
+	template<typename T>
+	void gauss(Math::DynamicMatrix<T> &mat,
+			   Math::DynamicMatrix<T> &x, ThreadPool &pool, Pivoting pivoting, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		const int n = mat.rows();
+		const int s = mat.cols() - n;
+		assert(s >= 0);
+		x.resize(n, s);
+		detail::gauss(mat, x, n, s, pivoting, eps, &pool, stats);
+	}
+
+	template<typename T>
+	void gauss(Math::DynamicMatrix<T> &mat,
+			   Math::DynamicMatrix<T> &x, ThreadPool &pool, bool swapVar = false, double eps = 1e-5,
+			   SolverStats *stats = nullptr) {
+		gauss(mat, x, pool, swapVar ? Pivoting::Columns : Pivoting::None, eps, stats);
+	}
+
 	/** LU-decomposition
+	 * Unpivoted, so it fails on a zero leading minor; see LUFactorization
+	 * for a pivoted factorization that can also solve systems.
 	 * @param[in] mat Matrix to be decomposed
-	 * @param[out] L lower-triangular matrix; no clearing is done (TODO?)
-	 * @param[out] U upper-unitriangular matrix; no clearing is done (TODO?)
+	 * @param[out] L lower-triangular matrix
+	 * @param[out] U upper-unitriangular matrix
 	 */
 	template<typename T, int n>
 	void luDecomposition(const Math::Matrix<T, n, n> &mat,
 						 Math::Matrix<T, n, n> &L,
 						 Math::Matrix<T, n, n> &U) {
-		for(int i = 0; i < n; ++i) {
-			for(int j = i; j < n; ++j) {
-				T sum = 0;
-				for(int k = 0; k < j; ++k) {
-					sum += L(j, k) * U(k, i);
-				}
-				L(j, i) = mat(j, i) - sum;
-				sum = 0;
-				for(int k = 0; k < i; ++k) {
-					sum += L(i, k) * U(k, j);
-				}
-				U(i, j) = (mat(i, j) - sum) / L(i, i);
-			}
-		}
+		detail::luDecomposition(mat, L, U, n);
+	}
+
+	/** LU-decomposition of a runtime-sized matrix
+	 * @param[out] L lower-triangular matrix, resized to n x n
+	 * @param[out] U upper-unitriangular matrix, resized to n x n
+	 */
+	template<typename T>
+	void luDecomposition(const Math::DynamicMatrix<T> &mat,
+						 Math::DynamicMatrix<T> &L,
+						 Math::DynamicMatrix<T> &U) {
+		const int n = mat.rows();
+		assert(mat.cols() == n);
+		L.resize(n, n);
+		U.resize(n, n);
+		detail::luDecomposition(mat, L, U, n);
 	}
 
 	/** Euclid norm of a vector
+	 * Accepts expressions, so the norm of a difference needs no temporary.
 	 * @returns norm
 	 */
-	template<typename T, int n>
-	double euclidNorm(const Math::Matrix<T, n, 1> &vec) {
-		T sum = 0;
-		for(int i = 0; i < n; ++i) {
-			sum += vec(i, 0) * vec(i, 0);
+	template<typename E>
+	double euclidNorm(const Math::MatrixExpr<E> &expr) {
+		static_assert(detail::dimsAgree(E::Cols, 1), "euclidNorm expects a column vector");
+		const E &vec = expr.derived();
+		assert(vec.cols() == 1);
+		typename E::Scalar sum = 0;
+		for(int i = 0; i < vec.rows(); ++i) {
+			typename E::Scalar v = vec(i, 0);
+			sum += v * v;
 		}
 		return std::sqrt(static_cast<double>(sum));
 	}
 
+	/** Euclid norm of a fixed-size vector, straight from its storage
+	 * @see euclidNorm()
+	 */
+	template<typename T, int n>
+	double euclidNorm(const Math::Matrix<T, n, 1> &vec) {
+		return std::sqrt(static_cast<double>(detail::rowDot(vec.data(), vec.data(), n)));
+	}
+
 	/** Solve the system x=Hx+g iteratively.
 	 * @param guess The initial guess.
 	 * @param[out] sol Solution vector.
+	 * @param[out] stats Optional: iterations, |x_k - x_(k-1)| of every iteration, time.
+	 * @param callback Optional: sees every iteration and may stop the solver.
 	 */
 	template<typename T, int n>
 	int iterativeSolve(const Math::Matrix<T, n, n> &H,
@@ -131,74 +734,82 @@ namespace Math {
 					   const Math::Matrix<T, n, 1> &guess,
 					   Math::Matrix<T, n, 1> &sol,
 					   double precision = 1e-5,
-					   int maxiter = 100) {
-		Math::Matrix<T, n, 1> x = guess;
-	
-		for(int i = 0; i < maxiter; ++i) {
-			Math::Matrix<T, n, 1> old_x = x;
-			x = Math::dot(H, x) + g;
-			//std::cout << "\n" << x << "\n" << old_x;
-			if(i && (euclidNorm(x - old_x) < precision)) {
-				sol = x;
-				return i;
-			}
-		}
-		sol = x;
-		return maxiter;
+					   int maxiter = 100,
+					   SolverStats *stats = nullptr,
+					   const IterationCallback &callback = IterationCallback()) {
+		return detail::iterativeSolve(H, g, guess, sol, precision, maxiter, stats, callback);
+	}
+
+	/** Solve the runtime-sized system x=Hx+g iteratively.
+	 * @see iterativeSolve()
+	 */
+	template<typename T>
+	int iterativeSolve(const Math::DynamicMatrix<T> &H,
+					   const Math::DynamicMatrix<T> &g,
+					   const Math::DynamicMatrix<T> &guess,
+					   Math::DynamicMatrix<T> &sol,
+					   double precision = 1e-5,
+					   int maxiter = 100,
+					   SolverStats *stats = nullptr,
+					   const IterationCallback &callback = IterationCallback()) {
+		assert(H.rows() == H.cols() && g.rows() == H.rows() && guess.rows() == H.rows());
+		return detail::iterativeSolve(H, g, guess, sol, precision, maxiter, stats, callback);
 	}
 
-	/** Rewrite system Ax=b to form x=Hx+g */
+	/** Rewrite system Ax=b to form x=Hx+g
+	 * H is a dense copy of A scaled by its diagonal; the overload taking a
+	 * LinearOperator H stores nothing of it.
+	 */
 	template<typename T, int n>
 	void rewriteSystem(const Math::Matrix<T, n, n> &mat,
 					   const Math::Matrix<T, n, 1> &b,
 					   Math::Matrix<T, n, n> &H,
 					   Math::Matrix<T, n, 1> &g) {
-		for(int i = 0; i < n; ++i) {
-			for(int j = 0; j < n; ++j) {
-				H(i, j) = (i == j) ? 0 : -mat(i, j) / mat(i, i);
-				g(i, 0) = b(i, 0) / mat(i, i);
-			}
-		}
+		detail::rewriteSystem(mat, b, H, g, n);
+	}
+
+	/** Rewrite runtime-sized system Ax=b to form x=Hx+g */
+	template<typename T>
+	void rewriteSystem(const Math::DynamicMatrix<T> &mat,
+					   const Math::DynamicMatrix<T> &b,
+					   Math::DynamicMatrix<T> &H,
+					   Math::DynamicMatrix<T> &g) {
+		const int n = mat.rows();
+		H.resize(n, n);
+		g.resize(n, 1);
+		detail::rewriteSystem(mat, b, H, g, n);
 	}
 
 	/** Solve a system \p mat*sol=vec using Seidel method.
 	 * Uses zero vector as the initial guess.
 	 * @param[out] sol Solution vector.
+	 * @param[out] stats Optional: iterations, |x_k - x_(k-1)| of every sweep, time.
+	 * @param callback Optional: sees every sweep and may stop the solver.
 	 */
 	template<typename T, int n>
 	int seidel(const Math::Matrix<T, n, n> &mat,
 			   const Math::Matrix<T, n, 1> &vec,
 			   Math::Matrix<T, n, 1> &sol,
 			   double eps = 1e-5,
-			   int maxiter = 100) {
-		typedef Math::Matrix<T, n, n> matrix;
-		typedef Math::Matrix<T, n, 1> vector;
-
-		matrix Hseid;
-		vector gseid;
-
-		rewriteSystem(mat, vec, Hseid, gseid);
+			   int maxiter = 100,
+			   SolverStats *stats = nullptr,
+			   const IterationCallback &callback = IterationCallback()) {
+		return detail::seidel(mat, vec, sol, n, eps, maxiter, stats, callback);
+	}
 
-		vector x;
-		vector old_x;
-		for(int iter = 0; iter < maxiter; ++iter) {
-			old_x = x;
-			for(int i = 0; i < n; ++i) {
-				T sum = 0;
-				for(int j = 0; j < n; ++j) {
-					sum += (j < i) ? Hseid(i, j) * x(j, 0) : Hseid(i, j) * old_x(j, 0);
-				}
-				sum += gseid(i, 0);
-				x(i, 0) = sum;
-			}
-			if(iter && (euclidNorm(x - old_x) < eps)) {
-				sol = x;
-				return iter;
-			}
-		}
-	
-		sol = x;
-		return maxiter;
+	/** Solve a runtime-sized system \p mat*sol=vec using Seidel method.
+	 * @see seidel()
+	 */
+	template<typename T>
+	int seidel(const Math::DynamicMatrix<T> &mat,
+			   const Math::DynamicMatrix<T> &vec,
+			   Math::DynamicMatrix<T> &sol,
+			   double eps = 1e-5,
+			   int maxiter = 100,
+			   SolverStats *stats = nullptr,
+			   const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows());
+		return detail::seidel(mat, vec, sol, mat.rows(), eps, maxiter, stats, callback);
 	}
 
 };
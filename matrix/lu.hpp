@@ -0,0 +1,351 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "linsys.hpp"
+
+namespace Math {
+	/**
+	 * LU factorization with partial (row) pivoting: P*A = L*U.
+	 * L is unit lower triangular, U is upper triangular; both are packed
+	 * into a single matrix of the same type as A.
+	 *
+	 * The factorization is right-looking and blocked: a panel of
+	 * `blockSize` columns is factored with the unblocked algorithm, then the
+	 * trailing matrix is updated with a single gemm() call, so for large
+	 * matrices most of the work runs in the gemm() micro-kernels.
+	 * Given a ThreadPool, the U12 solve and the trailing update are split
+	 * into independent column/tile tasks.
+	 *
+	 * Once factored, each right-hand side costs O(n^2).
+	 * A in another storage order than RowMajor is factored in a row-major copy.
+	 * @tparam MatrixType Matrix<T, n, n, Layout> or DynamicMatrix<T>
+	 */
+	template<typename MatrixType>
+	class LUFactorization
+	{
+	public:
+		typedef typename MatrixType::Scalar Scalar;
+		typedef typename detail::RowMajorOf<MatrixType>::type PackedMatrix;
+
+		explicit LUFactorization(const MatrixType &mat, int blockSize = 64);
+		LUFactorization(const MatrixType &mat, ThreadPool &pool, int blockSize = 64);
+
+		/** Factors another matrix of the same size, reusing the storage. */
+		void factorize(const MatrixType &mat);
+
+		/**
+		 * Solves A*X = B for every column of B.
+		 * @throws std::domain_error if A is singular
+		 */
+		template<typename Rhs>
+		typename PlainObject<Rhs>::type solve(const MatrixExpr<Rhs> &b) const;
+
+		Scalar determinant() const;
+
+		/**
+		 * @throws std::domain_error if A is singular
+		 */
+		MatrixType inverse() const;
+
+		/**
+		 * Estimated condition number ||A|| ||A^-1|| in the given norm, from
+		 * the factors in O(n^2) (detail::estimateNorm1) rather than the
+		 * O(n^3) of an inverse; a lower bound, rarely off by more than 3x.
+		 * Infinite for a singular A.
+		 */
+		double cond(Norm norm = Norm::One) const;
+
+		/**
+		 * 1 / cond(), the early warning to check before trusting solve():
+		 * 0 for a singular A, and below the machine epsilon of Scalar the
+		 * solution may not have a single correct digit.
+		 */
+		double rcond(Norm norm = Norm::One) const;
+
+		bool invertible() const { return !singular; }
+		int size() const { return n; }
+
+		/** Packed factors: strictly lower part is L, upper part is U. */
+		const PackedMatrix& matrixLU() const { return lu; }
+
+		/** Row i of P*A is row permutation()[i] of A. */
+		const std::vector<int>& permutation() const { return perm; }
+
+	private:
+		PackedMatrix lu;
+		std::vector<int> perm;
+		int n;
+		int blockSize;
+		ThreadPool *pool;
+		int swaps;
+		bool singular;
+		/* norms of A, taken before factoring */
+		double normOne, normInfinity;
+
+		void factor();
+		void factorPanel(int k0, int kb);
+		void solveU12(int k0, int kb);
+		void updateTrailing(int k0, int kb);
+		void applyInverse(Scalar *x) const;
+		void applyInverseTransposed(Scalar *x) const;
+	};
+
+	template<typename MatrixType>
+	LUFactorization<MatrixType>::LUFactorization(const MatrixType &mat, int blockSize)
+		: lu(mat), n(mat.rows()), blockSize(std::max(1, blockSize)), pool(nullptr), swaps(0), singular(false)
+	{
+		factor();
+	}
+
+	template<typename MatrixType>
+	LUFactorization<MatrixType>::LUFactorization(const MatrixType &mat, ThreadPool &pool, int blockSize)
+		: lu(mat), n(mat.rows()), blockSize(std::max(1, blockSize)), pool(&pool), swaps(0), singular(false)
+	{
+		factor();
+	}
+
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::factorize(const MatrixType &mat) {
+		lu = mat;
+		n = mat.rows();
+		factor();
+	}
+
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::factor() {
+		assert(lu.rows() == lu.cols());
+		perm.resize(n);
+		for(int i = 0; i < n; ++i) {
+			perm[i] = i;
+		}
+		swaps = 0;
+		singular = false;
+		normOne = detail::norm1(lu);
+		normInfinity = detail::normInf(lu);
+
+		for(int k0 = 0; k0 < n; k0 += blockSize) {
+			int kb = std::min(blockSize, n - k0);
+			factorPanel(k0, kb);
+			if(k0 + kb < n) {
+				solveU12(k0, kb);
+				updateTrailing(k0, kb);
+			}
+		}
+	}
+
+	/**
+	 * Unblocked factorization of columns k0..k0+kb-1, rows k0..n-1.
+	 * Whole rows are swapped: in row-major storage this is a contiguous copy
+	 * and leaves nothing to apply to the other blocks later.
+	 */
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::factorPanel(int k0, int kb) {
+		Scalar *a = lu.data();
+		for(int j = k0; j < k0 + kb; ++j) {
+			int p = j;
+			double maxAbs = std::abs(static_cast<double>(a[j * n + j]));
+			for(int i = j + 1; i < n; ++i) {
+				double v = std::abs(static_cast<double>(a[i * n + j]));
+				if(v > maxAbs) {
+					maxAbs = v;
+					p = i;
+				}
+			}
+			if(p != j) {
+				std::swap_ranges(a + j * n, a + (j + 1) * n, a + p * n);
+				std::swap(perm[j], perm[p]);
+				++swaps;
+			}
+			if(maxAbs == 0) {
+				singular = true;
+				continue;
+			}
+			Scalar pivotInv = Scalar(1) / a[j * n + j];
+			for(int i = j + 1; i < n; ++i) {
+				Scalar *row = a + i * n;
+				Scalar l = row[j] * pivotInv;
+				row[j] = l;
+				const Scalar *pivotRow = a + j * n;
+				for(int c = j + 1; c < k0 + kb; ++c) {
+					row[c] -= l * pivotRow[c];
+				}
+			}
+		}
+	}
+
+	namespace detail {
+		/* Columns (rows) of the trailing matrix per parallel LU task */
+		const int luTileSize = 256;
+	}
+
+	/** U12 = L11^-1 * A12 with L11 unit lower triangular. */
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::solveU12(int k0, int kb) {
+		Scalar *a = lu.data();
+		const int n = this->n;
+		auto solveColumns = [=](int c0, int c1) {
+			for(int i = k0 + 1; i < k0 + kb; ++i) {
+				Scalar *row = a + i * n;
+				for(int p = k0; p < i; ++p) {
+					Scalar l = row[p];
+					const Scalar *prow = a + p * n;
+					for(int c = c0; c < c1; ++c) {
+						row[c] -= l * prow[c];
+					}
+				}
+			}
+		};
+		if(pool) {
+			parallelFor(*pool, k0 + kb, n, detail::luTileSize, solveColumns);
+		} else {
+			solveColumns(k0 + kb, n);
+		}
+	}
+
+	/** A22 -= L21 * U12 */
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::updateTrailing(int k0, int kb) {
+		Scalar *a = lu.data();
+		const int n = this->n;
+		const int r0 = k0 + kb;
+		const int m = n - r0;
+		auto update = [=](int i0, int i1, int j0, int j1) {
+			gemm(i1 - i0, j1 - j0, kb, Scalar(-1),
+				 a + i0 * n + k0, n, 1,
+				 a + k0 * n + j0, n, 1,
+				 Scalar(1), a + i0 * n + j0, n, 1);
+		};
+		const int tile = detail::luTileSize;
+		if(!pool || pool->size() == 1 || m <= tile) {
+			update(r0, n, r0, n);
+			return;
+		}
+		TaskGroup group(*pool);
+		for(int i0 = r0; i0 < n; i0 += tile) {
+			for(int j0 = r0; j0 < n; j0 += tile) {
+				int i1 = std::min(n, i0 + tile), j1 = std::min(n, j0 + tile);
+				group.run([=]() { update(i0, i1, j0, j1); });
+			}
+		}
+		group.wait();
+	}
+
+	template<typename MatrixType>
+	template<typename Rhs>
+	typename PlainObject<Rhs>::type LUFactorization<MatrixType>::solve(const MatrixExpr<Rhs> &rhs) const {
+		if(singular) {
+			throw std::domain_error("Not invertible matrix");
+		}
+		const Rhs &b = rhs.derived();
+		assert(b.rows() == n);
+		const int s = b.cols();
+		typename PlainObject<Rhs>::type x(b);
+		Scalar *X = x.data();
+		const Scalar *a = lu.data();
+
+		/* X = P*B */
+		for(int i = 0; i < n; ++i) {
+			for(int k = 0; k < s; ++k) {
+				X[i * s + k] = b(perm[i], k);
+			}
+		}
+		if(s == 1) {
+			/* one column: both substitutions are row dot products */
+			for(int i = 1; i < n; ++i) {
+				X[i] -= detail::rowDot(a + i * n, X, i);
+			}
+			for(int i = n - 1; i >= 0; --i) {
+				X[i] = (X[i] - detail::rowDot(a + i * n + i + 1, X + i + 1, n - i - 1)) / a[i * n + i];
+			}
+			return x;
+		}
+		/* L*Y = P*B, U*X = Y, blocked over the right-hand sides */
+		trsm(Triangle::UnitLower, n, s, a, n, 1, X, s, 1);
+		trsm(Triangle::Upper, n, s, a, n, 1, X, s, 1);
+		return x;
+	}
+
+	template<typename MatrixType>
+	typename LUFactorization<MatrixType>::Scalar LUFactorization<MatrixType>::determinant() const {
+		Scalar det = (swaps % 2) ? -1 : 1;
+		for(int i = 0; i < n; ++i) {
+			det *= lu(i, i);
+		}
+		return det;
+	}
+
+	template<typename MatrixType>
+	MatrixType LUFactorization<MatrixType>::inverse() const {
+		PackedMatrix E(lu);
+		detail::setZero(E);
+		for(int i = 0; i < n; ++i) {
+			E(i, i) = 1;
+		}
+		return solve(E);
+	}
+
+	/** x := A^-1 x = U^-1 L^-1 P x */
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::applyInverse(Scalar *x) const {
+		const Scalar *a = lu.data();
+		std::vector<Scalar> y(n);
+		for(int i = 0; i < n; ++i) {
+			y[i] = x[perm[i]];
+		}
+		for(int i = 1; i < n; ++i) {
+			y[i] -= detail::rowDot(a + i * n, y.data(), i);
+		}
+		for(int i = n - 1; i >= 0; --i) {
+			y[i] = (y[i] - detail::rowDot(a + i * n + i + 1, y.data() + i + 1, n - i - 1)) / a[i * n + i];
+		}
+		std::copy(y.begin(), y.end(), x);
+	}
+
+	/** x := A^-T x = P^T L^-T U^-T x; the rows of U and L become columns, so both are axpy sweeps */
+	template<typename MatrixType>
+	void LUFactorization<MatrixType>::applyInverseTransposed(Scalar *x) const {
+		const Scalar *a = lu.data();
+		std::vector<Scalar> y(x, x + n);
+		for(int i = 0; i < n; ++i) {
+			const Scalar *row = a + i * n;
+			y[i] /= row[i];
+			for(int j = i + 1; j < n; ++j) {
+				y[j] -= row[j] * y[i];
+			}
+		}
+		for(int i = n - 1; i > 0; --i) {
+			const Scalar *row = a + i * n;
+			for(int j = 0; j < i; ++j) {
+				y[j] -= row[j] * y[i];
+			}
+		}
+		for(int i = 0; i < n; ++i) {
+			x[perm[i]] = y[i];
+		}
+	}
+
+	template<typename MatrixType>
+	double LUFactorization<MatrixType>::rcond(Norm norm) const {
+		if(singular) {
+			return 0;
+		}
+		auto inverse = [this](Scalar *x) { applyInverse(x); };
+		auto transposed = [this](Scalar *x) { applyInverseTransposed(x); };
+		/* ||A^-1||_inf = ||A^-T||_1: the same estimate with the roles swapped */
+		if(norm == Norm::One) {
+			return detail::reciprocal(normOne, detail::estimateNorm1<Scalar>(n, inverse, transposed));
+		}
+		return detail::reciprocal(normInfinity, detail::estimateNorm1<Scalar>(n, transposed, inverse));
+	}
+
+	template<typename MatrixType>
+	double LUFactorization<MatrixType>::cond(Norm norm) const {
+		const double r = rcond(norm);
+		return (r > 0) ? 1 / r : std::numeric_limits<double>::infinity();
+	}
+};
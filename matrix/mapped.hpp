@@ -0,0 +1,262 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "matrix.hpp"
+#include "sparse.hpp"
+
+namespace Math
+{
+	/*
+	 * Binary matrix files, version 1.
+	 *
+	 *   offset 0    BinaryHeader, 128 bytes
+	 *   offsets[0]  dense: rows*cols elements, row-major
+	 *               CSR: rows+1 int32 row pointers
+	 *   offsets[1]  CSR: nonZeros int32 column indices
+	 *   offsets[2]  CSR: nonZeros elements
+	 *
+	 * Every array starts at a multiple of 64 bytes, so a mapping of the
+	 * file (page aligned) can be used in place, as DynamicMatrix storage.
+	 * Numbers are in the byte order of the machine that wrote the file;
+	 * other orders are rejected.
+	 */
+	const uint32_t binaryVersion = 1;
+
+	enum class BinaryLayout : uint32_t { Dense = 1, CSR = 2 };
+
+	struct BinaryHeader {
+		char magic[8];
+		uint32_t version;
+		/* 0x01020304 as written by the producer */
+		uint32_t byteOrder;
+		BinaryLayout layout;
+		/* sizeof(element): 4 for float, 8 for double */
+		uint32_t scalarSize;
+		int64_t rows;
+		int64_t cols;
+		int64_t nonZeros;
+		uint64_t offsets[3];
+		uint8_t reserved[56];
+	};
+	static_assert(sizeof(BinaryHeader) == 128, "BinaryHeader must stay 128 bytes");
+
+	namespace detail {
+		const char binaryMagic[8] = {'M', 'A', 'T', 'H', 'B', 'I', 'N', '\0'};
+		const uint32_t binaryByteOrder = 0x01020304;
+		const uint64_t binaryAlignment = 64;
+
+		inline uint64_t alignOffset(uint64_t offset) {
+			return (offset + binaryAlignment - 1) / binaryAlignment * binaryAlignment;
+		}
+
+		inline BinaryHeader makeHeader(BinaryLayout layout, uint32_t scalarSize, int64_t rows, int64_t cols,
+									   int64_t nonZeros) {
+			BinaryHeader h;
+			std::memset(&h, 0, sizeof(h));
+			std::memcpy(h.magic, binaryMagic, sizeof(h.magic));
+			h.version = binaryVersion;
+			h.byteOrder = binaryByteOrder;
+			h.layout = layout;
+			h.scalarSize = scalarSize;
+			h.rows = rows;
+			h.cols = cols;
+			h.nonZeros = nonZeros;
+			return h;
+		}
+
+		/** Writes the arrays at the next aligned offsets, recording them in the header. */
+		inline void writeBinary(const std::string &path, BinaryHeader header,
+								const std::vector<std::pair<const void*, uint64_t> > &arrays) {
+			uint64_t offset = sizeof(BinaryHeader);
+			for(size_t k = 0; k < arrays.size(); ++k) {
+				offset = alignOffset(offset);
+				header.offsets[k] = offset;
+				offset += arrays[k].second;
+			}
+			std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			uint64_t written = sizeof(header);
+			const char zeros[binaryAlignment] = {};
+			for(size_t k = 0; k < arrays.size(); ++k) {
+				out.write(zeros, header.offsets[k] - written);
+				out.write(static_cast<const char*>(arrays[k].first), arrays[k].second);
+				written = header.offsets[k] + arrays[k].second;
+			}
+			if(!out) {
+				throw std::runtime_error("Cannot write " + path);
+			}
+		}
+	}
+
+	/** Writes a dense matrix (or the value of an expression) in the binary format. */
+	template<typename E>
+	void saveBinary(const std::string &path, const MatrixExpr<E> &expr) {
+		typedef typename E::Scalar T;
+		const typename PlainObject<E>::type mat(expr);
+		const int64_t rows = mat.rows(), cols = mat.cols();
+		detail::writeBinary(path, detail::makeHeader(BinaryLayout::Dense, sizeof(T), rows, cols, rows * cols),
+							{{mat.data(), static_cast<uint64_t>(rows * cols) * sizeof(T)}});
+	}
+
+	/** Writes a sparse matrix in the binary CSR format. */
+	template<typename T>
+	void saveBinary(const std::string &path, const SparseMatrix<T> &mat) {
+		const int64_t nnz = mat.nonZeros();
+		detail::writeBinary(path, detail::makeHeader(BinaryLayout::CSR, sizeof(T), mat.rows(), mat.cols(), nnz),
+							{{mat.rowPtr(), static_cast<uint64_t>(mat.rows() + 1) * sizeof(int)},
+							 {mat.colIdx(), static_cast<uint64_t>(nnz) * sizeof(int)},
+							 {mat.values(), static_cast<uint64_t>(nnz) * sizeof(T)}});
+	}
+
+	/**
+	 * A binary matrix file mapped into memory.
+	 * dense() and sparse() return matrices on External storage inside the
+	 * mapping: nothing is copied, the elements are read only when touched,
+	 * and pages are loaded on demand (sparse() validates the index arrays
+	 * up front, so that a corrupt file cannot index out of bounds). The mapping is private, so solvers that
+	 * work in place (gauss()) may modify the matrix; the file is never
+	 * changed. The views must not outlive the MappedMatrix.
+	 */
+	class MappedMatrix
+	{
+	public:
+		/** @throws std::runtime_error if the file cannot be mapped or is not a valid matrix file */
+		explicit MappedMatrix(const std::string &path);
+		~MappedMatrix();
+		MappedMatrix(const MappedMatrix&) = delete;
+		MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+		const BinaryHeader& header() const { return *reinterpret_cast<const BinaryHeader*>(base); }
+		BinaryLayout layout() const { return header().layout; }
+		int rows() const { return static_cast<int>(header().rows); }
+		int cols() const { return static_cast<int>(header().cols); }
+		int64_t nonZeros() const { return header().nonZeros; }
+
+		/** @throws std::runtime_error if the file is not dense with elements of type T */
+		template<typename T>
+		DynamicMatrix<T> dense();
+
+		/**
+		 * Reads the row pointers and column indices once, to check them;
+		 * the values stay unread.
+		 * @throws std::runtime_error if the file is not CSR with elements of type T
+		 * or its row pointers or column indices are out of order or range
+		 */
+		template<typename T>
+		SparseMatrix<T> sparse();
+
+	private:
+		char *base;
+		size_t size;
+		std::string path;
+
+		template<typename T>
+		T* array(int k, uint64_t count);
+		void check(BinaryLayout layout, size_t scalarSize) const;
+	};
+
+	inline MappedMatrix::MappedMatrix(const std::string &path) : base(nullptr), size(0), path(path)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if(fd < 0) {
+			throw std::runtime_error("Cannot open " + path);
+		}
+		struct stat st;
+		if(::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BinaryHeader))) {
+			::close(fd);
+			throw std::runtime_error(path + " is not a matrix file");
+		}
+		size = static_cast<size_t>(st.st_size);
+		void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if(p == MAP_FAILED) {
+			throw std::runtime_error("Cannot map " + path);
+		}
+		base = static_cast<char*>(p);
+
+		const BinaryHeader &h = header();
+		const char *error = nullptr;
+		if(std::memcmp(h.magic, detail::binaryMagic, sizeof(h.magic)) != 0) {
+			error = " is not a matrix file";
+		} else if(h.byteOrder != detail::binaryByteOrder) {
+			error = " has another byte order";
+		} else if(h.version != binaryVersion) {
+			error = " has an unsupported version";
+		} else if(h.rows < 0 || h.cols < 0 || h.nonZeros < 0 ||
+				  (h.layout != BinaryLayout::Dense && h.layout != BinaryLayout::CSR)) {
+			error = " has a corrupt header";
+		} else if(h.rows > INT_MAX || h.cols > INT_MAX || h.nonZeros > INT_MAX ||
+				  (h.layout == BinaryLayout::Dense && h.rows * h.cols > INT_MAX)) {
+			/* DynamicMatrix and SparseMatrix index their elements with int */
+			error = " is too large";
+		}
+		if(error) {
+			::munmap(base, size);
+			throw std::runtime_error(path + error);
+		}
+	}
+
+	inline MappedMatrix::~MappedMatrix() {
+		::munmap(base, size);
+	}
+
+	inline void MappedMatrix::check(BinaryLayout layout, size_t scalarSize) const {
+		if(header().layout != layout) {
+			throw std::runtime_error(path + (layout == BinaryLayout::Dense ? " is not dense" : " is not CSR"));
+		}
+		if(header().scalarSize != scalarSize) {
+			throw std::runtime_error(path + " has another element type");
+		}
+	}
+
+	template<typename T>
+	T* MappedMatrix::array(int k, uint64_t count) {
+		uint64_t offset = header().offsets[k];
+		if(offset % detail::binaryAlignment != 0 || offset > size || count > (size - offset) / sizeof(T)) {
+			throw std::runtime_error(path + " is truncated");
+		}
+		return reinterpret_cast<T*>(base + offset);
+	}
+
+	template<typename T>
+	DynamicMatrix<T> MappedMatrix::dense() {
+		check(BinaryLayout::Dense, sizeof(T));
+		T *data = array<T>(0, static_cast<uint64_t>(header().rows) * header().cols);
+		return DynamicMatrix<T>(rows(), cols(), data, external);
+	}
+
+	template<typename T>
+	SparseMatrix<T> MappedMatrix::sparse() {
+		check(BinaryLayout::CSR, sizeof(T));
+		const int64_t nnz = nonZeros();
+		const int *rowPtr = array<int>(0, header().rows + 1);
+		const int *colIdx = array<int>(1, nnz);
+		T *values = array<T>(2, nnz);
+		if(rowPtr[0] != 0 || rowPtr[rows()] != nnz) {
+			throw std::runtime_error(path + " has corrupt row pointers");
+		}
+		for(int i = 0; i < rows(); ++i) {
+			if(rowPtr[i + 1] < rowPtr[i]) {
+				throw std::runtime_error(path + " has corrupt row pointers");
+			}
+		}
+		for(int64_t k = 0; k < nnz; ++k) {
+			if(colIdx[k] < 0 || colIdx[k] >= cols()) {
+				throw std::runtime_error(path + " has corrupt column indices");
+			}
+		}
+		return SparseMatrix<T>(rows(), cols(), static_cast<int>(nnz), rowPtr, colIdx, values, external);
+	}
+};
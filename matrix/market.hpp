@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "matrix.hpp"
+#include "sparse.hpp"
+
+namespace Math
+{
+	/**
+	 * Streaming reader of Matrix Market (.mtx) files.
+	 * Supports the coordinate and array formats with real, integer or
+	 * pattern (coordinate only) elements and general, symmetric or
+	 * skew-symmetric storage. Entries are parsed one line at a time into a
+	 * reused buffer: forEach() and readDense() need no memory beyond the
+	 * result, readSparse() also holds a triplet array of entries() elements
+	 * (twice that for symmetric files) while it builds the CSR.
+	 */
+	class MatrixMarketReader
+	{
+	public:
+		/**
+		 * Reads the banner and the size line.
+		 * @throws std::runtime_error if the header is malformed or unsupported
+		 */
+		explicit MatrixMarketReader(std::istream &in);
+
+		int rows() const { return n; }
+		int cols() const { return m; }
+		/** Entries stored in the file, before symmetric ones are expanded */
+		long entries() const { return count; }
+		bool coordinate() const { return isCoordinate; }
+		bool symmetric() const { return symmetry != General; }
+
+		/**
+		 * Calls f(row, col, value) with 0-based indices for every element in
+		 * the file; the mirror of an off-diagonal symmetric entry follows it.
+		 * Array files are visited column by column. Can be called once.
+		 * @throws std::runtime_error if an entry is malformed or out of range
+		 */
+		template<typename F>
+		void forEach(F f);
+
+		/**
+		 * Reads the whole matrix; duplicate coordinate entries are summed.
+		 * @throws std::runtime_error from readDense() if rows*cols exceeds INT_MAX
+		 */
+		template<typename T>
+		SparseMatrix<T> readSparse();
+
+		template<typename T>
+		DynamicMatrix<T> readDense();
+
+	private:
+		enum Symmetry { General, Symmetric, SkewSymmetric };
+
+		std::istream &in;
+		std::string line;
+		long lineNumber;
+		int n;
+		int m;
+		long count;
+		bool isCoordinate;
+		bool pattern;
+		Symmetry symmetry;
+
+		bool nextLine();
+		[[noreturn]] void fail(const std::string &what) const;
+	};
+
+	namespace detail {
+		inline std::string lowerCase(std::string s) {
+			for(char &c : s) {
+				if(c >= 'A' && c <= 'Z') {
+					c = c - 'A' + 'a';
+				}
+			}
+			return s;
+		}
+
+		/** Parses a long at p, advancing p; false if there is none */
+		inline bool parseLong(const char *&p, long &value) {
+			char *end;
+			errno = 0;
+			value = std::strtol(p, &end, 10);
+			if(end == p || errno != 0) {
+				return false;
+			}
+			p = end;
+			return true;
+		}
+
+		inline bool parseDouble(const char *&p, double &value) {
+			char *end;
+			value = std::strtod(p, &end);
+			if(end == p) {
+				return false;
+			}
+			p = end;
+			return true;
+		}
+	}
+
+	inline MatrixMarketReader::MatrixMarketReader(std::istream &in)
+		: in(in), lineNumber(0), n(0), m(0), count(0), isCoordinate(true), pattern(false), symmetry(General)
+	{
+		if(!std::getline(in, line)) {
+			fail("empty input");
+		}
+		++lineNumber;
+		std::vector<std::string> words;
+		size_t pos = 0;
+		while(pos < line.size()) {
+			size_t start = line.find_first_not_of(" \t\r", pos);
+			if(start == std::string::npos) {
+				break;
+			}
+			pos = line.find_first_of(" \t\r", start);
+			words.push_back(detail::lowerCase(line.substr(start, pos - start)));
+		}
+		if(words.size() != 5 || words[0] != "%%matrixmarket" || words[1] != "matrix") {
+			fail("not a Matrix Market matrix");
+		}
+		if(words[2] == "array") {
+			isCoordinate = false;
+		} else if(words[2] != "coordinate") {
+			fail("unknown format " + words[2]);
+		}
+		if(words[3] == "pattern" && isCoordinate) {
+			pattern = true;
+		} else if(words[3] != "real" && words[3] != "integer") {
+			fail("unsupported field " + words[3]);
+		}
+		if(words[4] == "symmetric") {
+			symmetry = Symmetric;
+		} else if(words[4] == "skew-symmetric") {
+			symmetry = SkewSymmetric;
+		} else if(words[4] != "general") {
+			fail("unsupported symmetry " + words[4]);
+		}
+
+		if(!nextLine()) {
+			fail("missing size line");
+		}
+		const char *p = line.c_str();
+		long rows, cols, entries = 0;
+		if(!detail::parseLong(p, rows) || !detail::parseLong(p, cols) ||
+		   (isCoordinate && !detail::parseLong(p, entries)) || rows < 0 || cols < 0 || entries < 0) {
+			fail("bad size line");
+		}
+		if(rows > INT_MAX || cols > INT_MAX || entries > INT_MAX) {
+			fail("matrix too large");
+		}
+		if(symmetry != General && rows != cols) {
+			fail("symmetric matrix is not square");
+		}
+		n = static_cast<int>(rows);
+		m = static_cast<int>(cols);
+		if(isCoordinate) {
+			count = entries;
+		} else if(symmetry == General) {
+			count = rows * cols;
+		} else if(symmetry == Symmetric) {
+			/* the lower triangle, diagonal included */
+			count = rows * (rows + 1) / 2;
+		} else {
+			count = rows * (rows - 1) / 2;
+		}
+	}
+
+	/* skips comments and blank lines */
+	inline bool MatrixMarketReader::nextLine() {
+		while(std::getline(in, line)) {
+			++lineNumber;
+			size_t start = line.find_first_not_of(" \t\r");
+			if(start != std::string::npos && line[start] != '%') {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline void MatrixMarketReader::fail(const std::string &what) const {
+		throw std::runtime_error("Matrix Market line " + std::to_string(lineNumber) + ": " + what);
+	}
+
+	template<typename F>
+	void MatrixMarketReader::forEach(F f) {
+		const double sign = symmetry == SkewSymmetric ? -1 : 1;
+		/* position of the next array entry, column by column over the stored triangle */
+		long i = symmetry == SkewSymmetric ? 1 : 0, j = 0;
+		for(long k = 0; k < count; ++k) {
+			if(!nextLine()) {
+				fail("expected " + std::to_string(count) + " entries, found " + std::to_string(k));
+			}
+			const char *p = line.c_str();
+			double value = 1;
+			if(isCoordinate) {
+				long row, col;
+				if(!detail::parseLong(p, row) || !detail::parseLong(p, col)) {
+					fail("bad entry");
+				}
+				if(row < 1 || row > n || col < 1 || col > m) {
+					fail("entry out of range");
+				}
+				i = row - 1;
+				j = col - 1;
+			}
+			if(!pattern && !detail::parseDouble(p, value)) {
+				fail("bad value");
+			}
+			f(static_cast<int>(i), static_cast<int>(j), value);
+			if(symmetry != General && i != j) {
+				f(static_cast<int>(j), static_cast<int>(i), sign * value);
+			}
+			if(!isCoordinate && ++i == n) {
+				++j;
+				i = symmetry == General ? 0 : (symmetry == Symmetric ? j : j + 1);
+			}
+		}
+	}
+
+	template<typename T>
+	SparseMatrix<T> MatrixMarketReader::readSparse() {
+		std::vector<Triplet<T> > triplets;
+		triplets.reserve(symmetry == General ? count : 2 * count);
+		forEach([&](int i, int j, double value) {
+			triplets.push_back({i, j, static_cast<T>(value)});
+		});
+		return SparseMatrix<T>(n, m, triplets);
+	}
+
+	template<typename T>
+	DynamicMatrix<T> MatrixMarketReader::readDense() {
+		if(static_cast<long>(n) * m > INT_MAX) {
+			fail("matrix too large for dense storage");
+		}
+		DynamicMatrix<T> mat(n, m);
+		forEach([&](int i, int j, double value) {
+			mat(i, j) += static_cast<T>(value);
+		});
+		return mat;
+	}
+};
@@ -6,6 +6,9 @@
 #include <iomanip>
 #include <iostream>
 
+#include "expr.hpp"
+#include "dynamic.hpp"
+
 namespace Math 
 {
 	/**
@@ -13,115 +16,174 @@ namespace Math
 	 * @tparam T type of matrix elements
 	 * @tparam n number of rows
 	 * @tparam m number of columns
+	 * @tparam Layout storage order: RowMajor, ColMajor or Tiled<b> (see layout.hpp)
 	 */
-	template<typename T, int n, int m>
-	class Matrix 
+	template<typename T, int n, int m, typename Layout>
+	class Matrix : public MatrixExpr<Matrix<T, n, m, Layout> >
 	{
 	protected:
-		std::array<T,n*m> matrix;
+		std::array<T, Layout::size(n, m)> matrix;
 	public:
+		typedef T Scalar;
+		typedef Layout StorageOrder;
+		static constexpr int Rows = n;
+		static constexpr int Cols = m;
+
 		Matrix();
+		/** Elements row by row, whatever the layout */
 		Matrix(std::initializer_list<T> l);
-		Matrix(const Matrix<T, n, m> &mat);
-		Matrix(Matrix<T, n, m> &&mat);
+		Matrix(const Matrix &mat);
+		Matrix(Matrix &&mat);
+		template<typename E>
+		Matrix(const MatrixExpr<E> &expr);
+		int rows() const { return n; }
+		int cols() const { return m; }
 		T& operator()(int row, int col);
 		T operator()(int row, int col) const;
-		Matrix<T, n, m>& operator=(Matrix<T, n, m> mat);
+		/** Storage of the elements in Layout order */
+		T* data() { return matrix.data(); }
+		const T* data() const { return matrix.data(); }
+		Matrix& operator=(Matrix mat);
+		template<typename E>
+		Matrix& operator=(const MatrixExpr<E> &expr);
 		friend void swap(Matrix& m1, Matrix& m2) {
 			std::swap(m1.matrix, m2.matrix);
 		};
 
 		/* arithmetics */
-		Matrix<T, n, m>& operator+=(const Matrix<T, n, m>& rhs);
-		Matrix<T, n, m>& operator-=(const Matrix<T, n, m>& rhs);
-		Matrix<T, n, m>& operator*=(T scalar);
-		bool operator==(const Matrix<T, n, m> &rhs);
+		template<typename E>
+		Matrix& operator+=(const MatrixExpr<E>& rhs);
+		template<typename E>
+		Matrix& operator-=(const MatrixExpr<E>& rhs);
+		Matrix& operator*=(T scalar);
+		bool operator==(const Matrix &rhs);
 	};
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m>::Matrix() 
+	template<typename T, int n, int m, typename L>
+	Matrix<T, n, m, L>::Matrix() 
 	{
 		assert(n > 0 && m > 0);
 		matrix.fill(0);
 	}
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m>::Matrix(std::initializer_list<T> l) 
+	template<typename T, int n, int m, typename L>
+	Matrix<T, n, m, L>::Matrix(std::initializer_list<T> l) 
 	{
 		assert(l.size() <= n*m);
-		std::copy(l.begin(), l.end(), matrix.begin());
+		matrix.fill(0);
+		int k = 0;
+		for(auto it = l.begin(); it != l.end(); ++it, ++k) {
+			matrix[L::index(k / m, k % m, n, m)] = *it;
+		}
 	}
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m>::Matrix(const Matrix<T, n, m> &mat) {
+	template<typename T, int n, int m, typename L>
+	Matrix<T, n, m, L>::Matrix(const Matrix &mat) {
 		std::copy(mat.matrix.begin(), mat.matrix.end(), matrix.begin());
 	}
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m>::Matrix(Matrix<T, n, m> &&mat) 
+	template<typename T, int n, int m, typename L>
+	Matrix<T, n, m, L>::Matrix(Matrix &&mat) 
 	{
 		swap(*this, mat);
 	}
+
+	template<typename T, int n, int m, typename L>
+	template<typename E>
+	Matrix<T, n, m, L>::Matrix(const MatrixExpr<E> &expr)
+	{
+		static_assert(detail::dimsAgree(E::Rows, n) && detail::dimsAgree(E::Cols, m),
+					  "matrix dimensions must agree");
+		assert(expr.derived().rows() == n && expr.derived().cols() == m);
+		if(!L::strided) {
+			/* the padding of tiled storage is never written */
+			matrix.fill(0);
+		}
+		detail::evalTo(*this, expr.derived());
+	}
 		
 
-	template<typename T, int n, int m>
-	T& Matrix<T, n, m>::operator()(int row, int col) 
+	template<typename T, int n, int m, typename L>
+	T& Matrix<T, n, m, L>::operator()(int row, int col) 
 	{
 		assert(row >= 0 && row < n);
 		assert(col >= 0 && col < m);
-		return matrix[row*m+col];
+		return matrix[L::index(row, col, n, m)];
 	}
 
-	template<typename T, int n, int m>
-	T Matrix<T, n, m>::operator()(int row, int col) const {
+	template<typename T, int n, int m, typename L>
+	T Matrix<T, n, m, L>::operator()(int row, int col) const {
 		assert(row >= 0 && row < n);
 		assert(col >= 0 && col < m);
-		return matrix[row*m+col];
+		return matrix[L::index(row, col, n, m)];
 	}
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m>& Matrix<T, n, m>::operator=(Matrix<T, n, m> mat) {
+	template<typename T, int n, int m, typename L>
+	Matrix<T, n, m, L>& Matrix<T, n, m, L>::operator=(Matrix mat) {
 		swap(*this, mat);
 		return *this;
 	}
 
+	/**
+	 * Assigns an expression in a single pass.
+	 * A temporary is made only if the expression reads this matrix through a product.
+	 */
+	template<typename T, int n, int m, typename L>
+	template<typename E>
+	Matrix<T, n, m, L>& Matrix<T, n, m, L>::operator=(const MatrixExpr<E> &expr) {
+		static_assert(detail::dimsAgree(E::Rows, n) && detail::dimsAgree(E::Cols, m),
+					  "matrix dimensions must agree");
+		assert(expr.derived().rows() == n && expr.derived().cols() == m);
+		if(detail::aliases(expr.derived(), data())) {
+			Matrix tmp(expr);
+			swap(*this, tmp);
+		} else {
+			detail::evalTo(*this, expr.derived());
+		}
+		return *this;
+	}
+
 	/* arithmetics */
-	template<typename T, int n, int m>
-	Matrix<T, n, m>& Matrix<T, n, m>::operator+=(const Matrix<T, n, m>& rhs) {
-		for(int i = 0; i < n*m; ++i) {
-			matrix[i] += rhs.matrix[i];
+	template<typename T, int n, int m, typename L>
+	template<typename E>
+	Matrix<T, n, m, L>& Matrix<T, n, m, L>::operator+=(const MatrixExpr<E>& rhs) {
+		static_assert(detail::dimsAgree(E::Rows, n) && detail::dimsAgree(E::Cols, m),
+					  "matrix dimensions must agree");
+		assert(rhs.derived().rows() == n && rhs.derived().cols() == m);
+		if(detail::aliases(rhs.derived(), data())) {
+			detail::addTo(*this, Matrix(rhs), T(1));
+		} else {
+			detail::addTo(*this, rhs.derived(), T(1));
 		}
 		return *this;
 	}
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m>& Matrix<T, n, m>::operator-=(const Matrix<T, n, m>& rhs) {
-		return this->operator+=(-rhs);
+	template<typename T, int n, int m, typename L>
+	template<typename E>
+	Matrix<T, n, m, L>& Matrix<T, n, m, L>::operator-=(const MatrixExpr<E>& rhs) {
+		static_assert(detail::dimsAgree(E::Rows, n) && detail::dimsAgree(E::Cols, m),
+					  "matrix dimensions must agree");
+		assert(rhs.derived().rows() == n && rhs.derived().cols() == m);
+		if(detail::aliases(rhs.derived(), data())) {
+			detail::addTo(*this, Matrix(rhs), T(-1));
+		} else {
+			detail::addTo(*this, rhs.derived(), T(-1));
+		}
+		return *this;
 	}
 	
-	template<typename T, int n, int m>
-	Matrix<T, n, m>& Matrix<T, n, m>::operator*=(T scalar) {
+	template<typename T, int n, int m, typename L>
+	Matrix<T, n, m, L>& Matrix<T, n, m, L>::operator*=(T scalar) {
 		for(auto it = matrix.begin(); it != matrix.end(); ++it) {
 			(*it) *= scalar;
 		}
 		return *this;
 	}
 	
-	template<typename T, int n, int m>
-	Matrix<T, n, m> operator-(const Matrix<T, n, m> &rhs) {
-		Matrix<T, n, m> result;
-		for(int i = 0; i < n; ++i) {
-			for(int j = 0; j < m; ++j) {
-				result(i, j) = -rhs(i, j);
-			}
-		}
-		return result;
-	}
-
-	template<typename T, int n, int m>
-	bool Matrix<T,n,m>::operator==(const Matrix<T, n, m> &rhs) {
+	template<typename T, int n, int m, typename L>
+	bool Matrix<T, n, m, L>::operator==(const Matrix &rhs) {
 		bool result = true;
-		for(int i = 0; i < n*m; ++i) {
+		for(int i = 0; i < L::size(n, m); ++i) {
 			if(matrix[i] != rhs.matrix[i]) {
 				result = false;
 				break;
@@ -130,39 +192,12 @@ namespace Math
 		return result;
 	}
 
-	template<typename T, int n, int m>
-	Matrix<T, n, m> operator+(Matrix<T, n, m> lhs, const Matrix<T, n, m> &rhs) {
-		lhs += rhs;
-		return lhs;
-	}
-
-	template<typename T, int n, int m>
-	Matrix<T, n, m> operator-(Matrix<T, n, m> lhs, const Matrix<T, n, m> &rhs) {
-		lhs -= rhs;
-		return lhs;
-	}
-
 	/**
-	 * A scalar multiplication.
-	 * @see dot()
-	 */
-	template<typename T, int n, int m>
-	Matrix<T, n, m> operator*(Matrix<T, n, m> lhs, T scalar) {
-		lhs *= scalar;
-		return lhs;
-	}
-
-	template<typename T, int n, int m>
-	Matrix<T, n, m> operator*(T scalar, const Matrix<T, n, m> &rhs) {
-		return rhs * scalar;
-	}
-
-			/**
 	 * Dot product.
-	 * This is a naive algorithm. It will be replaced by some other algorithm in the future.
+	 * This is a naive algorithm. It is kept as a reference implementation for dot().
 	 */
 	template<typename T, int n, int m, int r>
-	Matrix<T, n, m> dot(const Matrix<T, n, r> &lhs, const Matrix<T, r, m> &rhs) {
+	Matrix<T, n, m> naiveDot(const Matrix<T, n, r> &lhs, const Matrix<T, r, m> &rhs) {
 		Matrix<T, n, m> product;
 		for(int i = 0; i < n; ++i) {
 			for(int j = 0; j < m; ++j) {
@@ -174,4 +209,3 @@ namespace Math
 		return product;
 	}
 };
-
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <assert.h>
+
+#include "matrix.hpp"
+#include "stats.hpp"
+
+/*
+ * Linear operators: what the iterative and Krylov solvers need of A when
+ * it is cheaper to apply than to store (stencils, convolutions, Kronecker
+ * products). An operator is any object with
+ *     typedef T Scalar;
+ *     int rows() const;
+ *     int cols() const;
+ *     void apply(const T *x, T *y) const;   // y = A*x
+ * and, for what divides by the diagonal (rewriteSystem(),
+ * JacobiPreconditioner), also
+ *     T diagonal(int i) const;
+ * LinearOperator wraps lambdas into one. Matrix, DynamicMatrix and
+ * SparseMatrix are taken by the same solvers as they are.
+ */
+namespace Math
+{
+	template<typename T>
+	class SparseMatrix;
+
+	/** An n x n operator made of functions, e.g. lambdas over a grid */
+	template<typename T>
+	class LinearOperator
+	{
+	public:
+		typedef T Scalar;
+		typedef std::function<void(const T *x, T *y)> Apply;
+		typedef std::function<T(int i)> Diagonal;
+
+		/**
+		 * @param apply y = A*x for arrays of n elements
+		 * @param diagonal Optional: a_ii
+		 */
+		LinearOperator(int n, Apply apply, Diagonal diagonal = Diagonal())
+			: n(n), f(std::move(apply)), d(std::move(diagonal)) {}
+
+		int rows() const { return n; }
+		int cols() const { return n; }
+		void apply(const T *x, T *y) const { f(x, y); }
+
+		bool hasDiagonal() const { return static_cast<bool>(d); }
+		/** @throws std::runtime_error if no diagonal was given */
+		T diagonal(int i) const {
+			if(!d) {
+				throw std::runtime_error("Operator without a diagonal");
+			}
+			return d(i);
+		}
+
+	private:
+		int n;
+		Apply f;
+		Diagonal d;
+	};
+
+	namespace detail {
+		/** True for the types with Scalar and apply(const Scalar*, Scalar*) const */
+		template<typename Op, typename = void>
+		struct IsLinearOperator : std::false_type {};
+
+		template<typename Op>
+		struct IsLinearOperator<Op, decltype(std::declval<const Op&>().apply(
+			std::declval<const typename Op::Scalar*>(), std::declval<typename Op::Scalar*>()), void())>
+			: std::true_type {};
+
+		template<typename Op>
+		typename std::enable_if<IsLinearOperator<Op>::value>::type
+		multiply(const Op &A, const typename Op::Scalar *x, typename Op::Scalar *y) {
+			A.apply(x, y);
+		}
+
+		template<typename T>
+		void multiply(const SparseMatrix<T> &A, const T *x, T *y) {
+			A.multiply(x, y);
+		}
+
+		/* Dense y = A*x, row by row: rows are contiguous */
+		template<typename Mat, typename T>
+		void denseMultiply(const Mat &A, const T *x, T *y, RowMajor) {
+			const int n = A.rows(), m = A.cols();
+			const T *a = A.data();
+			for(int i = 0; i < n; ++i) {
+				T sum = 0;
+				const T *row = a + i * m;
+				for(int j = 0; j < m; ++j) {
+					sum += row[j] * x[j];
+				}
+				y[i] = sum;
+			}
+		}
+
+		/* column by column: y += x_j * (column j) */
+		template<typename Mat, typename T>
+		void denseMultiply(const Mat &A, const T *x, T *y, ColMajor) {
+			const int n = A.rows(), m = A.cols();
+			const T *a = A.data();
+			std::fill(y, y + n, T(0));
+			for(int j = 0; j < m; ++j) {
+				const T xj = x[j];
+				const T *col = a + j * n;
+				for(int i = 0; i < n; ++i) {
+					y[i] += col[i] * xj;
+				}
+			}
+		}
+
+		/* any other layout, e.g. Tiled<b> with its padding, element by element */
+		template<typename Mat, typename T, typename Layout>
+		void denseMultiply(const Mat &A, const T *x, T *y, Layout) {
+			const int n = A.rows(), m = A.cols();
+			for(int i = 0; i < n; ++i) {
+				T sum = 0;
+				for(int j = 0; j < m; ++j) {
+					sum += A(i, j) * x[j];
+				}
+				y[i] = sum;
+			}
+		}
+
+		/* Dense y = A*x in the storage order of A */
+		template<typename Mat>
+		typename std::enable_if<!IsLinearOperator<Mat>::value>::type
+		multiply(const Mat &A, const typename Mat::Scalar *x, typename Mat::Scalar *y) {
+			denseMultiply(A, x, y, typename LayoutOf<Mat>::type());
+		}
+
+		template<typename Op>
+		typename std::enable_if<IsLinearOperator<Op>::value, typename Op::Scalar>::type
+		diagonal(const Op &A, int i) {
+			return A.diagonal(i);
+		}
+
+		template<typename T>
+		T diagonal(const SparseMatrix<T> &A, int i) {
+			return A.coeff(i, i);
+		}
+
+		template<typename Mat>
+		typename std::enable_if<!IsLinearOperator<Mat>::value, typename Mat::Scalar>::type
+		diagonal(const Mat &A, int i) {
+			return A(i, i);
+		}
+
+		/* x = Hx + g for a sparse matrix or an operator H: one multiply() per step */
+		template<typename Op, typename T>
+		int operatorIterativeSolve(const Op &H, const DynamicMatrix<T> &g, const DynamicMatrix<T> &guess,
+								   DynamicMatrix<T> &sol, double precision, int maxiter,
+								   SolverStats *stats, const IterationCallback &callback) {
+			StatsRecorder recorder(stats, callback);
+			const int n = H.rows();
+			assert(H.cols() == n && g.rows() == n && guess.rows() == n);
+			sol = guess;
+			DynamicMatrix<T> next(guess);
+			T *x = sol.data(), *y = next.data();
+			const T *gp = g.data();
+			const double limit = precision * precision;
+
+			int i = 0;
+			bool converged = false;
+			for(; i < maxiter; ++i) {
+				multiply(H, x, y);
+				T diff = 0;
+				for(int r = 0; r < n; ++r) {
+					const T v = y[r] + gp[r];
+					const T d = v - x[r];
+					diff += d * d;
+					y[r] = v;
+				}
+				std::swap(x, y);
+				converged = i && (diff < limit);
+				if((recorder.tracking() && !recorder.iteration(i, std::sqrt(static_cast<double>(diff)))) || converged) {
+					break;
+				}
+			}
+			if(x != sol.data()) {
+				std::copy(x, x + n, sol.data());
+			}
+			recorder.finish(i, converged);
+			return i;
+		}
+	}
+
+	/**
+	 * Rewrite Ax=b to form x=Hx+g without building H: H = I - D^-1 A is an
+	 * operator that applies A and scales, so nothing of size n^2 is stored.
+	 * @param A any operator with diagonal(), or a matrix; it must outlive H.
+	 * @param[out] H the iteration operator for iterativeSolve()
+	 * @throws std::domain_error on a zero diagonal element
+	 */
+	template<typename Op, typename T>
+	void rewriteSystem(const Op &A,
+					   const DynamicMatrix<T> &b,
+					   LinearOperator<T> &H,
+					   DynamicMatrix<T> &g) {
+		const int n = A.rows();
+		assert(A.cols() == n && b.rows() == n);
+		std::shared_ptr<std::vector<T> > invDiag(new std::vector<T>(n));
+		g.resize(n, 1);
+		for(int i = 0; i < n; ++i) {
+			const T d = detail::diagonal(A, i);
+			if(d == T(0)) {
+				throw std::domain_error("Zero diagonal element");
+			}
+			(*invDiag)[i] = T(1) / d;
+			g(i, 0) = b(i, 0) / d;
+		}
+		const Op *a = &A;
+		H = LinearOperator<T>(n, [a, invDiag, n](const T *x, T *y) {
+			detail::multiply(*a, x, y);
+			const T *inv = invDiag->data();
+			for(int i = 0; i < n; ++i) {
+				y[i] = x[i] - y[i] * inv[i];
+			}
+		}, [](int) { return T(0); });
+	}
+
+	/** Solve x=Hx+g iteratively for an operator H; each step is one apply().
+	 * @param guess The initial guess.
+	 * @param[out] sol Solution vector.
+	 * @param[out] stats Optional: iterations, |x_k - x_(k-1)| of every iteration, time.
+	 * @param callback Optional: sees every iteration and may stop the solver.
+	 * @see iterativeSolve()
+	 */
+	template<typename Op, typename T>
+	typename std::enable_if<detail::IsLinearOperator<Op>::value, int>::type
+	iterativeSolve(const Op &H,
+				   const DynamicMatrix<T> &g,
+				   const DynamicMatrix<T> &guess,
+				   DynamicMatrix<T> &sol,
+				   double precision = 1e-5,
+				   int maxiter = 100,
+				   SolverStats *stats = nullptr,
+				   const IterationCallback &callback = IterationCallback()) {
+		return detail::operatorIterativeSolve(H, g, guess, sol, precision, maxiter, stats, callback);
+	}
+};
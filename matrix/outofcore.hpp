@@ -0,0 +1,696 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "matrix.hpp"
+#include "stats.hpp"
+
+namespace Math
+{
+	/** I/O done by an out-of-core solver, filled in when the caller passes an OutOfCoreStats*. */
+	struct OutOfCoreStats {
+		uint64_t bytesRead = 0;
+		uint64_t bytesWritten = 0;
+		/** Tiles found in the cache when the computation asked for them */
+		long hits = 0;
+		/** Tiles the computation had to read itself */
+		long misses = 0;
+		/** Tiles read ahead of time by the I/O thread */
+		long prefetched = 0;
+		/** Time the computation spent waiting for tiles to be read or written */
+		double stallSeconds = 0;
+		/** Tiles the cache could hold within the memory budget */
+		int cacheTiles = 0;
+	};
+
+	inline std::ostream& operator<<(std::ostream &os, const OutOfCoreStats &io) {
+		return os << "read " << io.bytesRead << " B, written " << io.bytesWritten << " B, "
+				  << io.hits << " hits, " << io.misses << " misses, " << io.prefetched << " prefetched, "
+				  << io.cacheTiles << " tiles cached, stalled " << io.stallSeconds << " s\n";
+	}
+
+	/**
+	 * A dense matrix kept in a file as tileSize x tileSize tiles.
+	 * Each tile is stored row-major in one contiguous block (edge tiles are
+	 * padded), so a tile costs one read. This is the working storage of the
+	 * out-of-core gauss(); fill it with setBlock(), a band of rows at a time.
+	 */
+	template<typename T>
+	class TiledMatrix
+	{
+	public:
+		typedef T Scalar;
+
+		/**
+		 * Creates (or truncates) the file, holding a zero rows x cols matrix.
+		 * @throws std::runtime_error if the file cannot be created
+		 */
+		TiledMatrix(const std::string &path, int rows, int cols, int tileSize = 256);
+		~TiledMatrix() { ::close(fd); }
+		TiledMatrix(const TiledMatrix&) = delete;
+		TiledMatrix& operator=(const TiledMatrix&) = delete;
+
+		int rows() const { return n; }
+		int cols() const { return m; }
+		int tileSize() const { return b; }
+		int tileRows() const { return (n + b - 1) / b; }
+		int tileCols() const { return (m + b - 1) / b; }
+		size_t tileBytes() const { return static_cast<size_t>(b) * b * sizeof(T); }
+		const std::string& path() const { return name; }
+
+		/** Copies the value of expr to the block starting at (row0, col0). */
+		template<typename E>
+		void setBlock(int row0, int col0, const MatrixExpr<E> &expr);
+
+		DynamicMatrix<T> block(int row0, int col0, int rows, int cols) const;
+
+		/** Tile (i, j) from/to a buffer of tileSize^2 elements; thread safe */
+		void readTile(int i, int j, T *tile) const;
+		void writeTile(int i, int j, const T *tile);
+
+	private:
+		std::string name;
+		int fd;
+		int n;
+		int m;
+		int b;
+
+		off_t offset(int i, int j) const {
+			return static_cast<off_t>(i * tileCols() + j) * static_cast<off_t>(tileBytes());
+		}
+	};
+
+	template<typename T>
+	TiledMatrix<T>::TiledMatrix(const std::string &path, int rows, int cols, int tileSize)
+		: name(path), n(rows), m(cols), b(tileSize)
+	{
+		assert(rows >= 0 && cols >= 0 && tileSize > 0);
+		fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if(fd < 0) {
+			throw std::runtime_error("Cannot create " + path);
+		}
+		if(::ftruncate(fd, offset(tileRows(), 0)) != 0) {
+			::close(fd);
+			throw std::runtime_error("Cannot allocate " + path);
+		}
+	}
+
+	template<typename T>
+	void TiledMatrix<T>::readTile(int i, int j, T *tile) const {
+		char *p = reinterpret_cast<char*>(tile);
+		size_t left = tileBytes();
+		off_t at = offset(i, j);
+		while(left > 0) {
+			ssize_t got = ::pread(fd, p, left, at);
+			if(got <= 0) {
+				throw std::runtime_error("Cannot read " + name);
+			}
+			p += got;
+			at += got;
+			left -= got;
+		}
+	}
+
+	template<typename T>
+	void TiledMatrix<T>::writeTile(int i, int j, const T *tile) {
+		const char *p = reinterpret_cast<const char*>(tile);
+		size_t left = tileBytes();
+		off_t at = offset(i, j);
+		while(left > 0) {
+			ssize_t put = ::pwrite(fd, p, left, at);
+			if(put <= 0) {
+				throw std::runtime_error("Cannot write " + name);
+			}
+			p += put;
+			at += put;
+			left -= put;
+		}
+	}
+
+	template<typename T>
+	template<typename E>
+	void TiledMatrix<T>::setBlock(int row0, int col0, const MatrixExpr<E> &expr) {
+		const typename PlainObject<E>::type src(expr);
+		const int rows = src.rows(), cols = src.cols();
+		assert(row0 >= 0 && col0 >= 0 && row0 + rows <= n && col0 + cols <= m);
+		std::vector<T> tile(static_cast<size_t>(b) * b);
+		for(int ti = row0 / b; ti * b < row0 + rows; ++ti) {
+			for(int tj = col0 / b; tj * b < col0 + cols; ++tj) {
+				readTile(ti, tj, tile.data());
+				const int r0 = std::max(row0, ti * b), r1 = std::min(row0 + rows, (ti + 1) * b);
+				const int c0 = std::max(col0, tj * b), c1 = std::min(col0 + cols, (tj + 1) * b);
+				for(int r = r0; r < r1; ++r) {
+					for(int c = c0; c < c1; ++c) {
+						tile[(r - ti * b) * b + c - tj * b] = src(r - row0, c - col0);
+					}
+				}
+				writeTile(ti, tj, tile.data());
+			}
+		}
+	}
+
+	template<typename T>
+	DynamicMatrix<T> TiledMatrix<T>::block(int row0, int col0, int rows, int cols) const {
+		assert(row0 >= 0 && col0 >= 0 && row0 + rows <= n && col0 + cols <= m);
+		DynamicMatrix<T> dst(rows, cols, uninitialized);
+		std::vector<T> tile(static_cast<size_t>(b) * b);
+		for(int ti = row0 / b; ti * b < row0 + rows; ++ti) {
+			for(int tj = col0 / b; tj * b < col0 + cols; ++tj) {
+				readTile(ti, tj, tile.data());
+				const int r0 = std::max(row0, ti * b), r1 = std::min(row0 + rows, (ti + 1) * b);
+				const int c0 = std::max(col0, tj * b), c1 = std::min(col0 + cols, (tj + 1) * b);
+				for(int r = r0; r < r1; ++r) {
+					for(int c = c0; c < c1; ++c) {
+						dst(r - row0, c - col0) = tile[(r - ti * b) * b + c - tj * b];
+					}
+				}
+			}
+		}
+		return dst;
+	}
+
+	namespace detail {
+		/**
+		 * A fixed number of tiles of a TiledMatrix held in memory.
+		 * get() pins a tile until release(); unpinned tiles are evicted least
+		 * recently used first, modified ones written back. prefetch() hands a
+		 * tile to an I/O thread, which reads it while the caller computes;
+		 * prefetching never evicts a pinned tile or one prefetched and not yet
+		 * used, so reading ahead cannot throw out the work at hand.
+		 */
+		template<typename T>
+		class TileCache
+		{
+		public:
+			TileCache(TiledMatrix<T> &file, int capacity, OutOfCoreStats &io);
+			~TileCache();
+
+			T* get(int i, int j);
+			void release(int i, int j, bool dirty);
+			void prefetch(int i, int j);
+			/** Writes back every modified tile */
+			void flush();
+
+		private:
+			enum State { Free, Loading, Ready, Evicting };
+			struct Slot {
+				T *data;
+				int tile;
+				State state;
+				bool dirty;
+				/* prefetched, not used yet */
+				bool fresh;
+				int pins;
+				uint64_t used;
+			};
+
+			TiledMatrix<T> &file;
+			OutOfCoreStats &io;
+			DynamicMatrix<T> storage;
+			std::vector<Slot> slots;
+			/* slot of every tile, -1 if it is not cached */
+			std::vector<int> where;
+			std::deque<int> requests;
+			std::mutex mutex;
+			std::condition_variable changed;
+			std::condition_variable requested;
+			uint64_t clock;
+			bool stop;
+			std::thread worker;
+
+			int victim(bool prefetching) const;
+			int acquire(std::unique_lock<std::mutex> &lock, bool prefetching);
+			void load(std::unique_lock<std::mutex> &lock, int tile, int slot, bool prefetching);
+			void ioLoop();
+		};
+
+		template<typename T>
+		TileCache<T>::TileCache(TiledMatrix<T> &file, int capacity, OutOfCoreStats &io)
+			: file(file), io(io), storage(capacity, file.tileSize() * file.tileSize(), uninitialized),
+			  slots(capacity), where(file.tileRows() * file.tileCols(), -1), clock(0), stop(false)
+		{
+			for(int s = 0; s < capacity; ++s) {
+				Slot slot = {storage.data() + static_cast<size_t>(s) * storage.cols(), -1, Free, false, false, 0, 0};
+				slots[s] = slot;
+			}
+			worker = std::thread([this]() { ioLoop(); });
+		}
+
+		template<typename T>
+		TileCache<T>::~TileCache() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stop = true;
+			}
+			requested.notify_one();
+			worker.join();
+		}
+
+		/* a free slot, else the least recently used tile that may go */
+		template<typename T>
+		int TileCache<T>::victim(bool prefetching) const {
+			int best = -1;
+			for(int s = 0; s < static_cast<int>(slots.size()); ++s) {
+				const Slot &slot = slots[s];
+				if(slot.state == Free) {
+					return s;
+				}
+				if(slot.state == Ready && slot.pins == 0 && !(prefetching && slot.fresh) &&
+				   (best < 0 || slot.used < slots[best].used)) {
+					best = s;
+				}
+			}
+			return best;
+		}
+
+		/**
+		 * Empties a slot, writing its tile back if needed; the lock is dropped
+		 * during the write. Returns -1 if a prefetch finds nothing to evict.
+		 */
+		template<typename T>
+		int TileCache<T>::acquire(std::unique_lock<std::mutex> &lock, bool prefetching) {
+			for(;;) {
+				int s = victim(prefetching);
+				if(s < 0) {
+					if(prefetching) {
+						return -1;
+					}
+					bool busy = false;
+					for(const Slot &slot : slots) {
+						busy = busy || slot.state == Loading || slot.state == Evicting;
+					}
+					if(!busy) {
+						throw std::runtime_error("Memory budget too small: every cached tile is in use");
+					}
+					changed.wait(lock);
+					continue;
+				}
+				Slot &slot = slots[s];
+				if(slot.state == Ready) {
+					if(slot.dirty) {
+						slot.state = Evicting;
+						const int tile = slot.tile, tc = file.tileCols();
+						lock.unlock();
+						try {
+							file.writeTile(tile / tc, tile % tc, slot.data);
+						} catch(...) {
+							lock.lock();
+							slot.state = Ready;
+							changed.notify_all();
+							throw;
+						}
+						lock.lock();
+						io.bytesWritten += file.tileBytes();
+						slot.dirty = false;
+					}
+					where[slot.tile] = -1;
+				}
+				slot.state = Free;
+				slot.tile = -1;
+				slot.fresh = false;
+				changed.notify_all();
+				return s;
+			}
+		}
+
+		template<typename T>
+		void TileCache<T>::load(std::unique_lock<std::mutex> &lock, int tile, int s, bool prefetching) {
+			Slot &slot = slots[s];
+			slot.state = Loading;
+			slot.tile = tile;
+			where[tile] = s;
+			const int tc = file.tileCols();
+			lock.unlock();
+			try {
+				file.readTile(tile / tc, tile % tc, slot.data);
+			} catch(...) {
+				lock.lock();
+				where[tile] = -1;
+				slot.state = Free;
+				slot.tile = -1;
+				changed.notify_all();
+				throw;
+			}
+			lock.lock();
+			slot.state = Ready;
+			slot.dirty = false;
+			slot.fresh = prefetching;
+			slot.used = ++clock;
+			io.bytesRead += file.tileBytes();
+			++(prefetching ? io.prefetched : io.misses);
+			changed.notify_all();
+		}
+
+		template<typename T>
+		T* TileCache<T>::get(int i, int j) {
+			const int tile = i * file.tileCols() + j;
+			std::unique_lock<std::mutex> lock(mutex);
+			const auto start = std::chrono::steady_clock::now();
+			bool waited = false;
+			for(;;) {
+				const int s = where[tile];
+				if(s >= 0 && slots[s].state == Ready) {
+					Slot &slot = slots[s];
+					++slot.pins;
+					slot.used = ++clock;
+					slot.fresh = false;
+					if(waited) {
+						std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+						io.stallSeconds += d.count();
+					} else {
+						++io.hits;
+					}
+					return slot.data;
+				}
+				waited = true;
+				if(s >= 0) {
+					/* being read ahead, or written back before it is read again */
+					changed.wait(lock);
+					continue;
+				}
+				const int free = acquire(lock, false);
+				if(where[tile] < 0) {
+					load(lock, tile, free, false);
+				}
+			}
+		}
+
+		template<typename T>
+		void TileCache<T>::release(int i, int j, bool dirty) {
+			std::lock_guard<std::mutex> lock(mutex);
+			Slot &slot = slots[where[i * file.tileCols() + j]];
+			assert(slot.pins > 0);
+			--slot.pins;
+			slot.dirty = slot.dirty || dirty;
+			slot.used = ++clock;
+			changed.notify_all();
+		}
+
+		template<typename T>
+		void TileCache<T>::prefetch(int i, int j) {
+			const int tile = i * file.tileCols() + j;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if(where[tile] >= 0) {
+					return;
+				}
+				requests.push_back(tile);
+			}
+			requested.notify_one();
+		}
+
+		template<typename T>
+		void TileCache<T>::ioLoop() {
+			std::unique_lock<std::mutex> lock(mutex);
+			for(;;) {
+				requested.wait(lock, [this]() { return stop || !requests.empty(); });
+				if(stop) {
+					return;
+				}
+				const int tile = requests.front();
+				requests.pop_front();
+				if(where[tile] >= 0) {
+					continue;
+				}
+				/* a failed read ahead is dropped: get() reads the tile again and reports the error */
+				try {
+					const int s = acquire(lock, true);
+					if(s >= 0 && where[tile] < 0) {
+						load(lock, tile, s, true);
+					}
+				} catch(const std::exception&) {
+				}
+			}
+		}
+
+		template<typename T>
+		void TileCache<T>::flush() {
+			std::unique_lock<std::mutex> lock(mutex);
+			requests.clear();
+			changed.wait(lock, [this]() {
+				for(const Slot &slot : slots) {
+					if(slot.state == Loading || slot.state == Evicting) {
+						return false;
+					}
+				}
+				return true;
+			});
+			const int tc = file.tileCols();
+			for(Slot &slot : slots) {
+				if(slot.state == Ready && slot.dirty) {
+					file.writeTile(slot.tile / tc, slot.tile % tc, slot.data);
+					io.bytesWritten += file.tileBytes();
+					slot.dirty = false;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Out-of-core Gauss elimination for an n x (n+s) extended matrix that
+	 * does not fit in memory.
+	 * The matrix is factored by tile columns (right-looking blocked LU with
+	 * partial pivoting): a panel of one tile column is factored in memory,
+	 * then the tile columns right of it are pivoted and updated one by one
+	 * with gemm(). Tiles go through a cache of at most memoryBudget bytes,
+	 * and the tiles needed next are read by an I/O thread while the panel
+	 * and the current column are computed. The budget must hold two tile
+	 * columns (the panel and the column being updated); a third lets the
+	 * reads fully overlap the computation.
+	 *
+	 * Like gauss(), works in place: afterwards the file holds the factors
+	 * and the transformed right-hand sides. Rows are swapped, never the
+	 * unknowns; the swaps of a panel are not applied to the panels before it.
+	 * @param[out] x Resized to n x s; held in memory outside the budget.
+	 * @param[out] io Optional: bytes read and written, cache hits, time stalled on I/O.
+	 * @param[out] stats Optional: pivot growth, row swaps, small pivots and time.
+	 * @param eps Pivots smaller than this are counted in SolverStats::smallPivots.
+	 * @throws std::domain_error if A is singular
+	 * @throws std::runtime_error if the budget is too small or the file cannot be read or written
+	 */
+	template<typename T>
+	void gauss(TiledMatrix<T> &mat, DynamicMatrix<T> &x, size_t memoryBudget,
+			   OutOfCoreStats *io = nullptr, SolverStats *stats = nullptr, double eps = 1e-5) {
+		const int n = mat.rows();
+		const int s = mat.cols() - n;
+		assert(s >= 0);
+		const int b = mat.tileSize();
+		const int nt = mat.tileRows();
+		const int ct = mat.tileCols();
+		const size_t capacity = std::min(memoryBudget / mat.tileBytes(), static_cast<size_t>(nt) * ct);
+		if(capacity < static_cast<size_t>(2 * nt)) {
+			throw std::runtime_error("Memory budget too small: out-of-core gauss needs two tile columns");
+		}
+		detail::StatsRecorder recorder(stats);
+		OutOfCoreStats local;
+		OutOfCoreStats &ioStats = io ? *io : local;
+		ioStats = OutOfCoreStats();
+		ioStats.cacheTiles = static_cast<int>(capacity);
+		detail::TileCache<T> cache(mat, static_cast<int>(capacity), ioStats);
+
+		auto height = [&](int i) { return std::min(b, n - i * b); };
+		auto width = [&](int j) { return std::min(b, n + s - j * b); };
+		auto prefetchColumn = [&](int j, int fromRow) {
+			for(int i = fromRow; i < nt; ++i) {
+				cache.prefetch(i, j);
+			}
+		};
+		/* row r (global) of a pinned tile column */
+		std::vector<T*> panel(nt), column(nt);
+		auto row = [&](const std::vector<T*> &tiles, int r) { return tiles[r / b] + (r % b) * b; };
+		double maxA = 0, maxU = 0;
+		auto maxAbs = [&](const T *p, int count) {
+			double max = 0;
+			for(int c = 0; c < count; ++c) {
+				max = std::max(max, std::abs(static_cast<double>(p[c])));
+			}
+			return max;
+		};
+		std::vector<int> pivots(b);
+
+		prefetchColumn(0, 0);
+		for(int k = 0; k < nt; ++k) {
+			const int k0 = k * b;
+			const int kb = height(k);
+			for(int i = k; i < nt; ++i) {
+				panel[i] = cache.get(i, k);
+			}
+			/* the first column to update is read while the panel is factored */
+			const int first = (kb < width(k)) ? k : k + 1;
+			if(first < ct) {
+				prefetchColumn(first, k);
+			}
+			if(recorder.active() && k == 0) {
+				for(int r = 0; r < n; ++r) {
+					maxA = std::max(maxA, maxAbs(row(panel, r), std::min(width(0), n)));
+				}
+			}
+
+			/* panel: unblocked LU of columns k0..k0+kb-1, whole tile rows swapped */
+			for(int c = 0; c < kb; ++c) {
+				const int r = k0 + c;
+				int p = r;
+				double best = std::abs(static_cast<double>(row(panel, r)[c]));
+				for(int i = r + 1; i < n; ++i) {
+					double v = std::abs(static_cast<double>(row(panel, i)[c]));
+					if(v > best) {
+						best = v;
+						p = i;
+					}
+				}
+				if(best == 0) {
+					for(int i = k; i < nt; ++i) {
+						cache.release(i, k, true);
+					}
+					throw std::domain_error("Not invertible matrix");
+				}
+				pivots[c] = p;
+				T *pivotRow = row(panel, r);
+				if(p != r) {
+					std::swap_ranges(pivotRow, pivotRow + width(k), row(panel, p));
+					if(recorder.active()) {
+						++recorder->swaps;
+					}
+				}
+				if(recorder.active()) {
+					if(best < eps) {
+						++recorder->smallPivots;
+					}
+					maxU = std::max(maxU, maxAbs(pivotRow + c, kb - c));
+				}
+				const T pivotInv = T(1) / pivotRow[c];
+				for(int i = r + 1; i < n; ++i) {
+					T *ri = row(panel, i);
+					const T l = ri[c] * pivotInv;
+					ri[c] = l;
+					for(int cc = c + 1; cc < kb; ++cc) {
+						ri[cc] -= l * pivotRow[cc];
+					}
+				}
+			}
+
+			/* trailing tile columns: swap rows, U_kj = L_kk^-1 A_kj, A_ij -= L_ik U_kj */
+			for(int j = first; j < ct; ++j) {
+				const int c0 = (j == k) ? kb : 0;
+				const int c1 = width(j);
+				if(j + 1 < ct) {
+					prefetchColumn(j + 1, k);
+				} else if(k + 1 < nt) {
+					prefetchColumn(k + 1, k + 1);
+				}
+				for(int i = k; i < nt; ++i) {
+					column[i] = cache.get(i, j);
+				}
+				if(recorder.active() && k == 0 && j > 0) {
+					for(int r = 0; r < n; ++r) {
+						maxA = std::max(maxA, maxAbs(row(column, r), std::max(0, std::min(c1, n - j * b))));
+					}
+				}
+				if(j != k) {
+					for(int c = 0; c < kb; ++c) {
+						if(pivots[c] != k0 + c) {
+							std::swap_ranges(row(column, k0 + c), row(column, k0 + c) + c1, row(column, pivots[c]));
+						}
+					}
+				}
+				T *U = column[k];
+				const T *L = panel[k];
+				for(int r = 1; r < kb; ++r) {
+					for(int p = 0; p < r; ++p) {
+						const T l = L[r * b + p];
+						for(int c = c0; c < c1; ++c) {
+							U[r * b + c] -= l * U[p * b + c];
+						}
+					}
+				}
+				if(recorder.active()) {
+					const int cA = std::min(c1, n - j * b);
+					for(int r = 0; r < kb && cA > c0; ++r) {
+						maxU = std::max(maxU, maxAbs(U + r * b + c0, cA - c0));
+					}
+				}
+				for(int i = k + 1; i < nt; ++i) {
+					gemm(height(i), c1 - c0, kb, T(-1),
+						 panel[i], b, 1,
+						 U + c0, b, 1,
+						 T(1), column[i] + c0, b, 1);
+				}
+				for(int i = k; i < nt; ++i) {
+					cache.release(i, j, true);
+				}
+			}
+			for(int i = k; i < nt; ++i) {
+				cache.release(i, k, true);
+			}
+		}
+
+		/* back substitution U*X = Y, one tile row at a time from the bottom */
+		x.resize(n, s);
+		if(s > 0) {
+			for(int i = 0; i < nt; ++i) {
+				for(int j = n / b; j < ct; ++j) {
+					const T *tile = cache.get(i, j);
+					for(int r = 0; r < height(i); ++r) {
+						for(int c = std::max(0, n - j * b); c < width(j); ++c) {
+							x(i * b + r, j * b + c - n) = tile[r * b + c];
+						}
+					}
+					cache.release(i, j, false);
+				}
+			}
+			T *X = x.data();
+			for(int k = nt - 1; k >= 0; --k) {
+				const int k0 = k * b;
+				const int kb = height(k);
+				if(k > 0) {
+					for(int j = k - 1; j < nt; ++j) {
+						cache.prefetch(k - 1, j);
+					}
+				}
+				for(int j = k + 1; j < nt; ++j) {
+					const T *U = cache.get(k, j);
+					gemm(kb, s, std::min(b, n - j * b), T(-1),
+						 U, b, 1,
+						 X + j * b * s, s, 1,
+						 T(1), X + k0 * s, s, 1);
+					cache.release(k, j, false);
+				}
+				const T *U = cache.get(k, k);
+				for(int r = kb - 1; r >= 0; --r) {
+					T *xr = X + (k0 + r) * s;
+					for(int p = r + 1; p < kb; ++p) {
+						const T u = U[r * b + p];
+						const T *xp = X + (k0 + p) * s;
+						for(int c = 0; c < s; ++c) {
+							xr[c] -= u * xp[c];
+						}
+					}
+					const T uInv = T(1) / U[r * b + r];
+					for(int c = 0; c < s; ++c) {
+						xr[c] *= uInv;
+					}
+				}
+				cache.release(k, k, false);
+			}
+		}
+		cache.flush();
+		if(recorder.active()) {
+			recorder->pivotGrowth = (maxA > 0) ? maxU / maxA : 0;
+		}
+		recorder.finish(n);
+	}
+};
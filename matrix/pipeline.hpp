@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <assert.h>
+
+namespace Math
+{
+	/** What a BoundedQueue went through, for tuning its capacity. */
+	struct QueueStats {
+		int capacity = 0;
+		/** Items that went through */
+		long pushed = 0;
+		/** Largest and time-averaged number of items waiting */
+		int maxSize = 0;
+		double meanSize = 0;
+		/** Pushes that found the queue full, pops that found it empty */
+		long fullWaits = 0;
+		long emptyWaits = 0;
+	};
+
+	inline std::ostream& operator<<(std::ostream &os, const QueueStats &stats) {
+		return os << "capacity " << stats.capacity << ", mean " << stats.meanSize
+				  << ", max " << stats.maxSize << ", full waits " << stats.fullWaits
+				  << ", empty waits " << stats.emptyWaits;
+	}
+
+	/**
+	 * A FIFO between threads holding at most `capacity` items: push() blocks
+	 * while it is full and pop() while it is empty, so a fast producer cannot
+	 * run ahead of a slow consumer by more than the capacity.
+	 */
+	template<typename T>
+	class BoundedQueue
+	{
+	public:
+		explicit BoundedQueue(int capacity) : capacity(std::max(1, capacity)), closed(false) {
+			counters.capacity = this->capacity;
+			start = last = std::chrono::steady_clock::now();
+		}
+
+		/**
+		 * Waits for room and appends the item.
+		 * @returns false if the queue was closed; the item is dropped
+		 */
+		bool push(T item) {
+			std::unique_lock<std::mutex> lock(mutex);
+			if(!closed && static_cast<int>(items.size()) >= capacity) {
+				++counters.fullWaits;
+				notFull.wait(lock, [this] { return closed || static_cast<int>(items.size()) < capacity; });
+			}
+			if(closed) {
+				return false;
+			}
+			account();
+			items.push_back(std::move(item));
+			++counters.pushed;
+			counters.maxSize = std::max(counters.maxSize, static_cast<int>(items.size()));
+			lock.unlock();
+			notEmpty.notify_one();
+			return true;
+		}
+
+		/**
+		 * Waits for an item and takes it.
+		 * @returns false once the queue is closed and empty
+		 */
+		bool pop(T &item) {
+			std::unique_lock<std::mutex> lock(mutex);
+			if(!closed && items.empty()) {
+				++counters.emptyWaits;
+				notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+			}
+			if(items.empty()) {
+				return false;
+			}
+			account();
+			item = std::move(items.front());
+			items.pop_front();
+			lock.unlock();
+			notFull.notify_one();
+			return true;
+		}
+
+		/** No more pushes; pop() still returns what is queued. */
+		void close() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				closed = true;
+			}
+			notFull.notify_all();
+			notEmpty.notify_all();
+		}
+
+		/** Closes the queue and drops what is queued. */
+		void cancel() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				closed = true;
+				account();
+				items.clear();
+			}
+			notFull.notify_all();
+			notEmpty.notify_all();
+		}
+
+		QueueStats stats() const {
+			std::lock_guard<std::mutex> lock(mutex);
+			QueueStats s = counters;
+			std::chrono::duration<double> total = last - start;
+			s.meanSize = (total.count() > 0) ? area / total.count() : 0;
+			return s;
+		}
+
+	private:
+		const int capacity;
+		std::deque<T> items;
+		mutable std::mutex mutex;
+		std::condition_variable notFull, notEmpty;
+		bool closed;
+		QueueStats counters;
+		/* integral of the size over time, for the mean */
+		double area = 0;
+		std::chrono::steady_clock::time_point start, last;
+
+		/* adds the time since the last change at the current size; lock held */
+		void account() {
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			std::chrono::duration<double> d = now - last;
+			area += d.count() * items.size();
+			last = now;
+		}
+
+		BoundedQueue(const BoundedQueue&);
+		BoundedQueue& operator=(const BoundedQueue&);
+	};
+
+	struct PipelineOptions {
+		/** Threads running the work stage; 0 means one per core */
+		int workers = 0;
+		/** Capacity of the queues between the stages */
+		int queueSize = 64;
+		/** Write results in input order rather than as they complete */
+		bool ordered = true;
+	};
+
+	/** What runPipeline() did */
+	struct PipelineStats {
+		/** Items written */
+		long items = 0;
+		int workers = 0;
+		/** Wall time from the first read to the last write */
+		double seconds = 0;
+		/** Ordered output: most results held back waiting for an earlier one */
+		int maxReorder = 0;
+		/** Between reading and work, and between work and writing */
+		QueueStats input, output;
+
+		double throughput() const { return (seconds > 0) ? items / seconds : 0; }
+	};
+
+	inline std::ostream& operator<<(std::ostream &os, const PipelineStats &stats) {
+		os << "items " << stats.items << ", " << stats.seconds << " s, "
+		   << stats.throughput() << " items/s, " << stats.workers << " workers";
+		if(stats.maxReorder > 0) {
+			os << ", reorder max " << stats.maxReorder;
+		}
+		return os << "\ninput queue: " << stats.input << "\noutput queue: " << stats.output << "\n";
+	}
+
+	namespace detail {
+		/* first exception of any stage; stops the others through their queues */
+		class PipelineError
+		{
+		public:
+			template<typename F>
+			void fail(F cancel) {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if(!error) {
+						error = std::current_exception();
+					}
+				}
+				cancel();
+			}
+
+			void rethrow() {
+				if(error) {
+					std::rethrow_exception(error);
+				}
+			}
+
+		private:
+			std::mutex mutex;
+			std::exception_ptr error;
+		};
+	}
+
+	/**
+	 * Runs three stages connected by BoundedQueues: read(In&) fills in the
+	 * next item and returns false at the end of the input, work(In&) turns it
+	 * into a result on one of `workers` threads, and write(long index, Out&)
+	 * gets the results with their position in the input. Reading has a thread
+	 * of its own, writing runs on the calling thread.
+	 *
+	 * Ordered output holds a result back until the ones before it are written;
+	 * reading then stays at most 2 * queueSize + workers items ahead of
+	 * writing, so one slow item cannot fill memory with finished ones.
+	 * The first exception of any stage stops the pipeline and is rethrown.
+	 */
+	template<typename In, typename Read, typename Work, typename Write>
+	PipelineStats runPipeline(Read read, Work work, Write write, const PipelineOptions &options = PipelineOptions()) {
+		typedef typename std::decay<typename std::result_of<Work(In&)>::type>::type Out;
+		typedef std::pair<long, In> Job;
+		typedef std::pair<long, Out> Result;
+
+		const int workers = (options.workers > 0)
+			? options.workers : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+		const int window = 2 * options.queueSize + workers;
+		BoundedQueue<Job> input(options.queueSize);
+		BoundedQueue<Result> output(options.queueSize);
+		/* ordered output: a slot is taken per item read and given back when it is written */
+		BoundedQueue<char> slots(window);
+		if(options.ordered) {
+			for(int i = 0; i < window; ++i) {
+				slots.push(0);
+			}
+		}
+		detail::PipelineError error;
+		auto cancel = [&]() {
+			input.cancel();
+			output.cancel();
+			slots.cancel();
+		};
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		std::thread reader([&]() {
+			try {
+				char slot;
+				for(long index = 0; ; ++index) {
+					Job job;
+					job.first = index;
+					if(!read(job.second)) {
+						break;
+					}
+					if((options.ordered && !slots.pop(slot)) || !input.push(std::move(job))) {
+						break;
+					}
+				}
+			} catch(...) {
+				error.fail(cancel);
+			}
+			input.close();
+		});
+
+		std::atomic<int> running(workers);
+		std::vector<std::thread> pool;
+		for(int w = 0; w < workers; ++w) {
+			pool.push_back(std::thread([&]() {
+				try {
+					Job job;
+					while(input.pop(job)) {
+						Result r(job.first, work(job.second));
+						if(!output.push(std::move(r))) {
+							break;
+						}
+					}
+				} catch(...) {
+					error.fail(cancel);
+				}
+				if(--running == 0) {
+					output.close();
+				}
+			}));
+		}
+
+		PipelineStats stats;
+		stats.workers = workers;
+		try {
+			std::map<long, Out> held;
+			long next = 0;
+			Result r;
+			while(output.pop(r)) {
+				if(!options.ordered) {
+					write(r.first, r.second);
+					++stats.items;
+					continue;
+				}
+				held.insert(std::make_pair(r.first, std::move(r.second)));
+				stats.maxReorder = std::max(stats.maxReorder, static_cast<int>(held.size()) - 1);
+				for(auto it = held.begin(); it != held.end() && it->first == next; it = held.erase(it), ++next) {
+					write(it->first, it->second);
+					++stats.items;
+					slots.push(0);
+				}
+			}
+		} catch(...) {
+			error.fail(cancel);
+		}
+
+		reader.join();
+		for(std::thread &t : pool) {
+			t.join();
+		}
+		std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+		stats.seconds = d.count();
+		stats.input = input.stats();
+		stats.output = output.stats();
+		error.rethrow();
+		return stats;
+	}
+};
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <algorithm>
+
+#include "condition.hpp"
+#include "lu.hpp"
+#include "stats.hpp"
+
+namespace Math
+{
+	namespace detail {
+		/** max |a_ij| over column k */
+		template<typename M>
+		double columnMaxAbs(const M &a, int k) {
+			double max = 0;
+			for(int i = 0; i < a.rows(); ++i) {
+				max = std::max(max, std::abs(static_cast<double>(a(i, k))));
+			}
+			return max;
+		}
+	}
+
+	/**
+	 * Mixed-precision linear solver: A is factored once by LUFactorization in
+	 * the low precision (float by default, half the memory traffic and twice
+	 * the SIMD width), and every solution is refined in the precision of A:
+	 *
+	 *     r = b - A*x,  solve A*d = r with the low-precision factors,  x += d
+	 *
+	 * until the normwise backward error |r| / (|A| |x| + |b|) drops below the
+	 * tolerance. When refinement stalls (a correction is not at least half the
+	 * previous one), does not converge, or A does not fit the low precision,
+	 * the solver factors A in full precision and uses that from then on.
+	 * @tparam MatrixType Matrix<double, n, n, Layout> or DynamicMatrix<double>; A is kept row-major
+	 * @tparam Low element type of the factorization
+	 */
+	template<typename MatrixType, typename Low = float>
+	class MixedPrecisionSolver
+	{
+	public:
+		typedef typename MatrixType::Scalar Scalar;
+		typedef typename PlainObject<CastExpr<Low, MatrixType> >::type LowMatrix;
+
+		/**
+		 * @param tolerance Normwise backward error to reach, in the precision of A.
+		 * @param maxIterations Refinement steps before falling back.
+		 */
+		explicit MixedPrecisionSolver(const MatrixType &mat, double tolerance = 1e-14, int maxIterations = 30);
+
+		/**
+		 * Solves A*X = B for every column of B.
+		 * @param[out] stats Optional: refinement steps, the backward error of each, time.
+		 *                   After a fallback the last error is that of the full-precision
+		 *                   solution, and converged tells whether it met the tolerance.
+		 * @throws std::domain_error if A is singular
+		 */
+		template<typename Rhs>
+		typename PlainObject<Rhs>::type solve(const MatrixExpr<Rhs> &b, SolverStats *stats = nullptr);
+
+		/** True once the solver has fallen back to a full-precision factorization */
+		bool fullPrecision() const { return high != nullptr; }
+
+	private:
+		/* row-major, so the residual rows are contiguous */
+		typename detail::RowMajorOf<MatrixType>::type a;
+		double normA;
+		double tolerance;
+		int maxIterations;
+		std::unique_ptr<LUFactorization<LowMatrix> > low;
+		std::unique_ptr<LUFactorization<MatrixType> > high;
+
+		void fallBack();
+	};
+
+	template<typename MatrixType, typename Low>
+	MixedPrecisionSolver<MatrixType, Low>::MixedPrecisionSolver(const MatrixType &mat, double tolerance,
+																int maxIterations)
+		: a(mat), normA(detail::normInf(mat)), tolerance(tolerance), maxIterations(maxIterations)
+	{
+		assert(mat.rows() == mat.cols());
+		/* elements beyond the range of Low would turn into inf */
+		if(!(normA < static_cast<double>(std::numeric_limits<Low>::max()))) {
+			fallBack();
+			return;
+		}
+		low.reset(new LUFactorization<LowMatrix>(LowMatrix(cast<Low>(a))));
+		if(!low->invertible()) {
+			/* singular in Low may still be regular in full precision */
+			fallBack();
+		}
+	}
+
+	template<typename MatrixType, typename Low>
+	void MixedPrecisionSolver<MatrixType, Low>::fallBack() {
+		if(!high) {
+			high.reset(new LUFactorization<MatrixType>(a));
+			low.reset();
+		}
+	}
+
+	template<typename MatrixType, typename Low>
+	template<typename Rhs>
+	typename PlainObject<Rhs>::type MixedPrecisionSolver<MatrixType, Low>::solve(const MatrixExpr<Rhs> &rhs,
+																				 SolverStats *stats) {
+		typedef typename PlainObject<Rhs>::type Result;
+		detail::StatsRecorder recorder(stats);
+		const Result b(rhs);
+		assert(b.rows() == a.rows());
+		const int s = b.cols();
+
+		std::vector<double> normB(s);
+		for(int k = 0; k < s; ++k) {
+			normB[k] = detail::columnMaxAbs(b, k);
+		}
+		/* r = b - A*x and the largest backward error of the columns, in full precision */
+		Result r(b);
+		auto backwardError = [&](const Result &x) {
+			if(s == 1) {
+				const int n = a.rows();
+				for(int i = 0; i < n; ++i) {
+					r(i, 0) = b(i, 0) - detail::rowDot(a.data() + i * n, x.data(), n);
+				}
+			} else {
+				r = b;
+				r -= dot(a, x);
+			}
+			double error = 0;
+			for(int k = 0; k < s; ++k) {
+				double scale = normA * detail::columnMaxAbs(x, k) + normB[k];
+				double rk = detail::columnMaxAbs(r, k);
+				error = std::max(error, scale > 0 ? rk / scale : rk);
+			}
+			return error;
+		};
+
+		int iter = 0;
+		if(low) {
+			Result x(cast<Scalar>(low->solve(cast<Low>(b))));
+			double lastCorrection = std::numeric_limits<double>::infinity();
+			for(; iter < maxIterations; ++iter) {
+				const double error = backwardError(x);
+				recorder.iteration(iter, error);
+				if(error <= tolerance) {
+					recorder.finish(iter, true);
+					return x;
+				}
+				const Result d(cast<Scalar>(low->solve(cast<Low>(r))));
+				double correction = 0;
+				for(int k = 0; k < s; ++k) {
+					correction = std::max(correction, detail::columnMaxAbs(d, k));
+				}
+				/* also catches NaN from an overflow in Low */
+				if(!(correction <= 0.5 * lastCorrection)) {
+					++iter;
+					break;
+				}
+				lastCorrection = correction;
+				x += d;
+			}
+			fallBack();
+		}
+		/* the full-precision solution is measured like the refined ones, not assumed converged */
+		Result x(high->solve(b));
+		const double error = backwardError(x);
+		recorder.iteration(iter, error);
+		recorder.finish(iter, error <= tolerance);
+		return x;
+	}
+};
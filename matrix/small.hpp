@@ -0,0 +1,345 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Kernels for matrices whose size is a template parameter and small enough
+ * to live in registers. Every loop bound is a compile-time constant, so the
+ * compiler unrolls the loops completely, and the matrices are plain
+ * row-major arrays, so nothing is bounds-checked. Matrix<T, n, m> gets them
+ * through dot(), gauss(), invert(), determinant() and euclidNorm() up to
+ * smallSize x smallSize; SmallBatch uses the closed forms with vector lanes.
+ */
+namespace Math
+{
+	namespace detail {
+		const int smallSize = 8;
+
+		/**
+		 * Closed-form determinant and adjugate of an n x n matrix a (row-major),
+		 * A^-1 = adj / det. V is a scalar or a vector of lanes.
+		 */
+		template<int n>
+		struct SmallInverse;
+
+		template<>
+		struct SmallInverse<2> {
+			template<typename V>
+			static void determinant(const V *a, V &det) {
+				det = a[0] * a[3] - a[1] * a[2];
+			}
+
+			template<typename V>
+			static void adjugate(const V *a, V *b, V &det) {
+				b[0] = a[3];
+				b[1] = -a[1];
+				b[2] = -a[2];
+				b[3] = a[0];
+				determinant(a, det);
+			}
+		};
+
+		template<>
+		struct SmallInverse<3> {
+			template<typename V>
+			static void determinant(const V *a, V &det) {
+				det = a[0] * (a[4] * a[8] - a[5] * a[7])
+					- a[1] * (a[3] * a[8] - a[5] * a[6])
+					+ a[2] * (a[3] * a[7] - a[4] * a[6]);
+			}
+
+			template<typename V>
+			static void adjugate(const V *a, V *b, V &det) {
+				b[0] = a[4] * a[8] - a[5] * a[7];
+				b[1] = a[2] * a[7] - a[1] * a[8];
+				b[2] = a[1] * a[5] - a[2] * a[4];
+				b[3] = a[5] * a[6] - a[3] * a[8];
+				b[4] = a[0] * a[8] - a[2] * a[6];
+				b[5] = a[2] * a[3] - a[0] * a[5];
+				b[6] = a[3] * a[7] - a[4] * a[6];
+				b[7] = a[1] * a[6] - a[0] * a[7];
+				b[8] = a[0] * a[4] - a[1] * a[3];
+				det = a[0] * b[0] + a[1] * b[3] + a[2] * b[6];
+			}
+		};
+
+		/* 4x4 through the 2x2 minors of the top (s) and bottom (c) row pairs */
+		template<>
+		struct SmallInverse<4> {
+			template<typename V>
+			static void determinant(const V *a, V &det) {
+				V s0 = a[0] * a[5] - a[4] * a[1];
+				V s1 = a[0] * a[6] - a[4] * a[2];
+				V s2 = a[0] * a[7] - a[4] * a[3];
+				V s3 = a[1] * a[6] - a[5] * a[2];
+				V s4 = a[1] * a[7] - a[5] * a[3];
+				V s5 = a[2] * a[7] - a[6] * a[3];
+				V c5 = a[10] * a[15] - a[14] * a[11];
+				V c4 = a[9] * a[15] - a[13] * a[11];
+				V c3 = a[9] * a[14] - a[13] * a[10];
+				V c2 = a[8] * a[15] - a[12] * a[11];
+				V c1 = a[8] * a[14] - a[12] * a[10];
+				V c0 = a[8] * a[13] - a[12] * a[9];
+				det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			}
+
+			template<typename V>
+			static void adjugate(const V *a, V *b, V &det) {
+				V s0 = a[0] * a[5] - a[4] * a[1];
+				V s1 = a[0] * a[6] - a[4] * a[2];
+				V s2 = a[0] * a[7] - a[4] * a[3];
+				V s3 = a[1] * a[6] - a[5] * a[2];
+				V s4 = a[1] * a[7] - a[5] * a[3];
+				V s5 = a[2] * a[7] - a[6] * a[3];
+				V c5 = a[10] * a[15] - a[14] * a[11];
+				V c4 = a[9] * a[15] - a[13] * a[11];
+				V c3 = a[9] * a[14] - a[13] * a[10];
+				V c2 = a[8] * a[15] - a[12] * a[11];
+				V c1 = a[8] * a[14] - a[12] * a[10];
+				V c0 = a[8] * a[13] - a[12] * a[9];
+
+				b[0] = a[5] * c5 - a[6] * c4 + a[7] * c3;
+				b[1] = -a[1] * c5 + a[2] * c4 - a[3] * c3;
+				b[2] = a[13] * s5 - a[14] * s4 + a[15] * s3;
+				b[3] = -a[9] * s5 + a[10] * s4 - a[11] * s3;
+				b[4] = -a[4] * c5 + a[6] * c2 - a[7] * c1;
+				b[5] = a[0] * c5 - a[2] * c2 + a[3] * c1;
+				b[6] = -a[12] * s5 + a[14] * s2 - a[15] * s1;
+				b[7] = a[8] * s5 - a[10] * s2 + a[11] * s1;
+				b[8] = a[4] * c4 - a[5] * c2 + a[7] * c0;
+				b[9] = -a[0] * c4 + a[1] * c2 - a[3] * c0;
+				b[10] = a[12] * s4 - a[13] * s2 + a[15] * s0;
+				b[11] = -a[8] * s4 + a[9] * s2 - a[11] * s0;
+				b[12] = -a[4] * c3 + a[5] * c1 - a[6] * c0;
+				b[13] = a[0] * c3 - a[1] * c1 + a[2] * c0;
+				b[14] = -a[12] * s3 + a[13] * s1 - a[14] * s0;
+				b[15] = a[8] * s3 - a[9] * s1 + a[10] * s0;
+				det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			}
+		};
+
+		/**
+		 * How an n x n matrix is inverted or its determinant taken:
+		 * 2 closed form, 1 unrolled elimination, 0 the generic code.
+		 */
+		template<int n>
+		struct SmallMethod : std::integral_constant<int, (n >= 2 && n <= 4) ? 2 : (n <= smallSize ? 1 : 0)> {};
+
+		/** Products with all three dimensions up to this use smallProduct() */
+		template<int n, int r, int m>
+		struct SmallProduct : std::integral_constant<bool, n <= smallSize && r <= smallSize && m <= smallSize> {};
+
+		/**
+		 * c += alpha * a * b, one element at a time with its sum in a register.
+		 * Every sum starts from c and adds the terms in the order multiplyAdd()
+		 * does, so the results agree bit for bit. Row-wise accumulation made
+		 * GCC transpose b and check for overlap at runtime instead.
+		 */
+		template<int n, int r, int m, typename T>
+		inline void smallProduct(T alpha, const T *__restrict a, const T *__restrict b, T *__restrict c) {
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < m; ++j) {
+					T sum = c[i * m + j];
+					for(int k = 0; k < r; ++k) {
+						sum += alpha * a[i * r + k] * b[k * m + j];
+					}
+					c[i * m + j] = sum;
+				}
+			}
+		}
+
+		/**
+		 * b = a^-1 as adj / det; a singular a gives non-finite elements.
+		 * Dividing rather than multiplying by 1 / det keeps exact quotients exact.
+		 */
+		template<int n, typename T>
+		void smallInverse(const T *a, T *b, std::integral_constant<int, 2>) {
+			T det;
+			SmallInverse<n>::adjugate(a, b, det);
+			for(int e = 0; e < n * n; ++e) {
+				b[e] /= det;
+			}
+		}
+
+		/** b = a^-1 by in-place Gauss-Jordan elimination with row pivoting */
+		template<int n, typename T>
+		void smallInverse(const T *a, T *b, std::integral_constant<int, 1>) {
+			std::copy(a, a + n * n, b);
+			int perm[n];
+			for(int k = 0; k < n; ++k) {
+				int p = k;
+				for(int i = k + 1; i < n; ++i) {
+					if(std::abs(b[i * n + k]) > std::abs(b[p * n + k])) {
+						p = i;
+					}
+				}
+				perm[k] = p;
+				if(p != k) {
+					std::swap_ranges(b + k * n, b + k * n + n, b + p * n);
+				}
+				/* column k of the inverse takes the place of column k of a */
+				const T r = T(1) / b[k * n + k];
+				b[k * n + k] = 1;
+				for(int j = 0; j < n; ++j) {
+					b[k * n + j] *= r;
+				}
+				for(int i = 0; i < n; ++i) {
+					if(i != k) {
+						const T f = b[i * n + k];
+						b[i * n + k] = 0;
+						for(int j = 0; j < n; ++j) {
+							b[i * n + j] -= f * b[k * n + j];
+						}
+					}
+				}
+			}
+			/* the row swaps of a are column swaps of the inverse, undone in reverse */
+			for(int k = n - 1; k >= 0; --k) {
+				if(perm[k] != k) {
+					for(int i = 0; i < n; ++i) {
+						std::swap(b[i * n + k], b[i * n + perm[k]]);
+					}
+				}
+			}
+		}
+
+		template<int n, typename T>
+		T smallDeterminant(const T *a, std::integral_constant<int, 2>) {
+			T det;
+			SmallInverse<n>::determinant(a, det);
+			return det;
+		}
+
+		/**
+		 * Product of the pivots of an elimination with row pivoting, on a copy
+		 * of a: on the stack up to smallSize, on the heap beyond.
+		 */
+		template<int n, typename T>
+		T smallDeterminant(const T *a, std::integral_constant<int, 1>) {
+			T local[n <= smallSize ? n * n : 1];
+			std::vector<T> heap(n <= smallSize ? 0 : n * n);
+			T *m = n <= smallSize ? local : heap.data();
+			std::copy(a, a + n * n, m);
+			T det = 1;
+			for(int k = 0; k < n; ++k) {
+				int p = k;
+				for(int i = k + 1; i < n; ++i) {
+					if(std::abs(m[i * n + k]) > std::abs(m[p * n + k])) {
+						p = i;
+					}
+				}
+				if(m[p * n + k] == T(0)) {
+					return 0;
+				}
+				if(p != k) {
+					std::swap_ranges(m + k * n + k, m + k * n + n, m + p * n + k);
+					det = -det;
+				}
+				det *= m[k * n + k];
+				const T r = T(1) / m[k * n + k];
+				for(int i = k + 1; i < n; ++i) {
+					const T f = m[i * n + k] * r;
+					for(int j = k + 1; j < n; ++j) {
+						m[i * n + j] -= f * m[k * n + j];
+					}
+				}
+			}
+			return det;
+		}
+
+		/**
+		 * gauss() for a row-major n x (n+s) extended matrix a; the same steps
+		 * as the generic code, so a and x come out bit for bit the same, but
+		 * with compile-time bounds and nothing allocated.
+		 */
+		template<int n, int s, typename T>
+		void smallGauss(T *a, T *x, bool pivotRows, bool pivotCols) {
+			const int ld = n + s;
+			int rowOrder[n], colOrder[n];
+			bool rowDone[n], colDone[n];
+			T l[n];
+			for(int i = 0; i < n; ++i) {
+				rowOrder[i] = colOrder[i] = i;
+				rowDone[i] = colDone[i] = false;
+			}
+			int r0 = 0, c0 = 0;
+			for(int k = 0; k < n; ++k) {
+				T temp = a[rowOrder[k] * ld + colOrder[k]];
+				if(pivotRows && pivotCols) {
+					/* as in gauss(): the largest, of equal ones the first physical (i, j) */
+					int pr = rowOrder[k], pc = colOrder[k];
+					T best = -1;
+					for(int i = 0; i < n; ++i) {
+						for(int j = 0; j < n; ++j) {
+							const T v = std::abs(a[i * ld + j]);
+							if(!rowDone[i] && !colDone[j] && v > best) {
+								best = v;
+								pr = i;
+								pc = j;
+							}
+						}
+					}
+					temp = a[pr * ld + pc];
+					std::swap(rowOrder[k], *std::find(rowOrder + k, rowOrder + n, pr));
+					std::swap(colOrder[k], *std::find(colOrder + k, colOrder + n, pc));
+				} else if(pivotRows || pivotCols) {
+					int pi = k, pj = k;
+					const int iEnd = pivotRows ? n : k + 1;
+					const int jEnd = pivotCols ? n : k + 1;
+					for(int i = k; i < iEnd; ++i) {
+						for(int j = k; j < jEnd; ++j) {
+							if(std::abs(a[rowOrder[i] * ld + colOrder[j]]) > std::abs(temp)) {
+								temp = a[rowOrder[i] * ld + colOrder[j]];
+								pi = i;
+								pj = j;
+							}
+						}
+					}
+					std::swap(rowOrder[k], rowOrder[pi]);
+					std::swap(colOrder[k], colOrder[pj]);
+				}
+				const int p = rowOrder[k];
+				const int q = colOrder[k];
+				rowDone[p] = colDone[q] = true;
+				T *pivotRow = a + p * ld;
+				for(int j = c0; j < ld; ++j) {
+					pivotRow[j] /= temp;
+				}
+				for(int i = r0; i < n; ++i) {
+					l[i] = rowDone[i] ? T(0) : a[i * ld + q];
+				}
+				for(int i = r0; i < n; ++i) {
+					if(l[i] == T(0)) {
+						continue;
+					}
+					for(int j = c0; j < ld; ++j) {
+						a[i * ld + j] -= pivotRow[j] * l[i];
+					}
+				}
+				while(r0 < n && rowDone[r0]) {
+					++r0;
+				}
+				while(c0 < n && colDone[c0]) {
+					++c0;
+				}
+			}
+			for(int c = 0; c < s; ++c) {
+				T xt[n];
+				for(int i = n - 1; i >= 0; --i) {
+					const T *row = a + rowOrder[i] * ld;
+					T sum = 0;
+					for(int j = i + 1; j < n; ++j) {
+						sum += row[colOrder[j]] * xt[j];
+					}
+					xt[i] = row[n + c] - sum;
+				}
+				for(int i = 0; i < n; ++i) {
+					x[colOrder[i] * s + c] = xt[i];
+				}
+			}
+		}
+	}
+};
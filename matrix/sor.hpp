@@ -0,0 +1,536 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
+
+#include "linsys.hpp"
+#include "sparse.hpp"
+
+/*
+ * Successive over-relaxation for A*x = b.
+ *
+ * sor() relaxes every Gauss-Seidel update by a factor omega,
+ *     x_i <- x_i + omega * (gs_i - x_i),
+ * and ssor() follows every forward sweep with a backward one. Both start
+ * from the zero vector, stop like seidel() and return the number of sweeps.
+ *
+ * Passing autoOmega estimates omega on the fly from the observed rate of
+ * convergence; SolverStats::omega reports the value used last.
+ *
+ * A Colouring groups the unknowns of a sparse A so that no row reads an
+ * unknown of its own colour; the rows of one colour are then relaxed in
+ * parallel, one colour after another.
+ */
+namespace Math
+{
+	/** Let sor() and ssor() estimate the relaxation factor */
+	const double autoOmega = 0;
+
+	/**
+	 * A partition of the unknowns into colours with a_ij = a_ji = 0 for any
+	 * two different unknowns i, j of the same colour. Within a colour the
+	 * unknowns are kept in increasing order.
+	 */
+	class Colouring
+	{
+	public:
+		Colouring() : start(1, 0) {}
+
+		/**
+		 * Red-black colouring of an nx x ny x nz grid numbered x first, for
+		 * 3, 5 and 7-point stencils: unknown (x, y, z) is red when x + y + z is even.
+		 */
+		static Colouring redBlack(int nx, int ny = 1, int nz = 1);
+
+		/** Greedy colouring of the graph of A + A^T, unknowns taken in order */
+		template<typename T>
+		static Colouring greedy(const SparseMatrix<T> &A);
+
+		int colours() const { return static_cast<int>(start.size()) - 1; }
+		int size() const { return static_cast<int>(order.size()); }
+		/** The unknowns of colour c */
+		const int* rows(int c) const { return order.data() + start[c]; }
+		int count(int c) const { return start[c + 1] - start[c]; }
+
+		/** True if no row of A reads an unknown of its own colour */
+		template<typename T>
+		bool independent(const SparseMatrix<T> &A) const;
+
+	private:
+		std::vector<int> order;
+		std::vector<int> start;
+
+		/* buckets the unknowns by colour, keeping their order */
+		static Colouring fromColours(const std::vector<int> &colour, int colours);
+	};
+
+	inline Colouring Colouring::fromColours(const std::vector<int> &colour, int colours) {
+		Colouring c;
+		c.start.assign(colours + 1, 0);
+		for(int k : colour) {
+			++c.start[k + 1];
+		}
+		for(int k = 0; k < colours; ++k) {
+			c.start[k + 1] += c.start[k];
+		}
+		c.order.resize(colour.size());
+		std::vector<int> next(c.start.begin(), c.start.end() - 1);
+		for(size_t i = 0; i < colour.size(); ++i) {
+			c.order[next[colour[i]]++] = static_cast<int>(i);
+		}
+		return c;
+	}
+
+	inline Colouring Colouring::redBlack(int nx, int ny, int nz) {
+		std::vector<int> colour(static_cast<size_t>(nx) * ny * nz);
+		int i = 0;
+		for(int z = 0; z < nz; ++z) {
+			for(int y = 0; y < ny; ++y) {
+				for(int x = 0; x < nx; ++x) {
+					colour[i++] = (x + y + z) & 1;
+				}
+			}
+		}
+		return fromColours(colour, std::min(2, nx * ny * nz));
+	}
+
+	template<typename T>
+	Colouring Colouring::greedy(const SparseMatrix<T> &A) {
+		const int n = A.rows();
+		assert(A.cols() == n);
+		const int *ptr = A.rowPtr();
+		const int *col = A.colIdx();
+		/* the pattern of A^T, so that a_ji couples j to i as well */
+		std::vector<int> tptr(n + 1, 0), trow(A.nonZeros());
+		for(int k = 0; k < A.nonZeros(); ++k) {
+			++tptr[col[k] + 1];
+		}
+		for(int j = 0; j < n; ++j) {
+			tptr[j + 1] += tptr[j];
+		}
+		std::vector<int> next(tptr.begin(), tptr.end() - 1);
+		for(int i = 0; i < n; ++i) {
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				trow[next[col[k]]++] = i;
+			}
+		}
+
+		/* taken[c] == i: colour c is used by a neighbour of i */
+		std::vector<int> colour(n, -1), taken;
+		int colours = 0;
+		for(int i = 0; i < n; ++i) {
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				if(colour[col[k]] >= 0) {
+					taken[colour[col[k]]] = i;
+				}
+			}
+			for(int k = tptr[i]; k < tptr[i + 1]; ++k) {
+				if(colour[trow[k]] >= 0) {
+					taken[colour[trow[k]]] = i;
+				}
+			}
+			int c = 0;
+			while(c < colours && taken[c] == i) {
+				++c;
+			}
+			if(c == colours) {
+				taken.push_back(-1);
+				++colours;
+			}
+			colour[i] = c;
+		}
+		return fromColours(colour, colours);
+	}
+
+	template<typename T>
+	bool Colouring::independent(const SparseMatrix<T> &A) const {
+		if(size() != A.rows()) {
+			return false;
+		}
+		std::vector<int> colour(size());
+		for(int c = 0; c < colours(); ++c) {
+			for(int k = start[c]; k < start[c + 1]; ++k) {
+				colour[order[k]] = c;
+			}
+		}
+		const int *ptr = A.rowPtr();
+		const int *col = A.colIdx();
+		for(int i = 0; i < A.rows(); ++i) {
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				if(col[k] != i && colour[col[k]] == colour[i]) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	namespace detail {
+		/** The rows of a dense row-major A for in-place sweeps, like SeidelRows */
+		template<typename T>
+		class DenseSeidelRows
+		{
+		public:
+			template<typename Mat>
+			explicit DenseSeidelRows(const Mat &A) : a(A.data()), n(A.rows()), invDiag(A.rows()) {
+				for(int i = 0; i < n; ++i) {
+					invDiag[i] = T(1) / A(i, i);
+				}
+			}
+
+			T operator()(int i, const T *b, const T *x) const {
+				const T *row = a + i * n;
+				return (b[i] - rowDot(row, x, i) - rowDot(row + i + 1, x + i + 1, n - i - 1)) * invDiag[i];
+			}
+
+		private:
+			const T *a;
+			int n;
+			std::vector<T> invDiag;
+		};
+
+		/**
+		 * Estimates the optimal omega from |x_k - x_(k-1)|, which shrinks by
+		 * the spectral radius lambda of the sweep once the slowest mode dominates.
+		 * For a consistently ordered A (tridiagonal, red-black stencils) Young's
+		 * relation (lambda + omega - 1)^2 = lambda omega^2 mu^2 gives the Jacobi
+		 * radius mu and so omega_opt = 2 / (1 + sqrt(1 - mu^2)). Starting from
+		 * omega = 1, SOR moves omega up to every larger estimate; SSOR makes
+		 * a single estimate from forward Gauss-Seidel sweeps and then uses
+		 * 2 / (1 + sqrt(2 (1 - mu))). Other orderings break the theory, so a
+		 * new omega whose rate turns out worse than the one it replaced (for
+		 * SSOR: two Gauss-Seidel sweeps) is taken back.
+		 */
+		class OmegaTuner
+		{
+		public:
+			OmegaTuner(double omega, bool symmetric)
+				: tuning(omega <= 0), ssor(symmetric), forward(tuning && symmetric), checking(false),
+				  w(tuning ? 1 : omega), last(w), baseline(0), prev(0), ratio(0), steady(0)
+			{
+				assert(w > 0 && w < 2);
+			}
+
+			double omega() const { return w; }
+			/** Needs |x_k - x_(k-1)| after every sweep */
+			bool active() const { return tuning; }
+			/** SSOR runs forward sweeps only while its omega is being estimated */
+			bool symmetric() const { return ssor && !forward; }
+
+			void observe(double diff) {
+				if(!tuning) {
+					return;
+				}
+				if(prev > 0 && diff > 0) {
+					const double r = diff / prev;
+					/* omega_opt hangs on 1 - lambda, so that is what has to settle */
+					steady = (r < 1 && std::abs(r - ratio) < 0.05 * (1 - r)) ? steady + 1 : 0;
+					ratio = r;
+					if(steady >= 3 && update()) {
+						/* the rates seen so far belong to the old omega */
+						prev = ratio = 0;
+						steady = 0;
+						return;
+					}
+				}
+				prev = diff;
+			}
+
+		private:
+			bool tuning, ssor, forward, checking;
+			double w, last, baseline, prev, ratio;
+			int steady;
+
+			/* true when omega changed */
+			bool update() {
+				if(checking) {
+					checking = false;
+					if(ratio >= baseline) {
+						w = last;
+						tuning = false;
+						return true;
+					}
+					if(ssor) {
+						tuning = false;
+						return false;
+					}
+				}
+				const double mu2 = (ratio + w - 1) * (ratio + w - 1) / (ratio * w * w);
+				double next;
+				/* past omega_opt |lambda| = omega - 1 and the estimate says nothing */
+				if(mu2 >= 1 || ratio - (w - 1) < 0.5 * (1 - ratio)) {
+					tuning = false;
+					return false;
+				}
+				if(ssor) {
+					next = 2 / (1 + std::sqrt(2 * (1 - std::sqrt(mu2))));
+					baseline = ratio * ratio;
+					forward = false;
+				} else {
+					next = 2 / (1 + std::sqrt(1 - mu2));
+					if(next < w + 0.001) {
+						return false;
+					}
+					baseline = ratio;
+				}
+				last = w;
+				w = next;
+				checking = true;
+				return true;
+			}
+		};
+
+		/**
+		 * One relaxation sweep over the unknowns, forward or backward; with a
+		 * colouring, colour by colour, the rows of a colour split over the pool.
+		 * Partial sums are kept per chunk of `grain` rows and added in order,
+		 * so the result does not depend on the number of threads.
+		 * @returns |x_new - x_old|^2
+		 */
+		template<typename Rows, typename T>
+		double relaxSweep(const Rows &rows, const T *b, T *x, int n, T w, bool backward,
+						  const Colouring *colouring, ThreadPool *pool, std::vector<double> &partial) {
+			const int grain = 256;
+			double diff = 0;
+			if(!colouring) {
+				for(int k = 0; k < n; ++k) {
+					const int i = backward ? n - 1 - k : k;
+					const T d = w * (rows(i, b, x) - x[i]);
+					diff += static_cast<double>(d * d);
+					x[i] += d;
+				}
+				return diff;
+			}
+			const int colours = colouring->colours();
+			for(int k = 0; k < colours; ++k) {
+				const int c = backward ? colours - 1 - k : k;
+				const int *order = colouring->rows(c);
+				const int count = colouring->count(c);
+				auto chunk = [&](int lo, int hi) {
+					for(int c0 = lo; c0 < hi; c0 += grain) {
+						double s = 0;
+						for(int r = c0; r < std::min(hi, c0 + grain); ++r) {
+							const int i = order[r];
+							const T d = w * (rows(i, b, x) - x[i]);
+							s += static_cast<double>(d * d);
+							x[i] += d;
+						}
+						partial[c0 / grain] = s;
+					}
+				};
+				const int chunks = (count + grain - 1) / grain;
+				partial.resize(std::max<size_t>(partial.size(), chunks));
+				if(pool) {
+					parallelFor(*pool, 0, count, grain, chunk);
+				} else {
+					chunk(0, count);
+				}
+				for(int j = 0; j < chunks; ++j) {
+					diff += partial[j];
+				}
+			}
+			return diff;
+		}
+
+		template<typename Rows, typename Vec>
+		int relax(const Rows &rows, const Vec &vec, Vec &sol, int n, double omega, bool symmetric,
+				  const Colouring *colouring, ThreadPool *pool, double eps, int maxiter,
+				  SolverStats *stats, const IterationCallback &callback) {
+			typedef typename Vec::Scalar T;
+			StatsRecorder recorder(stats, callback);
+			OmegaTuner tuner(omega, symmetric);
+			/* b is copied in case sol is vec */
+			const Vec b(vec);
+			sol = vec;
+			setZero(sol);
+			T *x = sol.data();
+			std::vector<T> old;
+			std::vector<double> partial;
+			const double limit = eps * eps;
+
+			int iter = 0;
+			bool converged = false;
+			for(; iter < maxiter; ++iter) {
+				const T w = static_cast<T>(tuner.omega());
+				double diff;
+				if(tuner.symmetric()) {
+					/* x changes twice; measure the change of the whole step */
+					old.assign(x, x + n);
+					relaxSweep(rows, b.data(), x, n, w, false, colouring, pool, partial);
+					relaxSweep(rows, b.data(), x, n, w, true, colouring, pool, partial);
+					diff = 0;
+					for(int i = 0; i < n; ++i) {
+						const double d = static_cast<double>(x[i] - old[i]);
+						diff += d * d;
+					}
+				} else {
+					diff = relaxSweep(rows, b.data(), x, n, w, false, colouring, pool, partial);
+				}
+				converged = iter && (diff < limit);
+				const double norm = (recorder.tracking() || tuner.active()) ? std::sqrt(diff) : 0;
+				tuner.observe(norm);
+				if((recorder.tracking() && !recorder.iteration(iter, norm)) || converged) {
+					break;
+				}
+			}
+			if(recorder.active()) {
+				recorder->omega = tuner.omega();
+			}
+			recorder.finish(iter, converged);
+			return iter;
+		}
+	}
+
+	/** Solve a system \p mat*sol=vec by successive over-relaxation.
+	 * Uses zero vector as the initial guess; omega = 1 is seidel().
+	 * @param omega The relaxation factor, 0 < omega < 2, or autoOmega to estimate it.
+	 * @param[out] sol Solution vector.
+	 * @param[out] stats Optional: iterations, |x_k - x_(k-1)| of every sweep, omega, time.
+	 * @param callback Optional: sees every sweep and may stop the solver.
+	 */
+	template<typename T, int n>
+	int sor(const Matrix<T, n, n> &mat,
+			const Matrix<T, n, 1> &vec,
+			Matrix<T, n, 1> &sol,
+			double omega = autoOmega,
+			double eps = 1e-5,
+			int maxiter = 100,
+			SolverStats *stats = nullptr,
+			const IterationCallback &callback = IterationCallback()) {
+		return detail::relax(detail::DenseSeidelRows<T>(mat), vec, sol, n, omega, false,
+							 nullptr, nullptr, eps, maxiter, stats, callback);
+	}
+
+	/** @see sor() */
+	template<typename T>
+	int sor(const DynamicMatrix<T> &mat,
+			const DynamicMatrix<T> &vec,
+			DynamicMatrix<T> &sol,
+			double omega = autoOmega,
+			double eps = 1e-5,
+			int maxiter = 100,
+			SolverStats *stats = nullptr,
+			const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows());
+		return detail::relax(detail::DenseSeidelRows<T>(mat), vec, sol, mat.rows(), omega, false,
+							 nullptr, nullptr, eps, maxiter, stats, callback);
+	}
+
+	/** @see sor() */
+	template<typename T>
+	int sor(const SparseMatrix<T> &mat,
+			const DynamicMatrix<T> &vec,
+			DynamicMatrix<T> &sol,
+			double omega = autoOmega,
+			double eps = 1e-5,
+			int maxiter = 100,
+			SolverStats *stats = nullptr,
+			const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows());
+		return detail::relax(detail::SeidelRows<T>(mat), vec, sol, mat.rows(), omega, false,
+							 nullptr, nullptr, eps, maxiter, stats, callback);
+	}
+
+	/** Multicolour SOR: the colours are swept in turn, the rows of each in parallel.
+	 * @param colouring Must be independent() for mat.
+	 * @see sor()
+	 */
+	template<typename T>
+	int sor(const SparseMatrix<T> &mat,
+			const DynamicMatrix<T> &vec,
+			DynamicMatrix<T> &sol,
+			const Colouring &colouring,
+			ThreadPool &pool,
+			double omega = autoOmega,
+			double eps = 1e-5,
+			int maxiter = 100,
+			SolverStats *stats = nullptr,
+			const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows() && colouring.size() == mat.rows());
+		return detail::relax(detail::SeidelRows<T>(mat), vec, sol, mat.rows(), omega, false,
+							 &colouring, &pool, eps, maxiter, stats, callback);
+	}
+
+	/** Solve a system \p mat*sol=vec by symmetric SOR: a forward and a backward sweep per step.
+	 * @see sor()
+	 */
+	template<typename T, int n>
+	int ssor(const Matrix<T, n, n> &mat,
+			 const Matrix<T, n, 1> &vec,
+			 Matrix<T, n, 1> &sol,
+			 double omega = autoOmega,
+			 double eps = 1e-5,
+			 int maxiter = 100,
+			 SolverStats *stats = nullptr,
+			 const IterationCallback &callback = IterationCallback()) {
+		return detail::relax(detail::DenseSeidelRows<T>(mat), vec, sol, n, omega, true,
+							 nullptr, nullptr, eps, maxiter, stats, callback);
+	}
+
+	/** @see ssor() */
+	template<typename T>
+	int ssor(const DynamicMatrix<T> &mat,
+			 const DynamicMatrix<T> &vec,
+			 DynamicMatrix<T> &sol,
+			 double omega = autoOmega,
+			 double eps = 1e-5,
+			 int maxiter = 100,
+			 SolverStats *stats = nullptr,
+			 const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows());
+		return detail::relax(detail::DenseSeidelRows<T>(mat), vec, sol, mat.rows(), omega, true,
+							 nullptr, nullptr, eps, maxiter, stats, callback);
+	}
+
+	/** @see ssor() */
+	template<typename T>
+	int ssor(const SparseMatrix<T> &mat,
+			 const DynamicMatrix<T> &vec,
+			 DynamicMatrix<T> &sol,
+			 double omega = autoOmega,
+			 double eps = 1e-5,
+			 int maxiter = 100,
+			 SolverStats *stats = nullptr,
+			 const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows());
+		return detail::relax(detail::SeidelRows<T>(mat), vec, sol, mat.rows(), omega, true,
+							 nullptr, nullptr, eps, maxiter, stats, callback);
+	}
+
+	/** Multicolour SSOR: colours forward, then backward, the rows of each in parallel.
+	 * @see sor()
+	 */
+	template<typename T>
+	int ssor(const SparseMatrix<T> &mat,
+			 const DynamicMatrix<T> &vec,
+			 DynamicMatrix<T> &sol,
+			 const Colouring &colouring,
+			 ThreadPool &pool,
+			 double omega = autoOmega,
+			 double eps = 1e-5,
+			 int maxiter = 100,
+			 SolverStats *stats = nullptr,
+			 const IterationCallback &callback = IterationCallback()) {
+		assert(mat.rows() == mat.cols() && vec.rows() == mat.rows() && colouring.size() == mat.rows());
+		return detail::relax(detail::SeidelRows<T>(mat), vec, sol, mat.rows(), omega, true,
+							 &colouring, &pool, eps, maxiter, stats, callback);
+	}
+
+	/** Multicolour Gauss-Seidel, sor() with omega = 1.
+	 * @see seidel()
+	 */
+	template<typename T>
+	int seidel(const SparseMatrix<T> &mat,
+			   const DynamicMatrix<T> &vec,
+			   DynamicMatrix<T> &sol,
+			   const Colouring &colouring,
+			   ThreadPool &pool,
+			   double eps = 1e-5,
+			   int maxiter = 100,
+			   SolverStats *stats = nullptr,
+			   const IterationCallback &callback = IterationCallback()) {
+		return sor(mat, vec, sol, colouring, pool, 1.0, eps, maxiter, stats, callback);
+	}
+};
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <assert.h>
+
+#include "matrix.hpp"
+#include "operator.hpp"
+#include "stats.hpp"
+
+namespace Math
+{
+	/** Element of a sparse matrix under construction; duplicates are summed. */
+	template<typename T>
+	struct Triplet {
+		int row;
+		int col;
+		T value;
+	};
+
+	/**
+	 * Sparse matrix in compressed sparse row (CSR) format.
+	 * Row i owns the entries rowPtr()[i]..rowPtr()[i+1]-1 of colIdx() and
+	 * values(); columns within a row are sorted and unique.
+	 * Products and sweeps cost O(nnz) instead of O(n^2).
+	 * Like DynamicMatrix, a matrix built with the External tag works on
+	 * arrays it does not own; copies of it own theirs.
+	 */
+	template<typename T>
+	class SparseMatrix
+	{
+	public:
+		typedef T Scalar;
+
+		SparseMatrix() : n(0), m(0), rowPtr_(1, 0) { bind(); }
+
+		/** Empty (all zero) rows x cols matrix */
+		SparseMatrix(int rows, int cols) : n(rows), m(cols), rowPtr_(rows + 1, 0) { bind(); }
+
+		SparseMatrix(int rows, int cols, const std::vector<Triplet<T> > &triplets);
+
+		/** Keeps the elements of a dense matrix with |a_ij| > dropTolerance. */
+		template<typename E>
+		explicit SparseMatrix(const MatrixExpr<E> &dense, double dropTolerance = 0);
+
+		/** Uses CSR arrays owned by someone else, which must outlive the matrix. */
+		SparseMatrix(int rows, int cols, int nonZeros, const int *rowPtr, const int *colIdx, T *values, External);
+
+		SparseMatrix(const SparseMatrix &other);
+		SparseMatrix(SparseMatrix &&other);
+		SparseMatrix& operator=(SparseMatrix other) {
+			swap(*this, other);
+			return *this;
+		}
+		friend void swap(SparseMatrix &a, SparseMatrix &b) {
+			std::swap(a.n, b.n);
+			std::swap(a.m, b.m);
+			std::swap(a.nnz, b.nnz);
+			a.rowPtr_.swap(b.rowPtr_);
+			a.colIdx_.swap(b.colIdx_);
+			a.values_.swap(b.values_);
+			std::swap(a.ptr, b.ptr);
+			std::swap(a.col, b.col);
+			std::swap(a.val, b.val);
+		}
+
+		int rows() const { return n; }
+		int cols() const { return m; }
+		int nonZeros() const { return nnz; }
+
+		const int* rowPtr() const { return ptr; }
+		const int* colIdx() const { return col; }
+		const T* values() const { return val; }
+		T* values() { return val; }
+
+		/** Element (i, j), zero if it is not stored; O(log(row length)) */
+		T coeff(int i, int j) const;
+
+		/** Position of the diagonal entry of each row, -1 if it is not stored */
+		std::vector<int> diagonalIndex() const;
+
+		/** y = A*x for column vectors stored as plain arrays */
+		void multiply(const T *x, T *y) const;
+
+		DynamicMatrix<T> toDense() const;
+
+	private:
+		int n;
+		int m;
+		int nnz;
+		std::vector<int> rowPtr_;
+		std::vector<int> colIdx_;
+		std::vector<T> values_;
+		/* the arrays in use: the vectors above or External ones */
+		const int *ptr;
+		const int *col;
+		T *val;
+
+		void bind() {
+			nnz = static_cast<int>(values_.size());
+			ptr = rowPtr_.data();
+			col = colIdx_.data();
+			val = values_.data();
+		}
+	};
+
+	template<typename T>
+	SparseMatrix<T>::SparseMatrix(int rows, int cols, int nonZeros, const int *rowPtr, const int *colIdx,
+								  T *values, External)
+		: n(rows), m(cols), nnz(nonZeros), ptr(rowPtr), col(colIdx), val(values)
+	{
+		assert(rowPtr[0] == 0 && rowPtr[rows] == nonZeros);
+	}
+
+	template<typename T>
+	SparseMatrix<T>::SparseMatrix(const SparseMatrix &other)
+		: n(other.n), m(other.m),
+		  rowPtr_(other.ptr, other.ptr + other.n + 1),
+		  colIdx_(other.col, other.col + other.nnz),
+		  values_(other.val, other.val + other.nnz)
+	{
+		bind();
+	}
+
+	/* moving the vectors keeps their buffers, so the pointers stay valid */
+	template<typename T>
+	SparseMatrix<T>::SparseMatrix(SparseMatrix &&other) : SparseMatrix()
+	{
+		swap(*this, other);
+	}
+
+	template<typename T>
+	SparseMatrix<T>::SparseMatrix(int rows, int cols, const std::vector<Triplet<T> > &triplets)
+		: n(rows), m(cols), rowPtr_(rows + 1, 0)
+	{
+		/* bucket by row, then sort and merge each row */
+		for(const Triplet<T> &t : triplets) {
+			assert(t.row >= 0 && t.row < n && t.col >= 0 && t.col < m);
+			++rowPtr_[t.row + 1];
+		}
+		for(int i = 0; i < n; ++i) {
+			rowPtr_[i + 1] += rowPtr_[i];
+		}
+		std::vector<int> next(rowPtr_.begin(), rowPtr_.end() - 1);
+		std::vector<std::pair<int, T> > entries(triplets.size());
+		for(const Triplet<T> &t : triplets) {
+			entries[next[t.row]++] = std::make_pair(t.col, t.value);
+		}
+
+		colIdx_.reserve(entries.size());
+		values_.reserve(entries.size());
+		int start = 0;
+		for(int i = 0; i < n; ++i) {
+			int end = rowPtr_[i + 1];
+			std::sort(entries.begin() + start, entries.begin() + end,
+					  [](const std::pair<int, T> &a, const std::pair<int, T> &b) { return a.first < b.first; });
+			rowPtr_[i] = static_cast<int>(colIdx_.size());
+			for(int k = start; k < end; ++k) {
+				if(static_cast<int>(colIdx_.size()) > rowPtr_[i] && colIdx_.back() == entries[k].first) {
+					values_.back() += entries[k].second;
+				} else {
+					colIdx_.push_back(entries[k].first);
+					values_.push_back(entries[k].second);
+				}
+			}
+			start = end;
+		}
+		rowPtr_[n] = static_cast<int>(colIdx_.size());
+		bind();
+	}
+
+	template<typename T>
+	template<typename E>
+	SparseMatrix<T>::SparseMatrix(const MatrixExpr<E> &expr, double dropTolerance)
+		: n(expr.derived().rows()), m(expr.derived().cols()), rowPtr_(n + 1, 0)
+	{
+		typename PlainObject<E>::type dense(expr);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < m; ++j) {
+				T v = dense(i, j);
+				if(std::abs(static_cast<double>(v)) > dropTolerance) {
+					colIdx_.push_back(j);
+					values_.push_back(v);
+				}
+			}
+			rowPtr_[i + 1] = static_cast<int>(colIdx_.size());
+		}
+		bind();
+	}
+
+	template<typename T>
+	T SparseMatrix<T>::coeff(int i, int j) const {
+		const int *begin = col + ptr[i];
+		const int *end = col + ptr[i + 1];
+		const int *p = std::lower_bound(begin, end, j);
+		return (p != end && *p == j) ? val[p - col] : T(0);
+	}
+
+	template<typename T>
+	std::vector<int> SparseMatrix<T>::diagonalIndex() const {
+		std::vector<int> diag(n, -1);
+		for(int i = 0; i < n && i < m; ++i) {
+			const int *begin = col + ptr[i];
+			const int *end = col + ptr[i + 1];
+			const int *p = std::lower_bound(begin, end, i);
+			if(p != end && *p == i) {
+				diag[i] = static_cast<int>(p - col);
+			}
+		}
+		return diag;
+	}
+
+	template<typename T>
+	void SparseMatrix<T>::multiply(const T *x, T *y) const {
+		for(int i = 0; i < n; ++i) {
+			T sum = 0;
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				sum += val[k] * x[col[k]];
+			}
+			y[i] = sum;
+		}
+	}
+
+	template<typename T>
+	DynamicMatrix<T> SparseMatrix<T>::toDense() const {
+		DynamicMatrix<T> dense(n, m);
+		for(int i = 0; i < n; ++i) {
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				dense(i, col[k]) = val[k];
+			}
+		}
+		return dense;
+	}
+
+	/** Sparse times dense: every column of \p rhs is multiplied in one pass over A. */
+	template<typename T, typename E>
+	DynamicMatrix<T> dot(const SparseMatrix<T> &A, const MatrixExpr<E> &rhs) {
+		typename PlainObject<E>::type x(rhs);
+		assert(A.cols() == x.rows());
+		const int s = x.cols();
+		DynamicMatrix<T> y(A.rows(), s);
+		if(s == 1) {
+			A.multiply(x.data(), y.data());
+			return y;
+		}
+		const int *ptr = A.rowPtr();
+		const int *col = A.colIdx();
+		const T *val = A.values();
+		const T *X = x.data();
+		for(int i = 0; i < A.rows(); ++i) {
+			T *yi = y.data() + i * s;
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				const T a = val[k];
+				const T *xj = X + col[k] * s;
+				for(int c = 0; c < s; ++c) {
+					yi[c] += a * xj[c];
+				}
+			}
+		}
+		return y;
+	}
+
+	/**
+	 * Rewrite sparse system Ax=b to form x=Hx+g.
+	 * H keeps the sparsity pattern of A minus the diagonal.
+	 */
+	template<typename T>
+	void rewriteSystem(const SparseMatrix<T> &mat,
+					   const DynamicMatrix<T> &b,
+					   SparseMatrix<T> &H,
+					   DynamicMatrix<T> &g) {
+		const int n = mat.rows();
+		assert(mat.cols() == n && b.rows() == n);
+		const int *ptr = mat.rowPtr();
+		const int *col = mat.colIdx();
+		const T *val = mat.values();
+		std::vector<T> diag(n, T(0));
+		std::vector<Triplet<T> > entries;
+		entries.reserve(mat.nonZeros());
+		for(int i = 0; i < n; ++i) {
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				if(col[k] == i) {
+					diag[i] = val[k];
+				}
+			}
+			for(int k = ptr[i]; k < ptr[i + 1]; ++k) {
+				if(col[k] != i) {
+					Triplet<T> t = {i, col[k], -val[k] / diag[i]};
+					entries.push_back(t);
+				}
+			}
+		}
+		H = SparseMatrix<T>(n, n, entries);
+		g.resize(n, 1);
+		for(int i = 0; i < n; ++i) {
+			g(i, 0) = b(i, 0) / diag[i];
+		}
+	}
+
+	/** Solve the sparse system x=Hx+g iteratively; each step is one SpMV.
+	 * @param guess The initial guess.
+	 * @param[out] sol Solution vector.
+	 * @see iterativeSolve()
+	 */
+	template<typename T>
+	int iterativeSolve(const SparseMatrix<T> &H,
+					   const DynamicMatrix<T> &g,
+					   const DynamicMatrix<T> &guess,
+					   DynamicMatrix<T> &sol,
+					   double precision = 1e-5,
+					   int maxiter = 100,
+					   SolverStats *stats = nullptr,
+					   const IterationCallback &callback = IterationCallback()) {
+		return detail::operatorIterativeSolve(H, g, guess, sol, precision, maxiter, stats, callback);
+	}
+
+	namespace detail {
+		/**
+		 * The rows of a sparse A split at the diagonal, for sweeps that update
+		 * x in place: row i is ptr[i]..lower[i]-1 left of the diagonal and
+		 * upper[i]..ptr[i+1]-1 right of it.
+		 */
+		template<typename T>
+		class SeidelRows
+		{
+		public:
+			explicit SeidelRows(const SparseMatrix<T> &A)
+				: ptr(A.rowPtr()), col(A.colIdx()), val(A.values()),
+				  lower(A.rows()), upper(A.rows()), invDiag(A.rows())
+			{
+				for(int i = 0; i < A.rows(); ++i) {
+					lower[i] = static_cast<int>(std::lower_bound(col + ptr[i], col + ptr[i + 1], i) - col);
+					const bool stored = lower[i] < ptr[i + 1] && col[lower[i]] == i;
+					upper[i] = lower[i] + stored;
+					invDiag[i] = T(1) / (stored ? val[lower[i]] : T(0));
+				}
+			}
+
+			/** The Gauss-Seidel value of x_i: (b_i - sum_(j!=i) a_ij x_j) / a_ii */
+			T operator()(int i, const T *b, const T *x) const {
+				T sum = b[i];
+				for(int k = ptr[i]; k < lower[i]; ++k) {
+					sum -= val[k] * x[col[k]];
+				}
+				for(int k = upper[i]; k < ptr[i + 1]; ++k) {
+					sum -= val[k] * x[col[k]];
+				}
+				return sum * invDiag[i];
+			}
+
+		private:
+			const int *ptr;
+			const int *col;
+			const T *val;
+			std::vector<int> lower, upper;
+			std::vector<T> invDiag;
+		};
+	}
+
+	/** Solve a sparse system \p mat*sol=vec using Seidel method.
+	 * Uses zero vector as the initial guess. A sweep updates x in place
+	 * straight from A, every row split at its diagonal entry, so it costs
+	 * O(nnz) and needs neither H nor any allocation after the setup.
+	 * @param[out] sol Solution vector.
+	 * @see seidel()
+	 */
+	template<typename T>
+	int seidel(const SparseMatrix<T> &mat,
+			   const DynamicMatrix<T> &vec,
+			   DynamicMatrix<T> &sol,
+			   double eps = 1e-5,
+			   int maxiter = 100,
+			   SolverStats *stats = nullptr,
+			   const IterationCallback &callback = IterationCallback()) {
+		detail::StatsRecorder recorder(stats, callback);
+		const int n = mat.rows();
+		assert(mat.cols() == n && vec.rows() == n);
+		const detail::SeidelRows<T> rows(mat);
+		const DynamicMatrix<T> b(vec);
+		const T *bp = b.data();
+		sol.resize(n, 1);
+		T *xp = sol.data();
+		std::fill(xp, xp + n, T(0));
+		const double limit = eps * eps;
+
+		int iter = 0;
+		bool converged = false;
+		for(; iter < maxiter; ++iter) {
+			T diff = 0;
+			for(int i = 0; i < n; ++i) {
+				const T v = rows(i, bp, xp);
+				const T d = v - xp[i];
+				diff += d * d;
+				xp[i] = v;
+			}
+			converged = iter && (diff < limit);
+			if((recorder.tracking() && !recorder.iteration(iter, std::sqrt(static_cast<double>(diff)))) || converged) {
+				break;
+			}
+		}
+		recorder.finish(iter, converged);
+		return iter;
+	}
+};
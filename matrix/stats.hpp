@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace Math
+{
+	/**
+	 * What a solver did, filled in when the caller passes a SolverStats*.
+	 * Solvers never print; use operator<< when a report is wanted.
+	 */
+	struct SolverStats {
+		/** Direct methods: max |u_kj| / max |a_ij|, U taken before the row scaling */
+		double pivotGrowth = 0;
+		/** Direct methods: row and column interchanges of the pivoting */
+		int swaps = 0;
+		/** Direct methods: leading elements below eps */
+		int smallPivots = 0;
+		/** Direct methods: estimated 1 / (||A||_1 ||A^-1||_1), 0 if singular, -1 if not estimated */
+		double rcond = -1;
+		/** Direct methods: rcond below the machine epsilon; the solution may have no correct digits */
+		bool illConditioned = false;
+		/** Elimination steps, sweeps or rotations */
+		int iterations = 0;
+		/** Iterative methods: the convergence measure after every iteration */
+		std::vector<double> residuals;
+		/** Iterative methods: the precision was reached */
+		bool converged = false;
+		/** SOR and SSOR: the relaxation factor of the last sweep, estimated or given */
+		double omega = 0;
+		/** Stopped because the callback asked to */
+		bool cancelled = false;
+		/** Wall time of the call */
+		double seconds = 0;
+	};
+
+	/**
+	 * Called after every iteration with its number (from 0) and residual;
+	 * returning false stops the solver, which then returns what it has.
+	 */
+	typedef std::function<bool(int iteration, double residual)> IterationCallback;
+
+	inline std::ostream& operator<<(std::ostream &os, const SolverStats &stats) {
+		os << "iterations " << stats.iterations;
+		if(!stats.residuals.empty()) {
+			os << ", residual " << stats.residuals.back()
+			   << (stats.converged ? ", converged" : ", not converged");
+		}
+		if(stats.omega > 0) {
+			os << ", omega " << stats.omega;
+		}
+		if(stats.pivotGrowth > 0) {
+			os << ", pivot growth " << stats.pivotGrowth
+			   << ", swaps " << stats.swaps << ", small pivots " << stats.smallPivots;
+		}
+		if(stats.rcond >= 0) {
+			os << ", rcond " << stats.rcond << (stats.illConditioned ? " (ill-conditioned)" : "");
+		}
+		if(stats.cancelled) {
+			os << ", cancelled";
+		}
+		return os << ", " << stats.seconds << " s\n";
+	}
+
+	namespace detail {
+		/**
+		 * Bookkeeping shared by the solvers; every call is a no-op for a null
+		 * SolverStats and an empty callback, so the default path costs nothing.
+		 */
+		class StatsRecorder
+		{
+		public:
+			explicit StatsRecorder(SolverStats *stats, const IterationCallback &callback = IterationCallback())
+				: stats(stats), callback(callback)
+			{
+				if(stats) {
+					*stats = SolverStats();
+					start = std::chrono::steady_clock::now();
+				}
+			}
+
+			bool active() const { return stats != nullptr; }
+			/** True if iteration() has anything to do; solvers may skip computing the residual otherwise */
+			bool tracking() const { return stats || callback; }
+			SolverStats* operator->() const { return stats; }
+
+			/** Records one iteration; false when the callback wants to stop. */
+			bool iteration(int i, double residual) {
+				if(stats) {
+					stats->residuals.push_back(residual);
+				}
+				if(callback && !callback(i, residual)) {
+					if(stats) {
+						stats->cancelled = true;
+					}
+					return false;
+				}
+				return true;
+			}
+
+			void finish(int iterations, bool converged = false) {
+				if(stats) {
+					stats->iterations = iterations;
+					stats->converged = converged;
+					std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+					stats->seconds = d.count();
+				}
+			}
+
+		private:
+			SolverStats *stats;
+			IterationCallback callback;
+			std::chrono::steady_clock::time_point start;
+		};
+	}
+};
@@ -0,0 +1,648 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <assert.h>
+
+#include "matrix.hpp"
+
+namespace Math
+{
+	/** Eigensolver used on the tridiagonal matrix */
+	enum class EigenMethod {
+		Auto,             ///< divide and conquer for large matrices with eigenvectors, QR otherwise
+		QR,               ///< implicit-shift QL/QR iteration
+		DivideAndConquer  ///< Cuppen's divide and conquer
+	};
+
+	namespace detail {
+		/* Below this size divide and conquer hands the subproblem to QR */
+		const int divideConquerBase = 32;
+		/* Auto chooses divide and conquer from this size on */
+		const int divideConquerMin = 128;
+
+		/**
+		 * Blocked Householder reduction of a symmetric n x n matrix (row-major,
+		 * both triangles) to tridiagonal form Q^T A Q = T.
+		 * A panel of nb reflectors is built with the level-2 algorithm, keeping
+		 * the vectors V and W of the update A -= V W^T + W V^T; the rest of the
+		 * matrix then receives the whole panel in two gemm() calls.
+		 * On exit d, e hold T, row i of a holds reflector i from column i+2 on
+		 * (its element i+1 is an implicit 1) and tau its scale factors.
+		 */
+		template<typename T>
+		void tridiagonalize(T *a, int n, int nb, T *d, T *e, T *tau) {
+			std::vector<T> V, W, v(n), w(n);
+			for(int k = 0; k < n - 1; k += nb) {
+				const int pb = std::min(nb, n - 1 - k);
+				V.assign(static_cast<size_t>(n) * pb, T(0));
+				W.assign(static_cast<size_t>(n) * pb, T(0));
+				for(int jj = 0; jj < pb; ++jj) {
+					const int i = k + jj;
+					T *row = a + i * n;
+					/* row i += earlier reflectors of the panel */
+					for(int t = 0; t < jj; ++t) {
+						T vi = V[i * pb + t], wi = W[i * pb + t];
+						for(int c = i; c < n; ++c) {
+							row[c] -= vi * W[c * pb + t] + wi * V[c * pb + t];
+						}
+					}
+					d[i] = row[i];
+
+					/* reflector zeroing row[i+2..n-1] */
+					const int m = n - i - 1;
+					T alpha = row[i + 1];
+					T xnorm = 0;
+					for(int c = i + 2; c < n; ++c) {
+						xnorm += row[c] * row[c];
+					}
+					xnorm = std::sqrt(xnorm);
+					T beta = alpha, t = 0;
+					if(xnorm != T(0)) {
+						beta = std::sqrt(alpha * alpha + xnorm * xnorm);
+						if(alpha > 0) {
+							beta = -beta;
+						}
+						t = (beta - alpha) / beta;
+						T scale = T(1) / (alpha - beta);
+						for(int c = i + 2; c < n; ++c) {
+							row[c] *= scale;
+						}
+					}
+					e[i] = beta;
+					tau[i] = t;
+					v[0] = 1;
+					std::copy(row + i + 2, row + n, v.begin() + 1);
+					for(int r = 0; r < m; ++r) {
+						V[(i + 1 + r) * pb + jj] = v[r];
+					}
+					if(t == T(0)) {
+						continue;
+					}
+
+					/* w = tau * (A22 - V W^T - W V^T) v - tau/2 (w^T v) v */
+					for(int r = 0; r < m; ++r) {
+						const T *ar = a + (i + 1 + r) * n + i + 1;
+						T sum = 0;
+						for(int c = 0; c < m; ++c) {
+							sum += ar[c] * v[c];
+						}
+						w[r] = sum;
+					}
+					for(int s = 0; s < jj; ++s) {
+						T wv = 0, vv = 0;
+						for(int r = 0; r < m; ++r) {
+							wv += W[(i + 1 + r) * pb + s] * v[r];
+							vv += V[(i + 1 + r) * pb + s] * v[r];
+						}
+						for(int r = 0; r < m; ++r) {
+							w[r] -= V[(i + 1 + r) * pb + s] * wv + W[(i + 1 + r) * pb + s] * vv;
+						}
+					}
+					T wv = 0;
+					for(int r = 0; r < m; ++r) {
+						w[r] *= t;
+						wv += w[r] * v[r];
+					}
+					wv *= -t / 2;
+					for(int r = 0; r < m; ++r) {
+						W[(i + 1 + r) * pb + jj] = w[r] + wv * v[r];
+					}
+				}
+
+				/* trailing matrix: A22 -= V W^T + W V^T */
+				const int r0 = k + pb;
+				const int m = n - r0;
+				if(m > 0) {
+					T *a22 = a + r0 * n + r0;
+					gemm(m, m, pb, T(-1), V.data() + r0 * pb, pb, 1, W.data() + r0 * pb, 1, pb, T(1), a22, n, 1);
+					gemm(m, m, pb, T(-1), W.data() + r0 * pb, pb, 1, V.data() + r0 * pb, 1, pb, T(1), a22, n, 1);
+				}
+			}
+			d[n - 1] = a[(n - 1) * n + n - 1];
+			if(n > 0) {
+				e[n - 1] = 0;
+			}
+		}
+
+		/**
+		 * Z = Q * Z for the Q of tridiagonalize(), Z being n x cols (row-major).
+		 * Reflectors are applied nb at a time as I - V S V^T (compact WY form,
+		 * S upper triangular), which is three gemm() calls per block.
+		 */
+		template<typename T>
+		void applyReflectors(const T *a, const T *tau, int n, int nb, T *z, int cols) {
+			const int count = n - 1;
+			std::vector<T> V, S, VtZ, SVtZ;
+			for(int k = ((count - 1) / nb) * nb; k >= 0; k -= nb) {
+				const int pb = std::min(nb, count - k);
+				const int m = n - k - 1;
+				/* V: m x pb, column t is reflector k+t on rows k+1..n-1 */
+				V.assign(static_cast<size_t>(m) * pb, T(0));
+				for(int t = 0; t < pb; ++t) {
+					const int i = k + t;
+					V[t * pb + t] = 1;
+					for(int r = i + 2; r < n; ++r) {
+						V[(r - k - 1) * pb + t] = a[i * n + r];
+					}
+				}
+				S.assign(static_cast<size_t>(pb) * pb, T(0));
+				for(int j = 0; j < pb; ++j) {
+					/* S(0:j, j) = -tau_j S(0:j, 0:j) V(:, 0:j)^T v_j */
+					std::vector<T> vv(j, T(0));
+					for(int i = 0; i < j; ++i) {
+						for(int r = 0; r < m; ++r) {
+							vv[i] += V[r * pb + i] * V[r * pb + j];
+						}
+					}
+					for(int i = 0; i < j; ++i) {
+						T sum = 0;
+						for(int l = i; l < j; ++l) {
+							sum += S[i * pb + l] * vv[l];
+						}
+						S[i * pb + j] = -tau[k + j] * sum;
+					}
+					S[j * pb + j] = tau[k + j];
+				}
+				T *zk = z + (k + 1) * cols;
+				VtZ.resize(static_cast<size_t>(pb) * cols);
+				SVtZ.resize(static_cast<size_t>(pb) * cols);
+				gemm(pb, cols, m, T(1), V.data(), 1, pb, zk, cols, 1, T(0), VtZ.data(), cols, 1);
+				gemm(pb, cols, pb, T(1), S.data(), pb, 1, VtZ.data(), cols, 1, T(0), SVtZ.data(), cols, 1);
+				gemm(m, cols, pb, T(-1), V.data(), pb, 1, SVtZ.data(), cols, 1, T(1), zk, cols, 1);
+			}
+		}
+
+		/**
+		 * Implicit-shift QL iteration on the symmetric tridiagonal matrix
+		 * (d, e), e[i] coupling i and i+1. If zt is not null its rows are
+		 * rotated along, so starting from I they end up as the eigenvectors.
+		 * Eigenvalues are not sorted.
+		 */
+		template<typename T>
+		void tridiagonalQL(T *d, T *e, int n, T *zt, int ldz) {
+			const T eps = std::numeric_limits<T>::epsilon();
+			if(n > 0) {
+				e[n - 1] = 0;
+			}
+			for(int l = 0; l < n; ++l) {
+				int iter = 0;
+				int m;
+				do {
+					for(m = l; m < n - 1; ++m) {
+						T dd = std::abs(d[m]) + std::abs(d[m + 1]);
+						if(std::abs(e[m]) <= eps * dd) {
+							break;
+						}
+					}
+					if(m == l) {
+						break;
+					}
+					if(iter++ == 60) {
+						throw std::runtime_error("QL iteration did not converge");
+					}
+					/* Wilkinson-like shift from the leading 2x2 block */
+					T g = (d[l + 1] - d[l]) / (2 * e[l]);
+					T r = std::hypot(g, T(1));
+					g = d[m] - d[l] + e[l] / (g + (g >= 0 ? r : -r));
+					T s = 1, c = 1, p = 0;
+					int i;
+					for(i = m - 1; i >= l; --i) {
+						T f = s * e[i];
+						T b = c * e[i];
+						r = std::hypot(f, g);
+						e[i + 1] = r;
+						if(r == T(0)) {
+							d[i + 1] -= p;
+							e[m] = 0;
+							break;
+						}
+						s = f / r;
+						c = g / r;
+						g = d[i + 1] - p;
+						r = (d[i] - g) * s + 2 * c * b;
+						p = s * r;
+						d[i + 1] = g + p;
+						g = c * r - b;
+						if(zt) {
+							T *zi = zt + i * ldz;
+							T *zi1 = zt + (i + 1) * ldz;
+							for(int k = 0; k < ldz; ++k) {
+								T f1 = zi1[k];
+								zi1[k] = s * zi[k] + c * f1;
+								zi[k] = c * zi[k] - s * f1;
+							}
+						}
+					}
+					if(r == T(0) && i >= l) {
+						continue;
+					}
+					d[l] -= p;
+					e[l] = g;
+					e[m] = 0;
+				} while(m != l);
+			}
+		}
+
+		/**
+		 * Root lambda of the secular equation 1/rho + sum z_j^2 / (d_j - lambda) = 0
+		 * in the interval next to pole i, d sorted ascending, rho > 0, |z| = 1.
+		 * delta[j] = d_j - lambda is returned too, computed relative to the
+		 * nearer pole to keep it accurate.
+		 */
+		template<typename T>
+		T secularRoot(const T *d, const T *z, int k, T rho, int i, T *delta) {
+			const T eps = std::numeric_limits<T>::epsilon();
+			int origin = i;
+			T lo, hi;
+			if(i < k - 1) {
+				T gap = d[i + 1] - d[i];
+				T mid = gap / 2;
+				T f = 1 / rho;
+				for(int j = 0; j < k; ++j) {
+					f += z[j] * z[j] / ((d[j] - d[i]) - mid);
+				}
+				if(f >= 0) {
+					lo = 0;
+					hi = mid;
+				} else {
+					origin = i + 1;
+					lo = -mid;
+					hi = 0;
+				}
+			} else {
+				lo = 0;
+				hi = rho;
+			}
+			const T base = d[origin];
+			T tau = (lo + hi) / 2;
+			for(int iter = 0; iter < 200; ++iter) {
+				T f = 1 / rho, df = 0, fabs = 1 / rho;
+				for(int j = 0; j < k; ++j) {
+					T dj = (d[j] - base) - tau;
+					T q = z[j] / dj;
+					f += z[j] * q;
+					fabs += std::abs(z[j] * q);
+					df += q * q;
+				}
+				/* f is zero within its rounding error */
+				if(std::abs(f) <= 4 * k * eps * fabs) {
+					break;
+				}
+				if(f < 0) {
+					lo = tau;
+				} else {
+					hi = tau;
+				}
+				tau -= f / df;
+				if(!(tau > lo && tau < hi)) {
+					tau = (lo + hi) / 2;
+				}
+				/* relative to tau, which may be far below the spacing of the d */
+				if(hi - lo <= 2 * eps * (std::abs(lo) + std::abs(hi))) {
+					break;
+				}
+			}
+			for(int j = 0; j < k; ++j) {
+				delta[j] = (d[j] - base) - tau;
+			}
+			return base + tau;
+		}
+
+		/** Rotation of coordinates i, j: columns i, j of G are (c, s), (-s, c) */
+		template<typename T>
+		struct Givens {
+			int i;
+			int j;
+			T c;
+			T s;
+		};
+
+		/**
+		 * Eigendecomposition of D + rho*z*z^T, |z| = 1, for any d and rho.
+		 * Deflates small components of z and close pairs of d, solves the
+		 * secular equation for the rest and rebuilds z (Gu-Eisenstat) so the
+		 * eigenvectors stay orthogonal.
+		 * @param[out] lambda eigenvalues, ascending
+		 * @param[out] U k x k, eigenvectors in the columns
+		 */
+		template<typename T>
+		void rankOneEigen(const T *dIn, const T *zIn, int k, T rho, T *lambda, T *U) {
+			const T eps = std::numeric_limits<T>::epsilon();
+			/* rho < 0: solve -D + |rho| z z^T and negate */
+			const T sign = (rho < 0) ? T(-1) : T(1);
+			rho *= sign;
+			std::vector<T> d(k), z(zIn, zIn + k);
+			for(int j = 0; j < k; ++j) {
+				d[j] = sign * dIn[j];
+			}
+			std::vector<int> order(k);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](int a, int b) { return d[a] < d[b]; });
+
+			/* Givens rotations of the deflation, in the order they were found */
+			std::vector<Givens<T> > rotations;
+			T dmax = 0;
+			for(int j = 0; j < k; ++j) {
+				dmax = std::max(dmax, std::abs(d[j]));
+			}
+			const T tol = 8 * eps * std::max(dmax, rho);
+			std::vector<int> kept;
+			std::vector<bool> deflated(k, false);
+			int prev = -1;
+			for(int idx = 0; idx < k; ++idx) {
+				const int j = order[idx];
+				if(rho * std::abs(z[j]) <= tol) {
+					deflated[j] = true;
+					continue;
+				}
+				if(prev >= 0) {
+					T s = z[prev], c = z[j];
+					T t = std::hypot(c, s);
+					c /= t;
+					s = -s / t;
+					if(std::abs((d[j] - d[prev]) * c * s) <= tol) {
+						/* rotate z[prev] into z[j]; prev becomes an eigenvector */
+						z[j] = t;
+						z[prev] = 0;
+						Givens<T> g = {prev, j, c, s};
+						rotations.push_back(g);
+						T dp = d[prev] * c * c + d[j] * s * s;
+						d[j] = d[prev] * s * s + d[j] * c * c;
+						d[prev] = dp;
+						deflated[prev] = true;
+						kept.pop_back();
+					}
+				}
+				kept.push_back(j);
+				prev = j;
+			}
+
+			/* secular equation on the kept part, sorted by d */
+			std::sort(kept.begin(), kept.end(), [&](int a, int b) { return d[a] < d[b]; });
+			const int kk = static_cast<int>(kept.size());
+			std::vector<T> dk(kk), zk(kk), lam(kk), delta(static_cast<size_t>(kk) * kk);
+			T znorm = 0;
+			for(int j = 0; j < kk; ++j) {
+				dk[j] = d[kept[j]];
+				zk[j] = z[kept[j]];
+				znorm += zk[j] * zk[j];
+			}
+			znorm = std::sqrt(znorm);
+			const T rhoK = rho * znorm * znorm;
+			for(int j = 0; j < kk; ++j) {
+				zk[j] /= znorm;
+			}
+			for(int i = 0; i < kk; ++i) {
+				lam[i] = secularRoot(dk.data(), zk.data(), kk, rhoK, i, delta.data() + i * kk);
+			}
+			/* z recomputed from the roots: z_j^2 = prod(lambda_i - d_j) / (rho prod_{i!=j}(d_i - d_j)) */
+			for(int j = 0; j < kk; ++j) {
+				T p = -delta[j * kk + j] / rhoK;
+				for(int i = 0; i < kk; ++i) {
+					if(i != j) {
+						p *= -delta[i * kk + j] / (dk[i] - dk[j]);
+					}
+				}
+				zk[j] = (zk[j] < 0 ? -1 : 1) * std::sqrt(std::abs(p));
+			}
+
+			/*
+			 * Eigenvectors in the rotated basis: unit vectors for the deflated
+			 * ones, u_i = z / (d - lambda_i) on the kept rows for the others.
+			 */
+			std::vector<std::pair<T, int> > pairs;
+			std::vector<T> vectors(static_cast<size_t>(k) * k, T(0));
+			int col = 0;
+			for(int j = 0; j < k; ++j) {
+				if(deflated[j]) {
+					vectors[j * k + col] = 1;
+					pairs.push_back(std::make_pair(d[j], col++));
+				}
+			}
+			for(int i = 0; i < kk; ++i) {
+				T norm = 0;
+				for(int j = 0; j < kk; ++j) {
+					T u = zk[j] / delta[i * kk + j];
+					vectors[kept[j] * k + col] = u;
+					norm += u * u;
+				}
+				norm = 1 / std::sqrt(norm);
+				for(int j = 0; j < kk; ++j) {
+					vectors[kept[j] * k + col] *= norm;
+				}
+				pairs.push_back(std::make_pair(lam[i], col++));
+			}
+			/* back to the original basis, last rotation first; O(k) per rotation */
+			for(size_t g = rotations.size(); g-- > 0;) {
+				const Givens<T> &r = rotations[g];
+				T *xp = vectors.data() + r.i * k;
+				T *xq = vectors.data() + r.j * k;
+				for(int c = 0; c < k; ++c) {
+					T x = xp[c], y = xq[c];
+					xp[c] = r.c * x - r.s * y;
+					xq[c] = r.s * x + r.c * y;
+				}
+			}
+
+			for(size_t p = 0; p < pairs.size(); ++p) {
+				pairs[p].first *= sign;
+			}
+			std::sort(pairs.begin(), pairs.end());
+			for(int c = 0; c < k; ++c) {
+				lambda[c] = pairs[c].first;
+				for(int r = 0; r < k; ++r) {
+					U[r * k + c] = vectors[r * k + pairs[c].second];
+				}
+			}
+		}
+
+		/**
+		 * Cuppen's divide and conquer on the tridiagonal (d, e): T is split
+		 * into two halves plus a rank-one correction, each half is solved
+		 * recursively and the halves are merged with rankOneEigen() and gemm().
+		 * @param[out] q n x n block (row stride ldq), eigenvectors in the columns
+		 */
+		template<typename T>
+		void tridiagonalDC(T *d, T *e, int n, T *q, int ldq) {
+			if(n <= divideConquerBase) {
+				std::vector<T> zt(static_cast<size_t>(n) * n, T(0));
+				for(int i = 0; i < n; ++i) {
+					zt[i * n + i] = 1;
+				}
+				tridiagonalQL(d, e, n, zt.data(), n);
+				for(int r = 0; r < n; ++r) {
+					for(int c = 0; c < n; ++c) {
+						q[r * ldq + c] = zt[c * n + r];
+					}
+				}
+				return;
+			}
+			const int m = n / 2;
+			const T rho = e[m - 1];
+			d[m - 1] -= rho;
+			d[m] -= rho;
+			for(int r = 0; r < n; ++r) {
+				for(int c = 0; c < n; ++c) {
+					if((r < m) != (c < m)) {
+						q[r * ldq + c] = 0;
+					}
+				}
+			}
+			tridiagonalDC(d, e, m, q, ldq);
+			tridiagonalDC(d + m, e + m, n - m, q + m * ldq + m, ldq);
+
+			/* T = diag(Q1 D1 Q1^T, Q2 D2 Q2^T) + rho u u^T, u = e_{m-1} + e_m */
+			std::vector<T> z(n), U(static_cast<size_t>(n) * n), Q1(static_cast<size_t>(m) * m),
+				Q2(static_cast<size_t>(n - m) * (n - m));
+			const T scale = 1 / std::sqrt(T(2));
+			for(int j = 0; j < m; ++j) {
+				z[j] = q[(m - 1) * ldq + j] * scale;
+			}
+			for(int j = m; j < n; ++j) {
+				z[j] = q[m * ldq + j] * scale;
+			}
+			rankOneEigen(d, z.data(), n, 2 * rho, d, U.data());
+
+			for(int r = 0; r < m; ++r) {
+				std::copy(q + r * ldq, q + r * ldq + m, Q1.begin() + r * m);
+			}
+			for(int r = 0; r < n - m; ++r) {
+				std::copy(q + (m + r) * ldq + m, q + (m + r) * ldq + n, Q2.begin() + r * (n - m));
+			}
+			gemm(m, n, m, T(1), Q1.data(), m, 1, U.data(), n, 1, T(0), q, ldq, 1);
+			gemm(n - m, n, n - m, T(1), Q2.data(), n - m, 1, U.data() + m * n, n, 1, T(0), q + m * ldq, ldq, 1);
+		}
+	}
+
+	/**
+	 * Eigenvalues and eigenvectors of a symmetric matrix.
+	 * A is reduced to tridiagonal form T = Q^T A Q with blocked Householder
+	 * reflections, T is diagonalized with implicit-shift QR or divide and
+	 * conquer, and the eigenvectors of T are mapped back through Q.
+	 * Without eigenvectors the cost is about 4/3 n^3 for the reduction and
+	 * O(n^2) for QR.
+	 * @tparam MatrixType Matrix<T, n, n, Layout> or DynamicMatrix<T>
+	 */
+	template<typename MatrixType>
+	class SymmetricEigenSolver
+	{
+	public:
+		typedef typename MatrixType::Scalar Scalar;
+
+		/**
+		 * @param mat Symmetric matrix; only its lower triangle is read.
+		 * @param computeEigenvectors false for the faster eigenvalues-only mode
+		 */
+		explicit SymmetricEigenSolver(const MatrixType &mat, bool computeEigenvectors = true,
+									  EigenMethod method = EigenMethod::Auto, int blockSize = 32);
+
+		/** Eigenvalues in ascending order */
+		const std::vector<Scalar>& eigenvalues() const { return values; }
+
+		/** Orthonormal eigenvectors in the columns, in the order of eigenvalues() */
+		const MatrixType& eigenvectors() const {
+			assert(hasVectors);
+			return vectors;
+		}
+
+	private:
+		std::vector<Scalar> values;
+		MatrixType vectors;
+		bool hasVectors;
+	};
+
+	template<typename MatrixType>
+	SymmetricEigenSolver<MatrixType>::SymmetricEigenSolver(const MatrixType &mat, bool computeEigenvectors,
+														   EigenMethod method, int blockSize)
+		: values(mat.rows()), hasVectors(computeEigenvectors)
+	{
+		typedef Scalar T;
+		const int n = mat.rows();
+		assert(mat.cols() == n);
+		if(n == 0) {
+			return;
+		}
+		/* full symmetric copy from the lower triangle */
+		std::vector<T> a(static_cast<size_t>(n) * n);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j <= i; ++j) {
+				a[i * n + j] = a[j * n + i] = mat(i, j);
+			}
+		}
+		std::vector<T> d(n), e(n), tau(n);
+		detail::tridiagonalize(a.data(), n, std::max(1, blockSize), d.data(), e.data(), tau.data());
+
+		if(!computeEigenvectors) {
+			detail::tridiagonalQL(d.data(), e.data(), n, static_cast<T*>(nullptr), 0);
+			std::sort(d.begin(), d.end());
+			values = d;
+			return;
+		}
+
+		if(method == EigenMethod::Auto) {
+			method = (n >= detail::divideConquerMin) ? EigenMethod::DivideAndConquer : EigenMethod::QR;
+		}
+		/* the eigenvectors are built row-major whatever the layout of MatrixType */
+		typename detail::RowMajorOf<MatrixType>::type zm(mat);
+		T *z = zm.data();
+		if(method == EigenMethod::DivideAndConquer) {
+			detail::tridiagonalDC(d.data(), e.data(), n, z, n);
+			values = d;
+		} else {
+			std::vector<T> zt(static_cast<size_t>(n) * n, T(0));
+			for(int i = 0; i < n; ++i) {
+				zt[i * n + i] = 1;
+			}
+			detail::tridiagonalQL(d.data(), e.data(), n, zt.data(), n);
+			std::vector<int> order(n);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&](int x, int y) { return d[x] < d[y]; });
+			for(int c = 0; c < n; ++c) {
+				values[c] = d[order[c]];
+				for(int r = 0; r < n; ++r) {
+					z[r * n + c] = zt[order[c] * n + r];
+				}
+			}
+		}
+		if(n > 1) {
+			detail::applyReflectors(a.data(), tau.data(), n, std::max(1, blockSize), z, n);
+		}
+		vectors = std::move(zm);
+	}
+
+	/**
+	 * Drop-in replacement for jakobi(): on exit the diagonal of A holds the
+	 * eigenvalues (ascending, zeros elsewhere) and the columns of X the eigenvectors.
+	 * @see SymmetricEigenSolver
+	 */
+	template<int n>
+	void symmetricEigen(Matrix<double, n, n> &A, Matrix<double, n, n> &X) {
+		SymmetricEigenSolver<Matrix<double, n, n> > solver(A);
+		X = solver.eigenvectors();
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				A(i, j) = (i == j) ? solver.eigenvalues()[i] : 0;
+			}
+		}
+	}
+
+	/** symmetricEigen() for a runtime-sized matrix.
+	 * @param[out] X Resized to the size of A.
+	 */
+	inline void symmetricEigen(DynamicMatrix<double> &A, DynamicMatrix<double> &X) {
+		const int n = A.rows();
+		SymmetricEigenSolver<DynamicMatrix<double> > solver(A);
+		X = solver.eigenvectors();
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				A(i, j) = (i == j) ? solver.eigenvalues()[i] : 0;
+			}
+		}
+	}
+};
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <assert.h>
+
+namespace Math
+{
+	/**
+	 * A small work-stealing thread pool.
+	 * Every thread owns a queue: it takes its own tasks from the back (most
+	 * recently pushed, still in cache) and, when it runs dry, steals from the
+	 * front of the other queues. A thread waiting for a TaskGroup keeps
+	 * running tasks instead of blocking, so tasks may wait for other tasks.
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * @param threads Number of threads doing the work, including the one
+		 *                that waits for the results; 0 means one per core.
+		 *                A pool of one thread runs everything inline.
+		 */
+		explicit ThreadPool(int threads = 0);
+		~ThreadPool();
+
+		int size() const { return static_cast<int>(queues.size()); }
+
+		/** Queues a task; it runs on any thread of the pool. */
+		void submit(std::function<void()> task);
+
+		/**
+		 * Runs one queued task on the calling thread.
+		 * @returns false if there was nothing to run
+		 */
+		bool runPending();
+
+	private:
+		struct Queue {
+			std::mutex mutex;
+			std::deque<std::function<void()> > tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue> > queues;
+		std::vector<std::thread> workers;
+		std::mutex sleepMutex;
+		std::condition_variable wake;
+		std::atomic<int> queued;
+		std::atomic<unsigned> nextQueue;
+		bool stop;
+
+		ThreadPool(const ThreadPool&);
+		ThreadPool& operator=(const ThreadPool&);
+
+		int currentQueue();
+		bool tryPop(int self, std::function<void()> &task);
+		void workerLoop(int self);
+	};
+
+	namespace detail {
+		/* Queue index of the calling thread in the pool it works for */
+		struct PoolThread {
+			const ThreadPool *pool;
+			int index;
+		};
+
+		inline PoolThread& poolThread() {
+			static thread_local PoolThread self = {nullptr, 0};
+			return self;
+		}
+	}
+
+	inline ThreadPool::ThreadPool(int threads) : queued(0), nextQueue(0), stop(false)
+	{
+		if(threads <= 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+		for(int i = 0; i < threads; ++i) {
+			queues.push_back(std::unique_ptr<Queue>(new Queue));
+		}
+		/* queue 0 belongs to the threads outside the pool */
+		for(int i = 1; i < threads; ++i) {
+			workers.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+		}
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stop = true;
+		}
+		wake.notify_all();
+		for(size_t i = 0; i < workers.size(); ++i) {
+			workers[i].join();
+		}
+	}
+
+	inline int ThreadPool::currentQueue() {
+		const detail::PoolThread &self = detail::poolThread();
+		return (self.pool == this) ? self.index : 0;
+	}
+
+	inline void ThreadPool::submit(std::function<void()> task) {
+		if(workers.empty()) {
+			task();
+			return;
+		}
+		int self = currentQueue();
+		/* outside threads spread their tasks over all queues */
+		int target = self ? self : static_cast<int>(nextQueue++ % queues.size());
+		{
+			std::lock_guard<std::mutex> lock(queues[target]->mutex);
+			queues[target]->tasks.push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			++queued;
+		}
+		wake.notify_one();
+	}
+
+	inline bool ThreadPool::tryPop(int self, std::function<void()> &task) {
+		if(queued.load() == 0) {
+			return false;
+		}
+		const int count = size();
+		for(int i = 0; i < count; ++i) {
+			int victim = (self + i) % count;
+			Queue &q = *queues[victim];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if(q.tasks.empty()) {
+				continue;
+			}
+			if(i == 0) {
+				task = std::move(q.tasks.back());
+				q.tasks.pop_back();
+			} else {
+				task = std::move(q.tasks.front());
+				q.tasks.pop_front();
+			}
+			--queued;
+			return true;
+		}
+		return false;
+	}
+
+	inline bool ThreadPool::runPending() {
+		std::function<void()> task;
+		if(!tryPop(currentQueue(), task)) {
+			return false;
+		}
+		task();
+		return true;
+	}
+
+	inline void ThreadPool::workerLoop(int self) {
+		detail::PoolThread &me = detail::poolThread();
+		me.pool = this;
+		me.index = self;
+		std::function<void()> task;
+		for(;;) {
+			if(tryPop(self, task)) {
+				task();
+				task = nullptr;
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			wake.wait(lock, [this] { return stop || queued.load() > 0; });
+			if(stop && queued.load() == 0) {
+				return;
+			}
+		}
+	}
+
+	/**
+	 * A set of tasks that can be waited for.
+	 * The first exception thrown by a task is rethrown by wait().
+	 */
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup(ThreadPool &pool) : pool(pool), pending(0) {}
+		~TaskGroup() { waitNoThrow(); }
+
+		template<typename F>
+		void run(F f) {
+			++pending;
+			pool.submit([this, f]() {
+				try {
+					f();
+				} catch(...) {
+					std::lock_guard<std::mutex> lock(errorMutex);
+					if(!error) {
+						error = std::current_exception();
+					}
+				}
+				--pending;
+			});
+		}
+
+		/** Waits for all tasks, running queued tasks meanwhile. */
+		void wait() {
+			waitNoThrow();
+			if(error) {
+				std::exception_ptr e = error;
+				error = nullptr;
+				std::rethrow_exception(e);
+			}
+		}
+
+	private:
+		ThreadPool &pool;
+		std::atomic<int> pending;
+		std::mutex errorMutex;
+		std::exception_ptr error;
+
+		void waitNoThrow() {
+			while(pending.load() > 0) {
+				if(!pool.runPending()) {
+					std::this_thread::yield();
+				}
+			}
+		}
+	};
+
+	/**
+	 * Calls f(lo, hi) for consecutive chunks of [begin, end) of about `grain`
+	 * iterations, in parallel, and waits for all of them.
+	 */
+	template<typename F>
+	void parallelFor(ThreadPool &pool, int begin, int end, int grain, F f) {
+		grain = std::max(1, grain);
+		if(pool.size() == 1 || end - begin <= grain) {
+			if(begin < end) {
+				f(begin, end);
+			}
+			return;
+		}
+		TaskGroup group(pool);
+		for(int lo = begin; lo < end; lo += grain) {
+			int hi = std::min(end, lo + grain);
+			group.run([f, lo, hi]() { f(lo, hi); });
+		}
+		group.wait();
+	}
+
+	/**
+	 * Tasks with dependencies, run on a ThreadPool.
+	 * A task is handed to the pool as soon as the tasks it depends on have
+	 * finished, so independent work from different steps of an algorithm
+	 * overlaps instead of meeting at a barrier after every step. Tasks are
+	 * added first and may only depend on tasks added before them; run()
+	 * then executes the whole graph.
+	 */
+	class TaskGraph
+	{
+	public:
+		explicit TaskGraph(ThreadPool &pool) : pool(pool) {}
+
+		/**
+		 * @param after Tasks that must finish first; negative ids are ignored.
+		 * @returns The id of the new task.
+		 */
+		int add(std::function<void()> task, const std::vector<int> &after = std::vector<int>());
+
+		int size() const { return static_cast<int>(nodes.size()); }
+
+		/**
+		 * Runs every task and waits for all of them. The first exception is
+		 * rethrown; tasks depending on a failed task do not run.
+		 */
+		void run();
+
+	private:
+		struct Node {
+			std::function<void()> task;
+			std::vector<int> next;
+			int deps;
+		};
+
+		ThreadPool &pool;
+		std::vector<Node> nodes;
+
+		void start(TaskGroup &group, std::atomic<int> *remaining, int t);
+	};
+
+	inline int TaskGraph::add(std::function<void()> task, const std::vector<int> &after) {
+		const int t = size();
+		Node node = {std::move(task), std::vector<int>(), 0};
+		for(int before : after) {
+			if(before >= 0) {
+				assert(before < t);
+				nodes[before].next.push_back(t);
+				++node.deps;
+			}
+		}
+		nodes.push_back(std::move(node));
+		return t;
+	}
+
+	inline void TaskGraph::start(TaskGroup &group, std::atomic<int> *remaining, int t) {
+		group.run([this, &group, remaining, t]() {
+			nodes[t].task();
+			for(int next : nodes[t].next) {
+				if(--remaining[next] == 0) {
+					start(group, remaining, next);
+				}
+			}
+		});
+	}
+
+	inline void TaskGraph::run() {
+		if(pool.size() == 1) {
+			/* the order of addition respects every dependency */
+			for(Node &node : nodes) {
+				node.task();
+			}
+			return;
+		}
+		std::unique_ptr<std::atomic<int>[]> remaining(new std::atomic<int>[nodes.size()]);
+		for(size_t t = 0; t < nodes.size(); ++t) {
+			remaining[t] = nodes[t].deps;
+		}
+		TaskGroup group(pool);
+		for(int t = 0; t < size(); ++t) {
+			if(nodes[t].deps == 0) {
+				start(group, remaining.get(), t);
+			}
+		}
+		group.wait();
+	}
+
+	namespace detail {
+		inline std::unique_ptr<ThreadPool>& defaultPoolPtr() {
+			static std::unique_ptr<ThreadPool> pool;
+			return pool;
+		}
+
+		inline std::mutex& defaultPoolMutex() {
+			static std::mutex mutex;
+			return mutex;
+		}
+	}
+
+	/**
+	 * Sets the number of threads of the pool returned by defaultThreadPool().
+	 * Must not be called while the pool is working.
+	 */
+	inline void setNumThreads(int threads) {
+		std::lock_guard<std::mutex> lock(detail::defaultPoolMutex());
+		detail::defaultPoolPtr().reset(new ThreadPool(threads));
+	}
+
+	/** Shared pool, one thread per core unless changed with setNumThreads(). */
+	inline ThreadPool& defaultThreadPool() {
+		std::lock_guard<std::mutex> lock(detail::defaultPoolMutex());
+		std::unique_ptr<ThreadPool> &pool = detail::defaultPoolPtr();
+		if(!pool) {
+			pool.reset(new ThreadPool());
+		}
+		return *pool;
+	}
+};
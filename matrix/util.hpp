@@ -15,14 +15,60 @@ namespace Math {
 		return E;
 	}
 
-	
+
+	/**
+	 * @returns Identity matrix of a runtime size.
+	 */
+	template<typename T>
+	Math::DynamicMatrix<T> identity(int n) {
+		Math::DynamicMatrix<T> E(n, n);
+		for(int i = 0; i < n; ++i) {
+			E(i, i) = 1;
+		}
+		return E;
+	}
+
+	namespace detail {
+		template<typename T, int n>
+		void invert(const Matrix<T, n, n> &mat, Matrix<T, n, n> &inv, std::integral_constant<int, 0>) {
+			Matrix<T, n, n+n> cat = concatenateH(mat, identity<T, n>());
+			gauss(cat, inv);
+		}
+
+		template<typename T, int n, int method>
+		void invert(const Matrix<T, n, n> &mat, Matrix<T, n, n> &inv, std::integral_constant<int, method> m) {
+			smallInverse<n>(mat.data(), inv.data(), m);
+		}
+	}
+
 	/** Inverted matrix
-	 *
+	 * Up to 4 x 4 it is the adjugate over the determinant, up to 8 x 8 an
+	 * unrolled Gauss-Jordan elimination; a singular matrix gives non-finite elements.
 	 */
 	template<typename T, int n>
 	Math::Matrix<T, n, n> invert(const Math::Matrix<T, n, n> &mat) {
 		Math::Matrix<T, n, n> inv;
-		Math::Matrix<T, n, n+n> cat = concatenateH(mat, identity<T, n>());
+		detail::invert(mat, inv, detail::SmallMethod<n>());
+		return inv;
+	}
+
+	/** Determinant
+	 * Closed form up to 4 x 4, otherwise the product of the pivots of an
+	 * elimination with row pivoting.
+	 */
+	template<typename T, int n>
+	T determinant(const Math::Matrix<T, n, n> &mat) {
+		return detail::smallDeterminant<n>(mat.data(),
+			std::integral_constant<int, detail::SmallMethod<n>::value == 2 ? 2 : 1>());
+	}
+
+	/** Inverted runtime-sized matrix
+	 *
+	 */
+	template<typename T>
+	Math::DynamicMatrix<T> invert(const Math::DynamicMatrix<T> &mat) {
+		Math::DynamicMatrix<T> inv;
+		Math::DynamicMatrix<T> cat = concatenateH(mat, identity<T>(mat.rows()));
 		gauss(cat, inv);
 		return inv;
 	}
@@ -44,16 +90,36 @@ namespace Math {
 		return cat;
 	}
 
+	/**
+	 * Concatenate two runtime-sized matrices horizontally.
+	 * @see concatenateH()
+	 */
+	template<typename T>
+	DynamicMatrix<T> concatenateH(const DynamicMatrix<T> &mat1, const DynamicMatrix<T> &mat2) {
+		assert(mat1.rows() == mat2.rows());
+		const int n = mat1.rows();
+		const int r = mat1.cols();
+		const int s = mat2.cols();
+		DynamicMatrix<T> cat(n, r + s, uninitialized);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < r + s; ++j) {
+				cat(i, j) = (j < r) ? mat1(i, j) : mat2(i, j-r);
+			}
+		}
+		return cat;
+	}
+
 	/**
 	 * Pretty print
 	 * Prints matrix in a pretty way. New line is inserted after.
 	 */
-	template<typename T, int n, int m>
-	std::ostream& operator<<(std::ostream &os, const Matrix<T, n, m> &mat) {
+	template<typename E>
+	std::ostream& operator<<(std::ostream &os, const MatrixExpr<E> &expr) {
+		const E &mat = expr.derived();
 		os << std::setprecision(3);
-		for(int i = 0; i < n; ++i) {
+		for(int i = 0; i < mat.rows(); ++i) {
 			os << "| ";
-			for(int j = 0; j < m; ++j) {
+			for(int j = 0; j < mat.cols(); ++j) {
 				if(std::abs(mat(i, j)) < 0.1 && std::abs(mat(i, j)) > 1e6) {
 					os << std::setiosflags(std::ios::scientific);
 				}
@@ -69,8 +135,11 @@ namespace Math {
 	 * Pretty print
 	 * A better pretty print. Writes directly to std::cout. New line is inserted after.
 	 */
-	template<typename T, int n, int m>
-    void prettyPrint(const Matrix<T, n, m> &mat, std::string label = "", int precision = 3) {
+	template<typename E>
+    void prettyPrint(const MatrixExpr<E> &expr, std::string label = "", int precision = 3) {
+		const E &mat = expr.derived();
+		const int n = mat.rows();
+		const int m = mat.cols();
 		std::cout << std::setprecision(precision);
 		int labelLen = label.length();
 		for(int i = 0; i < n; ++i) {
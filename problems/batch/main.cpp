@@ -0,0 +1,271 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "../../matrix/lu.hpp"
+#include "../../matrix/pipeline.hpp"
+
+/*
+ * Solves a stream of linear systems A X = B read from a file or stdin and
+ * writes the solutions as they are found. Reading, solving and writing are
+ * pipelined, with the solving spread over worker threads.
+ *
+ * Text input, per system: "n s", then n rows of n + s numbers (A | B);
+ * lines starting with '#' are skipped. Text output, per system, one line:
+ * "index n s" and the n x s elements of X row by row, or "index error what".
+ *
+ * Binary input, per system: int32 n, int32 s, then n * (n + s) doubles row
+ * by row. Binary output: int64 index, int32 n, int32 s and n * s doubles;
+ * n = -1 without elements for a system that was not solved. Native byte order.
+ */
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	struct System {
+		MatrixXd A, B;
+	};
+
+	struct Solution {
+		MatrixXd X;
+		std::string error;
+	};
+
+	const int maxSize = 1 << 15;
+
+	void checkSizes(long index, long n, long s) {
+		if(n < 1 || s < 1 || n > maxSize || s > maxSize) {
+			throw std::runtime_error("system " + std::to_string(index) + ": bad sizes "
+									 + std::to_string(n) + " " + std::to_string(s));
+		}
+	}
+
+	class Reader
+	{
+	public:
+		Reader(std::istream &in, bool binary) : in(in), binary(binary), index(0) {}
+
+		bool operator()(System &sys) {
+			bool more = binary ? readBinary(sys) : readText(sys);
+			++index;
+			return more;
+		}
+
+	private:
+		std::istream &in;
+		bool binary;
+		long index;
+
+		bool readText(System &sys) {
+			in >> std::ws;
+			while(in.peek() == '#') {
+				in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+				in >> std::ws;
+			}
+			if(in.peek() == std::char_traits<char>::eof()) {
+				return false;
+			}
+			long n = 0, s = 0;
+			in >> n >> s;
+			checkSizes(index, n, s);
+			sys.A.resize(n, n);
+			sys.B.resize(n, s);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n + s; ++j) {
+					in >> ((j < n) ? sys.A(i, j) : sys.B(i, j - n));
+				}
+			}
+			if(!in) {
+				throw std::runtime_error("system " + std::to_string(index) + ": expected "
+										 + std::to_string(n * (n + s)) + " numbers");
+			}
+			return true;
+		}
+
+		bool readBinary(System &sys) {
+			std::int32_t size[2];
+			if(!in.read(reinterpret_cast<char*>(size), sizeof(size))) {
+				if(in.gcount() == 0) {
+					return false;
+				}
+				throw std::runtime_error("system " + std::to_string(index) + ": truncated header");
+			}
+			const int n = size[0], s = size[1];
+			checkSizes(index, n, s);
+			sys.A.resize(n, n);
+			sys.B.resize(n, s);
+			for(int i = 0; i < n; ++i) {
+				in.read(reinterpret_cast<char*>(&sys.A(i, 0)), n * sizeof(double));
+				in.read(reinterpret_cast<char*>(&sys.B(i, 0)), s * sizeof(double));
+			}
+			if(!in) {
+				throw std::runtime_error("system " + std::to_string(index) + ": truncated");
+			}
+			return true;
+		}
+	};
+
+	Solution solve(System &sys) {
+		Solution sol;
+		try {
+			Math::LUFactorization<MatrixXd> lu(sys.A);
+			sol.X = lu.solve(sys.B);
+		} catch(const std::domain_error &e) {
+			sol.error = e.what();
+		}
+		/* the matrices are done with; free them before the result queues up */
+		sys = System();
+		return sol;
+	}
+
+	class Writer
+	{
+	public:
+		Writer(std::ostream &out, bool binary) : out(out), binary(binary) {
+			out.precision(17);
+		}
+
+		void operator()(long index, const Solution &sol) {
+			if(binary) {
+				writeBinary(index, sol);
+			} else {
+				writeText(index, sol);
+			}
+			if(!out) {
+				throw std::runtime_error("write failed");
+			}
+		}
+
+	private:
+		std::ostream &out;
+		bool binary;
+
+		void writeText(long index, const Solution &sol) {
+			out << index;
+			if(!sol.error.empty()) {
+				out << " error " << sol.error << '\n';
+				return;
+			}
+			out << ' ' << sol.X.rows() << ' ' << sol.X.cols();
+			for(int i = 0; i < sol.X.rows(); ++i) {
+				for(int j = 0; j < sol.X.cols(); ++j) {
+					out << ' ' << sol.X(i, j);
+				}
+			}
+			out << '\n';
+		}
+
+		void writeBinary(long index, const Solution &sol) {
+			std::int64_t id = index;
+			std::int32_t size[2] = {-1, 0};
+			if(sol.error.empty()) {
+				size[0] = sol.X.rows();
+				size[1] = sol.X.cols();
+			}
+			out.write(reinterpret_cast<const char*>(&id), sizeof(id));
+			out.write(reinterpret_cast<const char*>(size), sizeof(size));
+			if(sol.error.empty()) {
+				out.write(reinterpret_cast<const char*>(sol.X.data()),
+						  static_cast<std::streamsize>(sol.X.rows()) * sol.X.cols() * sizeof(double));
+			}
+		}
+	};
+
+	void usage(const char *name) {
+		std::cerr << "usage: " << name << " [options]\n"
+				  << "  -i FILE       read the systems from FILE instead of stdin\n"
+				  << "  -o FILE       write the solutions to FILE instead of stdout\n"
+				  << "  -b            binary input and output\n"
+				  << "  --binary-in   binary input\n"
+				  << "  --binary-out  binary output\n"
+				  << "  -j N          solver threads (default: one per core)\n"
+				  << "  -q N          capacity of the queues between the stages (default 64)\n"
+				  << "  -u            write solutions as they complete, not in input order\n"
+				  << "  -s            no throughput and queue report on stderr\n";
+	}
+
+	int intArg(int argc, char **argv, int &i) {
+		if(i + 1 >= argc) {
+			throw std::invalid_argument(std::string(argv[i]) + " needs a value");
+		}
+		return std::atoi(argv[++i]);
+	}
+}
+
+int main(int argc, char **argv) {
+	std::string inName, outName;
+	bool binaryIn = false, binaryOut = false, report = true;
+	Math::PipelineOptions options;
+	try {
+		for(int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if(arg == "-i" && i + 1 < argc) {
+				inName = argv[++i];
+			} else if(arg == "-o" && i + 1 < argc) {
+				outName = argv[++i];
+			} else if(arg == "-b") {
+				binaryIn = binaryOut = true;
+			} else if(arg == "--binary-in") {
+				binaryIn = true;
+			} else if(arg == "--binary-out") {
+				binaryOut = true;
+			} else if(arg == "-j") {
+				options.workers = intArg(argc, argv, i);
+			} else if(arg == "-q") {
+				options.queueSize = intArg(argc, argv, i);
+			} else if(arg == "-u") {
+				options.ordered = false;
+			} else if(arg == "-s") {
+				report = false;
+			} else {
+				usage(argv[0]);
+				return (arg == "-h" || arg == "--help") ? 0 : 2;
+			}
+		}
+	} catch(const std::invalid_argument &e) {
+		std::cerr << e.what() << "\n";
+		usage(argv[0]);
+		return 2;
+	}
+
+	std::ifstream inFile;
+	std::ofstream outFile;
+	if(!inName.empty()) {
+		inFile.open(inName.c_str(), std::ios::binary);
+		if(!inFile) {
+			std::cerr << "cannot open " << inName << "\n";
+			return 1;
+		}
+	}
+	if(!outName.empty()) {
+		outFile.open(outName.c_str(), std::ios::binary);
+		if(!outFile) {
+			std::cerr << "cannot open " << outName << "\n";
+			return 1;
+		}
+	}
+	std::istream &in = inName.empty() ? std::cin : inFile;
+	std::ostream &out = outName.empty() ? std::cout : outFile;
+	std::ios::sync_with_stdio(false);
+
+	try {
+		Math::PipelineStats stats = Math::runPipeline<System>(Reader(in, binaryIn), solve,
+															  Writer(out, binaryOut), options);
+		out.flush();
+		if(report) {
+			std::cerr << "systems " << stats.items << ", " << stats.seconds << " s, "
+					  << stats.throughput() << " systems/s, " << stats.workers << " workers\n"
+					  << "parse -> solve queue: " << stats.input << "\n"
+					  << "solve -> write queue: " << stats.output << "\n";
+		}
+	} catch(const std::exception &e) {
+		out.flush();
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
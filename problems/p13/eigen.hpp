@@ -1,74 +1,113 @@
 #include "../../matrix/util.hpp"
 
 namespace Math {
-	template<int n>
-	double maxOverDiagonal(const Matrix<double, n, n> &A, int &idx_i, int &idx_j) {
-		double max = A(0, 1);
-		idx_i = 0; idx_j = 1;
-		for(int i = 0; i < n-1; ++i) {
-			for(int j = i+1; j < n; ++j) {
-				if(std::abs(max) < std::abs(A(i, j) )) {
-					max = A(i, j);
-					idx_i = i;
-					idx_j = j;
+	namespace detail {
+		template<typename Mat>
+		double maxOverDiagonal(const Mat &A, int n, int &idx_i, int &idx_j) {
+			double max = A(0, 1);
+			idx_i = 0; idx_j = 1;
+			for(int i = 0; i < n-1; ++i) {
+				for(int j = i+1; j < n; ++j) {
+					if(std::abs(max) < std::abs(A(i, j) )) {
+						max = A(i, j);
+						idx_i = i;
+						idx_j = j;
+					}
 				}
 			}
+			return max;
 		}
-		return max;
-	}
 
-	template<int n>
-	void jakobi(Matrix<double, n, n> &A,
-				Matrix<double, n, n> &X,
-				double eps = 1e-5) {
-		X = identity<double, n>();
+		template<typename Mat>
+		void setIdentity(Mat &A, int n) {
+			setZero(A);
+			for(int i = 0; i < n; ++i) {
+				A(i, i) = 1;
+			}
+		}
+
+		template<typename Mat>
+		void jakobi(Mat &A, Mat &X, int n, double eps, SolverStats *stats, const IterationCallback &callback) {
+			StatsRecorder recorder(stats, callback);
+			setIdentity(X, n);
+
+			int i, j;
+			double max = maxOverDiagonal(A, n, i, j);
+			int rotations = 0;
 
-		int i, j;
-		double max = maxOverDiagonal<n>(A, i, j);
+			while(std::abs(max) > eps) {
+				double d = std::sqrt((A(i, i) - A(j, j)) * (A(i, i) - A(j, j)) + 4 * A(i, j) * A(i, j));
+				double c = std::sqrt(0.5 + 0.5 * std::abs(A(i, i) - A(j, j)) / d);
+				int sign = (A(i, j) * (A(i, i) - A(j, j)) > 0) ? 1 : -1;
+				double s = sign * std::sqrt(0.5 - 0.5 * std::abs(A(i, i) - A(j, j)) / d);
 
-						
+				/* X = X*V for the rotation V in the (i, j) plane touches two columns only */
+				for(int k = 0; k < n; ++k) {
+					double x_ki = X(k, i);
+					double x_kj = X(k, j);
+					X(k, i) = c * x_ki + s * x_kj;
+					X(k, j) = -s * x_ki + c * x_kj;
+				}
+
+				for(int k = 0; k < n; ++k) {
+					if(k == i || k == j) {
+						continue;
+					}
 
-		while(std::abs(max) > eps) {
-			auto V = identity<double, n>();
-			
-			double d = std::sqrt((A(i, i) - A(j, j)) * (A(i, i) - A(j, j)) + 4 * A(i, j) * A(i, j));
-			double c = std::sqrt(0.5 + 0.5 * std::abs(A(i, i) - A(j, j)) / d);
-			int sign = (A(i, j) * (A(i, i) - A(j, j)) > 0) ? 1 : -1;
-			double s = sign * std::sqrt(0.5 - 0.5 * std::abs(A(i, i) - A(j, j)) / d);
-			
-			V(i, i) = c;
-			V(j, j) = c;
-			V(i, j) = -s;
-			V(j, i) = s;
+					double a_ki = A(k, i);
+					double a_kj = A(k, j);
 
-			for(int k = 0; k < n; ++k) {
-				if(k == i || k == j) {
-					continue;
+					A(k, i) = c * a_ki + s * a_kj;
+					A(i, k) = A(k, i);
+					A(k, j) = -s * a_ki + c * a_kj;
+					A(j, k) = A(k, j);
 				}
 
-				double a_ki = A(k, i);
-				double a_kj = A(k, j);
+				double a_ii = A(i, i);
+				double a_ij = A(i, j);
+				double a_jj = A(j, j);
+				A(i, i) = c * c * a_ii + 2 * c * s * a_ij + s * s * a_jj;
+				A(j, j) = s * s * a_ii - 2 * c * s * a_ij + c * c * a_jj;
+				A(i, j) = (c * c - s * s) * a_ij + c*s*(a_jj - a_ii);
+				A(j, i) = A(i, j);
 
-				A(k, i) = c * a_ki + s * a_kj;
-				A(i, k) = A(k, i);
-				A(k, j) = -s * a_ki + c * a_kj;
-				A(j, k) = A(k, j);
+				max = maxOverDiagonal(A, n, i, j);
+				if(!recorder.iteration(rotations++, std::abs(max))) {
+					break;
+				}
 			}
-			
-			double a_ii = A(i, i);
-			double a_ij = A(i, j);
-			double a_jj = A(j, j);
-			A(i, i) = c * c * a_ii + 2 * c * s * a_ij + s * s * a_jj;
-			A(j, j) = s * s * a_ii - 2 * c * s * a_ij + c * c * a_jj;
-			A(i, j) = (c * c - s * s) * a_ij + c*s*(a_jj - a_ii);
-			A(j, i) = A(i, j);
-			X = dot(X, V);
-			
-			max = maxOverDiagonal<n>(A, i, j);
+			recorder.finish(rotations, std::abs(max) <= eps);
 		}
-	}	
-}
-
+	}
 
+	template<int n>
+	double maxOverDiagonal(const Matrix<double, n, n> &A, int &idx_i, int &idx_j) {
+		return detail::maxOverDiagonal(A, n, idx_i, idx_j);
+	}
 
+	/** Jacobi eigenvalue method: rotates away the largest off-diagonal element until all are below eps.
+	 * @param[out] stats Optional: rotations, the largest |a_ij| after each of them, time.
+	 * @param callback Optional: sees every rotation and may stop the method.
+	 */
+	template<int n>
+	void jakobi(Matrix<double, n, n> &A,
+				Matrix<double, n, n> &X,
+				double eps = 1e-5,
+				SolverStats *stats = nullptr,
+				const IterationCallback &callback = IterationCallback()) {
+		detail::jakobi(A, X, n, eps, stats, callback);
+	}
 
+	/** Jacobi eigenvalue method for a runtime-sized symmetric matrix.
+	 * @param[out] X Resized to the size of A.
+	 */
+	inline void jakobi(DynamicMatrix<double> &A,
+					   DynamicMatrix<double> &X,
+					   double eps = 1e-5,
+					   SolverStats *stats = nullptr,
+					   const IterationCallback &callback = IterationCallback()) {
+		assert(A.rows() == A.cols());
+		X.resize(A.rows(), A.cols());
+		detail::jakobi(A, X, A.rows(), eps, stats, callback);
+	}
+}
@@ -0,0 +1,199 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <stdexcept>
+#include "../matrix/banded.hpp"
+#include "../matrix/krylov.hpp"
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_banded );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::TridiagonalMatrix<double> TridiagonalXd;
+typedef Math::BandedMatrix<double> BandedXd;
+
+namespace {
+	double random() {
+		return static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+	}
+
+	/* dense n x n with random elements inside the band, zero outside */
+	MatrixXd randomBand(int n, int kl, int ku, double diagonal) {
+		MatrixXd A(n, n);
+		for(int i = 0; i < n; ++i) {
+			for(int j = std::max(0, i - kl); j <= std::min(n - 1, i + ku); ++j) {
+				A(i, j) = random() + (i == j) * diagonal;
+			}
+		}
+		return A;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_banded_conversions ) {
+	std::srand(1);
+	const MatrixXd D = randomBand(9, 1, 1, 4);
+	const TridiagonalXd T(D);
+	BOOST_CHECK_EQUAL(Test::maxAbsDiff(T.toDense(), D), 0);
+	BOOST_CHECK_EQUAL(T.coeff(4, 3), D(4, 3));
+	BOOST_CHECK_EQUAL(T.coeff(0, 5), 0);
+	BOOST_CHECK_EQUAL(T.lower()[0], 0);
+	BOOST_CHECK_EQUAL(T.upper()[8], 0);
+
+	/* the bandwidths come from the nonzero elements */
+	const MatrixXd E = randomBand(12, 2, 3, 0);
+	const BandedXd B(E);
+	BOOST_CHECK_EQUAL(B.lowerBandwidth(), 2);
+	BOOST_CHECK_EQUAL(B.upperBandwidth(), 3);
+	BOOST_CHECK_EQUAL(Test::maxAbsDiff(B.toDense(), E), 0);
+	BOOST_CHECK_EQUAL(Test::maxAbsDiff(BandedXd(T).toDense(), D), 0);
+
+	/* a fixed-size Matrix both ways */
+	Math::Matrix<double, 3, 3> M{2, -1, 0,
+								 -1, 2, -1,
+								 0, -1, 2};
+	TridiagonalXd F(M);
+	F(2, 1) = -3;
+	M(2, 1) = -3;
+	BOOST_CHECK_EQUAL(Test::maxAbsDiff(F.toDense(), M), 0);
+	BOOST_CHECK_EQUAL(Test::maxAbsDiff(BandedXd(M).toDense(), M), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_banded_products ) {
+	std::srand(2);
+	const int n = 40;
+	const MatrixXd D = randomBand(n, 1, 1, 0), E = randomBand(n, 3, 2, 0);
+	const TridiagonalXd T(D);
+	const BandedXd B(E);
+	const MatrixXd x = Test::randomMatrix(n, 1, 21), X = Test::randomMatrix(n, 5, 22);
+	MatrixXd y(n, 1);
+	T.multiply(x.data(), y.data());
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(y, Math::dot(D, x)), 1e-14);
+	B.multiply(x.data(), y.data());
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(y, Math::dot(E, x)), 1e-14);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(T, X), Math::dot(D, X)), 1e-14);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(B, X), Math::dot(E, X)), 1e-14);
+
+	/* operators for the Krylov solvers */
+	BOOST_CHECK(Math::detail::IsLinearOperator<TridiagonalXd>::value);
+	BOOST_CHECK(Math::detail::IsLinearOperator<BandedXd>::value);
+	TridiagonalXd P(n);
+	for(int i = 0; i < n; ++i) {
+		P(i, i) = 4;
+		if(i > 0) {
+			P(i, i - 1) = P(i - 1, i) = -1;
+		}
+	}
+	MatrixXd cg, direct;
+	BOOST_CHECK(Math::conjugateGradient(P, x, cg, 1e-12, 100) < 100);
+	Math::thomas(P, x, direct);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(cg, direct), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( test_banded_thomas ) {
+	std::srand(3);
+	for(int n : {1, 2, 3, 50}) {
+		const MatrixXd D = randomBand(n, 1, 1, 3);
+		const MatrixXd B = Test::randomMatrix(n, 4, 31);
+		MatrixXd x;
+		Math::thomas(TridiagonalXd(D), B, x);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(x, Math::LUFactorization<MatrixXd>(D).solve(B)), 1e-12);
+	}
+
+	/* no pivoting: a zero leading element stops Thomas but not the banded LU */
+	MatrixXd S(2, 2, {0, 1,
+					  1, 0});
+	MatrixXd b(2, 1, {2, 3}), x;
+	BOOST_CHECK_THROW(Math::thomas(TridiagonalXd(S), b, x), std::domain_error);
+	x = Math::BandedLU<double>(TridiagonalXd(S)).solve(b);
+	BOOST_CHECK_EQUAL(x(0, 0), 3);
+	BOOST_CHECK_EQUAL(x(1, 0), 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_banded_lu ) {
+	std::srand(4);
+	const int n = 60;
+	/* no diagonal boost: the pivots come from below */
+	for(int kl : {1, 3}) {
+		for(int ku : {1, 2, 5}) {
+			const MatrixXd A = randomBand(n, kl, ku, 0);
+			const MatrixXd B = Test::randomMatrix(n, 3, 40 + 10 * kl + ku);
+			Math::BandedLU<double> lu((BandedXd(A)));
+			Math::LUFactorization<MatrixXd> dense(A);
+			BOOST_REQUIRE(lu.invertible());
+			const MatrixXd x = lu.solve(B);
+			/* backward error: the residual relative to the size of x */
+			const double xMax = Test::maxAbsDiff(x, MatrixXd(n, 3));
+			BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(A, x), B) / (1 + xMax), 1e-13);
+			BOOST_CHECK_CLOSE(lu.determinant(), dense.determinant(), 1e-8);
+		}
+	}
+
+	/* a fixed-size right-hand side keeps its type */
+	Math::Matrix<double, 3, 3> M{4, 1, 0,
+								 1, 4, 1,
+								 0, 1, 4};
+	Math::Matrix<double, 3, 1> v{1, 2, 3};
+	Math::Matrix<double, 3, 1> y = Math::BandedLU<double>(BandedXd(M)).solve(v);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(MatrixXd(Math::dot(M, y)), MatrixXd(v)), 1e-14);
+
+	/* singular */
+	MatrixXd S(3, 3, {1, 2, 0,
+					  2, 4, 0,
+					  0, 1, 1});
+	Math::BandedLU<double> sl((BandedXd(S)));
+	BOOST_CHECK(!sl.invertible());
+	BOOST_CHECK_EQUAL(sl.determinant(), 0);
+	BOOST_CHECK_THROW(sl.solve(MatrixXd(3, 1)), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_banded_cyclic_reduction ) {
+	std::srand(5);
+	const int count = 37;
+	Math::ThreadPool pool(3);
+	for(int n : {1, 2, 3, 7, 8, 100}) {
+		Math::TridiagonalBatch<double> batch(n, count);
+		const MatrixXd B = Test::randomMatrix(n, count, 51);
+		std::vector<TridiagonalXd> systems;
+		for(int s = 0; s < count; ++s) {
+			systems.push_back(TridiagonalXd(randomBand(n, 1, 1, 3)));
+			batch.set(s, systems.back());
+		}
+		BOOST_CHECK_EQUAL(Test::maxAbsDiff(batch.get(5).toDense(), systems[5].toDense()), 0);
+
+		MatrixXd X, Y;
+		BOOST_CHECK_EQUAL(Math::cyclicReduction(batch, B, X), 0);
+		BOOST_CHECK_EQUAL(Math::cyclicReduction(batch, B, Y, pool), 0);
+		BOOST_CHECK_EQUAL(Test::maxAbsDiff(X, Y), 0);
+		for(int s = 0; s < count; ++s) {
+			MatrixXd b(n, 1), x;
+			for(int i = 0; i < n; ++i) {
+				b(i, 0) = B(i, s);
+			}
+			Math::thomas(systems[s], b, x);
+			for(int i = 0; i < n; ++i) {
+				BOOST_CHECK_SMALL(X(i, s) - x(i, 0), 1e-12);
+			}
+		}
+	}
+
+	/* a system with a zero pivot gets a zero solution and is reported */
+	const int n = 8;
+	Math::TridiagonalBatch<double> batch(n, 3);
+	for(int s = 0; s < 3; ++s) {
+		batch.set(s, TridiagonalXd(randomBand(n, 1, 1, 3)));
+	}
+	batch.diagonal(0)[1] = 0;
+	batch.upper(0)[1] = 0;
+	unsigned char singular[3];
+	MatrixXd X;
+	BOOST_CHECK_EQUAL(Math::cyclicReduction(batch, Test::randomMatrix(n, 3, 52), X, singular), 1);
+	BOOST_CHECK_EQUAL(singular[0], 0);
+	BOOST_CHECK_EQUAL(singular[1], 1);
+	BOOST_CHECK_EQUAL(singular[2], 0);
+	for(int i = 0; i < n; ++i) {
+		BOOST_CHECK_EQUAL(X(i, 1), 0);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
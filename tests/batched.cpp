@@ -0,0 +1,100 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include "../matrix/batched.hpp"
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_batched );
+
+namespace {
+	template<int n>
+	void checkBatch(int count) {
+		typedef Math::Matrix<double, n, n> Mat;
+		Math::SmallBatch<double, n, n> A(count), inv(count);
+		Math::SmallBatch<double, n, 2> B(count), X(count);
+		std::srand(n);
+		for(int k = 0; k < count; ++k) {
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n; ++j) {
+					A(k, i, j) = static_cast<double>(std::rand() % 201 - 100) / 10;
+				}
+				B(k, i, 0) = i + k;
+				B(k, i, 1) = 1;
+			}
+		}
+		/* lane 3 is singular: two equal rows */
+		for(int j = 0; j < n; ++j) {
+			A(3, 1, j) = A(3, 0, j);
+		}
+
+		std::vector<double> det(count), c(count);
+		std::vector<unsigned char> singular(count);
+		Math::determinant(A, det.data());
+		BOOST_CHECK_EQUAL(Math::invert(A, inv, singular.data()), 1);
+		BOOST_CHECK_EQUAL(Math::solve(A, B, X), 1);
+		Math::cond(A, c.data());
+
+		for(int k = 0; k < count; ++k) {
+			Mat a = A.get(k);
+			Math::LUFactorization<Mat> lu(a);
+			BOOST_CHECK_EQUAL(bool(singular[k]), k == 3);
+			BOOST_CHECK_SMALL(det[k] - lu.determinant(), 1e-9 * (1 + std::abs(det[k])));
+			if(k == 3) {
+				BOOST_CHECK(inv.get(k) == Mat());
+				BOOST_CHECK(std::isinf(c[k]));
+				continue;
+			}
+			Mat E = Math::dot(a, inv.get(k)) - Math::identity<double, n>();
+			Math::Matrix<double, n, 2> R = Math::dot(a, X.get(k)) - B.get(k);
+			for(int i = 0; i < n; ++i) {
+				for(int j = 0; j < n; ++j) {
+					BOOST_CHECK_SMALL(E(i, j), 1e-9);
+				}
+				BOOST_CHECK_SMALL(R(i, 0), 1e-9);
+				BOOST_CHECK_SMALL(R(i, 1), 1e-9);
+			}
+			BOOST_CHECK(c[k] >= 1);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_batched_small ) {
+	checkBatch<2>(37);
+	checkBatch<3>(16);
+	checkBatch<4>(9);
+}
+
+BOOST_AUTO_TEST_CASE( test_batched_norm ) {
+	/* the system of problem 10 */
+	Math::SmallBatch<double, 2, 2> A(1);
+	A.set(0, Math::Matrix<double, 2, 2>{1.0, 0.99,
+										 0.99, 0.98});
+	double norm, cond;
+	Math::norm(A, &norm);
+	Math::cond(A, &cond);
+	BOOST_CHECK_CLOSE(norm, 1.99, 1e-12);
+	BOOST_CHECK_CLOSE(cond, 1.99 * 1.99 / 1e-4, 1e-6);
+
+	/* float: eight lanes per vector, and a partial last vector */
+	const int count = 21;
+	Math::SmallBatch<float, 3, 3> F(count);
+	std::srand(7);
+	for(int k = 0; k < count; ++k) {
+		for(int i = 0; i < 3; ++i) {
+			for(int j = 0; j < 3; ++j) {
+				F(k, i, j) = static_cast<float>(std::rand() % 201 - 100) / 10;
+			}
+		}
+	}
+	std::vector<float> norms(count);
+	Math::norm(F, norms.data());
+	for(int k = 0; k < count; ++k) {
+		float best = 0;
+		for(int i = 0; i < 3; ++i) {
+			best = std::max(best, std::abs(F(k, i, 0)) + std::abs(F(k, i, 1)) + std::abs(F(k, i, 2)));
+		}
+		BOOST_CHECK_EQUAL(norms[k], best);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
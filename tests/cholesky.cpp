@@ -0,0 +1,136 @@
+#include <boost/test/unit_test.hpp>
+#include "../matrix/cholesky.hpp"
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_cholesky );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	MatrixXd transpose(const MatrixXd &a) {
+		MatrixXd t(a.cols(), a.rows());
+		for(int i = 0; i < a.rows(); ++i) {
+			for(int j = 0; j < a.cols(); ++j) {
+				t(j, i) = a(i, j);
+			}
+		}
+		return t;
+	}
+
+	/* M*M^T + shift*I */
+	MatrixXd spd(int n, double shift, unsigned seed) {
+		const MatrixXd M = Test::randomMatrix(n, n, seed);
+		MatrixXd A = Math::dot(M, transpose(M));
+		for(int i = 0; i < n; ++i) {
+			A(i, i) += shift;
+		}
+		return A;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_llt_small ) {
+	Math::Matrix<double, 3, 3> A{4, 12, -16,
+								 12, 37, -43,
+								 -16, -43, 98};
+	Math::LLTFactorization<Math::Matrix<double, 3, 3> > llt(A);
+	BOOST_CHECK(llt.positiveDefinite());
+	Math::Matrix<double, 3, 3> L = llt.matrixL();
+	Math::Matrix<double, 3, 3> expected{2, 0, 0,
+										6, 1, 0,
+										-8, 5, 3};
+	BOOST_CHECK(L == expected);
+	BOOST_CHECK_CLOSE(llt.determinant(), 36, 1e-12);
+
+	Math::Matrix<double, 3, 1> b{1, 2, 3};
+	Math::Matrix<double, 3, 1> x = llt.solve(b);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), 1e-10);
+
+	Math::LDLTFactorization<Math::Matrix<double, 3, 3> > ldlt(A);
+	BOOST_CHECK(ldlt.invertible());
+	std::vector<double> d = ldlt.vectorD();
+	BOOST_CHECK_CLOSE(d[0], 4, 1e-12);
+	BOOST_CHECK_CLOSE(d[1], 1, 1e-12);
+	BOOST_CHECK_CLOSE(d[2], 9, 1e-12);
+	BOOST_CHECK_CLOSE(ldlt.matrixL()(2, 1), 5, 1e-12);
+	x = ldlt.solve(b);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( test_llt_tiled ) {
+	const int n = 150, s = 7;
+	const MatrixXd A = spd(n, 1, 1);
+	MatrixXd B(n, s);
+	for(int i = 0; i < n; ++i) {
+		for(int k = 0; k < s; ++k) {
+			B(i, k) = i - 3 * k;
+		}
+	}
+	/* only the lower triangle is read */
+	MatrixXd lowerOnly(A);
+	for(int i = 0; i < n; ++i) {
+		for(int j = i + 1; j < n; ++j) {
+			lowerOnly(i, j) = 1e300;
+		}
+	}
+	const MatrixXd reference = Math::LLTFactorization<MatrixXd>(A, 16).solve(B);
+	const double scale = Test::maxAbsDiff(reference, MatrixXd(n, s));
+
+	Math::ThreadPool pool(4);
+	const int tiles[] = {1, 16, 37, 64, 200};
+	for(int b : tiles) {
+		Math::LLTFactorization<MatrixXd> llt(lowerOnly, b);
+		BOOST_CHECK(llt.positiveDefinite());
+		MatrixXd X = llt.solve(B);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(B, Math::dot(A, X)) / scale, 1e-9);
+
+		MatrixXd L = llt.matrixL();
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(A, Math::dot(L, transpose(L))), 1e-10);
+
+		/* the task graph runs the same operations per tile in the same order */
+		Math::LLTFactorization<MatrixXd> parallel(lowerOnly, pool, b);
+		BOOST_CHECK(parallel.matrixL() == L);
+		BOOST_CHECK(parallel.solve(B, &pool) == X);
+	}
+
+	Math::LUFactorization<MatrixXd> lu(A);
+	Math::LLTFactorization<MatrixXd> llt(A, 32);
+	BOOST_CHECK_CLOSE(llt.determinant(), lu.determinant(), 1e-8);
+}
+
+BOOST_AUTO_TEST_CASE( test_ldlt_indefinite ) {
+	/* symmetric, diagonally dominant, with negative diagonal entries */
+	const int n = 90;
+	MatrixXd A(n, n);
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j <= i; ++j) {
+			double v = (i == j) ? ((i % 3 == 0) ? -(n + 1.0) : n + 1.0) : ((i * j) % 5) / 5.0 - 0.4;
+			A(i, j) = A(j, i) = v;
+		}
+	}
+	MatrixXd B(n, 2);
+	for(int i = 0; i < n; ++i) {
+		B(i, 0) = 1;
+		B(i, 1) = i;
+	}
+	Math::LLTFactorization<MatrixXd> llt(A, 16);
+	BOOST_CHECK(!llt.positiveDefinite());
+	BOOST_CHECK_THROW(llt.solve(B), std::domain_error);
+
+	Math::ThreadPool pool(3);
+	Math::LDLTFactorization<MatrixXd> ldlt(A, pool, 16);
+	BOOST_CHECK(ldlt.invertible());
+	std::vector<double> d = ldlt.vectorD();
+	BOOST_CHECK(d[0] < 0 && d[1] > 0);
+	MatrixXd X = ldlt.solve(B);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(B, Math::dot(A, X)), 1e-10);
+	BOOST_CHECK_CLOSE(ldlt.determinant(), Math::LUFactorization<MatrixXd>(A).determinant(), 1e-8);
+
+	MatrixXd singular(2, 2, {1, 1, 1, 1});
+	Math::LDLTFactorization<MatrixXd> bad(singular);
+	BOOST_CHECK(!bad.invertible());
+	BOOST_CHECK_THROW(bad.solve(MatrixXd(2, 1)), std::domain_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
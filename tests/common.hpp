@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "../matrix/matrix.hpp"
+
+/* Matrices and comparisons shared by the test suites (and the benchmarks) */
+namespace Test
+{
+	typedef Math::DynamicMatrix<double> MatrixXd;
+
+	/** n x cols elements uniform in [-1, 1] in steps of 1e-3, reproducible from the seed */
+	inline MatrixXd randomMatrix(int n, int cols, unsigned seed) {
+		MatrixXd A(n, cols);
+		std::srand(seed);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < cols; ++j) {
+				A(i, j) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+			}
+		}
+		return A;
+	}
+
+	/** Symmetric n x n with the elements of randomMatrix() */
+	inline MatrixXd randomSymmetric(int n, unsigned seed) {
+		MatrixXd A(n, n);
+		std::srand(seed);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j <= i; ++j) {
+				A(i, j) = A(j, i) = static_cast<double>(std::rand() % 2001 - 1000) / 1000;
+			}
+		}
+		return A;
+	}
+
+	/** 1 / (i + j + 1): the classic ill-conditioned matrix */
+	inline MatrixXd hilbert(int n) {
+		MatrixXd H(n, n);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				H(i, j) = 1.0 / (i + j + 1);
+			}
+		}
+		return H;
+	}
+
+	/** max |a_ij - b_ij| over matrices of the same size, any types */
+	template<typename A, typename B>
+	double maxAbsDiff(const A &a, const B &b) {
+		double d = 0;
+		for(int i = 0; i < a.rows(); ++i) {
+			for(int j = 0; j < a.cols(); ++j) {
+				d = std::max(d, std::abs(static_cast<double>(a(i, j) - b(i, j))));
+			}
+		}
+		return d;
+	}
+};
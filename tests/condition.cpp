@@ -0,0 +1,99 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <limits>
+#include <sstream>
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_condition );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* the estimate is a lower bound, and in practice within a factor of 3 */
+	void checkEstimate(double estimate, double exact) {
+		BOOST_CHECK(estimate <= exact * (1 + 1e-8));
+		BOOST_CHECK(estimate >= exact / 3);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_condition_lu ) {
+	for(unsigned seed = 1; seed <= 5; ++seed) {
+		const MatrixXd A = Test::randomMatrix(40, 40, seed);
+		Math::LUFactorization<MatrixXd> lu(A, 16);
+		const MatrixXd inv = lu.inverse();
+		checkEstimate(lu.cond(), Math::detail::norm1(A) * Math::detail::norm1(inv));
+		checkEstimate(lu.cond(Math::Norm::Infinity), Math::detail::normInf(A) * Math::detail::normInf(inv));
+		BOOST_CHECK_CLOSE(lu.rcond() * lu.cond(), 1, 1e-12);
+	}
+
+	/* fixed size: the 2 x 2 of problem 10 is estimated exactly */
+	Math::Matrix<double, 2, 2> M{3, 1,
+								 2, 7};
+	Math::LUFactorization<Math::Matrix<double, 2, 2> > small(M);
+	BOOST_CHECK_CLOSE(small.cond(Math::Norm::Infinity), 9 * 8 / 19.0, 1e-12);
+	BOOST_CHECK_CLOSE(small.cond(), 8 * 9 / 19.0, 1e-12);
+
+	/* ill-conditioned and singular */
+	const MatrixXd H = Test::hilbert(8);
+	Math::LUFactorization<MatrixXd> hl(H);
+	checkEstimate(hl.cond(), Math::detail::norm1(H) * Math::detail::norm1(hl.inverse()));
+	BOOST_CHECK(hl.cond() > 1e9);
+	MatrixXd S(3, 3, {1, 2, 3,
+					  2, 4, 6,
+					  1, 0, 1});
+	Math::LUFactorization<MatrixXd> sl(S);
+	BOOST_CHECK_EQUAL(sl.rcond(), 0);
+	BOOST_CHECK(sl.cond() == std::numeric_limits<double>::infinity());
+}
+
+BOOST_AUTO_TEST_CASE( test_condition_gauss ) {
+	const int n = 30;
+	const MatrixXd A = Test::randomMatrix(n, n, 7);
+	Math::LUFactorization<MatrixXd> lu(A);
+	const double exact = Math::detail::norm1(A) * Math::detail::norm1(lu.inverse());
+	const Math::Pivoting modes[] = {Math::Pivoting::None, Math::Pivoting::Rows,
+									Math::Pivoting::Columns, Math::Pivoting::Full};
+	for(Math::Pivoting p : modes) {
+		MatrixXd ext(n, n + 1), x;
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				ext(i, j) = A(i, j);
+			}
+			ext(i, n) = i;
+		}
+		Math::Matrix<double, n, n + 1, Math::ColMajor> fixed(ext);
+		Math::Matrix<double, n, 1> y;
+		Math::SolverStats stats, fixedStats;
+		Math::gauss(ext, x, p, 1e-5, &stats);
+		Math::gauss(fixed, y, p, 1e-5, &fixedStats);
+		checkEstimate(1 / stats.rcond, exact);
+		BOOST_CHECK(!stats.illConditioned);
+		BOOST_CHECK_CLOSE(fixedStats.rcond, stats.rcond, 1e-6);
+	}
+
+	/* the warning that replaces "Small leading element" */
+	const int m = 14;
+	MatrixXd ext(m, m + 1), x;
+	const MatrixXd H = Test::hilbert(m);
+	for(int i = 0; i < m; ++i) {
+		for(int j = 0; j < m; ++j) {
+			ext(i, j) = H(i, j);
+		}
+		ext(i, m) = 1;
+	}
+	Math::SolverStats stats;
+	Math::gauss(ext, x, Math::Pivoting::Rows, 1e-5, &stats);
+	BOOST_CHECK(stats.illConditioned);
+	BOOST_CHECK(stats.rcond < std::numeric_limits<double>::epsilon());
+	std::ostringstream text;
+	text << stats;
+	BOOST_CHECK(text.str().find("ill-conditioned") != std::string::npos);
+
+	/* -1 until a direct method estimates it */
+	Math::SolverStats none;
+	BOOST_CHECK_EQUAL(none.rcond, -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
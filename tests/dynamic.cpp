@@ -0,0 +1,142 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include "../matrix/linsys.hpp"
+#include "../matrix/util.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_dynamic );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+BOOST_AUTO_TEST_CASE( test_storage ) {
+	MatrixXd a(3, 5);
+	BOOST_CHECK_EQUAL(a.rows(), 3);
+	BOOST_CHECK_EQUAL(a.cols(), 5);
+	BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(a.data()) % 64, 0u);
+	BOOST_CHECK_EQUAL(a(2, 4), 0);
+
+	const double *p = a.data();
+	MatrixXd b(std::move(a));
+	BOOST_CHECK(b.data() == p);
+	BOOST_CHECK(a.data() == nullptr);
+
+	MatrixXd c(1000, 1000, Math::uninitialized);
+	c(999, 999) = 1;
+	BOOST_CHECK_EQUAL(c(999, 999), 1);
+}
+
+BOOST_AUTO_TEST_CASE( test_dynamic_gauss ) {
+	MatrixXd mat(2, 3, {2, 3,  6,
+						4, 9, 15});
+	MatrixXd expected_x(2, 1, {1.5, 1});
+	MatrixXd x;
+	Math::gauss(mat, x);
+	BOOST_CHECK(x == expected_x);
+}
+
+BOOST_AUTO_TEST_CASE( test_dynamic_LU_invert ) {
+	MatrixXd mat(3, 3, {2, -14, 8,
+						3, -22, 7,
+						0, 2, 5});
+	MatrixXd L_exp(3, 3, {2, 0, 0,
+						  3, -1, 0,
+						  0, 2, -5});
+	MatrixXd U_exp(3, 3, {1, -7, 4,
+						  0, 1, 5,
+						  0, 0, 1});
+	MatrixXd L, U;
+	Math::luDecomposition(mat, L, U);
+	BOOST_CHECK(L == L_exp);
+	BOOST_CHECK(U == U_exp);
+
+	MatrixXd inv_exp(3, 3, {-12.4, 8.6, 7.8,
+							-1.5, 1, 1,
+							0.6, -0.4, -0.2});
+	BOOST_CHECK(Math::invert(mat) == inv_exp);
+}
+
+BOOST_AUTO_TEST_CASE( test_dynamic_iterative ) {
+	MatrixXd mat(3, 3, {4, -1, -1,
+						-2, 6, 1,
+						-1, 1, 7});
+	MatrixXd vec(3, 1, {3, 9, -6});
+	MatrixXd H, g, x;
+	Math::rewriteSystem(mat, vec, H, g);
+	int iter = Math::iterativeSolve(H, g, MatrixXd(3, 1), x);
+	BOOST_CHECK(iter < 100);
+	BOOST_CHECK_SMALL(Math::euclidNorm(vec - Math::dot(mat, x)), 1e-4);
+
+	/* The same system in fixed-size matrices must take the same path */
+	Math::Matrix<double, 3, 3> matf{4, -1, -1,
+			-2, 6, 1,
+			-1, 1, 7};
+	Math::Matrix<double, 3, 1> vecf{3, 9, -6}, xf;
+	iter = Math::seidel(mat, vec, x, 1e-8);
+	BOOST_CHECK_EQUAL(Math::seidel(matf, vecf, xf, 1e-8), iter);
+	for(int i = 0; i < 3; ++i) {
+		BOOST_CHECK_EQUAL(x(i, 0), xf(i, 0));
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_fused_sweeps ) {
+	const int n = 9;
+	MatrixXd mat(n, n), vec(n, 1);
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			mat(i, j) = (i == j) ? 10 : ((3 * i + j) % 7) - 3;
+		}
+		vec(i, 0) = i - 4;
+	}
+	MatrixXd H, g;
+	Math::rewriteSystem(mat, vec, H, g);
+
+	/* plain sweeps, one at a time */
+	MatrixXd jacobi(n, 1), seidel(n, 1);
+	for(int sweeps = 1; sweeps <= 4; ++sweeps) {
+		MatrixXd next(n, 1);
+		for(int i = 0; i < n; ++i) {
+			double sum = g(i, 0), sumS = vec(i, 0);
+			for(int j = 0; j < n; ++j) {
+				sum += H(i, j) * jacobi(j, 0);
+				if(j != i) {
+					sumS -= mat(i, j) * seidel(j, 0);
+				}
+			}
+			next(i, 0) = sum;
+			seidel(i, 0) = sumS / mat(i, i);
+		}
+		jacobi = next;
+
+		/* precision 0 never converges; odd and even counts end in different buffers */
+		MatrixXd x;
+		Math::iterativeSolve(H, g, MatrixXd(n, 1), x, 0, sweeps);
+		BOOST_CHECK_SMALL(Math::euclidNorm(x - jacobi), 1e-14);
+		Math::seidel(mat, vec, x, 0, sweeps);
+		BOOST_CHECK_SMALL(Math::euclidNorm(x - seidel), 1e-14);
+	}
+
+	/* the solution may overwrite the right-hand side */
+	MatrixXd x, b(vec);
+	int iter = Math::seidel(mat, vec, x, 1e-10);
+	BOOST_CHECK_EQUAL(Math::seidel(mat, b, b, 1e-10), iter);
+	BOOST_CHECK(b == x);
+}
+
+BOOST_AUTO_TEST_CASE( test_dynamic_dot ) {
+	const int n = 70;
+	MatrixXd A(n, n), B(n, n);
+	Math::Matrix<double, n, n> Af, Bf;
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			A(i, j) = Af(i, j) = (i * 7 + j) % 11 - 5;
+			B(i, j) = Bf(i, j) = (i + 3 * j) % 13 - 6;
+		}
+	}
+	MatrixXd C = Math::dot(A, B);
+	Math::Matrix<double, n, n> expected = Math::naiveDot(Af, Bf);
+	BOOST_CHECK(C == MatrixXd(expected));
+	/* mixing fixed and dynamic operands */
+	C -= Math::dot(Af, B);
+	BOOST_CHECK(C == MatrixXd(n, n));
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,67 @@
+#include <boost/test/unit_test.hpp>
+#include "../matrix/linsys.hpp"
+#include "../matrix/util.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_expr );
+
+typedef Math::Matrix<double, 3, 3> Matrix3d;
+typedef Math::Matrix<double, 3, 1> Vector3d;
+
+BOOST_AUTO_TEST_CASE( test_elementwise ) {
+	Vector3d x{1, 2, 3}, y{4, 5, 6};
+	Vector3d expected{6, 9, 12};
+	Vector3d z = 2.0 * x + y;
+	BOOST_CHECK(z == expected);
+
+	z -= x;
+	Vector3d expected2{5, 7, 9};
+	BOOST_CHECK(z == expected2);
+
+	z = -(x - y) * 3.0;
+	Vector3d expected3{9, 9, 9};
+	BOOST_CHECK(z == expected3);
+	BOOST_CHECK_CLOSE(Math::euclidNorm(z - x), std::sqrt(64.0 + 49 + 36), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( test_product ) {
+	Matrix3d A{2, -14, 8,
+			3, -22, 7,
+			0, 2, 5};
+	Vector3d x{1, 1, 1}, b{1, 2, 3};
+
+	Vector3d r = b - Math::dot(A, x);
+	Vector3d expected{5, 14, -4};
+	BOOST_CHECK(r == expected);
+
+	r = b + (-Math::dot(A, x));
+	BOOST_CHECK(r == expected);
+
+	/* x appears on both sides; the product must not see partially updated values */
+	x = Math::dot(A, x) + b;
+	Vector3d expected2{-3, -10, 10};
+	BOOST_CHECK(x == expected2);
+
+	Matrix3d B = A;
+	B = Math::dot(B, Math::identity<double, 3>() * 2.0);
+	BOOST_CHECK(B == A * 2.0);
+}
+
+BOOST_AUTO_TEST_CASE( test_large_product_sum ) {
+	const int n = 40;
+	Math::Matrix<double, n, n> A, B, C;
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			A(i, j) = i - j;
+			B(i, j) = (i + j) % 5;
+			C(i, j) = 1;
+		}
+	}
+	Math::Matrix<double, n, n> expected = Math::naiveDot(A, B);
+	expected += C;
+	Math::Matrix<double, n, n> got = C + Math::dot(A, B);
+	BOOST_CHECK(got == expected);
+	C += Math::dot(A, B);
+	BOOST_CHECK(C == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
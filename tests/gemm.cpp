@@ -0,0 +1,130 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include <vector>
+#include "../matrix/matrix.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_gemm );
+
+namespace {
+	template<typename T, int n, int m>
+	void fillRandom(Math::Matrix<T, n, m> &mat) {
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < m; ++j) {
+				mat(i, j) = static_cast<T>(std::rand() % 201 - 100) / 50;
+			}
+		}
+	}
+
+	template<typename T, int n, int m>
+	double maxDiff(const Math::Matrix<T, n, m> &a, const Math::Matrix<T, n, m> &b) {
+		double diff = 0;
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < m; ++j) {
+				diff = std::max(diff, std::abs(static_cast<double>(a(i, j) - b(i, j))));
+			}
+		}
+		return diff;
+	}
+
+	template<typename T, int n, int m, int r>
+	void checkDot(double tol) {
+		const Math::GemmKernel kernels[] = {Math::GemmKernel::Scalar,
+											Math::GemmKernel::Avx2,
+											Math::GemmKernel::Avx512};
+		Math::Matrix<T, n, r> A;
+		Math::Matrix<T, r, m> B;
+		fillRandom(A);
+		fillRandom(B);
+		Math::Matrix<T, n, m> expected = Math::naiveDot(A, B);
+		for(Math::GemmKernel kernel : kernels) {
+			if(!Math::gemmKernelSupported(kernel)) {
+				continue;
+			}
+			Math::setGemmKernel(kernel);
+			Math::Matrix<T, n, m> product = Math::dot(A, B);
+			BOOST_CHECK_SMALL(maxDiff(product, expected), tol);
+		}
+		Math::setGemmKernel(Math::GemmKernel::Avx512);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_dot_small ) {
+	checkDot<double, 1, 1, 1>(1e-12);
+	checkDot<double, 3, 2, 5>(1e-12);
+	checkDot<int, 7, 9, 5>(0.5);
+}
+
+BOOST_AUTO_TEST_CASE( test_dot_blocked ) {
+	checkDot<double, 37, 53, 29>(1e-10);
+	checkDot<double, 101, 19, 300>(1e-9);
+	checkDot<float, 67, 45, 270>(1e-2);
+	checkDot<long, 20, 20, 20>(0.5);
+}
+
+BOOST_AUTO_TEST_CASE( test_gemm_strides ) {
+	/* C = 2*A^T*B + C, with A stored row-major and read transposed */
+	const int M = 130, N = 70, K = 260;
+	std::vector<double> A(K * M), B(K * N), C(M * N, 1.0), expected(M * N);
+	for(size_t i = 0; i < A.size(); ++i) A[i] = static_cast<double>(i % 13) - 6;
+	for(size_t i = 0; i < B.size(); ++i) B[i] = static_cast<double>(i % 7) - 3;
+	for(int i = 0; i < M; ++i) {
+		for(int j = 0; j < N; ++j) {
+			double sum = 0;
+			for(int k = 0; k < K; ++k) {
+				sum += A[k * M + i] * B[k * N + j];
+			}
+			expected[i * N + j] = 2 * sum + 1;
+		}
+	}
+	Math::gemm(M, N, K, 2.0, A.data(), 1, M, B.data(), N, 1, 1.0, C.data(), N, 1);
+	double diff = 0;
+	for(int i = 0; i < M * N; ++i) {
+		diff = std::max(diff, std::abs(C[i] - expected[i]));
+	}
+	BOOST_CHECK_SMALL(diff, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE( test_trsm ) {
+	/* more rows than a block and more columns than a pass; each triangle,
+	   read through its own strides and through the transposed ones */
+	const int n = 150, s = 300;
+	std::vector<double> A(n * n), X(n * s);
+	std::srand(3);
+	for(int i = 0; i < n * n; ++i) {
+		A[i] = static_cast<double>(std::rand() % 201 - 100) / (100 * n) + ((i / n == i % n) ? 2 : 0);
+	}
+	for(int i = 0; i < n * s; ++i) {
+		X[i] = static_cast<double>(std::rand() % 201 - 100) / 50;
+	}
+	const Math::Triangle triangles[] = {Math::Triangle::Lower, Math::Triangle::UnitLower,
+										Math::Triangle::Upper, Math::Triangle::UnitUpper};
+	for(Math::Triangle tri : triangles) {
+		const bool upper = tri == Math::Triangle::Upper || tri == Math::Triangle::UnitUpper;
+		const bool unit = tri == Math::Triangle::UnitLower || tri == Math::Triangle::UnitUpper;
+		for(bool transposed : {false, true}) {
+			const int rsa = transposed ? 1 : n, csa = transposed ? n : 1;
+			/* B = op(A) X, column-major when A is read transposed */
+			const int rsb = transposed ? 1 : s, csb = transposed ? n : 1;
+			std::vector<double> B(n * s);
+			for(int i = 0; i < n; ++i) {
+				for(int c = 0; c < s; ++c) {
+					double sum = unit ? X[i * s + c] : A[i * rsa + i * csa] * X[i * s + c];
+					for(int j = upper ? i + 1 : 0; j < (upper ? n : i); ++j) {
+						sum += A[i * rsa + j * csa] * X[j * s + c];
+					}
+					B[i * rsb + c * csb] = sum;
+				}
+			}
+			Math::trsm(tri, n, s, A.data(), rsa, csa, B.data(), rsb, csb);
+			double diff = 0;
+			for(int i = 0; i < n; ++i) {
+				for(int c = 0; c < s; ++c) {
+					diff = std::max(diff, std::abs(B[i * rsb + c * csb] - X[i * s + c]));
+				}
+			}
+			BOOST_CHECK_SMALL(diff, 1e-12);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
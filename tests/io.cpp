@@ -0,0 +1,263 @@
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include "../matrix/mapped.hpp"
+#include "../matrix/market.hpp"
+#include "../matrix/util.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_io );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::SparseMatrix<double> SparseXd;
+
+namespace {
+	/* A file name in the working directory, removed with the object */
+	struct TempFile {
+		std::string path;
+		explicit TempFile(const char *name) : path(name) {}
+		~TempFile() { std::remove(path.c_str()); }
+	};
+
+	std::string contents(const std::string &path) {
+		std::ifstream in(path.c_str(), std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+
+	/* 1D Laplacian with 4 on the diagonal */
+	SparseXd tridiagonal(int n) {
+		std::vector<Math::Triplet<double> > t;
+		for(int i = 0; i < n; ++i) {
+			t.push_back({i, i, 4});
+			if(i > 0) t.push_back({i, i - 1, -1});
+			if(i < n - 1) t.push_back({i, i + 1, -1});
+		}
+		return SparseXd(n, n, t);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_binary_dense ) {
+	TempFile file("test_io_dense.bin");
+	MatrixXd ext(3, 4, {4, -1, -1, 3,
+						-2, 6, 1, 9,
+						-1, 1, 7, -6});
+	Math::saveBinary(file.path, ext);
+	const std::string saved = contents(file.path);
+	BOOST_CHECK_EQUAL(saved.size() % 64, 32u);
+
+	MatrixXd x;
+	{
+		Math::MappedMatrix mapped(file.path);
+		BOOST_CHECK(mapped.layout() == Math::BinaryLayout::Dense);
+		BOOST_CHECK_EQUAL(mapped.rows(), 3);
+		BOOST_CHECK_EQUAL(mapped.cols(), 4);
+		MatrixXd view = mapped.dense<double>();
+		BOOST_CHECK(!view.ownsData());
+		BOOST_CHECK(view == ext);
+
+		/* the elimination works on the mapping itself */
+		Math::gauss(view, x);
+		BOOST_CHECK(!view.ownsData());
+		BOOST_CHECK(!(view == ext));
+
+		MatrixXd copy(view);
+		BOOST_CHECK(copy.ownsData());
+		BOOST_CHECK_THROW(mapped.dense<float>(), std::runtime_error);
+		BOOST_CHECK_THROW(mapped.sparse<double>(), std::runtime_error);
+	}
+	MatrixXd expected;
+	Math::gauss(ext, expected);
+	BOOST_CHECK(x == expected);
+	/* the mapping is private */
+	BOOST_CHECK(contents(file.path) == saved);
+
+	Math::saveBinary(file.path, Math::Matrix<float, 2, 2>{1, 2, 3, 4} + Math::Matrix<float, 2, 2>{1, 2, 3, 4});
+	Math::MappedMatrix mapped(file.path);
+	Math::DynamicMatrix<float> f = mapped.dense<float>();
+	BOOST_CHECK_EQUAL(f(1, 0), 6);
+}
+
+BOOST_AUTO_TEST_CASE( test_binary_sparse ) {
+	TempFile file("test_io_sparse.bin");
+	const int n = 50;
+	const SparseXd A = tridiagonal(n);
+	Math::saveBinary(file.path, A);
+
+	Math::MappedMatrix mapped(file.path);
+	BOOST_CHECK(mapped.layout() == Math::BinaryLayout::CSR);
+	BOOST_CHECK_EQUAL(mapped.nonZeros(), A.nonZeros());
+	SparseXd view = mapped.sparse<double>();
+	BOOST_CHECK_EQUAL(view.nonZeros(), A.nonZeros());
+	BOOST_CHECK(view.toDense() == A.toDense());
+	BOOST_CHECK(reinterpret_cast<const char*>(view.values()) >= reinterpret_cast<const char*>(&mapped.header()));
+
+	MatrixXd b(n, 1);
+	for(int i = 0; i < n; ++i) {
+		b(i, 0) = i % 3;
+	}
+	MatrixXd x, xv;
+	int iter = Math::seidel(A, b, x, 1e-10, 200);
+	BOOST_CHECK_EQUAL(Math::seidel(view, b, xv, 1e-10, 200), iter);
+	BOOST_CHECK(x == xv);
+
+	/* copies own their arrays, moves keep the view */
+	SparseXd copy(view);
+	BOOST_CHECK(copy.values() != view.values());
+	BOOST_CHECK(copy.toDense() == A.toDense());
+	const double *values = view.values();
+	SparseXd moved(std::move(view));
+	BOOST_CHECK(moved.values() == values);
+	BOOST_CHECK_EQUAL(view.nonZeros(), 0);
+	copy = moved;
+	BOOST_CHECK(copy.toDense() == A.toDense());
+}
+
+BOOST_AUTO_TEST_CASE( test_binary_errors ) {
+	TempFile file("test_io_bad.bin");
+	BOOST_CHECK_THROW(Math::MappedMatrix("test_io_missing.bin"), std::runtime_error);
+	{
+		std::ofstream out(file.path.c_str(), std::ios::binary);
+		out << std::string(200, 'x');
+	}
+	BOOST_CHECK_THROW(Math::MappedMatrix mapped(file.path), std::runtime_error);
+
+	/* header of a 1000 x 1000 matrix without the elements */
+	Math::saveBinary(file.path, MatrixXd(2, 2));
+	std::string data = contents(file.path);
+	Math::BinaryHeader header;
+	std::memcpy(&header, data.data(), sizeof(header));
+	header.rows = header.cols = 1000;
+	std::memcpy(&data[0], &header, sizeof(header));
+	{
+		std::ofstream out(file.path.c_str(), std::ios::binary);
+		out << data;
+	}
+	Math::MappedMatrix mapped(file.path);
+	BOOST_CHECK_THROW(mapped.dense<double>(), std::runtime_error);
+
+	/* sizes that do not fit an int */
+	header.rows = static_cast<int64_t>(INT_MAX) + 1;
+	std::memcpy(&data[0], &header, sizeof(header));
+	{
+		std::ofstream out(file.path.c_str(), std::ios::binary);
+		out << data;
+	}
+	BOOST_CHECK_THROW(Math::MappedMatrix large(file.path), std::runtime_error);
+
+	/* each size fits, their product does not: a header alone is enough */
+	header.rows = header.cols = 50000;
+	{
+		std::ofstream out(file.path.c_str(), std::ios::binary);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+	BOOST_CHECK_THROW(Math::MappedMatrix dense(file.path), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_binary_corrupt_indices ) {
+	TempFile file("test_io_indices.bin");
+	const int n = 6;
+	Math::saveBinary(file.path, tridiagonal(n));
+	const std::string data = contents(file.path);
+	Math::BinaryHeader header;
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	/* a row pointer going back, then a column index past the last column */
+	const size_t rowPtr = header.offsets[0] + 3 * sizeof(int), colIdx = header.offsets[1] + 4 * sizeof(int);
+	const int back = 1, past = n;
+	for(int k = 0; k < 2; ++k) {
+		std::string bad = data;
+		std::memcpy(&bad[k == 0 ? rowPtr : colIdx], k == 0 ? &back : &past, sizeof(int));
+		{
+			std::ofstream out(file.path.c_str(), std::ios::binary);
+			out << bad;
+		}
+		Math::MappedMatrix mapped(file.path);
+		BOOST_CHECK_THROW(mapped.sparse<double>(), std::runtime_error);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_market_coordinate ) {
+	std::istringstream in(
+		"%%MatrixMarket matrix coordinate real general\n"
+		"% a comment\n"
+		"\n"
+		"3 3 5\n"
+		"1 1 4.5\n"
+		"2 3 -1e-1\n"
+		"3 1 2\n"
+		"2 2 1\n"
+		"2 3 1\n");
+	Math::MatrixMarketReader reader(in);
+	BOOST_CHECK_EQUAL(reader.rows(), 3);
+	BOOST_CHECK_EQUAL(reader.entries(), 5);
+	BOOST_CHECK(reader.coordinate());
+	SparseXd A = reader.readSparse<double>();
+	BOOST_CHECK_EQUAL(A.nonZeros(), 4);
+	BOOST_CHECK_EQUAL(A.coeff(0, 0), 4.5);
+	BOOST_CHECK_CLOSE(A.coeff(1, 2), 0.9, 1e-12);
+	BOOST_CHECK_EQUAL(A.coeff(2, 0), 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_market_symmetric ) {
+	std::istringstream sym(
+		"%%MatrixMarket matrix coordinate integer symmetric\n"
+		"3 3 3\n"
+		"1 1 2\n"
+		"3 1 5\n"
+		"3 3 7\n");
+	MatrixXd A = Math::MatrixMarketReader(sym).readDense<double>();
+	BOOST_CHECK(A == MatrixXd(3, 3, {2, 0, 5,
+									 0, 0, 0,
+									 5, 0, 7}));
+
+	std::istringstream pattern(
+		"%%MatrixMarket matrix coordinate pattern skew-symmetric\n"
+		"2 2 1\n"
+		"2 1\n");
+	A = Math::MatrixMarketReader(pattern).readDense<double>();
+	BOOST_CHECK(A == MatrixXd(2, 2, {0, -1,
+									 1, 0}));
+}
+
+BOOST_AUTO_TEST_CASE( test_market_array ) {
+	/* column-major */
+	std::istringstream general(
+		"%%MatrixMarket matrix array real general\n"
+		"2 3\n"
+		"1\n2\n3\n4\n5\n6\n");
+	Math::MatrixMarketReader reader(general);
+	BOOST_CHECK(!reader.coordinate());
+	BOOST_CHECK(reader.readDense<double>() == MatrixXd(2, 3, {1, 3, 5,
+															   2, 4, 6}));
+
+	/* lower triangle, column by column */
+	std::istringstream sym(
+		"%%MatrixMarket matrix array real symmetric\n"
+		"3 3\n"
+		"1\n2\n3\n4\n5\n6\n");
+	BOOST_CHECK(Math::MatrixMarketReader(sym).readDense<double>() == MatrixXd(3, 3, {1, 2, 3,
+																					  2, 4, 5,
+																					  3, 5, 6}));
+}
+
+BOOST_AUTO_TEST_CASE( test_market_errors ) {
+	std::istringstream banner("%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n");
+	BOOST_CHECK_THROW(Math::MatrixMarketReader reader(banner), std::runtime_error);
+	std::istringstream notMarket("3 3 1\n");
+	BOOST_CHECK_THROW(Math::MatrixMarketReader reader(notMarket), std::runtime_error);
+	std::istringstream range("%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n");
+	Math::MatrixMarketReader reader(range);
+	BOOST_CHECK_THROW(reader.readSparse<double>(), std::runtime_error);
+	std::istringstream truncated("%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n");
+	Math::MatrixMarketReader reader2(truncated);
+	BOOST_CHECK_THROW(reader2.readSparse<double>(), std::runtime_error);
+	std::istringstream large("%%MatrixMarket matrix coordinate real general\n3000000000 1 1\n1 1 1\n");
+	BOOST_CHECK_THROW(Math::MatrixMarketReader reader3(large), std::runtime_error);
+	std::istringstream largeArray("%%MatrixMarket matrix array real general\n50000 50000\n1\n");
+	Math::MatrixMarketReader reader4(largeArray);
+	BOOST_CHECK_THROW(reader4.readDense<double>(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,76 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include "../matrix/jacobi.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_jacobi );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* max |A*X - X*D| and max |X^T*X - I| */
+	void checkEigen(const MatrixXd &A, const MatrixXd &D, const MatrixXd &X, double tol) {
+		const int n = A.rows();
+		MatrixXd AX = Math::dot(A, X);
+		double residual = 0, orthogonality = 0;
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				residual = std::max(residual, std::abs(AX(i, j) - X(i, j) * D(j, j)));
+				double xtx = 0;
+				for(int k = 0; k < n; ++k) {
+					xtx += X(k, i) * X(k, j);
+				}
+				orthogonality = std::max(orthogonality, std::abs(xtx - (i == j)));
+			}
+		}
+		BOOST_CHECK_SMALL(residual, tol);
+		BOOST_CHECK_SMALL(orthogonality, 1e-12);
+	}
+
+	std::vector<double> diagonal(const MatrixXd &D) {
+		std::vector<double> d;
+		for(int i = 0; i < D.rows(); ++i) {
+			d.push_back(D(i, i));
+		}
+		std::sort(d.begin(), d.end());
+		return d;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_jacobi_small ) {
+	/* the matrix of problem 13 */
+	Math::Matrix<double, 3, 3> A{-0.81417, -0.01937, 0.41372,
+			-0.01937, 0.54414, 0.00590,
+			0.41372, 0.00590, -0.81445};
+	Math::Matrix<double, 3, 3> D(A), X;
+	BOOST_CHECK(Math::jacobiEigen(D, X, 1e-10) < 10);
+	checkEigen(MatrixXd(A), MatrixXd(D), MatrixXd(X), 1e-9);
+	BOOST_CHECK_CLOSE(D(1, 1), 0.544416, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE( test_jacobi_cyclic_parallel ) {
+	const int sizes[] = {40, 41};
+	for(int n : sizes) {
+		const MatrixXd A = Test::randomSymmetric(n, n);
+		MatrixXd D(A), X;
+		int sweeps = Math::jacobiEigen(D, X, 1e-12);
+		BOOST_CHECK(sweeps < 15);
+		checkEigen(A, D, X, 1e-10);
+		std::vector<double> expected = diagonal(D);
+
+		const int threads[] = {1, 3};
+		for(int t : threads) {
+			Math::ThreadPool pool(t);
+			MatrixXd Dp(A), Xp;
+			BOOST_CHECK(Math::jacobiEigen(Dp, Xp, pool, 1e-12) < 15);
+			checkEigen(A, Dp, Xp, 1e-10);
+			std::vector<double> d = diagonal(Dp);
+			for(int i = 0; i < n; ++i) {
+				BOOST_CHECK_SMALL(d[i] - expected[i], 1e-10);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
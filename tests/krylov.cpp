@@ -0,0 +1,119 @@
+#include <boost/test/unit_test.hpp>
+#include "../matrix/krylov.hpp"
+#include "../matrix/util.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_krylov );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::SparseMatrix<double> SparseXd;
+
+namespace {
+	/* 5-point stencil on a k x k grid; convection > 0 makes it nonsymmetric */
+	SparseXd stencil(int k, double convection = 0) {
+		std::vector<Math::Triplet<double> > t;
+		for(int i = 0; i < k; ++i) {
+			for(int j = 0; j < k; ++j) {
+				int r = i * k + j;
+				t.push_back({r, r, 4});
+				if(i > 0) t.push_back({r, r - k, -1});
+				if(i < k - 1) t.push_back({r, r + k, -1});
+				if(j > 0) t.push_back({r, r - 1, -1 - convection});
+				if(j < k - 1) t.push_back({r, r + 1, -1 + convection});
+			}
+		}
+		return SparseXd(k * k, k * k, t);
+	}
+
+	MatrixXd ones(int n) {
+		MatrixXd b(n, 1);
+		for(int i = 0; i < n; ++i) {
+			b(i, 0) = 1;
+		}
+		return b;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_cg ) {
+	const int n = 400;
+	SparseXd A = stencil(20);
+	MatrixXd b = ones(n), x;
+	const double eps = 1e-8;
+
+	int seidelIter = Math::seidel(A, b, x, eps, 10000);
+	int cgIter = Math::conjugateGradient(A, b, x, eps, 1000);
+	BOOST_CHECK(cgIter < 1000);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), eps);
+	BOOST_CHECK(10 * cgIter < seidelIter);
+
+	Math::JacobiPreconditioner<double> jacobi(A);
+	Math::SSORPreconditioner<double> ssor(A, 1.2);
+	Math::ILU0Preconditioner<double> ilu(A);
+	int iters[] = {
+		Math::conjugateGradient(A, b, x, jacobi, eps, 1000),
+		Math::conjugateGradient(A, b, x, ssor, eps, 1000),
+		Math::conjugateGradient(A, b, x, ilu, eps, 1000)};
+	BOOST_CHECK(iters[0] <= cgIter + 1);
+	BOOST_CHECK(iters[1] < cgIter);
+	BOOST_CHECK(iters[2] < cgIter);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_nonsymmetric ) {
+	const int n = 400;
+	SparseXd A = stencil(20, 0.5);
+	MatrixXd b = ones(n), x;
+	const double eps = 1e-8;
+	Math::ILU0Preconditioner<double> ilu(A);
+
+	int iter = Math::bicgstab(A, b, x, eps, 1000);
+	BOOST_CHECK(iter < 1000);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), eps);
+	BOOST_CHECK(Math::bicgstab(A, b, x, ilu, eps, 1000) < iter);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), eps);
+
+	iter = Math::gmres(A, b, x, 30, eps, 1000);
+	BOOST_CHECK(iter < 1000);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), eps);
+	BOOST_CHECK(Math::gmres(A, b, x, ilu, 30, eps, 1000) < iter);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), eps);
+}
+
+BOOST_AUTO_TEST_CASE( test_krylov_dense ) {
+	Math::Matrix<double, 3, 3> mat{4, -1, -1,
+			-2, 6, 1,
+			-1, 1, 7};
+	Math::Matrix<double, 3, 1> b{3, 9, -6}, x;
+	BOOST_CHECK(Math::gmres(mat, b, x) <= 3);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(mat, x)), 1e-5);
+	BOOST_CHECK(Math::bicgstab(mat, b, x, Math::JacobiPreconditioner<double>(mat)) < 100);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(mat, x)), 1e-5);
+
+	/* SPD */
+	MatrixXd S(3, 3, {4, 1, 0,
+					  1, 3, 1,
+					  0, 1, 2});
+	MatrixXd c(3, 1, {1, 2, 3}), y;
+	BOOST_CHECK(Math::conjugateGradient(S, c, y, 1e-12) <= 4);
+	BOOST_CHECK_SMALL(Math::euclidNorm(c - Math::dot(S, y)), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( test_krylov_layouts ) {
+	/* b and x in padded Tiled storage are read and written element by element */
+	Math::Matrix<double, 3, 3> mat{4, 1, 0,
+			1, 3, 1,
+			0, 1, 2};
+	Math::Matrix<double, 3, 1> b{1, 2, 3}, x;
+	const Math::Matrix<double, 3, 1, Math::Tiled<2> > bt(b);
+	Math::Matrix<double, 3, 1, Math::Tiled<2> > cg, bi, gm;
+	Math::conjugateGradient(mat, b, x, 1e-12);
+	BOOST_CHECK(Math::conjugateGradient(mat, bt, cg, 1e-12) <= 4);
+	BOOST_CHECK(Math::bicgstab(mat, bt, bi, 1e-12) < 100);
+	BOOST_CHECK(Math::gmres(mat, bt, gm, 3, 1e-12) < 100);
+	for(int i = 0; i < 3; ++i) {
+		BOOST_CHECK_SMALL(cg(i, 0) - x(i, 0), 1e-12);
+		BOOST_CHECK_SMALL(bi(i, 0) - x(i, 0), 1e-10);
+		BOOST_CHECK_SMALL(gm(i, 0) - x(i, 0), 1e-10);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,216 @@
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include "../matrix/linsys.hpp"
+#include "../matrix/refine.hpp"
+#include "../matrix/symeig.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_layout );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* Test::randomMatrix() in layout L, plus diagonal on the diagonal */
+	template<int n, int m, typename L>
+	Math::Matrix<double, n, m, L> randomLayout(unsigned seed, double diagonal = 0) {
+		Math::Matrix<double, n, m, L> A(Test::randomMatrix(n, m, seed));
+		for(int i = 0; i < std::min(n, m); ++i) {
+			A(i, i) += diagonal;
+		}
+		return A;
+	}
+
+	/* every product of two layouts into a third agrees with the row-major one */
+	template<int n, int r, int m, typename LA, typename LB, typename LC>
+	void checkProduct() {
+		const Math::Matrix<double, n, r> A = randomLayout<n, r, Math::RowMajor>(1);
+		const Math::Matrix<double, r, m> B = randomLayout<r, m, Math::RowMajor>(2);
+		const Math::Matrix<double, n, m> expected = Math::naiveDot(A, B);
+		const Math::Matrix<double, n, r, LA> a(A);
+		const Math::Matrix<double, r, m, LB> b(B);
+		Math::Matrix<double, n, m, LC> c = Math::dot(a, b);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(c, expected), 1e-12);
+		c += Math::dot(a, b);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(c, expected * 2.0), 1e-12);
+	}
+
+	template<int n, int r, int m, typename LA, typename LB>
+	void checkProducts() {
+		checkProduct<n, r, m, LA, LB, Math::RowMajor>();
+		checkProduct<n, r, m, LA, LB, Math::ColMajor>();
+		checkProduct<n, r, m, LA, LB, Math::Tiled<4> >();
+	}
+
+	template<int n, int r, int m>
+	void checkAllProducts() {
+		checkProducts<n, r, m, Math::RowMajor, Math::RowMajor>();
+		checkProducts<n, r, m, Math::RowMajor, Math::ColMajor>();
+		checkProducts<n, r, m, Math::ColMajor, Math::RowMajor>();
+		checkProducts<n, r, m, Math::ColMajor, Math::ColMajor>();
+		checkProducts<n, r, m, Math::Tiled<4>, Math::Tiled<4> >();
+		checkProducts<n, r, m, Math::Tiled<4>, Math::ColMajor>();
+	}
+
+	template<typename L>
+	void checkGauss() {
+		const int n = 12;
+		typedef Math::Matrix<double, n, n + 2, L> Ext;
+		const Ext ext0 = randomLayout<n, n + 2, L>(3, 4);
+		Math::Matrix<double, n, n + 2> reference(ext0);
+		Math::Matrix<double, n, 2> expected, x;
+		Math::gauss(reference, expected);
+		const Math::Pivoting modes[] = {Math::Pivoting::None, Math::Pivoting::Rows,
+										Math::Pivoting::Columns, Math::Pivoting::Full};
+		for(Math::Pivoting p : modes) {
+			Ext ext(ext0);
+			Math::gauss(ext, x, p);
+			BOOST_CHECK_SMALL(Test::maxAbsDiff(x, expected), 1e-12);
+		}
+		/* same steps in every layout: the same bits */
+		for(Math::Pivoting p : modes) {
+			Ext ext(ext0);
+			Math::Matrix<double, n, n + 2> row(ext0);
+			Math::Matrix<double, n, 2> y;
+			Math::gauss(ext, x, p);
+			Math::gauss(row, y, p);
+			BOOST_CHECK(x == y);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_layout_storage ) {
+	/* every element has a slot of its own, and forEach visits each once */
+	typedef Math::Tiled<4> T4;
+	std::vector<int> hits(T4::size(7, 10));
+	int visits = 0;
+	T4::forEach(7, 10, [&](int i, int j, int idx) {
+		BOOST_CHECK_EQUAL(idx, T4::index(i, j, 7, 10));
+		++hits[idx];
+		++visits;
+	});
+	BOOST_CHECK_EQUAL(visits, 70);
+	BOOST_CHECK_EQUAL(std::count(hits.begin(), hits.end(), 1), 70);
+	Math::ColMajor::forEach(3, 2, [&](int i, int j, int idx) {
+		BOOST_CHECK_EQUAL(idx, j * 3 + i);
+	});
+
+	/* initializer lists are row by row in every layout */
+	Math::Matrix<double, 2, 3, Math::ColMajor> C{1, 2, 3,
+												 4, 5, 6};
+	BOOST_CHECK_EQUAL(C(0, 2), 3);
+	BOOST_CHECK_EQUAL(C(1, 0), 4);
+	BOOST_CHECK_EQUAL(C.data()[1], 4);
+	Math::Matrix<double, 2, 3, Math::Tiled<2> > T(C);
+	BOOST_CHECK_EQUAL(T(1, 2), 6);
+	BOOST_CHECK_EQUAL(T.data()[4], 3);
+	/* the padding of the last tile */
+	BOOST_CHECK_EQUAL(T.data()[5], 0);
+
+	/* elementwise expressions across layouts */
+	const Math::Matrix<double, 5, 7> A = randomLayout<5, 7, Math::RowMajor>(4);
+	const Math::Matrix<double, 5, 7, Math::ColMajor> B(A);
+	const Math::Matrix<double, 5, 7, Math::Tiled<3> > D = A + B;
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(D, A * 2.0), 1e-15);
+	MatrixXd E = D - B;
+	BOOST_CHECK(Test::maxAbsDiff(E, A) == 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_layout_product ) {
+	checkAllProducts<3, 5, 4>();
+	checkAllProducts<7, 9, 6>();
+	/* large enough for gemm() with strides */
+	checkAllProducts<20, 24, 18>();
+}
+
+BOOST_AUTO_TEST_CASE( test_layout_gauss ) {
+	checkGauss<Math::RowMajor>();
+	checkGauss<Math::ColMajor>();
+	checkGauss<Math::Tiled<5> >();
+
+	/* a zero leading element: row, column or full pivoting gets past it */
+	MatrixXd A(3, 4, {0, 2, 1, 5,
+					  1, 1, 1, 5,
+					  2, 1, 3, 12}), x;
+	const Math::Pivoting modes[] = {Math::Pivoting::Rows, Math::Pivoting::Columns, Math::Pivoting::Full};
+	/* where the first pivot is: it is scaled to 1 in place rather than moved to (0, 0) */
+	const int first[][2] = {{2, 0}, {0, 1}, {2, 2}};
+	for(int m = 0; m < 3; ++m) {
+		const Math::Pivoting p = modes[m];
+		MatrixXd ext(A);
+		Math::SolverStats stats;
+		Math::gauss(ext, x, p, 1e-5, &stats);
+		BOOST_CHECK_CLOSE(x(0, 0), 1, 1e-10);
+		BOOST_CHECK_CLOSE(x(1, 0), 1, 1e-10);
+		BOOST_CHECK_CLOSE(x(2, 0), 3, 1e-10);
+		BOOST_CHECK(stats.swaps > 0);
+		BOOST_CHECK_EQUAL(ext(first[m][0], first[m][1]), 1);
+	}
+
+	/* full pivoting takes the largest element of the whole matrix */
+	MatrixXd B(2, 3, {1, 2, 3,
+					  3, 100, 103}), y;
+	Math::SolverStats stats;
+	Math::gauss(B, y, Math::Pivoting::Full, 1e-5, &stats);
+	BOOST_CHECK_EQUAL(stats.swaps, 2);
+	BOOST_CHECK_CLOSE(y(0, 0), 1, 1e-10);
+	BOOST_CHECK_CLOSE(y(1, 0), 1, 1e-10);
+
+	/* the parallel path agrees */
+	Math::ThreadPool pool(3);
+	const int n = 150;
+	const MatrixXd big = Test::randomMatrix(n, n + 1, 5);
+	MatrixXd serial(big), parallel(big), xs, xp;
+	Math::gauss(serial, xs, Math::Pivoting::Rows);
+	Math::gauss(parallel, xp, pool, Math::Pivoting::Rows);
+	BOOST_CHECK(xs == xp);
+}
+
+/* the factorizations read A in its own layout, not data() as row-major */
+template<typename L>
+void checkSolvers() {
+	const Math::Matrix<double, 3, 3> R{4, 1, 0,
+									   2, 5, 1,
+									   0, 1, 3};
+	const Math::Matrix<double, 3, 3, L> A(R);
+	const Math::Matrix<double, 3, 1> b{1, 2, 3};
+	const Math::Matrix<double, 3, 1> expected = Math::LUFactorization<Math::Matrix<double, 3, 3> >(R).solve(b);
+
+	Math::LUFactorization<Math::Matrix<double, 3, 3, L> > lu(A);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(lu.solve(b), expected), 1e-14);
+	BOOST_CHECK_CLOSE(lu.determinant(), 4 * 14 - 1 * 6, 1e-12);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(R, lu.inverse()), Math::Matrix<double, 3, 3>{1, 0, 0, 0, 1, 0, 0, 0, 1}), 1e-14);
+
+	Math::MixedPrecisionSolver<Math::Matrix<double, 3, 3, L> > mixed(A);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(mixed.solve(b), expected), 1e-14);
+
+	/* symmetric: the eigenvectors come back in the layout of A */
+	Math::Matrix<double, 4, 4> S = randomLayout<4, 4, Math::RowMajor>(6);
+	for(int i = 0; i < 4; ++i) {
+		for(int j = 0; j < i; ++j) {
+			S(j, i) = S(i, j);
+		}
+	}
+	Math::SymmetricEigenSolver<Math::Matrix<double, 4, 4> > rowMajor(S);
+	Math::SymmetricEigenSolver<Math::Matrix<double, 4, 4, L> > other((Math::Matrix<double, 4, 4, L>(S)));
+	const Math::Matrix<double, 4, 4, L> &X = other.eigenvectors();
+	for(int c = 0; c < 4; ++c) {
+		BOOST_CHECK_CLOSE(other.eigenvalues()[c], rowMajor.eigenvalues()[c], 1e-10);
+		/* S x = lambda x for every column */
+		for(int i = 0; i < 4; ++i) {
+			double sx = 0;
+			for(int k = 0; k < 4; ++k) {
+				sx += S(i, k) * X(k, c);
+			}
+			BOOST_CHECK_SMALL(sx - other.eigenvalues()[c] * X(i, c), 1e-12);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_layout_solvers ) {
+	checkSolvers<Math::RowMajor>();
+	checkSolvers<Math::ColMajor>();
+	checkSolvers<Math::Tiled<2> >();
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include "../matrix/linsys.hpp"
 #include "../matrix/util.hpp"
+#include "common.hpp"
 
 BOOST_AUTO_TEST_SUITE( test_suite_linsys );
 
@@ -62,6 +63,21 @@ BOOST_AUTO_TEST_CASE( test_invert ) {
 	Math::Matrix<double, 3, 3> inv = Math::invert(mat);
 	BOOST_CHECK(inv == inv_exp);
 }
+
+BOOST_AUTO_TEST_CASE( test_gauss_blocked_pivoting ) {
+	/* several blocks of the back traverse, and for every pivoting the
+	   permutation applied to x in place */
+	const int n = 140;
+	const Math::DynamicMatrix<double> A = Test::randomMatrix(n, n, 2);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(A, Math::invert(A)), Math::identity<double>(n)), 1e-10);
+	const Math::Pivoting modes[] = {Math::Pivoting::None, Math::Pivoting::Rows,
+									Math::Pivoting::Columns, Math::Pivoting::Full};
+	for(Math::Pivoting p : modes) {
+		Math::DynamicMatrix<double> cat = Math::concatenateH(A, Math::identity<double>(n)), X;
+		Math::gauss(cat, X, p);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(A, X), Math::identity<double>(n)), 1e-10);
+	}
+}
 	
 
 BOOST_AUTO_TEST_SUITE_END();
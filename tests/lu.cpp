@@ -0,0 +1,76 @@
+#include <boost/test/unit_test.hpp>
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_lu );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+BOOST_AUTO_TEST_CASE( test_lu_small ) {
+	/* zero leading element: needs pivoting */
+	Math::Matrix<double, 3, 3>
+		mat {0, 2, 5,
+			2, -14, 8,
+			3, -22, 7};
+	Math::LUFactorization<Math::Matrix<double, 3, 3> > lu(mat);
+	BOOST_CHECK(lu.invertible());
+	BOOST_CHECK_CLOSE(lu.determinant(), 10.0, 1e-10);
+
+	Math::Matrix<double, 3, 1> b{7, -4, -12};
+	Math::Matrix<double, 3, 1> x = lu.solve(b);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(mat, x)), 1e-12);
+
+	Math::Matrix<double, 3, 3> inv = lu.inverse();
+	Math::Matrix<double, 3, 3> E = Math::dot(mat, inv) - Math::identity<double, 3>();
+	for(int i = 0; i < 3; ++i) {
+		for(int j = 0; j < 3; ++j) {
+			BOOST_CHECK_SMALL(E(i, j), 1e-12);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_lu_blocked ) {
+	const int n = 150, s = 7;
+	const MatrixXd A = Test::randomMatrix(n, n, 1);
+	MatrixXd B(n, s);
+	for(int i = 0; i < n; ++i) {
+		for(int k = 0; k < s; ++k) {
+			B(i, k) = i - k;
+		}
+	}
+	/* several block sizes, including one that does not divide n */
+	const int blocks[] = {1, 16, 37, 200};
+	for(int nb : blocks) {
+		Math::LUFactorization<MatrixXd> lu(A, nb);
+		MatrixXd X = lu.solve(B);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(B, Math::dot(A, X)), 1e-9);
+	}
+
+	/* P*A = L*U */
+	Math::LUFactorization<MatrixXd> lu(A);
+	const MatrixXd &LU = lu.matrixLU();
+	double maxErr = 0;
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			double sum = 0;
+			for(int k = 0; k <= std::min(i, j); ++k) {
+				sum += ((k == i) ? 1.0 : LU(i, k)) * LU(k, j);
+			}
+			maxErr = std::max(maxErr, std::abs(sum - A(lu.permutation()[i], j)));
+		}
+	}
+	BOOST_CHECK_SMALL(maxErr, 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( test_lu_singular ) {
+	MatrixXd A(3, 3, {1, 2, 3,
+					  2, 4, 6,
+					  1, 0, 1});
+	Math::LUFactorization<MatrixXd> lu(A);
+	BOOST_CHECK(!lu.invertible());
+	BOOST_CHECK_EQUAL(lu.determinant(), 0);
+	BOOST_CHECK_THROW(lu.solve(MatrixXd(3, 1)), std::domain_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
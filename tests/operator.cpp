@@ -0,0 +1,174 @@
+#include <boost/test/unit_test.hpp>
+#include <stdexcept>
+#include "../matrix/krylov.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_operator );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::SparseMatrix<double> SparseXd;
+
+namespace {
+	/* 5-point stencil on a k x k grid, centre c; never stored */
+	Math::LinearOperator<double> stencilOperator(int k, double c) {
+		return Math::LinearOperator<double>(k * k, [k, c](const double *x, double *y) {
+			for(int i = 0; i < k; ++i) {
+				for(int j = 0; j < k; ++j) {
+					const int r = i * k + j;
+					double v = c * x[r];
+					if(i > 0) v -= x[r - k];
+					if(i < k - 1) v -= x[r + k];
+					if(j > 0) v -= x[r - 1];
+					if(j < k - 1) v -= x[r + 1];
+					y[r] = v;
+				}
+			}
+		}, [c](int) { return c; });
+	}
+
+	/* the same operator stored */
+	SparseXd stencilMatrix(int k, double c) {
+		std::vector<Math::Triplet<double> > t;
+		for(int i = 0; i < k; ++i) {
+			for(int j = 0; j < k; ++j) {
+				const int r = i * k + j;
+				t.push_back({r, r, c});
+				if(i > 0) t.push_back({r, r - k, -1});
+				if(i < k - 1) t.push_back({r, r + k, -1});
+				if(j > 0) t.push_back({r, r - 1, -1});
+				if(j < k - 1) t.push_back({r, r + 1, -1});
+			}
+		}
+		return SparseXd(k * k, k * k, t);
+	}
+
+	/* an operator of its own, not a LinearOperator: tridiag(-1, 3, -1) */
+	struct Tridiagonal {
+		typedef double Scalar;
+		int n;
+		int rows() const { return n; }
+		int cols() const { return n; }
+		void apply(const double *x, double *y) const {
+			for(int i = 0; i < n; ++i) {
+				y[i] = 3 * x[i] - (i > 0 ? x[i - 1] : 0) - (i < n - 1 ? x[i + 1] : 0);
+			}
+		}
+		double diagonal(int) const { return 3; }
+	};
+
+	MatrixXd ones(int n) {
+		MatrixXd b(n, 1);
+		for(int i = 0; i < n; ++i) {
+			b(i, 0) = 1;
+		}
+		return b;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_operator_concept ) {
+	BOOST_CHECK(Math::detail::IsLinearOperator<Math::LinearOperator<double> >::value);
+	BOOST_CHECK(Math::detail::IsLinearOperator<Tridiagonal>::value);
+	BOOST_CHECK(!Math::detail::IsLinearOperator<MatrixXd>::value);
+	BOOST_CHECK(!Math::detail::IsLinearOperator<SparseXd>::value);
+	/* preconditioners have apply() too, but no Scalar */
+	BOOST_CHECK(!Math::detail::IsLinearOperator<Math::JacobiPreconditioner<double> >::value);
+
+	Math::LinearOperator<double> noDiagonal(3, [](const double *x, double *y) { std::copy(x, x + 3, y); });
+	BOOST_CHECK(!noDiagonal.hasDiagonal());
+	BOOST_CHECK_THROW(noDiagonal.diagonal(0), std::runtime_error);
+	Math::LinearOperator<double> H(0, Math::LinearOperator<double>::Apply());
+	MatrixXd g;
+	BOOST_CHECK_THROW(Math::rewriteSystem(noDiagonal, ones(3), H, g), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_operator_krylov ) {
+	/* an operator, a sparse and a dense matrix are interchangeable */
+	const int k = 15, n = k * k;
+	const Math::LinearOperator<double> op = stencilOperator(k, 4);
+	const SparseXd sparse = stencilMatrix(k, 4);
+	const MatrixXd dense = sparse.toDense();
+	const MatrixXd b = ones(n);
+	const double eps = 1e-10;
+	MatrixXd xo, xs, xd;
+	const int io = Math::conjugateGradient(op, b, xo, eps, 500);
+	const int is = Math::conjugateGradient(sparse, b, xs, eps, 500);
+	const int id = Math::conjugateGradient(dense, b, xd, eps, 500);
+	BOOST_CHECK(io < 500);
+	BOOST_CHECK_EQUAL(io, is);
+	BOOST_CHECK_EQUAL(io, id);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(xo, xs), 1e-9);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(xo, xd), 1e-9);
+
+	/* the Jacobi preconditioner from the operator's diagonal */
+	MatrixXd xp;
+	Math::conjugateGradient(op, b, xp, Math::JacobiPreconditioner<double>(op), eps, 500);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(xp, xs), 1e-9);
+
+	BOOST_CHECK(Math::bicgstab(op, b, xp, eps, 500) < 500);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(xp, xs), 1e-8);
+	BOOST_CHECK(Math::gmres(op, b, xp, 30, eps, 1000) < 1000);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(xp, xs), 1e-8);
+
+	/* a user type */
+	Tridiagonal tri = {50};
+	MatrixXd y;
+	BOOST_CHECK(Math::conjugateGradient(tri, ones(50), y, eps, 100) < 100);
+	MatrixXd r(50, 1);
+	tri.apply(y.data(), r.data());
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(r, ones(50)), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE( test_operator_layouts ) {
+	/* products follow the storage order, not a row-major reading of data() */
+	const Math::Matrix<double, 3, 3> R{4, 1, 0,
+									   2, 5, 1,
+									   0, 1, 3};
+	const Math::Matrix<double, 3, 3, Math::ColMajor> C(R);
+	const Math::Matrix<double, 3, 3, Math::Tiled<2> > T(R);
+	const Math::Matrix<double, 3, 1> b{1, 2, 3};
+	Math::Matrix<double, 3, 1> xr, xc, xt;
+	Math::bicgstab(R, b, xr, 1e-12, 50);
+	Math::bicgstab(C, b, xc, 1e-12, 50);
+	Math::bicgstab(T, b, xt, 1e-12, 50);
+	Math::Matrix<double, 3, 1> r = Math::dot(R, xr);
+	for(int i = 0; i < 3; ++i) {
+		BOOST_CHECK_SMALL(r(i, 0) - b(i, 0), 1e-10);
+		BOOST_CHECK_SMALL(xc(i, 0) - xr(i, 0), 1e-12);
+		BOOST_CHECK_SMALL(xt(i, 0) - xr(i, 0), 1e-12);
+	}
+
+	MatrixXd g, x;
+	Math::LinearOperator<double> Hc(0, Math::LinearOperator<double>::Apply());
+	Math::rewriteSystem(C, MatrixXd(b), Hc, g);
+	Math::iterativeSolve(Hc, g, MatrixXd(3, 1), x, 1e-12, 500);
+	for(int i = 0; i < 3; ++i) {
+		BOOST_CHECK_SMALL(x(i, 0) - xr(i, 0), 1e-10);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_operator_iterative ) {
+	/* x = Hx + g with H = I - D^-1 A never stored, against the dense H */
+	const int k = 10, n = k * k;
+	const Math::LinearOperator<double> op = stencilOperator(k, 6);
+	const MatrixXd A = stencilMatrix(k, 6).toDense();
+	const MatrixXd b = ones(n), guess(n, 1);
+	Math::LinearOperator<double> H(0, Math::LinearOperator<double>::Apply());
+	MatrixXd g, Hd, gd, x, xd;
+	Math::rewriteSystem(op, b, H, g);
+	Math::rewriteSystem(A, b, Hd, gd);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(g, gd), 1e-15);
+	Math::SolverStats stats;
+	const int iter = Math::iterativeSolve(H, g, guess, x, 1e-12, 500, &stats);
+	const int iterDense = Math::iterativeSolve(Hd, gd, guess, xd, 1e-12, 500);
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK_EQUAL(iter, iterDense);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(x, xd), 1e-12);
+
+	/* a dense matrix as the operator's A: only its diagonal and products are used */
+	Math::rewriteSystem(A, b, H, g);
+	Math::iterativeSolve(H, g, guess, x, 1e-12, 500);
+	BOOST_CHECK_SMALL(Test::maxAbsDiff(x, xd), 1e-12);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
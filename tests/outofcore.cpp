@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <boost/test/unit_test.hpp>
+#include "../matrix/outofcore.hpp"
+#include "../matrix/lu.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_outofcore );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+using Test::randomMatrix;
+using Test::maxAbsDiff;
+
+namespace {
+	/* A tiled file removed with the object */
+	struct TempTiles : Math::TiledMatrix<double> {
+		TempTiles(const char *path, int rows, int cols, int tileSize)
+			: Math::TiledMatrix<double>(path, rows, cols, tileSize) {}
+		~TempTiles() { std::remove(path().c_str()); }
+	};
+
+	/* writes [A | B] a band of rows at a time, as a generator of a large system would */
+	void fill(Math::TiledMatrix<double> &file, const MatrixXd &A, const MatrixXd &B) {
+		const int n = A.rows();
+		for(int r0 = 0; r0 < n; r0 += 7) {
+			const int rows = std::min(7, n - r0);
+			MatrixXd band(rows, n + B.cols());
+			for(int i = 0; i < rows; ++i) {
+				for(int j = 0; j < n; ++j) {
+					band(i, j) = A(r0 + i, j);
+				}
+				for(int k = 0; k < B.cols(); ++k) {
+					band(i, n + k) = B(r0 + i, k);
+				}
+			}
+			file.setBlock(r0, 0, band);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_tiled_matrix ) {
+	TempTiles file("test_outofcore_blocks.bin", 10, 13, 4);
+	BOOST_CHECK_EQUAL(file.tileRows(), 3);
+	BOOST_CHECK_EQUAL(file.tileCols(), 4);
+	const MatrixXd M = randomMatrix(6, 9, 1);
+	file.setBlock(3, 2, M);
+	BOOST_CHECK(file.block(3, 2, 6, 9) == M);
+	const MatrixXd corner = file.block(0, 0, 3, 13);
+	BOOST_CHECK(corner == MatrixXd(3, 13));
+	BOOST_CHECK_EQUAL(file.block(4, 3, 1, 1)(0, 0), M(1, 1));
+}
+
+BOOST_AUTO_TEST_CASE( test_outofcore_gauss ) {
+	/* 5 x 5 tiles of 16, the last ones partial; the right-hand sides share a tile with A */
+	const int n = 75, s = 3, b = 16;
+	const MatrixXd A = randomMatrix(n, n, 2), B = randomMatrix(n, s, 3);
+	const MatrixXd expected = Math::LUFactorization<MatrixXd>(A).solve(B);
+	const size_t tileBytes = b * b * sizeof(double);
+
+	/* every tile fits: each is read and written exactly once */
+	{
+		TempTiles file("test_outofcore_all.bin", n, n + s, b);
+		fill(file, A, B);
+		MatrixXd x;
+		Math::OutOfCoreStats io;
+		Math::SolverStats stats;
+		Math::gauss(file, x, 1 << 30, &io, &stats);
+		BOOST_CHECK_SMALL(maxAbsDiff(x, expected), 1e-11);
+		BOOST_CHECK_EQUAL(io.cacheTiles, 25);
+		BOOST_CHECK_EQUAL(io.bytesRead, 25 * tileBytes);
+		BOOST_CHECK_EQUAL(io.bytesWritten, 25 * tileBytes);
+		BOOST_CHECK_EQUAL(io.misses + io.prefetched, 25);
+		BOOST_CHECK(io.hits > 0);
+		BOOST_CHECK(stats.swaps > 0);
+		BOOST_CHECK(stats.pivotGrowth >= 1);
+		BOOST_CHECK_EQUAL(stats.iterations, n);
+	}
+
+	/* the smallest budget: tiles are evicted and read again, the result is the same */
+	{
+		TempTiles file("test_outofcore_small.bin", n, n + s, b);
+		fill(file, A, B);
+		MatrixXd x;
+		Math::OutOfCoreStats io;
+		Math::gauss(file, x, 10 * tileBytes, &io);
+		BOOST_CHECK_SMALL(maxAbsDiff(x, expected), 1e-11);
+		BOOST_CHECK_EQUAL(io.cacheTiles, 10);
+		BOOST_CHECK(io.bytesRead > 25 * tileBytes);
+		BOOST_CHECK(io.bytesWritten > 25 * tileBytes);
+		BOOST_CHECK(io.stallSeconds >= 0);
+
+		/* the file holds U and the transformed right-hand sides: u_nn x_n = y_n */
+		const MatrixXd last = file.block(n - 1, n - 1, 1, s + 1);
+		for(int k = 0; k < s; ++k) {
+			BOOST_CHECK_CLOSE(last(0, 0) * x(n - 1, k), last(0, k + 1), 1e-10);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_outofcore_errors ) {
+	const int n = 40, b = 8;
+	const size_t tileBytes = b * b * sizeof(double);
+	{
+		TempTiles file("test_outofcore_budget.bin", n, n + 1, b);
+		MatrixXd x;
+		BOOST_CHECK_THROW(Math::gauss(file, x, 9 * tileBytes), std::runtime_error);
+	}
+	{
+		TempTiles file("test_outofcore_singular.bin", n, n + 1, b);
+		MatrixXd I(n, n);
+		for(int i = 0; i < n - 1; ++i) {
+			I(i, i) = 1;
+		}
+		fill(file, I, MatrixXd(n, 1));
+		MatrixXd x;
+		BOOST_CHECK_THROW(Math::gauss(file, x, 1 << 20), std::domain_error);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
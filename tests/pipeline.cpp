@@ -0,0 +1,118 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "../matrix/pipeline.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_pipeline );
+
+BOOST_AUTO_TEST_CASE( test_bounded_queue ) {
+	Math::BoundedQueue<int> q(3);
+	std::thread producer([&]() {
+		for(int i = 0; i < 100; ++i) {
+			BOOST_CHECK(q.push(i));
+		}
+		q.close();
+	});
+	int item, expected = 0;
+	while(q.pop(item)) {
+		BOOST_CHECK_EQUAL(item, expected++);
+	}
+	producer.join();
+	BOOST_CHECK_EQUAL(expected, 100);
+	BOOST_CHECK(!q.push(100));
+
+	Math::QueueStats stats = q.stats();
+	BOOST_CHECK_EQUAL(stats.capacity, 3);
+	BOOST_CHECK_EQUAL(stats.pushed, 100);
+	BOOST_CHECK(stats.maxSize >= 1 && stats.maxSize <= 3);
+	BOOST_CHECK(stats.meanSize >= 0 && stats.meanSize <= 3);
+
+	/* cancel drops what is queued and wakes a blocked producer */
+	Math::BoundedQueue<int> full(1);
+	BOOST_CHECK(full.push(1));
+	std::thread blocked([&]() { BOOST_CHECK(!full.push(2)); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	full.cancel();
+	blocked.join();
+	BOOST_CHECK(!full.pop(item));
+}
+
+BOOST_AUTO_TEST_CASE( test_pipeline_order ) {
+	const int count = 500;
+	for(int workers : {1, 3}) {
+		for(bool ordered : {true, false}) {
+			Math::PipelineOptions options;
+			options.workers = workers;
+			options.queueSize = 4;
+			options.ordered = ordered;
+			int next = 0;
+			std::vector<int> seen(count, 0);
+			long last = -1;
+			bool inOrder = true;
+			Math::PipelineStats stats = Math::runPipeline<int>(
+				[&](int &i) { i = next++; return i < count; },
+				[](int &i) {
+					/* every tenth item is slow, so results overtake each other */
+					if(i % 10 == 0) {
+						std::this_thread::sleep_for(std::chrono::microseconds(200));
+					}
+					return 2 * i;
+				},
+				[&](long index, int r) {
+					BOOST_CHECK_EQUAL(r, 2 * index);
+					++seen[index];
+					inOrder = inOrder && index == last + 1;
+					last = index;
+				},
+				options);
+			BOOST_CHECK_EQUAL(stats.items, count);
+			BOOST_CHECK_EQUAL(stats.workers, workers);
+			BOOST_CHECK(std::count(seen.begin(), seen.end(), 1) == count);
+			if(ordered) {
+				BOOST_CHECK(inOrder);
+				BOOST_CHECK(stats.maxReorder < 2 * options.queueSize + workers);
+			}
+			BOOST_CHECK_EQUAL(stats.input.pushed, count);
+			BOOST_CHECK(stats.input.maxSize <= 4 && stats.output.maxSize <= 4);
+			BOOST_CHECK(stats.throughput() > 0);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_pipeline_errors ) {
+	Math::PipelineOptions options;
+	options.workers = 2;
+	options.queueSize = 2;
+	int next = 0;
+	auto read = [&](int &i) { i = next++; return i < 1000; };
+	auto write = [](long, int) {};
+
+	/* a failing stage stops the others and its exception comes out */
+	BOOST_CHECK_THROW(Math::runPipeline<int>(read, [](int &i) -> int {
+		if(i == 7) {
+			throw std::domain_error("seven");
+		}
+		return i;
+	}, write, options), std::domain_error);
+
+	next = 0;
+	BOOST_CHECK_THROW(Math::runPipeline<int>([&](int &i) -> bool {
+		if(next == 50) {
+			throw std::runtime_error("bad input");
+		}
+		i = next++;
+		return true;
+	}, [](int &i) { return i; }, write, options), std::runtime_error);
+
+	next = 0;
+	BOOST_CHECK_THROW(Math::runPipeline<int>(read, [](int &i) { return i; }, [](long index, int) {
+		if(index == 3) {
+			throw std::runtime_error("disk full");
+		}
+	}, options), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
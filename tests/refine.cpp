@@ -0,0 +1,99 @@
+#include <boost/test/unit_test.hpp>
+#include "../matrix/refine.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_refine );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+using Test::randomMatrix;
+using Test::hilbert;
+using Test::maxAbsDiff;
+
+BOOST_AUTO_TEST_CASE( test_cast ) {
+	MatrixXd A(2, 2, {1.5, -2, 1e-3, 4});
+	Math::DynamicMatrix<float> F = Math::cast<float>(A);
+	BOOST_CHECK_EQUAL(F(0, 0), 1.5f);
+	BOOST_CHECK_EQUAL(F(1, 0), 1e-3f);
+	MatrixXd back = Math::cast<double>(F + F);
+	BOOST_CHECK_EQUAL(back(1, 1), 8);
+}
+
+BOOST_AUTO_TEST_CASE( test_refine_accuracy ) {
+	const int n = 200;
+	MatrixXd A = randomMatrix(n, n, 1);
+	for(int i = 0; i < n; ++i) {
+		A(i, i) += 10;
+	}
+	const MatrixXd b = randomMatrix(n, 3, 2);
+
+	Math::MixedPrecisionSolver<MatrixXd> solver(A);
+	Math::SolverStats stats;
+	MatrixXd x = solver.solve(b, &stats);
+	BOOST_CHECK(!solver.fullPrecision());
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK(stats.iterations > 0 && stats.iterations < 10);
+	BOOST_CHECK(stats.residuals.back() <= 1e-14);
+	/* the float solution alone is about 1e-6 off */
+	BOOST_CHECK(stats.residuals.front() > 1e-10);
+
+	MatrixXd expected = Math::LUFactorization<MatrixXd>(A).solve(b);
+	BOOST_CHECK_SMALL(maxAbsDiff(x, expected), 1e-12);
+	MatrixXd r = b - Math::dot(A, x);
+	BOOST_CHECK_SMALL(maxAbsDiff(r, MatrixXd(n, 3)), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( test_refine_fallback ) {
+	/* cond(H_10) ~ 1e13: far beyond float, fine for double LU */
+	const int n = 10;
+	const MatrixXd H = hilbert(n);
+	MatrixXd xTrue(n, 1);
+	for(int i = 0; i < n; ++i) {
+		xTrue(i, 0) = 1;
+	}
+	const MatrixXd b = Math::dot(H, xTrue);
+
+	Math::MixedPrecisionSolver<MatrixXd> solver(H);
+	Math::SolverStats stats;
+	MatrixXd x = solver.solve(b, &stats);
+	BOOST_CHECK(solver.fullPrecision());
+	MatrixXd expected = Math::LUFactorization<MatrixXd>(H).solve(b);
+	BOOST_CHECK_SMALL(maxAbsDiff(x, expected), 1e-15);
+	/* the full-precision solution is measured too: its backward error is the last one */
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK(stats.residuals.back() <= 1e-14);
+	BOOST_CHECK_EQUAL(stats.iterations + 1, static_cast<int>(stats.residuals.size()));
+
+	/* a tolerance that not even double LU reaches is not reported as converged */
+	Math::MixedPrecisionSolver<MatrixXd> strict(H, 1e-30);
+	strict.solve(b, &stats);
+	BOOST_CHECK(strict.fullPrecision());
+	BOOST_CHECK(!stats.converged);
+	BOOST_CHECK(stats.residuals.back() > 1e-30);
+
+	/* out of the range of float */
+	MatrixXd big(2, 2, {1e300, 1, 1, 1e300});
+	Math::MixedPrecisionSolver<MatrixXd> bigSolver(big);
+	BOOST_CHECK(bigSolver.fullPrecision());
+	MatrixXd y = bigSolver.solve(MatrixXd(2, 1, {1e300, 1e300}));
+	BOOST_CHECK_CLOSE(y(0, 0), 1, 1e-10);
+
+	MatrixXd singular(2, 2, {1, 2, 2, 4});
+	Math::MixedPrecisionSolver<MatrixXd> singularSolver(singular);
+	BOOST_CHECK_THROW(singularSolver.solve(MatrixXd(2, 1, {1, 2})), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_refine_fixed ) {
+	Math::Matrix<double, 3, 3> A{4, -1, -1,
+								 -2, 6, 1,
+								 -1, 1, 7};
+	Math::Matrix<double, 3, 1> b{3, 9, -6};
+	Math::MixedPrecisionSolver<Math::Matrix<double, 3, 3> > solver(A);
+	Math::Matrix<double, 3, 1> x = solver.solve(b);
+	Math::Matrix<double, 3, 1> r = b - Math::dot(A, x);
+	for(int i = 0; i < 3; ++i) {
+		BOOST_CHECK_SMALL(r(i, 0), 1e-13);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,138 @@
+#include <memory>
+#include <pthread.h>
+#include <boost/test/unit_test.hpp>
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_small );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* Test::randomMatrix() in a fixed-size matrix */
+	template<int n, int m>
+	Math::Matrix<double, n, m> randomFixed(unsigned seed) {
+		return Math::Matrix<double, n, m>(Test::randomMatrix(n, m, seed));
+	}
+
+	template<int n, int m>
+	MatrixXd toDynamic(const Math::Matrix<double, n, m> &A) {
+		MatrixXd D(n, m);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < m; ++j) {
+				D(i, j) = A(i, j);
+			}
+		}
+		return D;
+	}
+
+	template<int n>
+	void checkInverse(unsigned seed) {
+		Math::Matrix<double, n, n> A = randomFixed<n, n>(seed);
+		/* a zero leading element: only a pivoting elimination gets past it,
+		   which the generic invert() beyond 8 x 8 is not */
+		if(n <= 8) {
+			A(0, 0) = 0;
+		}
+		const Math::Matrix<double, n, n> inv = Math::invert(A);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(A, inv), Math::identity<double, n>()), 1e-11);
+		BOOST_CHECK_SMALL(Test::maxAbsDiff(Math::dot(inv, A), Math::identity<double, n>()), 1e-11);
+		const double expected = Math::LUFactorization<MatrixXd>(toDynamic(A)).determinant();
+		BOOST_CHECK_CLOSE(Math::determinant(A), expected, 1e-9);
+	}
+
+	/* determinant() of a large fixed matrix, for a thread with a small stack */
+	const int largeSize = 200;
+	typedef Math::Matrix<double, largeSize, largeSize> LargeMatrix;
+	struct LargeDeterminant {
+		const LargeMatrix *A;
+		double det;
+	};
+
+	void* largeDeterminant(void *arg) {
+		LargeDeterminant *job = static_cast<LargeDeterminant*>(arg);
+		job->det = Math::determinant(*job->A);
+		return nullptr;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_small_product ) {
+	/* the unrolled kernel adds in the same order as the generic one */
+	const Math::Matrix<double, 3, 5> A = randomFixed<3, 5>(1);
+	const Math::Matrix<double, 5, 4> B = randomFixed<5, 4>(2);
+	const Math::Matrix<double, 3, 4> C = Math::dot(A, B);
+	const MatrixXd D = Math::dot(toDynamic(A), toDynamic(B));
+	BOOST_CHECK(toDynamic(C) == D);
+
+	Math::Matrix<double, 3, 4> E = randomFixed<3, 4>(3);
+	const MatrixXd F = toDynamic(E) + Math::dot(toDynamic(A), toDynamic(B));
+	E = E + Math::dot(A, B);
+	BOOST_CHECK(toDynamic(E) == F);
+
+	const Math::Matrix<double, 8, 1> v = randomFixed<8, 1>(4);
+	double sum = 0;
+	for(int i = 0; i < 8; ++i) {
+		sum += v(i, 0) * v(i, 0);
+	}
+	BOOST_CHECK_CLOSE(Math::euclidNorm(v), std::sqrt(sum), 1e-12);
+	BOOST_CHECK_CLOSE(Math::euclidNorm(v - v * 2.0), std::sqrt(sum), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE( test_small_gauss ) {
+	/* the same steps as the runtime-sized gauss(), so the same bits */
+	const Math::Pivoting modes[] = {Math::Pivoting::None, Math::Pivoting::Rows,
+									Math::Pivoting::Columns, Math::Pivoting::Full};
+	for(Math::Pivoting p : modes) {
+		Math::Matrix<double, 6, 8> ext = randomFixed<6, 8>(5);
+		MatrixXd dyn = toDynamic(ext), y;
+		Math::Matrix<double, 6, 2> x;
+		Math::gauss(ext, x, p);
+		Math::gauss(dyn, y, p);
+		BOOST_CHECK(toDynamic(x) == y);
+		BOOST_CHECK(toDynamic(ext) == dyn);
+	}
+
+	/* with stats the generic code runs, and gives the same answer */
+	Math::Matrix<double, 4, 5> ext = randomFixed<4, 5>(6), copy(ext);
+	Math::Matrix<double, 4, 1> x, y;
+	Math::SolverStats stats;
+	Math::gauss(ext, x);
+	Math::gauss(copy, y, false, 1e-5, &stats);
+	BOOST_CHECK(x == y);
+	BOOST_CHECK_EQUAL(stats.iterations, 4);
+}
+
+BOOST_AUTO_TEST_CASE( test_small_invert ) {
+	checkInverse<1>(7);
+	checkInverse<2>(8);
+	checkInverse<3>(9);
+	checkInverse<4>(10);
+	checkInverse<5>(11);
+	checkInverse<6>(12);
+	checkInverse<8>(13);
+	checkInverse<10>(14);
+
+	Math::Matrix<double, 3, 3> singular{1, 2, 3, 2, 4, 6, 0, 1, 1};
+	BOOST_CHECK_EQUAL(Math::determinant(singular), 0);
+	Math::Matrix<double, 6, 6> zero;
+	BOOST_CHECK_EQUAL(Math::determinant(zero), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_small_large_determinant ) {
+	/* beyond smallSize the working copy is on the heap: 320 KB would not fit this stack */
+	std::unique_ptr<LargeMatrix> A(new LargeMatrix);
+	*A = Test::randomMatrix(largeSize, largeSize, 15);
+	LargeDeterminant job = {A.get(), 0};
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, 128 * 1024);
+	pthread_t thread;
+	BOOST_REQUIRE_EQUAL(pthread_create(&thread, &attr, largeDeterminant, &job), 0);
+	pthread_join(thread, nullptr);
+	pthread_attr_destroy(&attr);
+	const double expected = Math::LUFactorization<MatrixXd>(toDynamic(*A)).determinant();
+	BOOST_CHECK_CLOSE(job.det, expected, 1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
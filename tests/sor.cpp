@@ -0,0 +1,189 @@
+#include <cmath>
+#include <cstdlib>
+#include <boost/test/unit_test.hpp>
+#include "../matrix/sor.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_sor );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::SparseMatrix<double> SparseXd;
+
+namespace {
+	/* 5-point Laplacian on a k x k grid, numbered along x first */
+	SparseXd stencil(int k) {
+		std::vector<Math::Triplet<double> > t;
+		for(int i = 0; i < k; ++i) {
+			for(int j = 0; j < k; ++j) {
+				int r = i * k + j;
+				t.push_back({r, r, 4});
+				if(i > 0) t.push_back({r, r - k, -1});
+				if(i < k - 1) t.push_back({r, r + k, -1});
+				if(j > 0) t.push_back({r, r - 1, -1});
+				if(j < k - 1) t.push_back({r, r + 1, -1});
+			}
+		}
+		return SparseXd(k * k, k * k, t);
+	}
+
+	MatrixXd ones(int n) {
+		MatrixXd b(n, 1);
+		for(int i = 0; i < n; ++i) {
+			b(i, 0) = 1;
+		}
+		return b;
+	}
+
+	double residual(const SparseXd &A, const MatrixXd &x, const MatrixXd &b) {
+		MatrixXd Ax(A.rows(), 1);
+		A.multiply(x.data(), Ax.data());
+		double r = 0;
+		for(int i = 0; i < A.rows(); ++i) {
+			r = std::max(r, std::abs(Ax(i, 0) - b(i, 0)));
+		}
+		return r;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_colouring ) {
+	const int k = 8;
+	const SparseXd A = stencil(k);
+	const Math::Colouring rb = Math::Colouring::redBlack(k, k);
+	BOOST_CHECK_EQUAL(rb.colours(), 2);
+	BOOST_CHECK_EQUAL(rb.count(0), 32);
+	BOOST_CHECK_EQUAL(rb.count(1), 32);
+	BOOST_CHECK(rb.independent(A));
+	BOOST_CHECK_EQUAL(Math::Colouring::greedy(A).colours(), 2);
+	BOOST_CHECK(!Math::Colouring::redBlack(k * k).independent(A));
+
+	/* only a_ij with j > i is stored, so the coupling shows in A^T alone */
+	std::vector<Math::Triplet<double> > t;
+	std::srand(1);
+	for(int i = 0; i < 60; ++i) {
+		t.push_back({i, i, 10});
+		for(int e = 0; e < 3; ++e) {
+			const int j = std::rand() % 60;
+			if(j > i) {
+				t.push_back({i, j, 1});
+			}
+		}
+	}
+	const SparseXd U(60, 60, t);
+	const Math::Colouring greedy = Math::Colouring::greedy(U);
+	BOOST_CHECK(greedy.independent(U));
+	BOOST_CHECK(greedy.colours() >= 2);
+	int total = 0;
+	for(int c = 0; c < greedy.colours(); ++c) {
+		for(int r = 1; r < greedy.count(c); ++r) {
+			BOOST_CHECK(greedy.rows(c)[r - 1] < greedy.rows(c)[r]);
+		}
+		total += greedy.count(c);
+	}
+	BOOST_CHECK_EQUAL(total, 60);
+}
+
+BOOST_AUTO_TEST_CASE( test_sor_dense ) {
+	const int n = 6;
+	Math::Matrix<double, n, n> A;
+	Math::Matrix<double, n, 1> b, x;
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			A(i, j) = (i == j) ? 10 : 1.0 / (1 + i + j);
+		}
+		b(i, 0) = i + 1;
+	}
+	const double eps = 1e-12;
+	Math::SolverStats stats;
+	Math::sor(A, b, x, 1.1, eps, 100, &stats);
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK_EQUAL(stats.omega, 1.1);
+	for(int i = 0; i < n; ++i) {
+		double s = 0;
+		for(int j = 0; j < n; ++j) {
+			s += A(i, j) * x(j, 0);
+		}
+		BOOST_CHECK_SMALL(s - b(i, 0), 1e-10);
+	}
+
+	MatrixXd D(n, n), d(n, 1), y;
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			D(i, j) = A(i, j);
+		}
+		d(i, 0) = b(i, 0);
+	}
+	Math::ssor(D, d, y, Math::autoOmega, eps, 100, &stats);
+	BOOST_CHECK(stats.converged);
+	for(int i = 0; i < n; ++i) {
+		BOOST_CHECK_SMALL(y(i, 0) - x(i, 0), 1e-10);
+	}
+
+	/* omega = 1 is Gauss-Seidel */
+	MatrixXd g;
+	const int sweeps = Math::seidel(D, d, g, eps, 100);
+	BOOST_CHECK_EQUAL(Math::sor(D, d, y, 1.0, eps, 100), sweeps);
+}
+
+BOOST_AUTO_TEST_CASE( test_sor_adaptive ) {
+	const int k = 32, n = k * k;
+	const SparseXd A = stencil(k);
+	const MatrixXd b = ones(n);
+	const double eps = 1e-8;
+	MatrixXd x;
+
+	Math::SolverStats gs;
+	Math::seidel(A, b, x, eps, 10000, &gs);
+	BOOST_CHECK(gs.converged);
+
+	/* Young's optimum for the model problem: 2 / (1 + sin(pi h)) */
+	const double best = 2 / (1 + std::sin(M_PI / (k + 1)));
+	Math::SolverStats stats;
+	Math::sor(A, b, x, Math::autoOmega, eps, 10000, &stats);
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK_SMALL(residual(A, x, b), 1e-5);
+	BOOST_CHECK_CLOSE(stats.omega, best, 3);
+	BOOST_CHECK(stats.iterations * 4 < gs.iterations);
+
+	Math::SolverStats fixed;
+	Math::sor(A, b, x, best, eps, 10000, &fixed);
+	BOOST_CHECK(stats.iterations < 2 * fixed.iterations);
+
+	Math::SolverStats sym;
+	Math::ssor(A, b, x, Math::autoOmega, eps, 10000, &sym);
+	BOOST_CHECK(sym.converged);
+	BOOST_CHECK_SMALL(residual(A, x, b), 1e-5);
+	BOOST_CHECK(sym.omega > 1.5);
+	BOOST_CHECK(sym.iterations * 2 < gs.iterations);
+}
+
+BOOST_AUTO_TEST_CASE( test_multicolour ) {
+	const int k = 40, n = k * k;
+	const SparseXd A = stencil(k);
+	const MatrixXd b = ones(n);
+	const Math::Colouring rb = Math::Colouring::redBlack(k, k);
+	const double eps = 1e-8;
+
+	/* the rows of a colour are independent: any number of threads gives the same bits */
+	Math::ThreadPool one(1), four(4);
+	MatrixXd x1, x4;
+	Math::SolverStats s1, s4;
+	Math::sor(A, b, x1, rb, one, Math::autoOmega, eps, 10000, &s1);
+	Math::sor(A, b, x4, rb, four, Math::autoOmega, eps, 10000, &s4);
+	BOOST_CHECK(s1.converged);
+	BOOST_CHECK_EQUAL(s1.iterations, s4.iterations);
+	BOOST_CHECK(x1 == x4);
+	BOOST_CHECK_SMALL(residual(A, x4, b), 1e-5);
+
+	Math::SolverStats gs;
+	Math::seidel(A, b, x1, rb, four, eps, 10000, &gs);
+	BOOST_CHECK(gs.converged);
+	BOOST_CHECK_SMALL(residual(A, x1, b), 1e-4);
+	BOOST_CHECK(s4.iterations * 4 < gs.iterations);
+
+	MatrixXd y;
+	Math::SolverStats sym;
+	Math::ssor(A, b, y, Math::Colouring::greedy(A), four, Math::autoOmega, eps, 10000, &sym);
+	BOOST_CHECK(sym.converged);
+	BOOST_CHECK_SMALL(residual(A, y, b), 1e-5);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
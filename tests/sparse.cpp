@@ -0,0 +1,86 @@
+#include <boost/test/unit_test.hpp>
+#include "../matrix/sparse.hpp"
+#include "../matrix/util.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_sparse );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+typedef Math::SparseMatrix<double> SparseXd;
+
+namespace {
+	/* 5-point Laplacian on a k x k grid */
+	SparseXd poisson(int k) {
+		std::vector<Math::Triplet<double> > t;
+		for(int i = 0; i < k; ++i) {
+			for(int j = 0; j < k; ++j) {
+				int r = i * k + j;
+				t.push_back({r, r, 4});
+				if(i > 0) t.push_back({r, r - k, -1});
+				if(i < k - 1) t.push_back({r, r + k, -1});
+				if(j > 0) t.push_back({r, r - 1, -1});
+				if(j < k - 1) t.push_back({r, r + 1, -1});
+			}
+		}
+		return SparseXd(k * k, k * k, t);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_sparse_build ) {
+	std::vector<Math::Triplet<double> > t = {{1, 2, 3}, {0, 0, 1}, {1, 0, 2}, {1, 2, 4}, {2, 1, 5}};
+	SparseXd A(3, 3, t);
+	BOOST_CHECK_EQUAL(A.nonZeros(), 4);
+	BOOST_CHECK_EQUAL(A.coeff(1, 2), 7);
+	BOOST_CHECK_EQUAL(A.coeff(1, 1), 0);
+	MatrixXd expected(3, 3, {1, 0, 0,
+							 2, 0, 7,
+							 0, 5, 0});
+	BOOST_CHECK(A.toDense() == expected);
+	BOOST_CHECK(SparseXd(expected).toDense() == expected);
+
+	MatrixXd x(3, 2, {1, 2,
+					  3, 4,
+					  5, 6});
+	BOOST_CHECK(Math::dot(A, x) == MatrixXd(Math::dot(expected, x)));
+	MatrixXd v(3, 1, {1, 2, 3});
+	BOOST_CHECK(Math::dot(A, v) == MatrixXd(Math::dot(expected, v)));
+}
+
+BOOST_AUTO_TEST_CASE( test_sparse_matches_dense ) {
+	MatrixXd mat(3, 3, {4, -1, -1,
+						-2, 6, 1,
+						-1, 1, 7});
+	MatrixXd vec(3, 1, {3, 9, -6});
+	SparseXd A(mat);
+
+	MatrixXd x, xs;
+	int iter = Math::seidel(mat, vec, x, 1e-8);
+	BOOST_CHECK_EQUAL(Math::seidel(A, vec, xs, 1e-8), iter);
+	BOOST_CHECK_SMALL(Math::euclidNorm(x - xs), 1e-14);
+
+	MatrixXd H, g;
+	SparseXd Hs;
+	MatrixXd gs;
+	Math::rewriteSystem(mat, vec, H, g);
+	Math::rewriteSystem(A, vec, Hs, gs);
+	BOOST_CHECK(Hs.toDense() == H);
+	BOOST_CHECK(gs == g);
+	iter = Math::iterativeSolve(H, g, MatrixXd(3, 1), x, 1e-8);
+	BOOST_CHECK_EQUAL(Math::iterativeSolve(Hs, gs, MatrixXd(3, 1), xs, 1e-8), iter);
+	BOOST_CHECK_SMALL(Math::euclidNorm(x - xs), 1e-14);
+}
+
+BOOST_AUTO_TEST_CASE( test_sparse_poisson ) {
+	const int k = 30, n = k * k;
+	SparseXd A = poisson(k);
+	BOOST_CHECK_EQUAL(A.nonZeros(), 5 * n - 4 * k);
+	MatrixXd b(n, 1);
+	for(int i = 0; i < n; ++i) {
+		b(i, 0) = 1;
+	}
+	MatrixXd x;
+	int iter = Math::seidel(A, b, x, 1e-10, 10000);
+	BOOST_CHECK(iter < 10000);
+	BOOST_CHECK_SMALL(Math::euclidNorm(b - Math::dot(A, x)), 1e-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
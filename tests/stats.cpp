@@ -0,0 +1,148 @@
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+#include "../matrix/sparse.hpp"
+#include "../matrix/util.hpp"
+#include "../problems/p13/eigen.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_stats );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	/* Redirects std::cout for the lifetime of the object */
+	struct CaptureCout {
+		std::ostringstream text;
+		std::streambuf *old;
+		CaptureCout() : old(std::cout.rdbuf(text.rdbuf())) {}
+		~CaptureCout() { std::cout.rdbuf(old); }
+	};
+
+	MatrixXd dominant(int n, int cols) {
+		MatrixXd A(n, cols);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < cols; ++j) {
+				A(i, j) = (i == j) ? 4 : ((i + 2 * j) % 5 == 0 ? 1 : 0);
+			}
+		}
+		return A;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_stats_gauss ) {
+	/* tiny leading element: swapVar swaps x and y */
+	MatrixXd mat(2, 3, {1e-8, 1, 1,
+						1,    1, 2});
+	MatrixXd x;
+	Math::SolverStats stats;
+	{
+		CaptureCout capture;
+		Math::gauss(mat, x, true, 1e-5, &stats);
+		BOOST_CHECK(capture.text.str().empty());
+	}
+	BOOST_CHECK_CLOSE(x(0, 0), 1, 1e-4);
+	BOOST_CHECK_CLOSE(x(1, 0), 1, 1e-4);
+	BOOST_CHECK_EQUAL(stats.swaps, 1);
+	BOOST_CHECK_EQUAL(stats.smallPivots, 1);
+	BOOST_CHECK_EQUAL(stats.iterations, 2);
+	BOOST_CHECK_CLOSE(stats.pivotGrowth, 1, 1e-6);
+	BOOST_CHECK(stats.seconds >= 0);
+
+	/* no swapping: the small pivot is counted, nothing is printed */
+	MatrixXd mat2(2, 3, {1e-8, 1, 1,
+						 1,    1, 2});
+	{
+		CaptureCout capture;
+		Math::gauss(mat2, x, false, 1e-5, &stats);
+		BOOST_CHECK(capture.text.str().empty());
+	}
+	BOOST_CHECK_EQUAL(stats.swaps, 0);
+	BOOST_CHECK_EQUAL(stats.smallPivots, 1);
+	BOOST_CHECK(stats.pivotGrowth > 1e7);
+}
+
+BOOST_AUTO_TEST_CASE( test_stats_iterative ) {
+	const int n = 20;
+	const MatrixXd ext = dominant(n, n + 1);
+	MatrixXd A(n, n), b(n, 1);
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			A(i, j) = ext(i, j);
+		}
+		b(i, 0) = ext(i, n);
+	}
+	MatrixXd H, g, sol;
+	Math::rewriteSystem(A, b, H, g);
+	Math::SolverStats stats;
+	int iter = Math::iterativeSolve(H, g, MatrixXd(n, 1), sol, 1e-8, 100, &stats);
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK_EQUAL(stats.iterations, iter);
+	BOOST_CHECK_EQUAL(static_cast<int>(stats.residuals.size()), iter + 1);
+	BOOST_CHECK(stats.residuals.back() < 1e-8);
+	BOOST_CHECK(stats.residuals.back() < stats.residuals.front());
+
+	iter = Math::seidel(A, b, sol, 1e-8, 100, &stats);
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK_EQUAL(static_cast<int>(stats.residuals.size()), iter + 1);
+
+	/* the sparse sweeps report the same way */
+	Math::SparseMatrix<double> S(A);
+	int sparseIter = Math::seidel(S, b, sol, 1e-8, 100, &stats);
+	BOOST_CHECK_EQUAL(sparseIter, iter);
+	BOOST_CHECK(stats.converged);
+}
+
+BOOST_AUTO_TEST_CASE( test_stats_callback ) {
+	const int n = 20;
+	const MatrixXd ext = dominant(n, n + 1);
+	MatrixXd A(n, n), b(n, 1), sol;
+	for(int i = 0; i < n; ++i) {
+		for(int j = 0; j < n; ++j) {
+			A(i, j) = ext(i, j);
+		}
+		b(i, 0) = ext(i, n);
+	}
+	std::vector<double> seen;
+	Math::IterationCallback stopAtThree = [&](int i, double residual) {
+		seen.push_back(residual);
+		return i < 2;
+	};
+	Math::SolverStats stats;
+	int iter = Math::seidel(A, b, sol, 1e-12, 100, &stats, stopAtThree);
+	BOOST_CHECK_EQUAL(iter, 2);
+	BOOST_CHECK_EQUAL(seen.size(), 3u);
+	BOOST_CHECK(stats.cancelled);
+	BOOST_CHECK(!stats.converged);
+	BOOST_CHECK(stats.residuals == seen);
+
+	/* a callback without stats */
+	seen.clear();
+	iter = Math::seidel(A, b, sol, 1e-12, 100, nullptr, stopAtThree);
+	BOOST_CHECK_EQUAL(iter, 2);
+
+	MatrixXd S(3, 3, {4, -1, -1,
+					  -1, 6, 1,
+					  -1, 1, 7}), X;
+	int rotations = 0;
+	Math::jakobi(S, X, 1e-6, &stats, [&](int, double) { return ++rotations < 2; });
+	BOOST_CHECK_EQUAL(rotations, 2);
+	BOOST_CHECK_EQUAL(stats.iterations, 2);
+	BOOST_CHECK(stats.cancelled);
+}
+
+BOOST_AUTO_TEST_CASE( test_stats_jakobi ) {
+	MatrixXd A(3, 3, {4, -1, -1,
+					  -1, 6, 1,
+					  -1, 1, 7}), X;
+	Math::SolverStats stats;
+	Math::jakobi(A, X, 1e-6, &stats);
+	BOOST_CHECK(stats.converged);
+	BOOST_CHECK(stats.iterations > 0);
+	BOOST_CHECK_EQUAL(static_cast<int>(stats.residuals.size()), stats.iterations);
+	BOOST_CHECK(stats.residuals.back() <= 1e-6);
+
+	std::ostringstream report;
+	report << stats;
+	BOOST_CHECK(report.str().find("converged") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
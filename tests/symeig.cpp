@@ -0,0 +1,86 @@
+#include <boost/test/unit_test.hpp>
+#include <cstdlib>
+#include "../matrix/symeig.hpp"
+#include "../matrix/jacobi.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_symeig );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+namespace {
+	void checkSolver(const MatrixXd &A, Math::EigenMethod method, int blockSize) {
+		const int n = A.rows();
+		Math::SymmetricEigenSolver<MatrixXd> solver(A, true, method, blockSize);
+		const std::vector<double> &l = solver.eigenvalues();
+		const MatrixXd &X = solver.eigenvectors();
+		MatrixXd AX = Math::dot(A, X);
+		double residual = 0, orthogonality = 0;
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				residual = std::max(residual, std::abs(AX(i, j) - X(i, j) * l[j]));
+				double xtx = 0;
+				for(int k = 0; k < n; ++k) {
+					xtx += X(k, i) * X(k, j);
+				}
+				orthogonality = std::max(orthogonality, std::abs(xtx - (i == j)));
+			}
+		}
+		BOOST_CHECK_SMALL(residual, 1e-10 * n);
+		BOOST_CHECK_SMALL(orthogonality, 1e-12 * n);
+		BOOST_CHECK(std::is_sorted(l.begin(), l.end()));
+
+		/* same spectrum as Jacobi and as the eigenvalues-only mode */
+		MatrixXd D(A), J;
+		Math::jacobiEigen(D, J, 1e-13);
+		std::vector<double> expected;
+		for(int i = 0; i < n; ++i) {
+			expected.push_back(D(i, i));
+		}
+		std::sort(expected.begin(), expected.end());
+		Math::SymmetricEigenSolver<MatrixXd> valuesOnly(A, false);
+		for(int i = 0; i < n; ++i) {
+			BOOST_CHECK_SMALL(l[i] - expected[i], 1e-10);
+			BOOST_CHECK_SMALL(valuesOnly.eigenvalues()[i] - expected[i], 1e-10);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_symeig_small ) {
+	/* the matrix of problem 13, through the jakobi-like interface */
+	Math::Matrix<double, 3, 3> A{-0.81417, -0.01937, 0.41372,
+			-0.01937, 0.54414, 0.00590,
+			0.41372, 0.00590, -0.81445};
+	Math::Matrix<double, 3, 3> D(A), X;
+	Math::symmetricEigen(D, X);
+	BOOST_CHECK_CLOSE(D(2, 2), 0.544416, 1e-3);
+	BOOST_CHECK_EQUAL(D(0, 1), 0);
+	checkSolver(MatrixXd(A), Math::EigenMethod::QR, 32);
+}
+
+BOOST_AUTO_TEST_CASE( test_symeig_methods ) {
+	const int sizes[] = {1, 2, 37, 100};
+	for(int n : sizes) {
+		MatrixXd A = Test::randomSymmetric(n, n);
+		checkSolver(A, Math::EigenMethod::QR, 8);
+		checkSolver(A, Math::EigenMethod::DivideAndConquer, 32);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_symeig_deflation ) {
+	/* repeated eigenvalues and decoupled blocks force deflation in the merges */
+	const int n = 80;
+	MatrixXd A(n, n);
+	for(int i = 0; i < n; ++i) {
+		A(i, i) = (i % 3 == 0) ? 1 : 2;
+		if(i + 1 < n && i % 20 != 19) {
+			A(i, i + 1) = A(i + 1, i) = 1e-3 * (i % 2);
+		}
+	}
+	checkSolver(A, Math::EigenMethod::DivideAndConquer, 16);
+	/* identity: everything deflates */
+	checkSolver(Math::identity<double>(70), Math::EigenMethod::DivideAndConquer, 16);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,113 @@
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <stdexcept>
+#include "../matrix/lu.hpp"
+#include "../matrix/util.hpp"
+#include "common.hpp"
+
+BOOST_AUTO_TEST_SUITE( test_suite_threadpool );
+
+typedef Math::DynamicMatrix<double> MatrixXd;
+
+BOOST_AUTO_TEST_CASE( test_parallel_for ) {
+	const int threads[] = {1, 2, 4};
+	for(int t : threads) {
+		Math::ThreadPool pool(t);
+		BOOST_CHECK_EQUAL(pool.size(), t);
+		std::vector<int> hits(1000);
+		Math::parallelFor(pool, 0, 1000, 7, [&](int lo, int hi) {
+			for(int i = lo; i < hi; ++i) {
+				++hits[i];
+			}
+		});
+		BOOST_CHECK(std::count(hits.begin(), hits.end(), 1) == 1000);
+
+		/* nested groups must not deadlock */
+		std::atomic<int> count(0);
+		Math::parallelFor(pool, 0, 8, 1, [&](int lo, int hi) {
+			for(int i = lo; i < hi; ++i) {
+				Math::parallelFor(pool, 0, 8, 1, [&](int lo, int hi) { count += hi - lo; });
+			}
+		});
+		BOOST_CHECK_EQUAL(count.load(), 64);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_task_exception ) {
+	Math::ThreadPool pool(3);
+	Math::TaskGroup group(pool);
+	for(int i = 0; i < 10; ++i) {
+		group.run([i]() {
+			if(i == 5) {
+				throw std::runtime_error("task failed");
+			}
+		});
+	}
+	BOOST_CHECK_THROW(group.wait(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_task_graph ) {
+	/* a diamond a -> (b, c) -> d, then a chain of 50 tasks after d */
+	for(int threads : {1, 4}) {
+		Math::ThreadPool pool(threads);
+		Math::TaskGraph graph(pool);
+		std::atomic<int> clock(0);
+		std::vector<int> at(54, -1);
+		auto stamp = [&](int t) { return [&, t]() { at[t] = clock++; }; };
+		int a = graph.add(stamp(0));
+		int b = graph.add(stamp(1), {a});
+		int c = graph.add(stamp(2), {a, -1});
+		int last = graph.add(stamp(3), {b, c});
+		for(int t = 4; t < 54; ++t) {
+			last = graph.add(stamp(t), {last});
+		}
+		BOOST_CHECK_EQUAL(graph.size(), 54);
+		graph.run();
+		BOOST_CHECK(at[0] < at[1] && at[0] < at[2]);
+		BOOST_CHECK(at[1] < at[3] && at[2] < at[3]);
+		for(int t = 4; t < 54; ++t) {
+			BOOST_CHECK_EQUAL(at[t], t);
+		}
+	}
+
+	/* a failing task stops the tasks after it, not the independent ones */
+	Math::ThreadPool pool(4);
+	Math::TaskGraph graph(pool);
+	std::atomic<int> ran(0);
+	int bad = graph.add([]() { throw std::runtime_error("task failed"); });
+	graph.add([&]() { ++ran; }, {bad});
+	graph.add([&]() { ++ran; });
+	BOOST_CHECK_THROW(graph.run(), std::runtime_error);
+	BOOST_CHECK_EQUAL(ran.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( test_parallel_gauss ) {
+	const int n = 200, s = 3;
+	MatrixXd ext = Test::randomMatrix(n, n + s, 2);
+	for(int i = 0; i < n; ++i) {
+		ext(i, i) += n;
+	}
+	MatrixXd serialMat(ext), serialX;
+	Math::gauss(serialMat, serialX);
+
+	const int threads[] = {1, 2, 4};
+	for(int t : threads) {
+		Math::ThreadPool pool(t);
+		MatrixXd mat(ext), x;
+		Math::gauss(mat, x, pool);
+		/* every element is updated by the same operations in the same order */
+		BOOST_CHECK(x == serialX);
+
+		MatrixXd A(n, n);
+		for(int i = 0; i < n; ++i) {
+			for(int j = 0; j < n; ++j) {
+				A(i, j) = ext(i, j);
+			}
+		}
+		Math::LUFactorization<MatrixXd> lu(A, pool, 32);
+		Math::LUFactorization<MatrixXd> serialLu(A, 32);
+		BOOST_CHECK(lu.matrixLU() == serialLu.matrixLU());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END();